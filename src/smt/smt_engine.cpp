@@ -115,6 +115,7 @@
 #include "smt/logic_request.h"
 #include "smt/managed_ostreams.h"
 #include "smt/smt_engine_scope.h"
+#include "smt/telemetry.h"
 #include "smt/term_formula_removal.h"
 #include "smt/update_ostream.h"
 #include "smt_util/boolean_simplification.h"
@@ -217,7 +218,7 @@ struct SmtEngineStatistics {
   /** time spent in checkUnsatCore() */
   TimerStat d_checkUnsatCoreTime;
   /** time spent in PropEngine::checkSat() */
-  TimerStat d_solveTime;
+  HistogramTimerStat d_solveTime;
   /** time spent in pushing/popping */
   TimerStat d_pushPopTime;
   /** time spent in processAssertions() */
@@ -861,6 +862,7 @@ SmtEngine::SmtEngine(ExprManager* em)
       d_private(NULL),
       d_statisticsRegistry(NULL),
       d_stats(NULL),
+      d_telemetry(NULL),
       d_channels(new LemmaChannels())
 {
   SmtScope smts(this);
@@ -914,6 +916,15 @@ SmtEngine::SmtEngine(ExprManager* em)
 
 void SmtEngine::finishInit() {
   Trace("smt-debug") << "SmtEngine::finishInit" << std::endl;
+  // open the telemetry file now, so that a bad path is reported before any
+  // query rather than after its result is computed
+  if (d_telemetry == NULL && !options::telemetryFile().empty())
+  {
+    std::unique_ptr<smt::Telemetry> telemetry(new smt::Telemetry());
+    telemetry->setFile(options::telemetryFile());
+    d_telemetry = telemetry.release();
+  }
+
   // ensure that our heuristics are properly set up
   setDefaults();
 
@@ -1077,6 +1088,8 @@ SmtEngine::~SmtEngine()
     d_proofManager = NULL;
 #endif
 
+    delete d_telemetry;
+    d_telemetry = NULL;
     delete d_stats;
     d_stats = NULL;
     delete d_statisticsRegistry;
@@ -1126,6 +1139,21 @@ LogicInfo SmtEngine::getLogicInfo() const {
 }
 void SmtEngine::setFilename(std::string filename) { d_filename = filename; }
 std::string SmtEngine::getFilename() const { return d_filename; }
+
+void SmtEngine::setTelemetryCallback(
+    std::function<void(const std::string&)> callback)
+{
+  if (d_telemetry == NULL)
+  {
+    std::unique_ptr<smt::Telemetry> telemetry(new smt::Telemetry());
+    if (!options::telemetryFile().empty())
+    {
+      telemetry->setFile(options::telemetryFile());
+    }
+    d_telemetry = telemetry.release();
+  }
+  d_telemetry->setCallback(callback);
+}
 void SmtEngine::setLogicInternal()
 {
   Assert(!d_fullyInited, "setting logic in SmtEngine but the engine has already"
@@ -1750,6 +1778,12 @@ void SmtEngine::setDefaults() {
   if( options::cbqiNestedQE() || ( options::proof() && !options::trackInstLemmas.wasSetByUser() ) ){
     options::trackInstLemmas.set( true );
   }
+  // the threads of full saturation read the instantiation tuple store
+  if (options::fullSaturateThreads() > 1
+      && !options::instTupleStore.wasSetByUser())
+  {
+    options::instTupleStore.set(true);
+  }
 
   if( ( options::fmfBoundLazy.wasSetByUser() && options::fmfBoundLazy() ) ||
       ( options::fmfBoundInt.wasSetByUser() && options::fmfBoundInt() ) ) {
@@ -3025,7 +3059,7 @@ Result SmtEngine::check() {
     }
   }
 
-  TimerStat::CodeTimer solveTimer(d_stats->d_solveTime);
+  HistogramTimerStat::CodeTimer solveTimer(d_stats->d_solveTime);
 
   Chat() << "solving..." << endl;
   Trace("smt") << "SmtEngine::check(): running check" << endl;
@@ -3760,12 +3794,29 @@ Result SmtEngine::checkSatisfiability(const vector<Expr>& assumptions,
       checkSynthSolution();
     }
 
+    takeTelemetrySnapshot(r);
+
     return r;
   } catch (UnsafeInterruptException& e) {
     AlwaysAssert(d_private->getResourceManager()->out());
     Result::UnknownExplanation why = d_private->getResourceManager()->outOfResources() ?
       Result::RESOURCEOUT : Result::TIMEOUT;
-    return Result(Result::SAT_UNKNOWN, why, d_filename);
+    Result r(Result::SAT_UNKNOWN, why, d_filename);
+    // the queries that run out of resources are the slow ones
+    takeTelemetrySnapshot(r);
+    return r;
+  }
+}
+
+void SmtEngine::takeTelemetrySnapshot(const Result& r)
+{
+  if (d_telemetry != NULL)
+  {
+    std::vector<const StatisticsRegistry*> registries;
+    registries.push_back(
+        NodeManager::fromExprManager(d_exprManager)->getStatisticsRegistry());
+    registries.push_back(d_statisticsRegistry);
+    d_telemetry->snapshot(registries, r);
   }
 }
 
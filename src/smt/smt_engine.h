@@ -19,6 +19,7 @@
 #ifndef __CVC4__SMT_ENGINE_H
 #define __CVC4__SMT_ENGINE_H
 
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -91,6 +92,7 @@ namespace smt {
   class SmtEnginePrivate;
   class SmtScope;
   class BooleanTermConverter;
+  class Telemetry;
 
   ProofManager* currentProofManager();
 
@@ -400,6 +402,9 @@ class CVC4_PUBLIC SmtEngine {
 
   smt::SmtEngineStatistics* d_stats;
 
+  /** The snapshots of the statistics after each query, if enabled */
+  smt::Telemetry* d_telemetry;
+
   /** Container for the lemma input and output channels for this SmtEngine.*/
   LemmaChannels* d_channels;
 
@@ -421,6 +426,9 @@ class CVC4_PUBLIC SmtEngine {
                              bool inUnsatCore,
                              bool isQuery);
 
+  /** Records the statistics after the query with result r, if enabled. */
+  void takeTelemetrySnapshot(const Result& r);
+
   /**
    * Check that all Expr in formals are of BOUND_VARIABLE kind, where func is
    * the function that the formal argument list is for. This method is used
@@ -494,6 +502,13 @@ class CVC4_PUBLIC SmtEngine {
   void setOption(const std::string& key, const CVC4::SExpr& value)
       /* throw(OptionException, ModalException) */;
 
+  /**
+   * Passes a JSON record of the statistics and of their change to callback
+   * after each satisfiability or validity query.
+   */
+  void setTelemetryCallback(
+      std::function<void(const std::string&)> callback);
+
   /** sets the input name */
   void setFilename(std::string filename);
   /** return the input name (if any) */
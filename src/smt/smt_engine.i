@@ -46,5 +46,6 @@ SWIGEXPORT void JNICALL Java_edu_nyu_acsys_CVC4_SmtEngine_dlRef(JNIEnv* jenv, jc
 
 %ignore CVC4::SmtEngine::setLogic(const char*);
 %ignore CVC4::smt::currentProofManager();
+%ignore CVC4::SmtEngine::setTelemetryCallback;
 
 %include "smt/smt_engine.h"
@@ -0,0 +1,209 @@
+/*********************                                                        */
+/*! \file telemetry.cpp
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2018 by the authors listed in the file AUTHORS
+ ** in the top-level source directory) and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief Snapshots of the statistics after each query
+ **/
+
+#include "smt/telemetry.h"
+
+#include <sstream>
+
+#include "base/exception.h"
+#include "util/sexpr.h"
+
+using namespace std;
+
+namespace CVC4 {
+namespace smt {
+
+Telemetry::Telemetry() : d_csv(false), d_queries(0) {}
+
+Telemetry::~Telemetry() {
+  if (d_out.is_open()) {
+    d_out.close();
+  }
+}
+
+void Telemetry::setFile(const std::string& filename) {
+  d_csv = filename.size() >= 4
+          && filename.compare(filename.size() - 4, 4, ".csv") == 0;
+  d_out.open(filename.c_str(), ios_base::out | ios_base::trunc);
+  if (!d_out) {
+    throw Exception("Cannot open telemetry file: `" + filename + "'");
+  }
+  if (d_csv) {
+    d_out << "query,result,name,value,delta" << endl;
+  }
+}
+
+std::string Telemetry::jsonString(const std::string& s) {
+  stringstream ss;
+  ss << '"';
+  for (string::const_iterator i = s.begin(); i != s.end(); ++i) {
+    switch (*i) {
+      case '"': ss << "\\\""; break;
+      case '\\': ss << "\\\\"; break;
+      case '\n': ss << "\\n"; break;
+      case '\t': ss << "\\t"; break;
+      case '\r': ss << "\\r"; break;
+      default:
+        if (static_cast<unsigned char>(*i) < 0x20) {
+          ss << "\\u00" << "0123456789abcdef"[(*i >> 4) & 0xf]
+             << "0123456789abcdef"[*i & 0xf];
+        } else {
+          ss << *i;
+        }
+    }
+  }
+  ss << '"';
+  return ss.str();
+}
+
+std::string Telemetry::numberString(const Rational& q) {
+  if (q.isIntegral()) {
+    return q.getNumerator().toString();
+  }
+  stringstream ss;
+  ss.precision(9);
+  ss << q.getDouble();
+  return ss.str();
+}
+
+std::string Telemetry::csvField(const std::string& s) {
+  if (s.find_first_of(",\"\n") == string::npos) {
+    return s;
+  }
+  string quoted = "\"";
+  for (string::const_iterator i = s.begin(); i != s.end(); ++i) {
+    if (*i == '"') {
+      quoted += '"';
+    }
+    quoted += *i;
+  }
+  return quoted + "\"";
+}
+
+void Telemetry::snapshot(
+    const std::vector<const StatisticsRegistry*>& registries,
+    const Result& result)
+{
+  ++d_queries;
+  vector<Entry> entries;
+  vector<TimerEntry> timers;
+  for (unsigned r = 0; r < registries.size(); ++r) {
+    const StatisticsRegistry* registry = registries[r];
+    for (StatisticsRegistry::const_iterator i = registry->begin();
+         i != registry->end();
+         ++i) {
+      Entry e;
+      e.d_name = (*i).first;
+      const SExpr& value = (*i).second;
+      e.d_numeric = value.isInteger() || value.isRational();
+      if (e.d_numeric) {
+        e.d_value = value.isInteger() ? Rational(value.getIntegerValue())
+                                      : value.getRationalValue();
+        Rational& previous = d_previous[e.d_name];
+        e.d_delta = e.d_value - previous;
+        previous = e.d_value;
+      } else {
+        e.d_text = value.toString();
+      }
+      entries.push_back(e);
+    }
+
+    vector<const HistogramTimerStat*> registryTimers;
+    registry->getHistogramTimers(registryTimers);
+    for (unsigned i = 0; i < registryTimers.size(); ++i) {
+      TimerEntry t;
+      t.d_name = registryTimers[i]->getName();
+      vector<uint64_t>& previous = d_previousHistograms[t.d_name];
+      previous.resize(HistogramTimerStat::s_histogramSize, 0);
+      for (unsigned b = 0; b < HistogramTimerStat::s_histogramSize; ++b) {
+        uint64_t count = registryTimers[i]->getHistogramCount(b);
+        t.d_histogram.push_back(count - previous[b]);
+        previous[b] = count;
+      }
+      timers.push_back(t);
+    }
+  }
+
+  string resultString = result.toString();
+  if (d_callback || (d_out.is_open() && !d_csv)) {
+    string json = toJson(resultString, entries, timers);
+    if (d_out.is_open() && !d_csv) {
+      d_out << json << endl;
+    }
+    if (d_callback) {
+      d_callback(json);
+    }
+  }
+  if (d_out.is_open() && d_csv) {
+    writeCsv(resultString, entries, timers);
+  }
+}
+
+std::string Telemetry::toJson(const std::string& result,
+                              const std::vector<Entry>& entries,
+                              const std::vector<TimerEntry>& timers) const
+{
+  stringstream ss;
+  ss << "{\"query\":" << d_queries << ",\"result\":" << jsonString(result)
+     << ",\"stats\":[";
+  for (unsigned i = 0; i < entries.size(); ++i) {
+    const Entry& e = entries[i];
+    ss << (i == 0 ? "" : ",") << "{\"name\":" << jsonString(e.d_name);
+    if (e.d_numeric) {
+      ss << ",\"value\":" << numberString(e.d_value)
+         << ",\"delta\":" << numberString(e.d_delta);
+    } else {
+      ss << ",\"value\":" << jsonString(e.d_text);
+    }
+    ss << "}";
+  }
+  ss << "],\"timers\":[";
+  for (unsigned i = 0; i < timers.size(); ++i) {
+    const TimerEntry& t = timers[i];
+    ss << (i == 0 ? "" : ",") << "{\"name\":" << jsonString(t.d_name)
+       << ",\"histogram\":[";
+    for (unsigned b = 0; b < t.d_histogram.size(); ++b) {
+      ss << (b == 0 ? "" : ",") << t.d_histogram[b];
+    }
+    ss << "]}";
+  }
+  ss << "]}";
+  return ss.str();
+}
+
+void Telemetry::writeCsv(const std::string& result,
+                         const std::vector<Entry>& entries,
+                         const std::vector<TimerEntry>& timers)
+{
+  string prefix = to_string(d_queries) + "," + csvField(result) + ",";
+  for (unsigned i = 0; i < entries.size(); ++i) {
+    const Entry& e = entries[i];
+    d_out << prefix << csvField(e.d_name) << ",";
+    if (e.d_numeric) {
+      d_out << numberString(e.d_value) << "," << numberString(e.d_delta);
+    } else {
+      d_out << csvField(e.d_text) << ",";
+    }
+    d_out << endl;
+  }
+  // Bucket b counts the durations of about 2^b microseconds
+  for (unsigned i = 0; i < timers.size(); ++i) {
+    const TimerEntry& t = timers[i];
+    for (unsigned b = 0; b < t.d_histogram.size(); ++b) {
+      d_out << prefix << csvField(t.d_name + "::bucket" + to_string(b))
+            << ",," << t.d_histogram[b] << endl;
+    }
+  }
+}
+
+}/* CVC4::smt namespace */
+}/* CVC4 namespace */
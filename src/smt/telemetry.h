@@ -0,0 +1,132 @@
+/*********************                                                        */
+/*! \file telemetry.h
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2018 by the authors listed in the file AUTHORS
+ ** in the top-level source directory) and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief Snapshots of the statistics after each query
+ **
+ ** After each satisfiability or validity query, including the ones that
+ ** run out of time or resources, the values of the registered statistics
+ ** are recorded together with their change since the previous query, and
+ ** the HistogramTimerStat timers with the change of the histograms of their
+ ** durations.  A record is a JSON object, written as one line to a file and
+ ** passed to a callback, or a block of CSV rows if the file ends in .csv.
+ **/
+
+#include "cvc4_private.h"
+
+#ifndef __CVC4__SMT__TELEMETRY_H
+#define __CVC4__SMT__TELEMETRY_H
+
+#include <fstream>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "util/rational.h"
+#include "util/result.h"
+#include "util/statistics_registry.h"
+
+namespace CVC4 {
+namespace smt {
+
+class Telemetry {
+ public:
+  /** A function receiving the JSON record of each query */
+  typedef std::function<void(const std::string&)> Callback;
+
+  Telemetry();
+  ~Telemetry();
+
+  /**
+   * Writes the records to the file, as CSV if its name ends in .csv and as
+   * JSON lines otherwise.
+   */
+  void setFile(const std::string& filename);
+
+  /** Passes the JSON record of each query to callback. */
+  void setCallback(Callback callback) { d_callback = callback; }
+
+  /** Returns true if the records go anywhere. */
+  bool isEnabled() const { return d_out.is_open() || d_callback; }
+
+  /**
+   * Records the statistics of the registries after a query.
+   *
+   * The statistics are plain counters and timers, read here without
+   * synchronization.  This is safe because snapshot is called on the main
+   * thread after the query, when the worker threads of a check have been
+   * joined.  The counters of those checks (e.g. the row bounds of parallel
+   * row propagation and the guessed instantiations of full saturation) are
+   * incremented on the main thread after the join, and the timer
+   * fullCheckTaskTime of a theory is only started and stopped by the one
+   * thread running that theory's task.
+   */
+  void snapshot(const std::vector<const StatisticsRegistry*>& registries,
+                const Result& result);
+
+ private:
+  /** A statistic in a record */
+  struct Entry
+  {
+    std::string d_name;
+    /** The value, if it is not numeric */
+    std::string d_text;
+    bool d_numeric;
+    Rational d_value;
+    Rational d_delta;
+  };
+
+  /** A timer in a record, with the change of its histogram */
+  struct TimerEntry
+  {
+    std::string d_name;
+    std::vector<uint64_t> d_histogram;
+  };
+
+  /** Returns s as a JSON string. */
+  static std::string jsonString(const std::string& s);
+
+  /** Returns q exactly if it is an integer, and as a decimal otherwise. */
+  static std::string numberString(const Rational& q);
+
+  /** Returns s as a CSV field. */
+  static std::string csvField(const std::string& s);
+
+  /** Returns the JSON record of the query. */
+  std::string toJson(const std::string& result,
+                     const std::vector<Entry>& entries,
+                     const std::vector<TimerEntry>& timers) const;
+
+  /** Writes the CSV rows of the query. */
+  void writeCsv(const std::string& result,
+                const std::vector<Entry>& entries,
+                const std::vector<TimerEntry>& timers);
+
+  /** The file of the records */
+  std::ofstream d_out;
+
+  /** Whether the file is in CSV */
+  bool d_csv;
+
+  Callback d_callback;
+
+  /** The number of queries so far */
+  unsigned d_queries;
+
+  /** The numeric values of the statistics at the previous query */
+  std::map<std::string, Rational> d_previous;
+
+  /** The histograms of the timers at the previous query */
+  std::map<std::string, std::vector<uint64_t> > d_previousHistograms;
+};/* class Telemetry */
+
+}/* CVC4::smt namespace */
+}/* CVC4 namespace */
+
+#endif /* __CVC4__SMT__TELEMETRY_H */
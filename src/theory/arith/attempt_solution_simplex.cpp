@@ -52,7 +52,7 @@ bool AttemptSolutionSDP::matchesNewValue(const DenseMap<DeltaRational>& nv, Arit
   return nv[v] == d_variables.getAssignment(v);
 }
 
-Result::Sat AttemptSolutionSDP::attempt(const ApproximateSimplex::Solution& sol){
+Result::Sat AttemptSolutionSDP::attempt(const ApproximateSimplex::Solution& sol, bool partialBasis){
   const DenseSet& newBasis = sol.newBasis;
   const DenseMap<DeltaRational>& newValues = sol.newValues;
 
@@ -118,6 +118,10 @@ Result::Sat AttemptSolutionSDP::attempt(const ApproximateSimplex::Solution& sol)
         }
       }
     }
+    if(partialBasis && toAdd == ARITHVAR_SENTINEL){
+      // The rest of newBasis cannot be reached from the current basis.
+      break;
+    }
     Assert(toRemove != ARITHVAR_SENTINEL);
     Assert(toAdd != ARITHVAR_SENTINEL);
 
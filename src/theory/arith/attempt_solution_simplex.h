@@ -65,7 +65,15 @@ class AttemptSolutionSDP : public SimplexDecisionProcedure {
 public:
   AttemptSolutionSDP(LinearEqualityModule& linEq, ErrorSet& errors, RaiseConflict conflictChannel, TempVarMalloc tvmalloc);
 
-  Result::Sat attempt(const ApproximateSimplex::Solution& sol);
+  /**
+   * Pivots towards the basis of sol and updates the nonbasic variables to
+   * their values in sol, which must have a value for every variable.
+   * If partialBasis is true, part of the basis of sol may be unreachable from
+   * the current basis, e.g. for a basis that predates rows added to the
+   * tableau, in which case the pivoting stops early.
+   */
+  Result::Sat attempt(const ApproximateSimplex::Solution& sol,
+                      bool partialBasis = false);
 
   Result::Sat findModel(bool exactResult) override { Unreachable(); }
 
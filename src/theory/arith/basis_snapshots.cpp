@@ -0,0 +1,133 @@
+/*********************                                                        */
+/*! \file basis_snapshots.cpp
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2018 by the authors listed in the file AUTHORS
+ ** in the top-level source directory) and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief Simplex basis snapshots tied to user context levels
+ **/
+
+#include "theory/arith/basis_snapshots.h"
+
+#include "base/output.h"
+
+using namespace std;
+
+namespace CVC4 {
+namespace theory {
+namespace arith {
+
+BasisSnapshots::BasisSnapshots(context::UserContext* u)
+  : context::ContextNotifyObj(u)
+  , d_userContext(u)
+  , d_snapshots()
+  , d_pending(false)
+{}
+
+void BasisSnapshots::take(const Tableau& tab, const ArithVariables& vars){
+  size_t level = d_userContext->getLevel();
+  d_snapshots.resize(level + 1);
+
+  Snapshot& snap = d_snapshots[level];
+  snap.newBasis.purge();
+  snap.newValues.purge();
+
+  ArithVariables::var_iterator vi = vars.var_begin(), vend = vars.var_end();
+  for(; vi != vend; ++vi){
+    ArithVar v = *vi;
+    if(tab.isBasic(v)){
+      snap.newBasis.add(v);
+    }
+    snap.newValues.set(v, vars.getAssignment(v));
+  }
+  Debug("arith::snapshots") << "took snapshot at " << level
+                            << " with " << snap.newValues.size()
+                            << " variables" << endl;
+}
+
+int BasisSnapshots::applicableLevel() const {
+  int level = d_userContext->getLevel();
+  if(level >= (int)d_snapshots.size()){
+    level = d_snapshots.size() - 1;
+  }
+  for(; level >= 0; --level){
+    if(!d_snapshots[level].newValues.empty()){
+      return level;
+    }
+  }
+  return -1;
+}
+
+bool BasisSnapshots::restorePending() const {
+  return d_pending && applicableLevel() >= 0;
+}
+
+bool BasisSnapshots::restore(const ArithVariables& vars, Snapshot& into){
+  d_pending = false;
+  int level = applicableLevel();
+  if(level < 0){
+    return false;
+  }
+  const Snapshot& snap = d_snapshots[level];
+  into.newBasis.purge();
+  into.newValues.purge();
+
+  for(DenseSet::const_iterator i = snap.newBasis.begin(),
+        i_end = snap.newBasis.end(); i != i_end; ++i){
+    ArithVar v = *i;
+    if(vars.hasNode(v)){
+      into.newBasis.add(v);
+    }
+  }
+
+  // Every current variable gets a value, as AttemptSolutionSDP::attempt()
+  // looks up the value of any basic variable.  Variables created since the
+  // snapshot and values that violate the current bounds keep the current
+  // assignment.
+  ArithVariables::var_iterator vi = vars.var_begin(), vend = vars.var_end();
+  for(; vi != vend; ++vi){
+    ArithVar v = *vi;
+    if(snap.newValues.isKey(v)){
+      const DeltaRational& value = snap.newValues[v];
+      if(!vars.strictlyLessThanLowerBound(v, value) &&
+         !vars.strictlyGreaterThanUpperBound(v, value)){
+        into.newValues.set(v, value);
+        continue;
+      }
+    }
+    into.newValues.set(v, vars.getAssignment(v));
+  }
+  Debug("arith::snapshots") << "restoring snapshot of " << level
+                            << " at " << d_userContext->getLevel() << endl;
+  return true;
+}
+
+void BasisSnapshots::clear(){
+  d_snapshots.clear();
+  d_pending = false;
+}
+
+uint32_t BasisSnapshots::size() const {
+  uint32_t count = 0;
+  for(size_t i = 0, N = d_snapshots.size(); i < N; ++i){
+    if(!d_snapshots[i].newValues.empty()){
+      ++count;
+    }
+  }
+  return count;
+}
+
+void BasisSnapshots::contextNotifyPop(){
+  size_t level = d_userContext->getLevel();
+  if(d_snapshots.size() > level + 1){
+    d_snapshots.resize(level + 1);
+  }
+  d_pending = true;
+}
+
+}/* CVC4::theory::arith namespace */
+}/* CVC4::theory namespace */
+}/* CVC4 namespace */
@@ -0,0 +1,93 @@
+/*********************                                                        */
+/*! \file basis_snapshots.h
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2018 by the authors listed in the file AUTHORS
+ ** in the top-level source directory) and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief Simplex basis snapshots tied to user context levels
+ **
+ ** In incremental sessions the tableau basis and the assignment survive a
+ ** user pop, but they are whatever the deepest check left behind. This
+ ** keeps, for each user context level, the basis and the committed (safe)
+ ** assignment of the most recent feasible full effort check at that level so
+ ** that the first simplex call after a pop can be warm started from them.
+ **/
+
+#include "cvc4_private.h"
+
+#ifndef __CVC4__THEORY__ARITH__BASIS_SNAPSHOTS_H
+#define __CVC4__THEORY__ARITH__BASIS_SNAPSHOTS_H
+
+#include <vector>
+
+#include "context/context.h"
+#include "theory/arith/approx_simplex.h"
+#include "theory/arith/partial_model.h"
+#include "theory/arith/tableau.h"
+
+namespace CVC4 {
+namespace theory {
+namespace arith {
+
+class BasisSnapshots : public context::ContextNotifyObj {
+public:
+  typedef ApproximateSimplex::Solution Snapshot;
+
+  BasisSnapshots(context::UserContext* u);
+
+  /**
+   * Records the basis of tab and the assignment of vars as the snapshot of
+   * the current user context level.  Snapshots of deeper levels are dropped.
+   * The assignment must have been committed.
+   */
+  void take(const Tableau& tab, const ArithVariables& vars);
+
+  /**
+   * Returns true if a user context pop has happened since the last call to
+   * restore() and there is a snapshot that applies to the current level.
+   */
+  bool restorePending() const;
+
+  /**
+   * Fills into with the snapshot of the deepest level that is at most the
+   * current user context level.  Variables that have been released since are
+   * dropped from the basis.  Every current variable of vars has a value in
+   * into: its value in the snapshot, or its current assignment if it was
+   * created since or its value in the snapshot violates its current bounds.
+   * Clears the pending flag.  Returns false if no snapshot applies.
+   */
+  bool restore(const ArithVariables& vars, Snapshot& into);
+
+  /** Drops all of the snapshots. */
+  void clear();
+
+  /** Returns the number of levels that have a snapshot. */
+  uint32_t size() const;
+
+protected:
+  void contextNotifyPop() override;
+
+private:
+  /** Returns the deepest level <= the current level with a snapshot or -1. */
+  int applicableLevel() const;
+
+  context::UserContext* d_userContext;
+
+  /**
+   * d_snapshots[i] is the snapshot taken at user context level i.
+   * An empty newValues map means that no snapshot was taken at that level.
+   */
+  std::vector<Snapshot> d_snapshots;
+
+  /** True if a pop has happened since the last call to restore(). */
+  bool d_pending;
+};/* class BasisSnapshots */
+
+}/* CVC4::theory::arith namespace */
+}/* CVC4::theory namespace */
+}/* CVC4 namespace */
+
+#endif /* __CVC4__THEORY__ARITH__BASIS_SNAPSHOTS_H */
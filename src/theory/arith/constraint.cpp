@@ -21,9 +21,11 @@
 #include <unordered_set>
 
 #include "base/output.h"
+#include "options/arith_options.h"
 #include "proof/proof.h"
 #include "smt/smt_statistics_registry.h"
 #include "theory/arith/arith_utilities.h"
+#include "theory/arith/farkas_minimizer.h"
 #include "theory/arith/normal_form.h"
 
 
@@ -770,6 +772,7 @@ ConstraintDatabase::ConstraintDatabase(context::Context* satContext, context::Co
   , d_avariables(avars)
   , d_congruenceManager(cm)
   , d_satContext(satContext)
+  , d_explanationCache(satContext)
   , d_raiseConflict(raiseConflict)
   , d_one(1)
   , d_negOne(-1)
@@ -889,16 +892,34 @@ ConstraintDatabase::~ConstraintDatabase(){
 
 ConstraintDatabase::Statistics::Statistics():
   d_unatePropagateCalls("theory::arith::cd::unatePropagateCalls", 0),
-  d_unatePropagateImplications("theory::arith::cd::unatePropagateImplications", 0)
+  d_unatePropagateImplications("theory::arith::cd::unatePropagateImplications", 0),
+  d_explanationCacheHits("theory::arith::cd::explanationCache::hits", 0),
+  d_explanationCacheMisses("theory::arith::cd::explanationCache::misses", 0),
+  d_minimizeAttempts("theory::arith::cd::minimize::attempts", 0),
+  d_minimizedConflicts("theory::arith::cd::minimize::minimized", 0),
+  d_minimizeDropped("theory::arith::cd::minimize::dropped", 0)
 {
   smtStatisticsRegistry()->registerStat(&d_unatePropagateCalls);
   smtStatisticsRegistry()->registerStat(&d_unatePropagateImplications);
 
+  smtStatisticsRegistry()->registerStat(&d_explanationCacheHits);
+  smtStatisticsRegistry()->registerStat(&d_explanationCacheMisses);
+
+  smtStatisticsRegistry()->registerStat(&d_minimizeAttempts);
+  smtStatisticsRegistry()->registerStat(&d_minimizedConflicts);
+  smtStatisticsRegistry()->registerStat(&d_minimizeDropped);
 }
 
 ConstraintDatabase::Statistics::~Statistics(){
   smtStatisticsRegistry()->unregisterStat(&d_unatePropagateCalls);
   smtStatisticsRegistry()->unregisterStat(&d_unatePropagateImplications);
+
+  smtStatisticsRegistry()->unregisterStat(&d_explanationCacheHits);
+  smtStatisticsRegistry()->unregisterStat(&d_explanationCacheMisses);
+
+  smtStatisticsRegistry()->unregisterStat(&d_minimizeAttempts);
+  smtStatisticsRegistry()->unregisterStat(&d_minimizedConflicts);
+  smtStatisticsRegistry()->unregisterStat(&d_minimizeDropped);
 }
 
 void ConstraintDatabase::deleteConstraintAndNegation(ConstraintP c){
@@ -1321,14 +1342,6 @@ Node Constraint::externalExplainConflict() const{
   return safeConstructNary(nb);
 }
 
-struct ConstraintCPHash {
-  /* Todo replace with an id */
-  size_t operator()(ConstraintCP c) const{
-    Assert(sizeof(ConstraintCP) > 0);
-    return ((size_t)c)/sizeof(ConstraintCP);
-  }
-};
-
 void Constraint::assertionFringe(ConstraintCPVec& v){
   unordered_set<ConstraintCP, ConstraintCPHash> visited;
   size_t writePos = 0;
@@ -1385,6 +1398,9 @@ void Constraint::externalExplain(NodeBuilder<>& nb, AssertionOrder order) const{
     nb << getWitness();
   }else if(hasEqualityEngineProof()){
     d_database->eeExplain(this, nb);
+  }else if(order == AssertionOrderSentinel && options::arithExplanationCache()){
+    Assert(!isAssumption());
+    d_database->cachedExplainByAssertions(this, nb);
   }else{
     Assert(!isAssumption());
     AntecedentId p = getEndAntecedent();
@@ -1406,6 +1422,9 @@ Node Constraint::externalExplain(AssertionOrder order) const{
     return getWitness();
   }else if(hasEqualityEngineProof()){
     return d_database->eeExplain(this);
+  }else if(order == AssertionOrderSentinel && options::arithExplanationCache()){
+    Assert(hasFarkasProof() || hasIntHoleProof() || hasTrichotomyProof());
+    return d_database->cachedExplainByAssertions(this);
   }else{
     Assert(hasFarkasProof() || hasIntHoleProof() || hasTrichotomyProof());
     Assert(!antecentListIsEmpty());
@@ -1562,6 +1581,119 @@ void ConstraintDatabase::eeExplain(const Constraint* const c, NodeBuilder<>& nb)
   d_congruenceManager.explain(c->getLiteral(), nb);
 }
 
+Node ConstraintDatabase::cachedExplainByAssertions(ConstraintCP c){
+  Assert(!c->assertedToTheTheory());
+  Assert(c->hasFarkasProof() || c->hasIntHoleProof() || c->hasTrichotomyProof());
+
+  ExplanationCache::const_iterator i = d_explanationCache.find(c);
+  if(i != d_explanationCache.end()){
+    ++d_statistics.d_explanationCacheHits;
+    return (*i).second;
+  }
+  ++d_statistics.d_explanationCacheMisses;
+
+  NodeBuilder<> nb(kind::AND);
+  AntecedentId p = c->getEndAntecedent();
+  ConstraintCP antecedent = d_antecedents[p];
+  while(antecedent != NullConstraint){
+    antecedent->externalExplain(nb, AssertionOrderSentinel);
+    --p;
+    antecedent = d_antecedents[p];
+  }
+  Node exp = safeConstructNary(nb);
+  d_explanationCache.insert(c, exp);
+  return exp;
+}
+
+void ConstraintDatabase::cachedExplainByAssertions(ConstraintCP c, NodeBuilder<>& nb){
+  Node exp = cachedExplainByAssertions(c);
+  if(exp.getKind() == kind::AND){
+    for(Node::iterator i = exp.begin(), iend = exp.end(); i != iend; ++i){
+      nb << *i;
+    }
+  }else{
+    nb << exp;
+  }
+}
+
+Node ConstraintDatabase::minimizedConflictExplanation(ConstraintCP c){
+  Assert(c->inConflict());
+  ++d_statistics.d_minimizeAttempts;
+
+  // Collect the fringe of the proofs of c and its negation.
+  ConstraintCPVec fringe;
+  unordered_set<ConstraintCP, ConstraintCPHash> visited;
+  ConstraintCPVec stack;
+  stack.push_back(c);
+  stack.push_back(c->getNegation());
+  while(!stack.empty()){
+    ConstraintCP curr = stack.back();
+    stack.pop_back();
+    if(visited.find(curr) != visited.end()){ continue; }
+    visited.insert(curr);
+
+    if(curr->assertedToTheTheory()){
+      if(curr->getType() == Disequality){ return Node::null(); }
+      fringe.push_back(curr);
+      if(fringe.size() > s_maxMinimizeFringe){ return Node::null(); }
+    }else if(curr->hasFarkasProof() || curr->hasTrichotomyProof()){
+      AntecedentId p = curr->getEndAntecedent();
+      ConstraintCP antecedent = d_antecedents[p];
+      while(antecedent != NullConstraint){
+        stack.push_back(antecedent);
+        --p;
+        antecedent = d_antecedents[p];
+      }
+    }else{
+      // Integer hole proofs are not rational and the equality engine
+      // proofs have no bounds.
+      return Node::null();
+    }
+  }
+
+  FarkasMinimizer fm;
+  for(size_t g = 0, N = fringe.size(); g < N; ++g){
+    ConstraintCP f = fringe[g];
+    Polynomial p = Polynomial::parsePolynomial(d_avariables.asNode(f->getVariable()));
+    const DeltaRational& b = f->getValue();
+    switch(f->getType()){
+    case UpperBound:
+      fm.addBound(g, p, true, b);
+      break;
+    case LowerBound:
+      fm.addBound(g, p, false, b);
+      break;
+    case Equality:
+      fm.addBound(g, p, true, b);
+      fm.addBound(g, p, false, b);
+      break;
+    default:
+      Unreachable();
+    }
+  }
+
+  std::vector<bool> keep;
+  if(!fm.minimize(keep)){
+    // This can only happen if the bounds are not linear in the variables.
+    Debug("arith::minimize") << "no certificate for " << c << endl;
+    return Node::null();
+  }
+
+  ConstraintCPVec kept;
+  for(size_t g = 0, N = fringe.size(); g < N; ++g){
+    if(keep[g]){
+      kept.push_back(fringe[g]);
+    }
+  }
+  if(kept.size() < fringe.size()){
+    ++d_statistics.d_minimizedConflicts;
+    d_statistics.d_minimizeDropped += fringe.size() - kept.size();
+  }
+  Debug("arith::minimize") << "minimized " << fringe.size() << " to "
+                           << kept.size() << endl;
+  return Constraint::externalExplainByAssertions(kept);
+}
+
 bool ConstraintDatabase::variableDatabaseIsSetup(ArithVar v) const {
   return v < d_varDatabases.size();
 }
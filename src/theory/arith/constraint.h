@@ -81,6 +81,7 @@
 #include <vector>
 
 #include "base/configuration_private.h"
+#include "context/cdhashmap.h"
 #include "context/cdlist.h"
 #include "context/cdqueue.h"
 #include "context/context.h"
@@ -941,6 +942,13 @@ std::ostream& operator<<(std::ostream& o, const ValueCollection& c);
 std::ostream& operator<<(std::ostream& o, const ConstraintCPVec& v);
 std::ostream& operator<<(std::ostream& o, const ArithProofType);
 
+struct ConstraintCPHash {
+  /* Todo replace with an id */
+  size_t operator()(ConstraintCP c) const{
+    Assert(sizeof(ConstraintCP) > 0);
+    return ((size_t)c)/sizeof(ConstraintCP);
+  }
+};
 
 class ConstraintDatabase {
 private:
@@ -1046,6 +1054,26 @@ private:
 
   const context::Context * const d_satContext;
 
+  /**
+   * Memoizes the explanations by assertions of constraints with a Farkas,
+   * integer hole or trichotomy proof.  This is sat context dependent: a
+   * proof and its explanation stay valid until the context the proof was
+   * made in is popped, and entries are never added before their proofs.
+   */
+  typedef context::CDHashMap<ConstraintCP, Node, ConstraintCPHash> ExplanationCache;
+  ExplanationCache d_explanationCache;
+
+  /**
+   * Returns the explanation by assertions of c using d_explanationCache.
+   * c must have a Farkas, integer hole or trichotomy proof and must not be
+   * asserted.
+   */
+  Node cachedExplainByAssertions(ConstraintCP c);
+  void cachedExplainByAssertions(ConstraintCP c, NodeBuilder<>& nb);
+
+  /** Conflicts with more fringe constraints than this are not minimized. */
+  static const size_t s_maxMinimizeFringe = 64;
+
   RaiseConflict d_raiseConflict;
 
 
@@ -1160,6 +1188,15 @@ public:
 
   /** AntecendentID must be in range. */
   ConstraintCP getAntecedent(AntecedentId p) const;
+
+  /**
+   * Returns an explanation of the conflict of c and its negation that uses
+   * an irreducible subset of the assertions used by their proofs.
+   * Assertions are dropped one at a time as long as the remaining bounds
+   * still have a Farkas certificate.  Returns null if the proofs use integer
+   * reasoning, the equality engine or disequalities, or are too large.
+   */
+  Node minimizedConflictExplanation(ConstraintCP c);
   
 private:
   /** returns true if cons is now in conflict. */
@@ -1172,6 +1209,13 @@ private:
     IntStat d_unatePropagateCalls;
     IntStat d_unatePropagateImplications;
 
+    IntStat d_explanationCacheHits;
+    IntStat d_explanationCacheMisses;
+
+    IntStat d_minimizeAttempts;
+    IntStat d_minimizedConflicts;
+    IntStat d_minimizeDropped;
+
     Statistics();
     ~Statistics();
   } d_statistics;
@@ -20,6 +20,7 @@
 #include "base/output.h"
 #include "options/arith_options.h"
 #include "smt/smt_statistics_registry.h"
+#include "theory/arith/hnf_solver.h"
 
 using namespace std;
 
@@ -54,7 +55,10 @@ DioSolver::Statistics::Statistics() :
   d_cuts("theory::arith::dio::cuts",0),
   d_conflicts("theory::arith::dio::conflicts",0),
   d_conflictTimer("theory::arith::dio::conflictTimer"),
-  d_cutTimer("theory::arith::dio::cutTimer")
+  d_cutTimer("theory::arith::dio::cutTimer"),
+  d_hnfCalls("theory::arith::dio::hnf::calls",0),
+  d_hnfInfeasible("theory::arith::dio::hnf::infeasible",0),
+  d_hnfRank("theory::arith::dio::hnf::rank")
 {
   smtStatisticsRegistry()->registerStat(&d_conflictCalls);
   smtStatisticsRegistry()->registerStat(&d_cutCalls);
@@ -64,6 +68,10 @@ DioSolver::Statistics::Statistics() :
 
   smtStatisticsRegistry()->registerStat(&d_conflictTimer);
   smtStatisticsRegistry()->registerStat(&d_cutTimer);
+
+  smtStatisticsRegistry()->registerStat(&d_hnfCalls);
+  smtStatisticsRegistry()->registerStat(&d_hnfInfeasible);
+  smtStatisticsRegistry()->registerStat(&d_hnfRank);
 }
 
 DioSolver::Statistics::~Statistics(){
@@ -75,6 +83,10 @@ DioSolver::Statistics::~Statistics(){
 
   smtStatisticsRegistry()->unregisterStat(&d_conflictTimer);
   smtStatisticsRegistry()->unregisterStat(&d_cutTimer);
+
+  smtStatisticsRegistry()->unregisterStat(&d_hnfCalls);
+  smtStatisticsRegistry()->unregisterStat(&d_hnfInfeasible);
+  smtStatisticsRegistry()->unregisterStat(&d_hnfRank);
 }
 
 bool DioSolver::queueConditions(TrailIndex t){
@@ -479,6 +491,15 @@ Node DioSolver::processEquationsForConflict(){
   ++(d_statistics.d_conflictCalls);
 
   Assert(!inConflict());
+  if(options::arithDioHnf()){
+    std::vector<Integer> multipliers;
+    if(hnfInfeasible(multipliers)){
+      ++(d_statistics.d_conflicts);
+      return hnfExplain(multipliers);
+    }else{
+      return Node::null();
+    }
+  }
   if(processEquations(true)){
     ++(d_statistics.d_conflicts);
     return proveIndex(getConflictIndex());
@@ -492,6 +513,15 @@ SumPair DioSolver::processEquationsForCut(){
   ++(d_statistics.d_cutCalls);
 
   Assert(!inConflict());
+  if(options::arithDioHnf()){
+    std::vector<Integer> multipliers;
+    if(hnfInfeasible(multipliers)){
+      ++(d_statistics.d_cuts);
+      return hnfCombine(multipliers);
+    }else{
+      return SumPair::mkZero();
+    }
+  }
   if(processEquations(true)){
     ++(d_statistics.d_cuts);
     return purifyIndex(getConflictIndex());
@@ -500,6 +530,55 @@ SumPair DioSolver::processEquationsForCut(){
   }
 }
 
+bool DioSolver::hnfInfeasible(std::vector<Integer>& multipliers){
+  ++(d_statistics.d_hnfCalls);
+
+  HnfSolver hnf;
+  for(size_t i = 0, N = d_inputConstraints.size(); i < N; ++i){
+    hnf.addRow(d_trail[d_inputConstraints[i].d_trailPos].d_eq);
+  }
+  bool result = hnf.infeasible(multipliers);
+  d_statistics.d_hnfRank.addEntry(hnf.getRank());
+  if(result){
+    ++(d_statistics.d_hnfInfeasible);
+  }
+  return result;
+}
+
+Node DioSolver::hnfExplain(const std::vector<Integer>& multipliers) const{
+  Assert(multipliers.size() == d_inputConstraints.size());
+
+  NodeBuilder<> nb(kind::AND);
+  for(size_t i = 0, N = multipliers.size(); i < N; ++i){
+    if(multipliers[i].isZero()){ continue; }
+    Node input = d_inputConstraints[i].d_reason;
+    if(input.getKind() == kind::AND){
+      for(Node::iterator j = input.begin(), jend = input.end(); j != jend; ++j){
+        nb << *j;
+      }
+    }else{
+      nb << input;
+    }
+  }
+  Assert(nb.getNumChildren() >= 1);
+  Node result = (nb.getNumChildren() == 1) ? nb[0] : (Node)nb;
+  Debug("arith::dio") << "hnfExplain " << result << endl;
+  return result;
+}
+
+SumPair DioSolver::hnfCombine(const std::vector<Integer>& multipliers) const{
+  Assert(multipliers.size() == d_inputConstraints.size());
+
+  SumPair result = SumPair::mkZero();
+  for(size_t i = 0, N = multipliers.size(); i < N; ++i){
+    if(multipliers[i].isZero()){ continue; }
+    const SumPair& sp = d_trail[d_inputConstraints[i].d_trailPos].d_eq;
+    result = result + sp * Constant::mkConstant(multipliers[i]);
+  }
+  Debug("arith::dio") << "hnfCombine " << result.getNode() << endl;
+  return result;
+}
+
 
 SumPair DioSolver::purifyIndex(TrailIndex i){
   // TODO: "This uses the substitution trail to reverse the substitutions from the sum term. Using the proof term should be more efficient."
@@ -212,6 +212,20 @@ public:
   SumPair processEquationsForCut();
 
 private:
+  /**
+   * Decides the integer feasibility of all of the input constraints at once
+   * using an HnfSolver.  If they are infeasible, this returns true and
+   * multipliers is an integer combination of the input constraints that is
+   * unsatisfiable by the gcd test.  This does not use the trail.
+   */
+  bool hnfInfeasible(std::vector<Integer>& multipliers);
+
+  /** Conjunction of the reasons of the input constraints used in multipliers. */
+  Node hnfExplain(const std::vector<Integer>& multipliers) const;
+
+  /** The combination of the input constraints given by multipliers. */
+  SumPair hnfCombine(const std::vector<Integer>& multipliers) const;
+
   /** Returns true if the TrailIndex refers to a element in the trail. */
   bool inRange(TrailIndex i) const{
     return i < d_trail.size();
@@ -412,6 +426,10 @@ public:
     TimerStat d_conflictTimer;
     TimerStat d_cutTimer;
 
+    IntStat d_hnfCalls;
+    IntStat d_hnfInfeasible;
+    AverageStat d_hnfRank;
+
     Statistics();
     ~Statistics();
   };
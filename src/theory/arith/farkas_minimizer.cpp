@@ -0,0 +1,229 @@
+/*********************                                                        */
+/*! \file farkas_minimizer.cpp
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2018 by the authors listed in the file AUTHORS
+ ** in the top-level source directory) and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief Deletion based minimization of Farkas conflicts
+ **/
+
+#include "theory/arith/farkas_minimizer.h"
+
+#include "base/output.h"
+
+using namespace std;
+
+namespace CVC4 {
+namespace theory {
+namespace arith {
+
+FarkasMinimizer::FarkasMinimizer()
+  : d_rows()
+  , d_columns()
+  , d_numGroups(0)
+{}
+
+void FarkasMinimizer::addBound(size_t g, const Polynomial& p, bool upper, const DeltaRational& b){
+  d_rows.push_back(Row());
+  Row& row = d_rows.back();
+  row.d_group = g;
+  row.d_bound = upper ? b : -b;
+  if(g >= d_numGroups){
+    d_numGroups = g + 1;
+  }
+
+  for(Polynomial::iterator i = p.begin(), iend = p.end(); i != iend; ++i){
+    Monomial m = *i;
+    const Rational& c = m.getConstant().getValue();
+    if(m.isConstant()){
+      // p + c <= b is p <= b - c
+      row.d_bound = row.d_bound - (upper ? DeltaRational(c) : DeltaRational(-c));
+      continue;
+    }
+    Node vl = m.getVarList().getNode();
+    unordered_map<Node, size_t, NodeHashFunction>::const_iterator col =
+      d_columns.find(vl);
+    size_t j;
+    if(col == d_columns.end()){
+      j = d_columns.size();
+      d_columns[vl] = j;
+    }else{
+      j = (*col).second;
+    }
+    row.d_coeffs.push_back(make_pair(j, upper ? c : -c));
+  }
+}
+
+bool FarkasMinimizer::minimize(vector<bool>& keep) const{
+  keep.assign(d_numGroups, true);
+  if(!infeasible(keep)){
+    return false;
+  }
+  for(size_t g = 0; g < d_numGroups; ++g){
+    keep[g] = false;
+    if(!infeasible(keep)){
+      keep[g] = true;
+    }
+  }
+  return true;
+}
+
+void FarkasMinimizer::pivot(RationalMatrix& tab, vector<size_t>& basis, size_t r, size_t c){
+  RationalVector& pr = tab[r];
+  Assert(!pr[c].isZero());
+  Rational inv = pr[c].inverse();
+  for(size_t j = 0, N = pr.size(); j < N; ++j){
+    if(!pr[j].isZero()){
+      pr[j] *= inv;
+    }
+  }
+  for(size_t i = 0, M = tab.size(); i < M; ++i){
+    if(i == r){ continue; }
+    RationalVector& ri = tab[i];
+    if(ri[c].isZero()){ continue; }
+    Rational f = ri[c];
+    for(size_t j = 0, N = ri.size(); j < N; ++j){
+      if(!pr[j].isZero()){
+        ri[j] -= f * pr[j];
+      }
+    }
+  }
+  basis[r] = c;
+}
+
+void FarkasMinimizer::simplex(RationalMatrix& tab, vector<size_t>& basis,
+                              const vector<DeltaRational>& cost, size_t allowed){
+  size_t M = tab.size();
+  if(M == 0){ return; }
+  size_t rhs = tab[0].size() - 1;
+  vector<bool> isBasic(rhs, false);
+  for(size_t r = 0; r < M; ++r){
+    isBasic[basis[r]] = true;
+  }
+
+  while(true){
+    // Bland's rule: the first column with a negative reduced cost enters.
+    size_t enter = allowed;
+    for(size_t j = 0; j < allowed && enter == allowed; ++j){
+      if(isBasic[j]){ continue; }
+      DeltaRational reduced = cost[j];
+      for(size_t r = 0; r < M; ++r){
+        if(!tab[r][j].isZero()){
+          reduced = reduced - cost[basis[r]] * tab[r][j];
+        }
+      }
+      if(reduced.sgn() < 0){
+        enter = j;
+      }
+    }
+    if(enter == allowed){ return; }
+
+    // The row with the minimum ratio leaves, ties by the smallest basic.
+    size_t leave = M;
+    Rational best;
+    for(size_t r = 0; r < M; ++r){
+      const Rational& a = tab[r][enter];
+      if(a.sgn() <= 0){ continue; }
+      Rational ratio = tab[r][rhs] / a;
+      if(leave == M || ratio < best ||
+         (ratio == best && basis[r] < basis[leave])){
+        leave = r;
+        best = ratio;
+      }
+    }
+    // The certificates are normalized, so the problem is bounded.
+    Assert(leave < M);
+    if(leave == M){ return; }
+
+    isBasic[basis[leave]] = false;
+    isBasic[enter] = true;
+    pivot(tab, basis, leave, enter);
+  }
+}
+
+DeltaRational FarkasMinimizer::value(const RationalMatrix& tab, const vector<size_t>& basis,
+                                     const vector<DeltaRational>& cost){
+  DeltaRational result(0);
+  for(size_t r = 0, M = tab.size(); r < M; ++r){
+    const Rational& v = tab[r].back();
+    if(!v.isZero()){
+      result = result + cost[basis[r]] * v;
+    }
+  }
+  return result;
+}
+
+bool FarkasMinimizer::infeasible(const vector<bool>& active) const{
+  // The certificate has a column for each active row.
+  vector<size_t> rows;
+  vector<size_t> colToTabRow(d_columns.size(), d_columns.size());
+  size_t numEqs = 0;
+  for(size_t i = 0, N = d_rows.size(); i < N; ++i){
+    const Row& row = d_rows[i];
+    if(!active[row.d_group]){ continue; }
+    rows.push_back(i);
+    for(size_t k = 0, K = row.d_coeffs.size(); k < K; ++k){
+      size_t j = row.d_coeffs[k].first;
+      if(colToTabRow[j] == d_columns.size()){
+        colToTabRow[j] = numEqs++;
+      }
+    }
+  }
+  if(rows.empty()){ return false; }
+
+  // sum_i lambda_i a_ij = 0 for each variable j and sum_i lambda_i = 1,
+  // with an artificial variable for each of these equalities.
+  size_t numLambda = rows.size();
+  size_t M = numEqs + 1;
+  size_t N = numLambda + M;
+  RationalMatrix tab(M, RationalVector(N + 1, Rational(0)));
+  vector<size_t> basis(M);
+  for(size_t l = 0; l < numLambda; ++l){
+    const Row& row = d_rows[rows[l]];
+    for(size_t k = 0, K = row.d_coeffs.size(); k < K; ++k){
+      tab[colToTabRow[row.d_coeffs[k].first]][l] += row.d_coeffs[k].second;
+    }
+    tab[numEqs][l] = Rational(1);
+  }
+  tab[numEqs][N] = Rational(1);
+  for(size_t r = 0; r < M; ++r){
+    tab[r][numLambda + r] = Rational(1);
+    basis[r] = numLambda + r;
+  }
+
+  // Phase 1: find a certificate.
+  vector<DeltaRational> cost(N, DeltaRational(0));
+  for(size_t j = numLambda; j < N; ++j){
+    cost[j] = DeltaRational(1);
+  }
+  simplex(tab, basis, cost, N);
+  if(value(tab, basis, cost).sgn() > 0){
+    return false;
+  }
+  for(size_t r = 0; r < M; ++r){
+    if(basis[r] < numLambda){ continue; }
+    for(size_t j = 0; j < numLambda; ++j){
+      if(!tab[r][j].isZero()){
+        pivot(tab, basis, r, j);
+        break;
+      }
+    }
+  }
+
+  // Phase 2: minimize sum_i lambda_i b_i over the certificates.
+  for(size_t j = 0; j < N; ++j){
+    cost[j] = (j < numLambda) ? d_rows[rows[j]].d_bound : DeltaRational(0);
+  }
+  simplex(tab, basis, cost, numLambda);
+  DeltaRational best = value(tab, basis, cost);
+  Debug("arith::farkas") << "farkas: " << numLambda << " bounds, best "
+                         << best << endl;
+  return best.sgn() < 0;
+}
+
+}/* CVC4::theory::arith namespace */
+}/* CVC4::theory namespace */
+}/* CVC4 namespace */
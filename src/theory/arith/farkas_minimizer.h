@@ -0,0 +1,95 @@
+/*********************                                                        */
+/*! \file farkas_minimizer.h
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2018 by the authors listed in the file AUTHORS
+ ** in the top-level source directory) and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief Deletion based minimization of Farkas conflicts
+ **
+ ** A set of bounds p_i <= b_i over the rationals (with b_i possibly
+ ** infinitesimal) is infeasible iff there is a Farkas certificate
+ ** lambda >= 0 with sum_i lambda_i p_i = 0 and sum_i lambda_i b_i < 0.
+ ** The existence of a certificate is decided with a small dense simplex
+ ** over the certificate.  Groups of bounds (e.g. the two halves of an
+ ** equality) are then dropped one at a time while a certificate remains.
+ **/
+
+#include "cvc4_private.h"
+
+#ifndef __CVC4__THEORY__ARITH__FARKAS_MINIMIZER_H
+#define __CVC4__THEORY__ARITH__FARKAS_MINIMIZER_H
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "expr/node.h"
+#include "theory/arith/delta_rational.h"
+#include "theory/arith/normal_form.h"
+#include "util/rational.h"
+
+namespace CVC4 {
+namespace theory {
+namespace arith {
+
+class FarkasMinimizer {
+public:
+  FarkasMinimizer();
+
+  /**
+   * Adds the bound p <= b if upper is true, and p >= b otherwise, to the
+   * group g.  The monomials of p are treated as independent variables.
+   */
+  void addBound(size_t g, const Polynomial& p, bool upper, const DeltaRational& b);
+
+  /** Returns the number of groups, i.e. one more than the largest group. */
+  size_t getNumGroups() const { return d_numGroups; }
+
+  /**
+   * Returns false if the bounds of all of the groups are feasible.
+   * Otherwise keep is set s.t. the bounds of the groups with keep[g] are
+   * infeasible and dropping any one of these groups makes them feasible.
+   */
+  bool minimize(std::vector<bool>& keep) const;
+
+private:
+  typedef std::vector<Rational> RationalVector;
+  typedef std::vector<RationalVector> RationalMatrix;
+
+  /** The bound sum_j d_coeffs[j].second * x_{d_coeffs[j].first} <= d_bound. */
+  struct Row {
+    size_t d_group;
+    std::vector< std::pair<size_t, Rational> > d_coeffs;
+    DeltaRational d_bound;
+  };
+
+  /** Returns true if the bounds of the active groups are infeasible. */
+  bool infeasible(const std::vector<bool>& active) const;
+
+  /** Pivots the tableau so that column c is basic in row r. */
+  static void pivot(RationalMatrix& tab, std::vector<size_t>& basis, size_t r, size_t c);
+
+  /**
+   * Minimizes cost over the tableau using Bland's rule.  Only the first
+   * allowed columns may enter the basis.
+   */
+  static void simplex(RationalMatrix& tab, std::vector<size_t>& basis,
+                      const std::vector<DeltaRational>& cost, size_t allowed);
+
+  /** Returns the value of cost at the current basic solution. */
+  static DeltaRational value(const RationalMatrix& tab, const std::vector<size_t>& basis,
+                             const std::vector<DeltaRational>& cost);
+
+  std::vector<Row> d_rows;
+  std::unordered_map<Node, size_t, NodeHashFunction> d_columns;
+  size_t d_numGroups;
+};/* class FarkasMinimizer */
+
+}/* CVC4::theory::arith namespace */
+}/* CVC4::theory namespace */
+}/* CVC4 namespace */
+
+#endif /* __CVC4__THEORY__ARITH__FARKAS_MINIMIZER_H */
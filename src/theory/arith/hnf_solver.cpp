@@ -0,0 +1,239 @@
+/*********************                                                        */
+/*! \file hnf_solver.cpp
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2018 by the authors listed in the file AUTHORS
+ ** in the top-level source directory) and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief Integer feasibility of linear equality systems via Hermite normal forms
+ **/
+
+#include "theory/arith/hnf_solver.h"
+
+#include "base/output.h"
+#include "util/rational.h"
+
+using namespace std;
+
+namespace CVC4 {
+namespace theory {
+namespace arith {
+
+HnfSolver::HnfSolver()
+  : d_columns()
+  , d_rows()
+  , d_rhs()
+  , d_rank(0)
+{}
+
+size_t HnfSolver::addRow(const SumPair& sp){
+  Assert(sp.isIntegral());
+  Assert(!sp.isNonlinear());
+
+  size_t index = d_rows.size();
+  d_rows.push_back(vector< pair<size_t, Integer> >());
+  vector< pair<size_t, Integer> >& row = d_rows.back();
+
+  Polynomial p = sp.getPolynomial();
+  for(Polynomial::iterator i = p.begin(), iend = p.end(); i != iend; ++i){
+    Monomial m = *i;
+    if(m.isConstant()){
+      Assert(m.getConstant().isZero());
+      continue;
+    }
+    Node var = m.getVarList().getNode();
+    unordered_map<Node, size_t, NodeHashFunction>::const_iterator col =
+      d_columns.find(var);
+    size_t c;
+    if(col == d_columns.end()){
+      c = d_columns.size();
+      d_columns[var] = c;
+    }else{
+      c = (*col).second;
+    }
+    row.push_back(make_pair(c, m.getConstant().getValue().getNumerator()));
+  }
+  d_rhs.push_back(-sp.getConstant().getValue().getNumerator());
+  return index;
+}
+
+Integer HnfSolver::selectIndependentRows(vector<size_t>& rows) const{
+  size_t m = d_rows.size(), n = d_columns.size();
+
+  IntegerMatrix mat(m, IntegerVector(n, Integer(0)));
+  vector<size_t> rowOrder(m);
+  for(size_t i = 0; i < m; ++i){
+    rowOrder[i] = i;
+    vector< pair<size_t, Integer> >::const_iterator j, jend;
+    for(j = d_rows[i].begin(), jend = d_rows[i].end(); j != jend; ++j){
+      mat[i][(*j).first] = (*j).second;
+    }
+  }
+
+  // Bareiss elimination with full pivoting. After step k, mat[k][k] is the
+  // determinant of the leading (k+1) x (k+1) minor of the permuted matrix.
+  Integer prev(1);
+  size_t rank = 0;
+  for(size_t k = 0; k < m && k < n; ++k){
+    size_t pr = m, pc = n;
+    for(size_t i = k; i < m && pr == m; ++i){
+      for(size_t j = k; j < n; ++j){
+        if(!mat[i][j].isZero()){
+          pr = i; pc = j;
+          break;
+        }
+      }
+    }
+    if(pr == m){ break; }
+
+    if(pr != k){
+      mat[pr].swap(mat[k]);
+      std::swap(rowOrder[pr], rowOrder[k]);
+    }
+    if(pc != k){
+      for(size_t i = 0; i < m; ++i){
+        std::swap(mat[i][pc], mat[i][k]);
+      }
+    }
+
+    const IntegerVector& pivotRow = mat[k];
+    const Integer& pivot = pivotRow[k];
+    for(size_t i = k + 1; i < m; ++i){
+      IntegerVector& row = mat[i];
+      const Integer& lead = row[k];
+      for(size_t j = k + 1; j < n; ++j){
+        row[j] = (pivot * row[j] - lead * pivotRow[j]).exactQuotient(prev);
+      }
+      row[k] = Integer(0);
+    }
+    prev = pivot;
+    rank = k + 1;
+  }
+
+  rows.assign(rowOrder.begin(), rowOrder.begin() + rank);
+  return prev.abs();
+}
+
+HnfSolver::IntegerMatrix HnfSolver::hnfModulo(IntegerMatrix& a, const Integer& d){
+  size_t n = a.size();
+  size_t r = n == 0 ? 0 : a[0].size();
+  Assert(n >= r);
+
+  for(size_t j = 0; j < n; ++j){
+    for(size_t l = 0; l < r; ++l){
+      a[j][l] = a[j][l].euclidianDivideRemainder(d);
+    }
+  }
+
+  IntegerMatrix h(r, IntegerVector(r, Integer(0)));
+  Integer modulus = d;
+  for(size_t i = 0; i < r; ++i){
+    // Combine row i of the remaining columns into column i.
+    IntegerVector& ak = a[i];
+    for(size_t j = i + 1; j < n; ++j){
+      IntegerVector& aj = a[j];
+      if(aj[i].isZero()){ continue; }
+
+      Integer g, u, v;
+      Integer::extendedGcd(g, u, v, ak[i], aj[i]);
+      Integer p = ak[i].exactQuotient(g);
+      Integer q = aj[i].exactQuotient(g);
+      for(size_t l = i; l < r; ++l){
+        Integer b = u * ak[l] + v * aj[l];
+        aj[l] = (p * aj[l] - q * ak[l]).euclidianDivideRemainder(modulus);
+        ak[l] = b.euclidianDivideRemainder(modulus);
+      }
+    }
+
+    // The i'th basis vector also accounts for modulus * e_i.
+    Integer g, u, v;
+    Integer::extendedGcd(g, u, v, ak[i], modulus);
+    IntegerVector& hi = h[i];
+    hi[i] = g;
+    for(size_t l = i + 1; l < r; ++l){
+      hi[l] = (u * ak[l]).euclidianDivideRemainder(modulus);
+    }
+
+    // Reduce row i of the previous basis vectors modulo the diagonal.
+    for(size_t c = 0; c < i; ++c){
+      IntegerVector& hc = h[c];
+      Integer f = hc[i].floorDivideQuotient(g);
+      if(!f.isZero()){
+        for(size_t l = i; l < r; ++l){
+          hc[l] -= f * hi[l];
+        }
+      }
+    }
+    modulus = modulus.exactQuotient(g);
+  }
+  return h;
+}
+
+bool HnfSolver::infeasible(vector<Integer>& multipliers) const{
+  multipliers.clear();
+
+  vector<size_t> rows;
+  Integer det = selectIndependentRows(rows);
+  d_rank = rows.size();
+  Debug("arith::hnf") << "hnf: " << d_rows.size() << " rows, "
+                      << d_columns.size() << " columns, rank " << d_rank
+                      << ", determinant " << det << endl;
+  if(d_rank == 0){ return false; }
+
+  size_t r = d_rank, n = d_columns.size();
+  IntegerMatrix a(n, IntegerVector(r, Integer(0)));
+  for(size_t i = 0; i < r; ++i){
+    vector< pair<size_t, Integer> >::const_iterator j, jend;
+    for(j = d_rows[rows[i]].begin(), jend = d_rows[rows[i]].end(); j != jend; ++j){
+      a[(*j).first][i] = (*j).second;
+    }
+  }
+  IntegerMatrix h = hnfModulo(a, det);
+
+  // Solve H y = b by forward substitution.  lambda[i] is row i of H^{-1},
+  // so lambda[i] * A is integral and y_i = lambda[i] * b.
+  vector< vector<Rational> > lambda(r);
+  for(size_t i = 0; i < r; ++i){
+    vector<Rational>& li = lambda[i];
+    li.assign(i + 1, Rational(0));
+    li[i] = Rational(1);
+    for(size_t c = 0; c < i; ++c){
+      const Integer& hci = h[c][i];
+      if(hci.isZero()){ continue; }
+      const vector<Rational>& lc = lambda[c];
+      for(size_t k = 0; k <= c; ++k){
+        if(!lc[k].isZero()){
+          li[k] -= lc[k] * hci;
+        }
+      }
+    }
+    Rational invDiag(Integer(1), h[i][i]);
+    Rational y(0);
+    for(size_t k = 0; k <= i; ++k){
+      if(!li[k].isZero()){
+        li[k] *= invDiag;
+        y += li[k] * d_rhs[rows[k]];
+      }
+    }
+
+    if(!y.isIntegral()){
+      Debug("arith::hnf") << "hnf: y_" << i << " = " << y << endl;
+      Integer den(1);
+      for(size_t k = 0; k <= i; ++k){
+        den = den.lcm(li[k].getDenominator());
+      }
+      multipliers.assign(d_rows.size(), Integer(0));
+      for(size_t k = 0; k <= i; ++k){
+        multipliers[rows[k]] = (li[k] * den).getNumerator();
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+}/* CVC4::theory::arith namespace */
+}/* CVC4::theory namespace */
+}/* CVC4 namespace */
@@ -0,0 +1,102 @@
+/*********************                                                        */
+/*! \file hnf_solver.h
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2018 by the authors listed in the file AUTHORS
+ ** in the top-level source directory) and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief Integer feasibility of linear equality systems via Hermite normal forms
+ **
+ ** Decides whether a system of linear equalities A x = b has an integer
+ ** solution by computing the Hermite normal form H of the lattice generated
+ ** by the columns of A, modulo the determinant of a maximal nonsingular
+ ** minor of A (Domich, Kannan and Trotter; Cohen, Algorithm 2.4.8).
+ ** The system has an integer solution iff H^{-1} b is integral.
+ ** If it does not, a row of H^{-1} is a rational combination of the
+ ** equalities whose left hand side is integral and whose right hand side is
+ ** not.
+ **/
+
+#include "cvc4_private.h"
+
+#ifndef __CVC4__THEORY__ARITH__HNF_SOLVER_H
+#define __CVC4__THEORY__ARITH__HNF_SOLVER_H
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "expr/node.h"
+#include "theory/arith/normal_form.h"
+#include "util/integer.h"
+
+namespace CVC4 {
+namespace theory {
+namespace arith {
+
+class HnfSolver {
+public:
+  HnfSolver();
+
+  /**
+   * Adds the linear equality sp = 0 with integer coefficients as the next
+   * row of the system.  Returns the index of the row.
+   */
+  size_t addRow(const SumPair& sp);
+
+  /** Returns the number of rows. */
+  size_t getNumRows() const { return d_rows.size(); }
+
+  /**
+   * Decides if the rows have a common integer solution.
+   *
+   * If they do not, this returns true and sets multipliers to an integer
+   * vector with one entry for each row s.t. the sum of multipliers[i] * row i
+   * is an equality whose coefficients have a gcd that does not divide its
+   * constant.
+   *
+   * The rows must have a common rational solution.
+   */
+  bool infeasible(std::vector<Integer>& multipliers) const;
+
+  /** Returns the rank of the system after a call to infeasible(). */
+  size_t getRank() const { return d_rank; }
+
+private:
+  typedef std::vector<Integer> IntegerVector;
+  typedef std::vector<IntegerVector> IntegerMatrix;
+
+  /**
+   * Selects a maximal set of linearly independent rows by fraction free
+   * Gaussian elimination.  Returns the selected rows in rows and the absolute
+   * value of the determinant of a nonsingular minor over them.
+   */
+  Integer selectIndependentRows(std::vector<size_t>& rows) const;
+
+  /**
+   * Computes the lower triangular Hermite normal form of the lattice
+   * generated by the columns of the r x n matrix a given that d times the
+   * unit vectors are in this lattice.  Column i of the result is the i'th
+   * basis vector.
+   */
+  static IntegerMatrix hnfModulo(IntegerMatrix& a, const Integer& d);
+
+  /** Maps the variables to columns. */
+  std::unordered_map<Node, size_t, NodeHashFunction> d_columns;
+
+  /** Sparse rows of the coefficient matrix. */
+  std::vector< std::vector< std::pair<size_t, Integer> > > d_rows;
+
+  /** The right hand sides, i.e. the negated constants of the rows. */
+  std::vector<Integer> d_rhs;
+
+  mutable size_t d_rank;
+};/* class HnfSolver */
+
+}/* CVC4::theory::arith namespace */
+}/* CVC4::theory namespace */
+}/* CVC4 namespace */
+
+#endif /* __CVC4__THEORY__ARITH__HNF_SOLVER_H */
@@ -0,0 +1,523 @@
+/*********************                                                        */
+/*! \file nl_icp.cpp
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2018 by the authors listed in the file AUTHORS
+ ** in the top-level source directory) and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief Implementation of interval constraint propagation for non-linear
+ ** arithmetic
+ **/
+
+#include "theory/arith/nl_icp.h"
+
+#include <algorithm>
+
+#include "base/output.h"
+#include "smt/smt_statistics_registry.h"
+#include "theory/arith/arith_msum.h"
+
+using namespace CVC4::kind;
+
+namespace CVC4 {
+namespace theory {
+namespace arith {
+
+namespace {
+
+/** An extended rational, one of -infinity, a rational, or +infinity. */
+struct ExtRational
+{
+  ExtRational() : d_inf(0), d_value() {}
+  ExtRational(int inf) : d_inf(inf), d_value() {}
+  ExtRational(const Rational& v) : d_inf(0), d_value(v) {}
+  int sgn() const { return d_inf != 0 ? d_inf : d_value.sgn(); }
+  bool operator<(const ExtRational& o) const
+  {
+    if (d_inf != o.d_inf)
+    {
+      return d_inf < o.d_inf;
+    }
+    return d_inf == 0 && d_value < o.d_value;
+  }
+  /** -inf, +inf are d_inf = -1, 1 */
+  int d_inf;
+  Rational d_value;
+};
+
+ExtRational lowerOf(const IcpBound& b)
+{
+  return b.d_finite ? ExtRational(b.d_value) : ExtRational(-1);
+}
+
+ExtRational upperOf(const IcpBound& b)
+{
+  return b.d_finite ? ExtRational(b.d_value) : ExtRational(1);
+}
+
+/**
+ * Product of two extended rationals, where 0 * inf = 0. This is the right
+ * convention for the end points of closed intervals.
+ */
+ExtRational extMult(const ExtRational& a, const ExtRational& b)
+{
+  if (a.d_inf == 0 && b.d_inf == 0)
+  {
+    return ExtRational(a.d_value * b.d_value);
+  }
+  int s = a.sgn() * b.sgn();
+  return s == 0 ? ExtRational(Rational(0)) : ExtRational(s);
+}
+
+ExtRational extPower(const ExtRational& a, unsigned e)
+{
+  if (a.d_inf != 0)
+  {
+    return ExtRational((a.d_inf < 0 && e % 2 == 1) ? -1 : 1);
+  }
+  Rational r(1);
+  for (unsigned i = 0; i < e; i++)
+  {
+    r = r * a.d_value;
+  }
+  return ExtRational(r);
+}
+
+/** Makes a derived bound from e, which is unbounded if e is infinite. */
+IcpBound mkBound(const ExtRational& e, Node exp)
+{
+  if (e.d_inf != 0)
+  {
+    return IcpBound();
+  }
+  return IcpBound(e.d_value, exp, true);
+}
+
+}  // namespace
+
+bool IcpInterval::isEmpty() const
+{
+  return d_lower.d_finite && d_upper.d_finite
+         && d_lower.d_value > d_upper.d_value;
+}
+
+bool IcpInterval::containsZero() const
+{
+  return (!d_lower.d_finite || d_lower.d_value.sgn() <= 0)
+         && (!d_upper.d_finite || d_upper.d_value.sgn() >= 0);
+}
+
+NlIcp::NlIcp(context::Context* c) : d_domains(c) {}
+
+NlIcp::~NlIcp() {}
+
+NlIcp::Statistics::Statistics()
+    : d_checks("theory::arith::nl::icp::checks", 0),
+      d_conflicts("theory::arith::nl::icp::conflicts", 0),
+      d_propagations("theory::arith::nl::icp::propagations", 0),
+      d_contractions("theory::arith::nl::icp::contractions", 0),
+      d_roundsEnded("theory::arith::nl::icp::roundsEnded", 0)
+{
+  smtStatisticsRegistry()->registerStat(&d_checks);
+  smtStatisticsRegistry()->registerStat(&d_conflicts);
+  smtStatisticsRegistry()->registerStat(&d_propagations);
+  smtStatisticsRegistry()->registerStat(&d_contractions);
+  smtStatisticsRegistry()->registerStat(&d_roundsEnded);
+}
+
+NlIcp::Statistics::~Statistics()
+{
+  smtStatisticsRegistry()->unregisterStat(&d_checks);
+  smtStatisticsRegistry()->unregisterStat(&d_conflicts);
+  smtStatisticsRegistry()->unregisterStat(&d_propagations);
+  smtStatisticsRegistry()->unregisterStat(&d_contractions);
+  smtStatisticsRegistry()->unregisterStat(&d_roundsEnded);
+}
+
+Node NlIcp::mkAnd(Node a, Node b)
+{
+  std::vector<Node> conj;
+  Node ab[2] = {a, b};
+  for (const Node& n : ab)
+  {
+    if (n.isNull())
+    {
+      continue;
+    }
+    if (n.getKind() == AND)
+    {
+      for (const Node& nc : n)
+      {
+        if (std::find(conj.begin(), conj.end(), nc) == conj.end())
+        {
+          conj.push_back(nc);
+        }
+      }
+    }
+    else if (std::find(conj.begin(), conj.end(), n) == conj.end())
+    {
+      conj.push_back(n);
+    }
+  }
+  if (conj.empty())
+  {
+    return Node::null();
+  }
+  return conj.size() == 1 ? conj[0]
+                          : NodeManager::currentNM()->mkNode(AND, conj);
+}
+
+IcpInterval NlIcp::mult(const IcpInterval& a, const IcpInterval& b)
+{
+  ExtRational ea[2] = {lowerOf(a.d_lower), upperOf(a.d_upper)};
+  ExtRational eb[2] = {lowerOf(b.d_lower), upperOf(b.d_upper)};
+  ExtRational lo = extMult(ea[0], eb[0]);
+  ExtRational hi = lo;
+  for (unsigned i = 0; i < 2; i++)
+  {
+    for (unsigned j = 0; j < 2; j++)
+    {
+      ExtRational p = extMult(ea[i], eb[j]);
+      if (p < lo)
+      {
+        lo = p;
+      }
+      if (hi < p)
+      {
+        hi = p;
+      }
+    }
+  }
+  Node exp = mkAnd(mkAnd(a.d_lower.d_exp, a.d_upper.d_exp),
+                   mkAnd(b.d_lower.d_exp, b.d_upper.d_exp));
+  IcpInterval ret;
+  ret.d_lower = mkBound(lo, exp);
+  ret.d_upper = mkBound(hi, exp);
+  return ret;
+}
+
+IcpInterval NlIcp::power(const IcpInterval& a, unsigned e)
+{
+  if (e == 1)
+  {
+    return a;
+  }
+  Node exp = mkAnd(a.d_lower.d_exp, a.d_upper.d_exp);
+  ExtRational lo = extPower(lowerOf(a.d_lower), e);
+  ExtRational hi = extPower(upperOf(a.d_upper), e);
+  IcpInterval ret;
+  if (e % 2 == 1 || (a.d_lower.d_finite && a.d_lower.d_value.sgn() >= 0))
+  {
+    // monotonically increasing
+    ret.d_lower = mkBound(lo, exp);
+    ret.d_upper = mkBound(hi, exp);
+  }
+  else if (a.d_upper.d_finite && a.d_upper.d_value.sgn() <= 0)
+  {
+    // monotonically decreasing
+    ret.d_lower = mkBound(hi, exp);
+    ret.d_upper = mkBound(lo, exp);
+  }
+  else
+  {
+    // even power of an interval containing zero
+    ret.d_lower = IcpBound(Rational(0), Node::null(), true);
+    ret.d_upper = mkBound(lo < hi ? hi : lo, exp);
+  }
+  return ret;
+}
+
+IcpInterval NlIcp::divide(const IcpInterval& a, const IcpInterval& b)
+{
+  Assert(!b.containsZero());
+  Node exp = mkAnd(b.d_lower.d_exp, b.d_upper.d_exp);
+  // 1/b, where 1/inf = 0
+  IcpInterval inv;
+  inv.d_lower = IcpBound(
+      b.d_upper.d_finite ? b.d_upper.d_value.inverse() : Rational(0),
+      exp,
+      true);
+  inv.d_upper = IcpBound(
+      b.d_lower.d_finite ? b.d_lower.d_value.inverse() : Rational(0),
+      exp,
+      true);
+  return mult(a, inv);
+}
+
+IcpInterval NlIcp::getDomain(Node t) const
+{
+  DomainMap::const_iterator it = d_domains.find(t);
+  if (it == d_domains.end())
+  {
+    return IcpInterval();
+  }
+  return (*it).second;
+}
+
+bool NlIcp::tighten(Node t, const IcpInterval& i)
+{
+  IcpInterval d = getDomain(t);
+  bool isInt = t.getType().isInteger();
+  bool changed = false;
+  if (i.d_lower.d_finite)
+  {
+    IcpBound b = i.d_lower;
+    if (isInt && !b.d_value.isIntegral())
+    {
+      b.d_value = Rational(b.d_value.ceiling());
+    }
+    if (!d.d_lower.d_finite || b.d_value > d.d_lower.d_value)
+    {
+      d.d_lower = b;
+      changed = true;
+    }
+  }
+  if (i.d_upper.d_finite)
+  {
+    IcpBound b = i.d_upper;
+    if (isInt && !b.d_value.isIntegral())
+    {
+      b.d_value = Rational(b.d_value.floor());
+    }
+    if (!d.d_upper.d_finite || b.d_value < d.d_upper.d_value)
+    {
+      d.d_upper = b;
+      changed = true;
+    }
+  }
+  if (changed)
+  {
+    if (Trace.isOn("nl-icp-debug"))
+    {
+      Trace("nl-icp-debug") << "Domain of " << t << " : ";
+      if (d.d_lower.d_finite)
+      {
+        Trace("nl-icp-debug") << "[" << d.d_lower.d_value;
+      }
+      else
+      {
+        Trace("nl-icp-debug") << "(-inf";
+      }
+      Trace("nl-icp-debug") << ", ";
+      if (d.d_upper.d_finite)
+      {
+        Trace("nl-icp-debug") << d.d_upper.d_value << "]";
+      }
+      else
+      {
+        Trace("nl-icp-debug") << "+inf)";
+      }
+      Trace("nl-icp-debug") << std::endl;
+    }
+    d_domains.insert(t, d);
+  }
+  return changed;
+}
+
+Node NlIcp::addAssertion(Node lit)
+{
+  bool polarity = lit.getKind() != NOT;
+  Node atom = polarity ? lit : lit[0];
+  Kind k = atom.getKind();
+  if ((k != GEQ && k != EQUAL) || (k == EQUAL && !polarity)
+      || !atom[0].getType().isReal())
+  {
+    return Node::null();
+  }
+  std::map<Node, Node> msum;
+  if (!ArithMSum::getMonomialSumLit(atom, msum))
+  {
+    return Node::null();
+  }
+  Node t;
+  Rational a(1);
+  Rational b(0);
+  for (const std::pair<const Node, Node>& m : msum)
+  {
+    if (m.first.isNull())
+    {
+      b = m.second.getConst<Rational>();
+    }
+    else if (t.isNull())
+    {
+      t = m.first;
+      if (!m.second.isNull())
+      {
+        a = m.second.getConst<Rational>();
+      }
+    }
+    else
+    {
+      // not a bound on a single term
+      return Node::null();
+    }
+  }
+  if (t.isNull() || a.isZero())
+  {
+    return Node::null();
+  }
+  // lit is equivalent to a*t + b <k> 0, or a*t + b < 0 if !polarity
+  IcpBound bound(-b / a, lit, false);
+  IcpInterval i;
+  if (k == EQUAL)
+  {
+    i.d_lower = bound;
+    i.d_upper = bound;
+  }
+  else if ((a.sgn() > 0) == polarity)
+  {
+    i.d_lower = bound;
+  }
+  else
+  {
+    i.d_upper = bound;
+  }
+  tighten(t, i);
+  return t;
+}
+
+bool NlIcp::addConflict(Node t, std::vector<Node>& lemmas)
+{
+  IcpInterval d = getDomain(t);
+  Assert(d.isEmpty());
+  Node exp = mkAnd(d.d_lower.d_exp, d.d_upper.d_exp);
+  if (exp.isNull())
+  {
+    Trace("nl-icp") << "ICP empty domain without explanation on " << t
+                    << std::endl;
+    return false;
+  }
+  Node lem = exp.negate();
+  Trace("nl-icp") << "ICP conflict on " << t << " : " << lem << std::endl;
+  ++(d_statistics.d_conflicts);
+  lemmas.push_back(lem);
+  return true;
+}
+
+bool NlIcp::check(const std::vector<Node>& assertions,
+                  const std::map<Node, std::map<Node, unsigned> >& mexp,
+                  const std::map<Node, Node>& mv,
+                  std::vector<Node>& lemmas)
+{
+  ++(d_statistics.d_checks);
+  NodeManager* nm = NodeManager::currentNM();
+
+  // (1) initial domains from the asserted bounds
+  for (const Node& lit : assertions)
+  {
+    Node t = addAssertion(lit);
+    if (!t.isNull() && getDomain(t).isEmpty())
+    {
+      return addConflict(t, lemmas);
+    }
+  }
+
+  // (2) contract through the monomial structure
+  for (unsigned sweep = 0; sweep < s_maxSweeps; sweep++)
+  {
+    bool changed = false;
+    for (const std::pair<const Node, std::map<Node, unsigned> >& me : mexp)
+    {
+      Node m = me.first;
+      if (m.getKind() != NONLINEAR_MULT)
+      {
+        continue;
+      }
+      // forward : D( m ) := D( m ) \cap prod_i D( x_i )^e_i
+      std::vector<IcpInterval> factors;
+      IcpInterval prod;
+      prod.d_lower = IcpBound(Rational(1), Node::null(), true);
+      prod.d_upper = prod.d_lower;
+      for (const std::pair<const Node, unsigned>& xe : me.second)
+      {
+        factors.push_back(power(getDomain(xe.first), xe.second));
+        prod = mult(prod, factors.back());
+      }
+      if (tighten(m, prod))
+      {
+        changed = true;
+        ++(d_statistics.d_contractions);
+      }
+      IcpInterval dm = getDomain(m);
+      if (dm.isEmpty())
+      {
+        return addConflict(m, lemmas);
+      }
+      // backward : D( x_j ) := D( x_j ) \cap D( m ) / prod_{i != j} D( x_i )
+      unsigned j = 0;
+      for (const std::pair<const Node, unsigned>& xe : me.second)
+      {
+        if (xe.second == 1)
+        {
+          IcpInterval rest;
+          rest.d_lower = IcpBound(Rational(1), Node::null(), true);
+          rest.d_upper = rest.d_lower;
+          for (unsigned i = 0, nfactors = factors.size(); i < nfactors; i++)
+          {
+            if (i != j)
+            {
+              rest = mult(rest, factors[i]);
+            }
+          }
+          if (!rest.containsZero())
+          {
+            if (tighten(xe.first, divide(dm, rest)))
+            {
+              changed = true;
+              ++(d_statistics.d_contractions);
+            }
+            if (getDomain(xe.first).isEmpty())
+            {
+              return addConflict(xe.first, lemmas);
+            }
+          }
+        }
+        j++;
+      }
+    }
+    if (!changed)
+    {
+      break;
+    }
+  }
+
+  // (3) propagate contracted bounds that the current model violates
+  for (DomainMap::const_iterator it = d_domains.begin();
+       it != d_domains.end();
+       ++it)
+  {
+    Node t = (*it).first;
+    const IcpInterval& d = (*it).second;
+    std::map<Node, Node>::const_iterator itv = mv.find(t);
+    if (itv == mv.end() || !itv->second.isConst())
+    {
+      continue;
+    }
+    const Rational& val = itv->second.getConst<Rational>();
+    for (unsigned r = 0; r < 2; r++)
+    {
+      const IcpBound& b = r == 0 ? d.d_lower : d.d_upper;
+      if (!b.d_finite || !b.d_derived)
+      {
+        continue;
+      }
+      if (r == 0 ? val >= b.d_value : val <= b.d_value)
+      {
+        continue;
+      }
+      Node c = nm->mkConst(b.d_value);
+      Node conc = r == 0 ? nm->mkNode(GEQ, t, c) : nm->mkNode(LEQ, t, c);
+      Node lem = b.d_exp.isNull() ? conc : nm->mkNode(IMPLIES, b.d_exp, conc);
+      Trace("nl-icp") << "ICP propagation : " << lem << std::endl;
+      ++(d_statistics.d_propagations);
+      lemmas.push_back(lem);
+    }
+  }
+  return false;
+}
+
+}  // namespace arith
+}  // namespace theory
+}  // namespace CVC4
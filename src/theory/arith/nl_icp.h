@@ -0,0 +1,163 @@
+/*********************                                                        */
+/*! \file nl_icp.h
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2018 by the authors listed in the file AUTHORS
+ ** in the top-level source directory) and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief Interval constraint propagation for non-linear arithmetic
+ **
+ ** Maintains interval domains for variables and monomials that are
+ ** contracted through the monomial structure computed by the non-linear
+ ** extension, and produces bound conflicts and bound propagations.
+ **/
+
+#include "cvc4_private.h"
+
+#ifndef __CVC4__THEORY__ARITH__NL_ICP_H
+#define __CVC4__THEORY__ARITH__NL_ICP_H
+
+#include <map>
+#include <vector>
+
+#include "context/cdhashmap.h"
+#include "context/context.h"
+#include "expr/node.h"
+#include "util/rational.h"
+#include "util/statistics_registry.h"
+
+namespace CVC4 {
+namespace theory {
+namespace arith {
+
+/** One end of an interval domain. */
+struct IcpBound
+{
+  IcpBound() : d_finite(false), d_value(), d_exp(), d_derived(false) {}
+  IcpBound(const Rational& v, Node exp, bool derived)
+      : d_finite(true), d_value(v), d_exp(exp), d_derived(derived)
+  {
+  }
+  /** If this is false, the bound is -infinity or +infinity. */
+  bool d_finite;
+  Rational d_value;
+  /** A conjunction of asserted literals that entails this bound. */
+  Node d_exp;
+  /** Was this bound obtained by contraction (rather than asserted)? */
+  bool d_derived;
+};
+
+/**
+ * A closed interval [d_lower, d_upper].  Strict bounds are weakened to
+ * non-strict ones, which keeps every contraction sound.
+ */
+struct IcpInterval
+{
+  IcpBound d_lower;
+  IcpBound d_upper;
+
+  /** Is this interval empty? */
+  bool isEmpty() const;
+  /** Does this interval contain zero? */
+  bool containsZero() const;
+};
+
+/** Interval constraint propagation
+ *
+ * The domains are stored in the SAT context, so that bounds found by
+ * contraction stay available to later rounds until we backtrack.
+ *
+ * Each call to check(...) does the following:
+ * (1) Tightens the domains of terms t from asserted literals that are
+ *     equivalent to t <k> c for a constant c.
+ * (2) Contracts the domains of monomials m = x_1^e_1 * ... * x_n^e_n by
+ *     D( m ) := D( m ) \cap D( x_1 )^e_1 * ... * D( x_n )^e_n, and of each
+ *     variable x_i with e_i = 1 by D( x_i ) := D( x_i ) \cap D( m ) / D( r )
+ *     where r is the remaining factor, provided 0 is not in D( r ).
+ * (3) If a domain becomes empty, it adds a conflict lemma. Otherwise it adds
+ *     lemmas ( exp => t >= c ) or ( exp => t <= c ) for contracted bounds
+ *     that are violated by the current model value of t.
+ */
+class NlIcp
+{
+ public:
+  NlIcp(context::Context* c);
+  ~NlIcp();
+
+  /** check
+   *
+   * assertions : the arithmetic literals asserted in the current context,
+   * mexp : maps each monomial to the multiset of its variables,
+   * mv : maps each term in mexp (and its variables) to its abstract model
+   * value.
+   *
+   * Adds conflict and propagation lemmas to lemmas. Returns true if a
+   * conflict lemma was added, in which case it is the only lemma. A domain
+   * that becomes empty without an explanation stops the check without
+   * lemmas.
+   */
+  bool check(const std::vector<Node>& assertions,
+             const std::map<Node, std::map<Node, unsigned> >& mexp,
+             const std::map<Node, Node>& mv,
+             std::vector<Node>& lemmas);
+  /**
+   * Called when lemmas of the last call to check were sent, which ends the
+   * round of the nonlinear extension before its tangent plane, magnitude
+   * and transcendental lemmas are computed.
+   */
+  void notifyLemmasSent() { ++(d_statistics.d_roundsEnded); }
+
+ private:
+  typedef context::CDHashMap<Node, IcpInterval, NodeHashFunction> DomainMap;
+  /** the current domain of each term */
+  DomainMap d_domains;
+  /** the maximum number of contraction sweeps per call to check */
+  static const unsigned s_maxSweeps = 8;
+
+  /** get the domain of t, which is (-inf, +inf) if t has none */
+  IcpInterval getDomain(Node t) const;
+  /**
+   * Intersect the domain of t with i. Returns true if the domain of t
+   * changed.
+   */
+  bool tighten(Node t, const IcpInterval& i);
+  /**
+   * Add the bound given by lit, if lit is a bound on a single term. Returns
+   * that term, or null if lit is not such a bound.
+   */
+  Node addAssertion(Node lit);
+  /**
+   * Add a conflict lemma for the empty domain of t to lemmas. Returns false
+   * if the bounds of t have no explanation, in which case no lemma is added.
+   */
+  bool addConflict(Node t, std::vector<Node>& lemmas);
+
+  /** Interval arithmetic, explanations are unions of those of the inputs */
+  static IcpInterval mult(const IcpInterval& a, const IcpInterval& b);
+  static IcpInterval power(const IcpInterval& a, unsigned e);
+  static IcpInterval divide(const IcpInterval& a, const IcpInterval& b);
+  /** The conjunction of the literals in a and b */
+  static Node mkAnd(Node a, Node b);
+
+  class Statistics
+  {
+   public:
+    IntStat d_checks;
+    IntStat d_conflicts;
+    IntStat d_propagations;
+    IntStat d_contractions;
+    /** the number of rounds that ended with the lemmas of check */
+    IntStat d_roundsEnded;
+    Statistics();
+    ~Statistics();
+  };
+  Statistics d_statistics;
+}; /* class NlIcp */
+
+}  // namespace arith
+}  // namespace theory
+}  // namespace CVC4
+
+#endif /* __CVC4__THEORY__ARITH__NL_ICP_H */
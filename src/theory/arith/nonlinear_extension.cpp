@@ -23,6 +23,7 @@
 #include "expr/node_algorithm.h"
 #include "expr/node_builder.h"
 #include "options/arith_options.h"
+#include "smt/smt_statistics_registry.h"
 #include "theory/arith/arith_msum.h"
 #include "theory/arith/arith_utilities.h"
 #include "theory/arith/theory_arith.h"
@@ -158,6 +159,7 @@ NonlinearExtension::NonlinearExtension(TheoryArith& containing,
                                        eq::EqualityEngine* ee)
     : d_builtModel(containing.getSatContext(), false),
       d_lemmas(containing.getUserContext()),
+      d_icp(containing.getSatContext()),
       d_zero_split(containing.getUserContext()),
       d_skolem_atoms(containing.getUserContext()),
       d_containing(containing),
@@ -185,6 +187,20 @@ NonlinearExtension::NonlinearExtension(TheoryArith& containing,
 
 NonlinearExtension::~NonlinearExtension() {}
 
+NonlinearExtension::Statistics::Statistics()
+    : d_checkRounds("theory::arith::nl::checkRounds", 0),
+      d_lemmas("theory::arith::nl::lemmas", 0)
+{
+  smtStatisticsRegistry()->registerStat(&d_checkRounds);
+  smtStatisticsRegistry()->registerStat(&d_lemmas);
+}
+
+NonlinearExtension::Statistics::~Statistics()
+{
+  smtStatisticsRegistry()->unregisterStat(&d_checkRounds);
+  smtStatisticsRegistry()->unregisterStat(&d_lemmas);
+}
+
 // Returns a reference to either map[key] if it exists in the map
 // or to a default value otherwise.
 //
@@ -669,6 +685,7 @@ int NonlinearExtension::flushLemma(Node lem) {
   d_lemmas.insert(lem);
   Trace("nl-ext-lemma") << "NonlinearExtension::Lemma : " << lem << std::endl;
   d_containing.getOutputChannel().lemma(lem);
+  ++(d_statistics.d_lemmas);
   return 1;
 }
 
@@ -1843,6 +1860,7 @@ int NonlinearExtension::checkLastCall(const std::vector<Node>& assertions,
   d_tf_rep_map.clear();
   d_tf_region.clear();
   d_waiting_lemmas.clear();
+  ++(d_statistics.d_checkRounds);
 
   int lemmas_proc = 0;
   std::vector<Node> lemmas;
@@ -2072,6 +2090,23 @@ int NonlinearExtension::checkLastCall(const std::vector<Node>& assertions,
     Trace("nl-ext") << "  ...finished with " << lemmas_proc << " new lemmas." << std::endl;
     return lemmas_proc;
   }
+
+  //-----------------------------------interval constraint propagation
+  if (options::nlExtIcp())
+  {
+    Trace("nl-ext") << "Get interval propagation lemmas..." << std::endl;
+    bool conflict = d_icp.check(assertions, d_m_exp, d_mv[1], lemmas);
+    Assert(!conflict || lemmas.size() == 1);
+    lemmas_proc = flushLemmas(lemmas);
+    if (lemmas_proc > 0)
+    {
+      d_icp.notifyLemmasSent();
+      Trace("nl-ext") << "  ...finished with " << lemmas_proc << " new "
+                      << (conflict ? "conflict" : "propagation")
+                      << " lemmas." << std::endl;
+      return lemmas_proc;
+    }
+  }
   
   //-----------------------------------monotonicity of transdental functions
   lemmas = checkTranscendentalMonotonic();
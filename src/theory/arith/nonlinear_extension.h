@@ -34,8 +34,10 @@
 #include "context/context.h"
 #include "expr/kind.h"
 #include "expr/node.h"
+#include "theory/arith/nl_icp.h"
 #include "theory/arith/theory_arith.h"
 #include "theory/uf/equality_engine.h"
+#include "util/statistics_registry.h"
 
 namespace CVC4 {
 namespace theory {
@@ -484,6 +486,8 @@ class NonlinearExtension {
 
   /** cache of all lemmas sent on the output channel (user-context-dependent) */
   NodeSet d_lemmas;
+  /** interval constraint propagation, used if options::nlExtIcp() is on */
+  NlIcp d_icp;
   /** cache of terms t for which we have added the lemma ( t = 0 V t != 0 ). */
   NodeSet d_zero_split;
   
@@ -554,6 +558,18 @@ class NonlinearExtension {
 
   void mkPi();
   void getCurrentPiBounds( std::vector< Node >& lemmas );
+
+  class Statistics
+  {
+   public:
+    /** number of calls to checkLastCall */
+    IntStat d_checkRounds;
+    /** number of lemmas sent on the output channel */
+    IntStat d_lemmas;
+    Statistics();
+    ~Statistics();
+  };
+  Statistics d_statistics;
   /** print rational approximation */
   void printRationalApprox(const char* c, Node cr, unsigned prec = 5) const;
   /** print model value */
@@ -19,6 +19,7 @@
 
 #include <stdint.h>
 
+#include <algorithm>
 #include <map>
 #include <queue>
 #include <vector>
@@ -132,6 +133,7 @@ TheoryArithPrivate::TheoryArithPrivate(TheoryArith& containing,
           d_linEq, d_errorSet, RaiseConflict(*this), TempVarMalloc(*this)),
       d_attemptSolSimplex(
           d_linEq, d_errorSet, RaiseConflict(*this), TempVarMalloc(*this)),
+      d_basisSnapshots(u),
       d_nonlinearExtension(NULL),
       d_pass1SDP(NULL),
       d_otherSDP(NULL),
@@ -399,6 +401,13 @@ TheoryArithPrivate::Statistics::Statistics()
   , d_satPivots("theory::arith::pivots::sat")
   , d_unsatPivots("theory::arith::pivots::unsat")
   , d_unknownPivots("theory::arith::pivots::unknown")
+  , d_basisSnapshotsTaken("theory::arith::snapshots::taken", 0)
+  , d_basisSnapshotsRestored("theory::arith::snapshots::restored", 0)
+  , d_warmStartPivots("theory::arith::snapshots::warmStartPivots")
+  , d_coldStartPivots("theory::arith::snapshots::coldStartPivots")
+  , d_parallelPropagateRounds("theory::arith::bound::parallel::rounds", 0)
+  , d_parallelPropagateRowBounds("theory::arith::bound::parallel::rowBounds", 0)
+  , d_parallelPropagateTime("theory::arith::bound::parallel::time")
   , d_solveIntModelsAttempts("theory::arith::z::solveInt::models::attempts", 0)
   , d_solveIntModelsSuccessful("theory::arith::zzz::solveInt::models::successful", 0)
   , d_mipTimer("theory::arith::z::approx::mip::timer")
@@ -443,6 +452,15 @@ TheoryArithPrivate::Statistics::Statistics()
   smtStatisticsRegistry()->registerStat(&d_unsatPivots);
   smtStatisticsRegistry()->registerStat(&d_unknownPivots);
 
+  smtStatisticsRegistry()->registerStat(&d_basisSnapshotsTaken);
+  smtStatisticsRegistry()->registerStat(&d_basisSnapshotsRestored);
+  smtStatisticsRegistry()->registerStat(&d_warmStartPivots);
+  smtStatisticsRegistry()->registerStat(&d_coldStartPivots);
+
+  smtStatisticsRegistry()->registerStat(&d_parallelPropagateRounds);
+  smtStatisticsRegistry()->registerStat(&d_parallelPropagateRowBounds);
+  smtStatisticsRegistry()->registerStat(&d_parallelPropagateTime);
+
   smtStatisticsRegistry()->registerStat(&d_replayLogRecCount);
   smtStatisticsRegistry()->registerStat(&d_replayLogRecConflictEscalation);
   smtStatisticsRegistry()->registerStat(&d_replayLogRecEarlyExit);
@@ -535,6 +553,15 @@ TheoryArithPrivate::Statistics::~Statistics(){
   smtStatisticsRegistry()->unregisterStat(&d_unsatPivots);
   smtStatisticsRegistry()->unregisterStat(&d_unknownPivots);
 
+  smtStatisticsRegistry()->unregisterStat(&d_basisSnapshotsTaken);
+  smtStatisticsRegistry()->unregisterStat(&d_basisSnapshotsRestored);
+  smtStatisticsRegistry()->unregisterStat(&d_warmStartPivots);
+  smtStatisticsRegistry()->unregisterStat(&d_coldStartPivots);
+
+  smtStatisticsRegistry()->unregisterStat(&d_parallelPropagateRounds);
+  smtStatisticsRegistry()->unregisterStat(&d_parallelPropagateRowBounds);
+  smtStatisticsRegistry()->unregisterStat(&d_parallelPropagateTime);
+
   smtStatisticsRegistry()->unregisterStat(&d_replayLogRecCount);
   smtStatisticsRegistry()->unregisterStat(&d_replayLogRecConflictEscalation);
   smtStatisticsRegistry()->unregisterStat(&d_replayLogRecEarlyExit);
@@ -1731,6 +1758,8 @@ void TheoryArithPrivate::releaseArithVar(ArithVar v){
 
   d_constraintDatabase.removeVariable(v);
   d_partialModel.releaseArithVar(v);
+  // v may be reallocated to a different node.
+  d_basisSnapshots.clear();
 }
 
 ArithVar TheoryArithPrivate::requestArithVar(TNode x, bool aux, bool internal){
@@ -2146,7 +2175,13 @@ void TheoryArithPrivate::outputConflicts(){
     for(size_t i = 0, i_end = d_conflicts.size(); i < i_end; ++i){
       ConstraintCP confConstraint = d_conflicts[i];
       Assert(confConstraint->inConflict());
-      Node conflict = confConstraint->externalExplainConflict();
+      Node conflict = Node::null();
+      if(options::arithMinimizeConflicts()){
+        conflict = d_constraintDatabase.minimizedConflictExplanation(confConstraint);
+      }
+      if(conflict.isNull()){
+        conflict = confConstraint->externalExplainConflict();
+      }
 
       ++conflicts;
       Debug("arith::conflict") << "d_conflicts[" << i << "] " << conflict
@@ -3285,7 +3320,24 @@ bool TheoryArithPrivate::solveRealRelaxation(Theory::Effort effortLevel){
     << endl;
   
   bool noPivotLimitPass1 = noPivotLimit && !useApprox;
-  d_qflraStatus = simplex.findModel(noPivotLimitPass1);
+
+  bool warmStarted = false;
+  if(options::arithBasisSnapshots() && d_basisSnapshots.restorePending()){
+    warmStarted = true;
+    d_qflraStatus = restoreBasisSnapshot();
+  }
+  if(!warmStarted || d_qflraStatus == Result::SAT_UNKNOWN){
+    d_qflraStatus = simplex.findModel(noPivotLimitPass1);
+    if(options::arithBasisSnapshots()){
+      if(warmStarted){
+        d_statistics.d_warmStartPivots.addEntry(simplex.getPivots());
+      }else{
+        d_statistics.d_coldStartPivots.addEntry(simplex.getPivots());
+      }
+    }
+  }else{
+    d_statistics.d_warmStartPivots.addEntry(0);
+  }
 
   Debug("TheoryArithPrivate::solveRealRelaxation")
     << "solveRealRelaxation()" << " pass1 " << d_qflraStatus << endl;
@@ -3361,6 +3413,15 @@ bool TheoryArithPrivate::solveRealRelaxation(Theory::Effort effortLevel){
   return emmittedConflictOrSplit;
 }
 
+Result::Sat TheoryArithPrivate::restoreBasisSnapshot(){
+  ApproximateSimplex::Solution snapshot;
+  if(!d_basisSnapshots.restore(d_partialModel, snapshot)){
+    return Result::SAT_UNKNOWN;
+  }
+  ++d_statistics.d_basisSnapshotsRestored;
+  return d_attemptSolSimplex.attempt(snapshot, true);
+}
+
 //   LinUnknown,  /* Unknown error */
 //   LinFeasible, /* Relaxation is feasible */
 //   LinInfeasible,   /* Relaxation is infeasible/all integer branches closed */
@@ -3632,6 +3693,10 @@ void TheoryArithPrivate::check(Theory::Effort effortLevel){
     Debug("arith::bt") << "committing sap inConflit"  << " " << newFacts << " " << previous << " " << d_qflraStatus  << endl;
     d_partialModel.commitAssignmentChanges();
     d_unknownsInARow = 0;
+    if(options::arithBasisSnapshots() && Theory::fullEffort(effortLevel)){
+      d_basisSnapshots.take(d_tableau, d_partialModel);
+      ++d_statistics.d_basisSnapshotsTaken;
+    }
     if(Debug.isOn("arith::consistency")){
       Assert(entireStateIsConsistent("sat comit"));
     }
@@ -4640,6 +4705,11 @@ void TheoryArithPrivate::propagateCandidatesNew(){
     d_partialModel.processBoundsQueue(utcb);
   }
 
+  if(options::arithParallelPropagateRows() > 0 &&
+     d_candidateRows.size() >= options::arithParallelPropagateRows()){
+    propagateCandidateRowsParallel();
+  }
+
   while(!d_candidateRows.empty()){
     RowIndex candidate = d_candidateRows.back();
     d_candidateRows.pop_back();
@@ -4648,6 +4718,91 @@ void TheoryArithPrivate::propagateCandidatesNew(){
   Debug("arith::prop") << "propagateCandidatesNew end" << endl << endl << endl;
 }
 
+void TheoryArithPrivate::propagateCandidateRowsParallel(){
+  TimerStat::CodeTimer codeTimer(d_statistics.d_parallelPropagateTime);
+  ++d_statistics.d_parallelPropagateRounds;
+
+  // Select the rows and the directions exactly as propagateCandidateRow().
+  vector<RowBoundJob> jobs;
+  while(!d_candidateRows.empty()){
+    RowIndex ridx = d_candidateRows.back();
+    d_candidateRows.pop_back();
+
+    BoundCounts hasCount = d_linEq.hasBoundCount(ridx);
+    uint32_t rowLength = d_tableau.getRowLength(ridx);
+    if (rowLength >= options::arithPropagateMaxLength()
+        && Random::getRandom().pickWithProb(
+               1.0 - double(options::arithPropagateMaxLength()) / rowLength))
+    {
+      continue;
+    }
+
+    for(int up = 0; up <= 1; ++up){
+      bool rowUp = (up == 1);
+      uint32_t count = rowUp ? hasCount.upperBoundCount()
+        : hasCount.lowerBoundCount();
+
+      RowBoundJob job;
+      job.d_ridx = ridx;
+      job.d_rowUp = rowUp;
+      if(count == rowLength){
+        job.d_skip = ARITHVAR_SENTINEL;
+        fullRowCandidates(ridx, rowUp, job.d_candidates);
+        if(job.d_candidates.empty()){ continue; }
+      }else if(count + 1 == rowLength){
+        const Tableau::Entry* ep =
+          d_linEq.rowLacksBound(ridx, rowUp, ARITHVAR_SENTINEL);
+        Assert(ep != NULL);
+        bool vUp = (rowUp == (ep->getCoefficient().sgn() < 0));
+        if(!propagateMightSucceed(ep->getColVar(), vUp)){ continue; }
+        job.d_skip = ep->getColVar();
+        job.d_candidates.push_back(ep);
+      }else{
+        continue;
+      }
+      jobs.push_back(job);
+    }
+  }
+  d_statistics.d_parallelPropagateRowBounds += jobs.size();
+  Debug("arith::prop") << "propagateCandidateRowsParallel " << jobs.size()
+                       << " row bounds" << endl;
+
+  // Compute the row bounds. This only reads the tableau and the bounds.
+  size_t numThreads = options::arithParallelPropagateThreads();
+#ifdef CVC4_CLN_IMP
+  // CLN numbers share representations with unsynchronized reference counts.
+  numThreads = 1;
+#endif /* CVC4_CLN_IMP */
+  if(numThreads > jobs.size()){ numThreads = std::max<size_t>(jobs.size(), 1); }
+  // The pool waits for all of its threads before it returns or rethrows.
+  d_propagateWorkers.run(numThreads, [this, &jobs, numThreads](size_t t){
+    computeRowBoundJobs(jobs, t, numThreads);
+  });
+
+  // Apply the implied constraints in the order of the serial path.
+  for(vector<RowBoundJob>::const_iterator i = jobs.begin(), iend = jobs.end();
+      i != iend; ++i){
+    const RowBoundJob& job = *i;
+    if(job.d_skip == ARITHVAR_SENTINEL){
+      applyFullRowBound(job.d_ridx, job.d_rowUp, job.d_candidates, job.d_bound);
+    }else{
+      // See attemptSingleton()
+      const Tableau::Entry* ep = job.d_candidates.front();
+      const Rational& coeff = ep->getCoefficient();
+      bool vUp = (job.d_rowUp == (coeff.sgn() < 0));
+      DeltaRational bound = job.d_bound / (- coeff);
+      tryToPropagate(job.d_ridx, job.d_rowUp, job.d_skip, vUp, bound);
+    }
+  }
+}
+
+void TheoryArithPrivate::computeRowBoundJobs(vector<RowBoundJob>& jobs, size_t first, size_t stride) const{
+  for(size_t i = first, N = jobs.size(); i < N; i += stride){
+    RowBoundJob& job = jobs[i];
+    job.d_bound = d_linEq.computeRowBound(job.d_ridx, job.d_rowUp, job.d_skip);
+  }
+}
+
 bool TheoryArithPrivate::propagateMightSucceed(ArithVar v, bool ub) const{
   int cmp = ub ? d_partialModel.cmpAssignmentUpperBound(v)
     : d_partialModel.cmpAssignmentLowerBound(v);
@@ -4711,7 +4866,15 @@ bool TheoryArithPrivate::attemptFull(RowIndex ridx, bool rowUp){
   Debug("arith::prop") << "  attemptFull" << ridx << endl;
 
   vector<const Tableau::Entry*> candidates;
+  fullRowCandidates(ridx, rowUp, candidates);
+  if(candidates.empty()){ return false; }
 
+  const DeltaRational slack =
+    d_linEq.computeRowBound(ridx, rowUp, ARITHVAR_SENTINEL);
+  return applyFullRowBound(ridx, rowUp, candidates, slack);
+}
+
+void TheoryArithPrivate::fullRowCandidates(RowIndex ridx, bool rowUp, vector<const Tableau::Entry*>& candidates) const{
   for(Tableau::RowIterator i = d_tableau.ridRowIterator(ridx); !i.atEnd(); ++i){
     const Tableau::Entry& e =*i;
     const Rational& c = e.getCoefficient();
@@ -4721,10 +4884,9 @@ bool TheoryArithPrivate::attemptFull(RowIndex ridx, bool rowUp){
       candidates.push_back(&e);
     }
   }
-  if(candidates.empty()){ return false; }
+}
 
-  const DeltaRational slack =
-    d_linEq.computeRowBound(ridx, rowUp, ARITHVAR_SENTINEL);
+bool TheoryArithPrivate::applyFullRowBound(RowIndex ridx, bool rowUp, const vector<const Tableau::Entry*>& candidates, const DeltaRational& slack){
   bool any = false;
   vector<const Tableau::Entry*>::const_iterator i, iend;
   for(i = candidates.begin(), iend = candidates.end(); i != iend; ++i){
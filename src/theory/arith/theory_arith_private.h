@@ -40,6 +40,7 @@
 #include "theory/arith/arith_utilities.h"
 #include "theory/arith/arithvar.h"
 #include "theory/arith/attempt_solution_simplex.h"
+#include "theory/arith/basis_snapshots.h"
 #include "theory/arith/congruence_manager.h"
 #include "theory/arith/constraint.h"
 #include "theory/arith/constraint.h"
@@ -67,6 +68,7 @@
 #include "util/rational.h"
 #include "util/result.h"
 #include "util/statistics_registry.h"
+#include "util/worker_pool.h"
 
 namespace CVC4 {
 namespace theory {
@@ -373,12 +375,26 @@ private:
   FCSimplexDecisionProcedure d_fcSimplex;
   SumOfInfeasibilitiesSPD d_soiSimplex;
   AttemptSolutionSDP d_attemptSolSimplex;
+
+  /**
+   * Per user context level copies of the basis and assignment of the last
+   * feasible full effort check.  Only maintained if
+   * options::arithBasisSnapshots() is on.
+   */
+  BasisSnapshots d_basisSnapshots;
   
   /** non-linear algebraic approach */
   NonlinearExtension * d_nonlinearExtension;
 
   bool solveRealRelaxation(Theory::Effort effortLevel);
 
+  /**
+   * Warm starts the simplex from the snapshot of the current user context
+   * level after a pop.  Returns the result of the attempt, which is
+   * SAT_UNKNOWN if simplex still needs to run.
+   */
+  Result::Sat restoreBasisSnapshot();
+
   /* Returns true if this is heuristically a good time to try
    * to solve the integers.
    */
@@ -582,6 +598,35 @@ private:
   bool attemptSingleton(RowIndex ridx, bool rowUp);
   /** Attempt to perform a row propagation where every variable is a potential candidate.*/
   bool attemptFull(RowIndex ridx, bool rowUp);
+  /** Collects the entries of the row that attemptFull() may propagate on. */
+  void fullRowCandidates(RowIndex ridx, bool rowUp, std::vector<const Tableau::Entry*>& candidates) const;
+  /** Propagates on the candidates of a full row given its row bound slack. */
+  bool applyFullRowBound(RowIndex ridx, bool rowUp, const std::vector<const Tableau::Entry*>& candidates, const DeltaRational& slack);
+
+  /**
+   * A row bound computation of the parallel propagation mode.
+   * If d_skip is ARITHVAR_SENTINEL this is for attemptFull() on the
+   * d_candidates, otherwise it is for attemptSingleton() on d_skip.
+   */
+  struct RowBoundJob {
+    RowIndex d_ridx;
+    bool d_rowUp;
+    ArithVar d_skip;
+    std::vector<const Tableau::Entry*> d_candidates;
+    DeltaRational d_bound;
+  };
+  /**
+   * Propagates on all of the d_candidateRows. The rows that can propagate
+   * are selected first, their row bounds are then computed in parallel
+   * and the implied constraints are finally applied serially in the order
+   * of the serial path. The tableau and the bounds are not modified while
+   * the row bounds are computed.
+   */
+  void propagateCandidateRowsParallel();
+  /** Computes the d_bound of jobs[i] for every i = first mod stride. */
+  void computeRowBoundJobs(std::vector<RowBoundJob>& jobs, size_t first, size_t stride) const;
+  /** The threads of propagateCandidateRowsParallel, kept between calls */
+  WorkerPool d_propagateWorkers;
   bool tryToPropagate(RowIndex ridx, bool rowUp, ArithVar v, bool vUp, const DeltaRational& bound);
   bool rowImplicationCanBeApplied(RowIndex ridx, bool rowUp, ConstraintP bestImplied);
   //void enqueueConstraints(std::vector<ConstraintCP>& out, Node n) const;
@@ -809,6 +854,15 @@ private:
     HistogramStat<uint32_t> d_unsatPivots;
     HistogramStat<uint32_t> d_unknownPivots;
 
+    IntStat d_basisSnapshotsTaken;
+    IntStat d_basisSnapshotsRestored;
+    AverageStat d_warmStartPivots;
+    AverageStat d_coldStartPivots;
+
+    IntStat d_parallelPropagateRounds;
+    IntStat d_parallelPropagateRowBounds;
+    TimerStat d_parallelPropagateTime;
+
 
     IntStat d_solveIntModelsAttempts;
     IntStat d_solveIntModelsSuccessful;
@@ -16,6 +16,8 @@
 
 #include "theory/evaluator.h"
 
+#include <algorithm>
+
 #include "theory/bv/theory_bv_utils.h"
 #include "theory/theory.h"
 #include "util/integer.h"
@@ -23,6 +25,84 @@
 namespace CVC4 {
 namespace theory {
 
+namespace {
+
+/** The semantics of the string operators, shared by the evaluators */
+
+String evalSubstr(const String& s, const Rational& ri, const Rational& rj)
+{
+  Integer s_len(s.size());
+  Integer i = ri.getNumerator();
+  Integer j = rj.getNumerator();
+  if (i.strictlyNegative() || j.strictlyNegative() || i >= s_len)
+  {
+    return String("");
+  }
+  else if (i + j > s_len)
+  {
+    return s.suffix((s_len - i).toUnsignedInt());
+  }
+  return s.substr(i.toUnsignedInt(), j.toUnsignedInt());
+}
+
+String evalCharAt(const String& s, const Rational& ri)
+{
+  Integer s_len(s.size());
+  Integer i = ri.getNumerator();
+  if (i.strictlyNegative() || i >= s_len)
+  {
+    return String("");
+  }
+  return s.substr(i.toUnsignedInt(), 1);
+}
+
+Rational evalIndexOf(const String& s, const String& x, const Rational& ri)
+{
+  Integer s_len(s.size());
+  Integer i = ri.getNumerator();
+  if (i.strictlyNegative() || i >= s_len)
+  {
+    return Rational(-1);
+  }
+  size_t r = s.find(x, i.toUnsignedInt());
+  if (r == std::string::npos)
+  {
+    return Rational(-1);
+  }
+  return Rational(r);
+}
+
+bool evalPrefix(const String& t, const String& s)
+{
+  return s.size() >= t.size() && s.prefix(t.size()) == t;
+}
+
+bool evalSuffix(const String& t, const String& s)
+{
+  return s.size() >= t.size() && s.suffix(t.size()) == t;
+}
+
+String evalItos(const Rational& ri)
+{
+  Integer i = ri.getNumerator();
+  if (i.strictlyNegative())
+  {
+    return String("");
+  }
+  return String(i.toString());
+}
+
+Rational evalStoi(const String& s)
+{
+  if (s.isNumber())
+  {
+    return Rational(s.toNumber());
+  }
+  return Rational(-1);
+}
+
+}  // namespace
+
 EvalResult::EvalResult(const EvalResult& other)
 {
   d_tag = other.d_tag;
@@ -302,41 +382,17 @@ EvalResult Evaluator::evalInternal(TNode n,
 
         case kind::STRING_SUBSTR:
         {
-          const String& s = results[currNode[0]].d_str;
-          Integer s_len(s.size());
-          Integer i = results[currNode[1]].d_rat.getNumerator();
-          Integer j = results[currNode[2]].d_rat.getNumerator();
-
-          if (i.strictlyNegative() || j.strictlyNegative() || i >= s_len)
-          {
-            results[currNode] = EvalResult(String(""));
-          }
-          else if (i + j > s_len)
-          {
-            results[currNode] =
-                EvalResult(s.suffix((s_len - i).toUnsignedInt()));
-          }
-          else
-          {
-            results[currNode] =
-                EvalResult(s.substr(i.toUnsignedInt(), j.toUnsignedInt()));
-          }
+          results[currNode] =
+              EvalResult(evalSubstr(results[currNode[0]].d_str,
+                                    results[currNode[1]].d_rat,
+                                    results[currNode[2]].d_rat));
           break;
         }
 
         case kind::STRING_CHARAT:
         {
-          const String& s = results[currNode[0]].d_str;
-          Integer s_len(s.size());
-          Integer i = results[currNode[1]].d_rat.getNumerator();
-          if (i.strictlyNegative() || i >= s_len)
-          {
-            results[currNode] = EvalResult(String(""));
-          }
-          else
-          {
-            results[currNode] = EvalResult(s.substr(i.toUnsignedInt(), 1));
-          }
+          results[currNode] = EvalResult(evalCharAt(
+              results[currNode[0]].d_str, results[currNode[1]].d_rat));
           break;
         }
 
@@ -350,27 +406,10 @@ EvalResult Evaluator::evalInternal(TNode n,
 
         case kind::STRING_STRIDOF:
         {
-          const String& s = results[currNode[0]].d_str;
-          Integer s_len(s.size());
-          const String& x = results[currNode[1]].d_str;
-          Integer i = results[currNode[2]].d_rat.getNumerator();
-
-          if (i.strictlyNegative() || i >= s_len)
-          {
-            results[currNode] = EvalResult(Rational(-1));
-          }
-          else
-          {
-            size_t r = s.find(x, i.toUnsignedInt());
-            if (r == std::string::npos)
-            {
-              results[currNode] = EvalResult(Rational(-1));
-            }
-            else
-            {
-              results[currNode] = EvalResult(Rational(r));
-            }
-          }
+          results[currNode] =
+              EvalResult(evalIndexOf(results[currNode[0]].d_str,
+                                     results[currNode[1]].d_str,
+                                     results[currNode[2]].d_rat));
           break;
         }
 
@@ -385,59 +424,27 @@ EvalResult Evaluator::evalInternal(TNode n,
 
         case kind::STRING_PREFIX:
         {
-          const String& t = results[currNode[0]].d_str;
-          const String& s = results[currNode[1]].d_str;
-          if (s.size() < t.size())
-          {
-            results[currNode] = EvalResult(false);
-          }
-          else
-          {
-            results[currNode] = EvalResult(s.prefix(t.size()) == t);
-          }
+          results[currNode] = EvalResult(evalPrefix(
+              results[currNode[0]].d_str, results[currNode[1]].d_str));
           break;
         }
 
         case kind::STRING_SUFFIX:
         {
-          const String& t = results[currNode[0]].d_str;
-          const String& s = results[currNode[1]].d_str;
-          if (s.size() < t.size())
-          {
-            results[currNode] = EvalResult(false);
-          }
-          else
-          {
-            results[currNode] = EvalResult(s.suffix(t.size()) == t);
-          }
+          results[currNode] = EvalResult(evalSuffix(
+              results[currNode[0]].d_str, results[currNode[1]].d_str));
           break;
         }
 
         case kind::STRING_ITOS:
         {
-          Integer i = results[currNode[0]].d_rat.getNumerator();
-          if (i.strictlyNegative())
-          {
-            results[currNode] = EvalResult(String(""));
-          }
-          else
-          {
-            results[currNode] = EvalResult(String(i.toString()));
-          }
+          results[currNode] = EvalResult(evalItos(results[currNode[0]].d_rat));
           break;
         }
 
         case kind::STRING_STOI:
         {
-          const String& s = results[currNode[0]].d_str;
-          if (s.isNumber())
-          {
-            results[currNode] = EvalResult(Rational(s.toNumber()));
-          }
-          else
-          {
-            results[currNode] = EvalResult(Rational(-1));
-          }
+          results[currNode] = EvalResult(evalStoi(results[currNode[0]].d_str));
           break;
         }
 
@@ -596,5 +603,686 @@ EvalResult Evaluator::evalInternal(TNode n,
   return results[n];
 }
 
+void Evaluator::evalBatch(TNode n,
+                          const std::vector<Node>& args,
+                          const std::vector<std::vector<Node> >& points,
+                          std::vector<Node>& results)
+{
+  Trace("evaluator") << "Evaluating " << n << " on " << points.size()
+                     << " points" << std::endl;
+  results.clear();
+  EvalProgram* p = getProgram(n, args);
+  if (p == nullptr)
+  {
+    for (const std::vector<Node>& vals : points)
+    {
+      results.push_back(evalInternal(n, args, vals).toNode());
+    }
+    return;
+  }
+  std::vector<const std::vector<Node>*> pts;
+  for (const std::vector<Node>& vals : points)
+  {
+    pts.push_back(&vals);
+  }
+  p->run(pts.data(), pts.size(), results);
+  for (size_t i = 0, npts = points.size(); i < npts; i++)
+  {
+    if (results[i].isNull())
+    {
+      results[i] = evalInternal(n, args, points[i]).toNode();
+    }
+  }
+}
+
+Node Evaluator::evalCached(TNode n,
+                           const std::vector<Node>& args,
+                           const std::vector<Node>& vals)
+{
+  EvalProgram* p = getProgram(n, args);
+  Node ret;
+  if (p != nullptr)
+  {
+    const std::vector<Node>* pt = &vals;
+    std::vector<Node> results;
+    p->run(&pt, 1, results);
+    ret = results[0];
+  }
+  if (ret.isNull())
+  {
+    ret = evalInternal(n, args, vals).toNode();
+  }
+  return ret;
+}
+
+EvalProgram* Evaluator::getProgram(TNode n, const std::vector<Node>& args)
+{
+  auto it = d_programs.find(n);
+  if (it == d_programs.end() || it->second->getArgs() != args)
+  {
+    if (it == d_programs.end() && d_programs.size() >= s_maxPrograms)
+    {
+      Trace("evaluator") << "Clear the cache of compiled programs" << std::endl;
+      d_programs.clear();
+    }
+    std::unique_ptr<EvalProgram>& p = d_programs[n];
+    p.reset(new EvalProgram(n, args));
+    Trace("evaluator") << "Compiled " << n << ", valid = " << p->isValid()
+                       << std::endl;
+    return p->isValid() ? p.get() : nullptr;
+  }
+  return it->second->isValid() ? it->second.get() : nullptr;
+}
+
+EvalProgram::EvalProgram(TNode n, const std::vector<Node>& args)
+    : d_args(args), d_valid(false), d_numWords(0), d_numRats(0), d_numStrs(0)
+{
+  std::unordered_map<TNode, unsigned, TNodeHashFunction> vars;
+  std::unordered_map<TNode, int, TNodeHashFunction> visited;
+  d_valid = compile(n, vars, visited) >= 0;
+  if (d_valid)
+  {
+    d_words.resize(d_numWords);
+    d_rats.resize(d_numRats);
+    d_strs.resize(d_numStrs);
+  }
+}
+
+bool EvalProgram::getRegType(TypeNode tn, RegType& rt, unsigned& width)
+{
+  width = 0;
+  if (tn.isBoolean())
+  {
+    rt = REG_BOOL;
+    width = 1;
+  }
+  else if (tn.isBitVector())
+  {
+    rt = REG_BITVECTOR;
+    width = tn.getBitVectorSize();
+    return width <= 64;
+  }
+  else if (tn.isReal())
+  {
+    rt = REG_RATIONAL;
+  }
+  else if (tn.isString())
+  {
+    rt = REG_STRING;
+  }
+  else
+  {
+    return false;
+  }
+  return true;
+}
+
+int EvalProgram::compile(
+    TNode n,
+    std::unordered_map<TNode, unsigned, TNodeHashFunction>& vars,
+    std::unordered_map<TNode, int, TNodeHashFunction>& visited)
+{
+  auto itv = visited.find(n);
+  if (itv != visited.end())
+  {
+    return itv->second;
+  }
+  visited[n] = -1;
+  Instr ins;
+  if (!getRegType(n.getType(), ins.d_type, ins.d_width))
+  {
+    Trace("evaluator") << "Type " << n.getType() << " not supported"
+                       << std::endl;
+    return -1;
+  }
+  ins.d_kind = n.getKind();
+  ins.d_arg = -1;
+  ins.d_hi = 0;
+  ins.d_lo = 0;
+  if (n.isVar())
+  {
+    // variables of enclosing lambdas shadow the arguments
+    auto it = vars.find(n);
+    if (it != vars.end())
+    {
+      visited[n] = it->second;
+      return it->second;
+    }
+    auto ita = std::find(d_args.begin(), d_args.end(), n);
+    if (ita == d_args.end())
+    {
+      return -1;
+    }
+    ins.d_arg = std::distance(d_args.begin(), ita);
+  }
+  else if (n.getKind() == kind::APPLY_UF
+           && n.getOperator().getKind() == kind::LAMBDA)
+  {
+    // inline the lambda
+    Node op = n.getOperator();
+    std::unordered_map<TNode, unsigned, TNodeHashFunction> lvars(vars);
+    for (size_t i = 0, nchild = n.getNumChildren(); i < nchild; i++)
+    {
+      int c = compile(n[i], vars, visited);
+      if (c < 0)
+      {
+        return -1;
+      }
+      lvars[op[0][i]] = c;
+    }
+    std::unordered_map<TNode, int, TNodeHashFunction> lvisited;
+    int ret = compile(op[1], lvars, lvisited);
+    visited[n] = ret;
+    return ret;
+  }
+  else
+  {
+    switch (n.getKind())
+    {
+      case kind::CONST_BOOLEAN:
+      case kind::CONST_BITVECTOR:
+      case kind::CONST_RATIONAL:
+      case kind::CONST_STRING: ins.d_const = n; break;
+      case kind::BITVECTOR_EXTRACT:
+        ins.d_hi = bv::utils::getExtractHigh(n);
+        ins.d_lo = bv::utils::getExtractLow(n);
+        break;
+      case kind::NOT:
+      case kind::AND:
+      case kind::OR:
+      case kind::PLUS:
+      case kind::MINUS:
+      case kind::MULT:
+      case kind::GEQ:
+      case kind::STRING_CONCAT:
+      case kind::STRING_LENGTH:
+      case kind::STRING_SUBSTR:
+      case kind::STRING_CHARAT:
+      case kind::STRING_STRCTN:
+      case kind::STRING_STRIDOF:
+      case kind::STRING_STRREPL:
+      case kind::STRING_PREFIX:
+      case kind::STRING_SUFFIX:
+      case kind::STRING_ITOS:
+      case kind::STRING_STOI:
+      case kind::BITVECTOR_NOT:
+      case kind::BITVECTOR_NEG:
+      case kind::BITVECTOR_CONCAT:
+      case kind::BITVECTOR_PLUS:
+      case kind::BITVECTOR_MULT:
+      case kind::BITVECTOR_AND:
+      case kind::BITVECTOR_OR:
+      case kind::BITVECTOR_XOR:
+      case kind::EQUAL:
+      case kind::ITE: break;
+      default:
+      {
+        Trace("evaluator") << "Kind " << n.getKind() << " not supported"
+                           << std::endl;
+        return -1;
+      }
+    }
+    for (const Node& nc : n)
+    {
+      int c = compile(nc, vars, visited);
+      if (c < 0)
+      {
+        return -1;
+      }
+      ins.d_children.push_back(c);
+    }
+  }
+  switch (ins.d_type)
+  {
+    case REG_RATIONAL: ins.d_reg = d_numRats++; break;
+    case REG_STRING: ins.d_reg = d_numStrs++; break;
+    default: ins.d_reg = d_numWords++; break;
+  }
+  int ret = d_instrs.size();
+  d_instrs.push_back(ins);
+  visited[n] = ret;
+  return ret;
+}
+
+void EvalProgram::run(const std::vector<Node>* const* pts,
+                      size_t npts,
+                      std::vector<Node>& results)
+{
+  Assert(d_valid);
+  results.clear();
+  if (npts == 0)
+  {
+    return;
+  }
+  for (std::vector<uint64_t>& r : d_words)
+  {
+    r.resize(npts);
+  }
+  for (std::vector<Rational>& r : d_rats)
+  {
+    r.resize(npts);
+  }
+  for (std::vector<String>& r : d_strs)
+  {
+    r.resize(npts);
+  }
+  std::vector<bool> valid(npts, true);
+  for (const Instr& ins : d_instrs)
+  {
+    if (ins.d_arg >= 0)
+    {
+      load(ins, pts, npts, valid);
+    }
+    else
+    {
+      execute(ins, npts);
+    }
+  }
+  NodeManager* nm = NodeManager::currentNM();
+  unsigned last = d_instrs.size() - 1;
+  const Instr& ins = d_instrs[last];
+  results.resize(npts);
+  for (size_t i = 0; i < npts; i++)
+  {
+    if (!valid[i])
+    {
+      results[i] = Node::null();
+      continue;
+    }
+    switch (ins.d_type)
+    {
+      case REG_BOOL: results[i] = nm->mkConst(getWords(last)[i] != 0); break;
+      case REG_BITVECTOR:
+        results[i] = nm->mkConst(BitVector(ins.d_width, getWords(last)[i]));
+        break;
+      case REG_RATIONAL: results[i] = nm->mkConst(getRats(last)[i]); break;
+      case REG_STRING: results[i] = nm->mkConst(getStrs(last)[i]); break;
+    }
+  }
+}
+
+void EvalProgram::load(const Instr& ins,
+                       const std::vector<Node>* const* pts,
+                       size_t npts,
+                       std::vector<bool>& valid)
+{
+  for (size_t i = 0; i < npts; i++)
+  {
+    Node v = (*pts[i])[ins.d_arg];
+    switch (ins.d_type)
+    {
+      case REG_BOOL:
+        if (v.getKind() == kind::CONST_BOOLEAN)
+        {
+          d_words[ins.d_reg][i] = v.getConst<bool>() ? 1 : 0;
+          continue;
+        }
+        break;
+      case REG_BITVECTOR:
+        if (v.getKind() == kind::CONST_BITVECTOR
+            && v.getConst<BitVector>().getSize() == ins.d_width)
+        {
+          d_words[ins.d_reg][i] =
+              v.getConst<BitVector>().getValue().getUnsignedLong();
+          continue;
+        }
+        break;
+      case REG_RATIONAL:
+        if (v.getKind() == kind::CONST_RATIONAL)
+        {
+          d_rats[ins.d_reg][i] = v.getConst<Rational>();
+          continue;
+        }
+        break;
+      case REG_STRING:
+        if (v.getKind() == kind::CONST_STRING)
+        {
+          d_strs[ins.d_reg][i] = v.getConst<String>();
+          continue;
+        }
+        break;
+    }
+    Trace("evaluator") << "Value " << v << " of " << d_args[ins.d_arg]
+                       << " not supported" << std::endl;
+    valid[i] = false;
+  }
+}
+
+void EvalProgram::execute(const Instr& ins, size_t npts)
+{
+  const std::vector<unsigned>& c = ins.d_children;
+  uint64_t mask = ins.d_width >= 64 ? ~uint64_t(0)
+                                    : (uint64_t(1) << ins.d_width) - 1;
+  switch (ins.d_kind)
+  {
+    case kind::CONST_BOOLEAN:
+    {
+      std::fill_n(&d_words[ins.d_reg][0], npts, ins.d_const.getConst<bool>());
+      break;
+    }
+    case kind::CONST_BITVECTOR:
+    {
+      uint64_t v =
+          ins.d_const.getConst<BitVector>().getValue().getUnsignedLong();
+      std::fill_n(&d_words[ins.d_reg][0], npts, v);
+      break;
+    }
+    case kind::CONST_RATIONAL:
+    {
+      std::fill_n(
+          &d_rats[ins.d_reg][0], npts, ins.d_const.getConst<Rational>());
+      break;
+    }
+    case kind::CONST_STRING:
+    {
+      std::fill_n(&d_strs[ins.d_reg][0], npts, ins.d_const.getConst<String>());
+      break;
+    }
+    case kind::NOT:
+    case kind::BITVECTOR_NOT:
+    {
+      uint64_t* r = &d_words[ins.d_reg][0];
+      const uint64_t* a = getWords(c[0]);
+      for (size_t i = 0; i < npts; i++)
+      {
+        r[i] = ~a[i] & mask;
+      }
+      break;
+    }
+    case kind::AND:
+    case kind::OR:
+    case kind::BITVECTOR_AND:
+    case kind::BITVECTOR_OR:
+    case kind::BITVECTOR_XOR:
+    case kind::BITVECTOR_PLUS:
+    case kind::BITVECTOR_MULT:
+    {
+      uint64_t* r = &d_words[ins.d_reg][0];
+      std::copy_n(getWords(c[0]), npts, r);
+      for (size_t j = 1, nchild = c.size(); j < nchild; j++)
+      {
+        const uint64_t* a = getWords(c[j]);
+        for (size_t i = 0; i < npts; i++)
+        {
+          switch (ins.d_kind)
+          {
+            case kind::AND:
+            case kind::BITVECTOR_AND: r[i] &= a[i]; break;
+            case kind::OR:
+            case kind::BITVECTOR_OR: r[i] |= a[i]; break;
+            case kind::BITVECTOR_XOR: r[i] ^= a[i]; break;
+            case kind::BITVECTOR_PLUS: r[i] = (r[i] + a[i]) & mask; break;
+            default: r[i] = (r[i] * a[i]) & mask; break;
+          }
+        }
+      }
+      break;
+    }
+    case kind::BITVECTOR_NEG:
+    {
+      uint64_t* r = &d_words[ins.d_reg][0];
+      const uint64_t* a = getWords(c[0]);
+      for (size_t i = 0; i < npts; i++)
+      {
+        r[i] = (~a[i] + 1) & mask;
+      }
+      break;
+    }
+    case kind::BITVECTOR_EXTRACT:
+    {
+      uint64_t* r = &d_words[ins.d_reg][0];
+      const uint64_t* a = getWords(c[0]);
+      for (size_t i = 0; i < npts; i++)
+      {
+        r[i] = (a[i] >> ins.d_lo) & mask;
+      }
+      break;
+    }
+    case kind::BITVECTOR_CONCAT:
+    {
+      uint64_t* r = &d_words[ins.d_reg][0];
+      std::copy_n(getWords(c[0]), npts, r);
+      for (size_t j = 1, nchild = c.size(); j < nchild; j++)
+      {
+        const uint64_t* a = getWords(c[j]);
+        unsigned w = d_instrs[c[j]].d_width;
+        for (size_t i = 0; i < npts; i++)
+        {
+          r[i] = (r[i] << w) | a[i];
+        }
+      }
+      break;
+    }
+    case kind::PLUS:
+    case kind::MULT:
+    {
+      Rational* r = &d_rats[ins.d_reg][0];
+      std::copy_n(getRats(c[0]), npts, r);
+      for (size_t j = 1, nchild = c.size(); j < nchild; j++)
+      {
+        const Rational* a = getRats(c[j]);
+        for (size_t i = 0; i < npts; i++)
+        {
+          r[i] = ins.d_kind == kind::PLUS ? r[i] + a[i] : r[i] * a[i];
+        }
+      }
+      break;
+    }
+    case kind::MINUS:
+    {
+      Rational* r = &d_rats[ins.d_reg][0];
+      const Rational* a = getRats(c[0]);
+      const Rational* b = getRats(c[1]);
+      for (size_t i = 0; i < npts; i++)
+      {
+        r[i] = a[i] - b[i];
+      }
+      break;
+    }
+    case kind::GEQ:
+    {
+      uint64_t* r = &d_words[ins.d_reg][0];
+      const Rational* a = getRats(c[0]);
+      const Rational* b = getRats(c[1]);
+      for (size_t i = 0; i < npts; i++)
+      {
+        r[i] = a[i] >= b[i];
+      }
+      break;
+    }
+    case kind::STRING_CONCAT:
+    {
+      String* r = &d_strs[ins.d_reg][0];
+      std::copy_n(getStrs(c[0]), npts, r);
+      for (size_t j = 1, nchild = c.size(); j < nchild; j++)
+      {
+        const String* a = getStrs(c[j]);
+        for (size_t i = 0; i < npts; i++)
+        {
+          r[i] = r[i].concat(a[i]);
+        }
+      }
+      break;
+    }
+    case kind::STRING_LENGTH:
+    {
+      Rational* r = &d_rats[ins.d_reg][0];
+      const String* a = getStrs(c[0]);
+      for (size_t i = 0; i < npts; i++)
+      {
+        r[i] = Rational(a[i].size());
+      }
+      break;
+    }
+    case kind::STRING_SUBSTR:
+    {
+      String* r = &d_strs[ins.d_reg][0];
+      const String* a = getStrs(c[0]);
+      const Rational* b = getRats(c[1]);
+      const Rational* d = getRats(c[2]);
+      for (size_t i = 0; i < npts; i++)
+      {
+        r[i] = evalSubstr(a[i], b[i], d[i]);
+      }
+      break;
+    }
+    case kind::STRING_CHARAT:
+    {
+      String* r = &d_strs[ins.d_reg][0];
+      const String* a = getStrs(c[0]);
+      const Rational* b = getRats(c[1]);
+      for (size_t i = 0; i < npts; i++)
+      {
+        r[i] = evalCharAt(a[i], b[i]);
+      }
+      break;
+    }
+    case kind::STRING_STRCTN:
+    case kind::STRING_PREFIX:
+    case kind::STRING_SUFFIX:
+    {
+      uint64_t* r = &d_words[ins.d_reg][0];
+      const String* a = getStrs(c[0]);
+      const String* b = getStrs(c[1]);
+      for (size_t i = 0; i < npts; i++)
+      {
+        switch (ins.d_kind)
+        {
+          case kind::STRING_STRCTN:
+            r[i] = a[i].find(b[i]) != std::string::npos;
+            break;
+          case kind::STRING_PREFIX: r[i] = evalPrefix(a[i], b[i]); break;
+          default: r[i] = evalSuffix(a[i], b[i]); break;
+        }
+      }
+      break;
+    }
+    case kind::STRING_STRIDOF:
+    {
+      Rational* r = &d_rats[ins.d_reg][0];
+      const String* a = getStrs(c[0]);
+      const String* b = getStrs(c[1]);
+      const Rational* d = getRats(c[2]);
+      for (size_t i = 0; i < npts; i++)
+      {
+        r[i] = evalIndexOf(a[i], b[i], d[i]);
+      }
+      break;
+    }
+    case kind::STRING_STRREPL:
+    {
+      String* r = &d_strs[ins.d_reg][0];
+      const String* a = getStrs(c[0]);
+      const String* b = getStrs(c[1]);
+      const String* d = getStrs(c[2]);
+      for (size_t i = 0; i < npts; i++)
+      {
+        r[i] = a[i].replace(b[i], d[i]);
+      }
+      break;
+    }
+    case kind::STRING_ITOS:
+    {
+      String* r = &d_strs[ins.d_reg][0];
+      const Rational* a = getRats(c[0]);
+      for (size_t i = 0; i < npts; i++)
+      {
+        r[i] = evalItos(a[i]);
+      }
+      break;
+    }
+    case kind::STRING_STOI:
+    {
+      Rational* r = &d_rats[ins.d_reg][0];
+      const String* a = getStrs(c[0]);
+      for (size_t i = 0; i < npts; i++)
+      {
+        r[i] = evalStoi(a[i]);
+      }
+      break;
+    }
+    case kind::EQUAL:
+    {
+      uint64_t* r = &d_words[ins.d_reg][0];
+      switch (d_instrs[c[0]].d_type)
+      {
+        case REG_RATIONAL:
+        {
+          const Rational* a = getRats(c[0]);
+          const Rational* b = getRats(c[1]);
+          for (size_t i = 0; i < npts; i++)
+          {
+            r[i] = a[i] == b[i];
+          }
+          break;
+        }
+        case REG_STRING:
+        {
+          const String* a = getStrs(c[0]);
+          const String* b = getStrs(c[1]);
+          for (size_t i = 0; i < npts; i++)
+          {
+            r[i] = a[i] == b[i];
+          }
+          break;
+        }
+        default:
+        {
+          const uint64_t* a = getWords(c[0]);
+          const uint64_t* b = getWords(c[1]);
+          for (size_t i = 0; i < npts; i++)
+          {
+            r[i] = a[i] == b[i];
+          }
+          break;
+        }
+      }
+      break;
+    }
+    case kind::ITE:
+    {
+      const uint64_t* cond = getWords(c[0]);
+      switch (ins.d_type)
+      {
+        case REG_RATIONAL:
+        {
+          Rational* r = &d_rats[ins.d_reg][0];
+          const Rational* a = getRats(c[1]);
+          const Rational* b = getRats(c[2]);
+          for (size_t i = 0; i < npts; i++)
+          {
+            r[i] = cond[i] ? a[i] : b[i];
+          }
+          break;
+        }
+        case REG_STRING:
+        {
+          String* r = &d_strs[ins.d_reg][0];
+          const String* a = getStrs(c[1]);
+          const String* b = getStrs(c[2]);
+          for (size_t i = 0; i < npts; i++)
+          {
+            r[i] = cond[i] ? a[i] : b[i];
+          }
+          break;
+        }
+        default:
+        {
+          uint64_t* r = &d_words[ins.d_reg][0];
+          const uint64_t* a = getWords(c[1]);
+          const uint64_t* b = getWords(c[2]);
+          for (size_t i = 0; i < npts; i++)
+          {
+            r[i] = cond[i] ? a[i] : b[i];
+          }
+          break;
+        }
+      }
+      break;
+    }
+    default: Unreachable(); break;
+  }
+}
+
 }  // namespace theory
 }  // namespace CVC4
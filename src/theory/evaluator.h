@@ -20,6 +20,9 @@
 #ifndef __CVC4__THEORY__EVALUATOR_H
 #define __CVC4__THEORY__EVALUATOR_H
 
+#include <stdint.h>
+#include <memory>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -75,10 +78,111 @@ struct EvalResult
   Node toNode() const;
 };
 
+/**
+ * A term compiled for its evaluation under many substitutions of the same
+ * variables.
+ *
+ * The term is lowered to a sequence of instructions in post-order, one for
+ * each of its distinct subterms, where applications of lambdas are inlined.
+ * Each instruction writes to a register that holds its value for all points,
+ * whose type is determined by the type of the subterm: Booleans and
+ * bit-vectors of width at most 64 are stored as machine words, integers and
+ * reals as rationals, and strings as strings. The program is run by executing
+ * each instruction on all points before the next one.
+ *
+ * The program is invalid if the term has a subterm whose kind or type is not
+ * supported, or a free variable that is not in the arguments.
+ */
+class EvalProgram
+{
+ public:
+  EvalProgram(TNode n, const std::vector<Node>& args);
+  /** is this program valid? */
+  bool isValid() const { return d_valid; }
+  /** get the arguments of this program */
+  const std::vector<Node>& getArgs() const { return d_args; }
+  /**
+   * Runs this program on the npts points pts, and stores their values in
+   * results. The value of a point is null if one of its values for the
+   * arguments is not a constant of the type of that argument.
+   */
+  void run(const std::vector<Node>* const* pts,
+           size_t npts,
+           std::vector<Node>& results);
+
+ private:
+  /** the types of registers */
+  enum RegType
+  {
+    REG_BOOL,
+    REG_BITVECTOR,
+    REG_RATIONAL,
+    REG_STRING,
+  };
+  /** An instruction */
+  struct Instr
+  {
+    /** the kind of the subterm */
+    Kind d_kind;
+    /** the type of its register */
+    RegType d_type;
+    /** the bit-width, for bit-vectors */
+    unsigned d_width;
+    /** the index of its register among those of its type */
+    unsigned d_reg;
+    /** the index of the argument, or -1 */
+    int d_arg;
+    /** the bounds of extracts */
+    unsigned d_hi;
+    unsigned d_lo;
+    /** the value of constants */
+    Node d_const;
+    /** the instructions of the children */
+    std::vector<unsigned> d_children;
+  };
+  /**
+   * Compile n, where vars maps the variables of enclosing lambdas to the
+   * instructions of their values, returns the index of its instruction or -1.
+   */
+  int compile(TNode n,
+              std::unordered_map<TNode, unsigned, TNodeHashFunction>& vars,
+              std::unordered_map<TNode, int, TNodeHashFunction>& visited);
+  /** get the type of the register for tn, returns false if unsupported */
+  static bool getRegType(TypeNode tn, RegType& rt, unsigned& width);
+  /** get the words of the register of instruction i */
+  uint64_t* getWords(unsigned i) { return &d_words[d_instrs[i].d_reg][0]; }
+  /** get the rationals of the register of instruction i */
+  Rational* getRats(unsigned i) { return &d_rats[d_instrs[i].d_reg][0]; }
+  /** get the strings of the register of instruction i */
+  String* getStrs(unsigned i) { return &d_strs[d_instrs[i].d_reg][0]; }
+  /** load the values of argument a of ins on the points pts into valid */
+  void load(const Instr& ins,
+            const std::vector<Node>* const* pts,
+            size_t npts,
+            std::vector<bool>& valid);
+  /** execute ins on npts points */
+  void execute(const Instr& ins, size_t npts);
+  /** the arguments */
+  std::vector<Node> d_args;
+  /** whether this program is valid */
+  bool d_valid;
+  /** the instructions, the last one is the term */
+  std::vector<Instr> d_instrs;
+  /** the number of registers holding words, rationals and strings */
+  unsigned d_numWords;
+  unsigned d_numRats;
+  unsigned d_numStrs;
+  /** the registers holding words, rationals and strings */
+  std::vector<std::vector<uint64_t> > d_words;
+  std::vector<std::vector<Rational> > d_rats;
+  std::vector<std::vector<String> > d_strs;
+};
+
 /**
  * The class that performs the actual evaluation of a term under a
- * substitution. Right now, the class does not cache anything between different
- * calls to `eval` but this might change in the future.
+ * substitution. The method `eval` does not cache anything between different
+ * calls, whereas `evalBatch` and `evalCached` compile the terms they evaluate
+ * into programs (see EvalProgram) that are cached by term.
  */
 class Evaluator
 {
@@ -92,8 +196,35 @@ class Evaluator
   Node eval(TNode n,
             const std::vector<Node>& args,
             const std::vector<Node>& vals);
+  /**
+   * Evaluates node `n` under the substitutions of the variable names `args`
+   * by each of the `points`, and stores the results in `results`. The result
+   * for each point is the same as `eval(n, args, points[i])`, but `n` is
+   * compiled once and evaluated on all points at once.
+   */
+  void evalBatch(TNode n,
+                 const std::vector<Node>& args,
+                 const std::vector<std::vector<Node> >& points,
+                 std::vector<Node>& results);
+  /**
+   * Same as `eval`, but using the compiled program for `n`. This is more
+   * efficient than `eval` when `n` is evaluated under many substitutions of
+   * the same variables by successive calls.
+   */
+  Node evalCached(TNode n,
+                  const std::vector<Node>& args,
+                  const std::vector<Node>& vals);
 
  private:
+  /** the maximum number of cached programs */
+  static const size_t s_maxPrograms = 4096;
+  /**
+   * Get the program for `n` over `args`, or null if `n` cannot be compiled.
+   */
+  EvalProgram* getProgram(TNode n, const std::vector<Node>& args);
+  /** the cached programs */
+  std::unordered_map<Node, std::unique_ptr<EvalProgram>, NodeHashFunction>
+      d_programs;
   /**
    * Evaluates node `n` under the substitution described by the variable names
    * `args` and the corresponding values `vals`. The internal version returns
@@ -0,0 +1,76 @@
+/*********************                                                        */
+/*! \file node_theory_sets.cpp
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2018 by the authors listed in the file AUTHORS
+ ** in the top-level source directory) and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief A context dependent map from nodes to sets of theories
+ **/
+
+#include "theory/node_theory_sets.h"
+
+#include <algorithm>
+
+namespace CVC4 {
+namespace theory {
+
+const size_t NodeTheorySets::s_maxDenseId;
+
+NodeTheorySets::NodeTheorySets(context::Context* context)
+  : d_sets(),
+    d_sparseSets(),
+    d_trail(),
+    d_trailSize(context, 0)
+{}
+
+void NodeTheorySets::backtrack() const {
+  while (d_trail.size() > d_trailSize) {
+    const TrailEntry& entry = d_trail.back();
+    setId(entry.d_id, entry.d_old);
+    d_trail.pop_back();
+  }
+}
+
+void NodeTheorySets::setId(size_t id, Theory::Set theories) const {
+  if (id >= s_maxDenseId) {
+    if (theories == 0) {
+      d_sparseSets.erase(id);
+    } else {
+      d_sparseSets[id] = theories;
+    }
+    return;
+  }
+  if (id >= d_sets.size()) {
+    d_sets.resize(std::min(std::max(id + 1, 2 * d_sets.size()), s_maxDenseId),
+                  0);
+  }
+  d_sets[id] = theories;
+}
+
+Theory::Set NodeTheorySets::get(TNode node) const {
+  backtrack();
+  size_t id = node.getId();
+  if (id < d_sets.size()) {
+    return d_sets[id];
+  }
+  if (id < s_maxDenseId) {
+    return 0;
+  }
+  std::unordered_map<size_t, Theory::Set>::const_iterator it =
+    d_sparseSets.find(id);
+  return it == d_sparseSets.end() ? 0 : (*it).second;
+}
+
+void NodeTheorySets::set(TNode node, Theory::Set theories) {
+  backtrack();
+  size_t id = node.getId();
+  d_trail.push_back(TrailEntry(id, get(node)));
+  d_trailSize = d_trail.size();
+  setId(id, theories);
+}
+
+}/* CVC4::theory namespace */
+}/* CVC4 namespace */
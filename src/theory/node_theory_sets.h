@@ -0,0 +1,78 @@
+/*********************                                                        */
+/*! \file node_theory_sets.h
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2018 by the authors listed in the file AUTHORS
+ ** in the top-level source directory) and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief A context dependent map from nodes to sets of theories
+ **
+ ** The sets are stored densely, indexed by the ids of the nodes, and the
+ ** changes are recorded on a trail that is undone lazily on the first access
+ ** after a pop.  Node ids are never reused, so the dense part only covers
+ ** the ids below s_maxDenseId and the sets of the other nodes are kept in a
+ ** hash map.  As with a map from TNodes, the nodes must be kept alive by
+ ** someone else while they have a non-empty set.
+ **/
+
+#include "cvc4_private.h"
+
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "context/cdo.h"
+#include "expr/node.h"
+#include "theory/theory.h"
+
+namespace CVC4 {
+namespace theory {
+
+class NodeTheorySets {
+public:
+  /** The ids from which the sets are not stored densely */
+  static const size_t s_maxDenseId = 1 << 20;
+
+  NodeTheorySets(context::Context* context);
+
+  /** Returns the set of the node, empty if it was never set */
+  Theory::Set get(TNode node) const;
+
+  /** Replaces the set of the node */
+  void set(TNode node, Theory::Set theories);
+
+  /** Returns true if the node has a non-empty set */
+  bool contains(TNode node) const { return get(node) != 0; }
+
+private:
+  /** Undoes the changes of the popped contexts */
+  void backtrack() const;
+
+  /** Replaces the set of the node with the given id */
+  void setId(size_t id, Theory::Set theories) const;
+
+  /** A change of the set of a node */
+  struct TrailEntry {
+    size_t d_id;
+    Theory::Set d_old;
+    TrailEntry(size_t id, Theory::Set old) : d_id(id), d_old(old) {}
+  };
+
+  /** The sets indexed by node id */
+  mutable std::vector<Theory::Set> d_sets;
+
+  /** The non-empty sets of the nodes with an id of at least s_maxDenseId */
+  mutable std::unordered_map<size_t, Theory::Set> d_sparseSets;
+
+  /** The changes to d_sets */
+  mutable std::vector<TrailEntry> d_trail;
+
+  /** Context dependent size of the trail */
+  context::CDO<size_t> d_trailSize;
+};/* class NodeTheorySets */
+
+}/* CVC4::theory namespace */
+}/* CVC4 namespace */
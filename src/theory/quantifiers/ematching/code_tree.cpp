@@ -0,0 +1,456 @@
+/*********************                                                        */
+/*! \file code_tree.cpp
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2018 by the authors listed in the file AUTHORS
+ ** in the top-level source directory) and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief Code trees for matching triggers
+ **/
+
+#include "theory/quantifiers/ematching/code_tree.h"
+
+#include "options/uf_options.h"
+#include "theory/quantifiers/ematching/trigger.h"
+#include "theory/quantifiers/term_database.h"
+#include "theory/quantifiers/term_util.h"
+#include "theory/quantifiers_engine.h"
+
+using namespace std;
+using namespace CVC4::kind;
+
+namespace CVC4 {
+namespace theory {
+namespace inst {
+
+CodeTree::CodeTree(QuantifiersEngine* qe)
+    : d_qe(qe),
+      d_numBuffered(0),
+      d_target(0),
+      d_callback(nullptr),
+      d_buffer(false)
+{
+}
+
+bool CodeTree::reset(Theory::Effort e)
+{
+  for (std::map<Node, bool>::iterator it = d_executed.begin();
+       it != d_executed.end();
+       ++it)
+  {
+    clearBuffers(it->first);
+  }
+  Assert(d_numBuffered == 0);
+  d_executed.clear();
+  return true;
+}
+
+unsigned CodeTree::addPattern(Node op,
+                              Node pat,
+                              const std::vector<int>& varNum)
+{
+  Assert(varNum.size() == pat.getNumChildren());
+  std::vector<Instruction> path;
+  // the argument where each variable first occurs
+  std::map<int, unsigned> firstArg;
+  for (unsigned i = 0, nchild = pat.getNumChildren(); i < nchild; i++)
+  {
+    Instruction inst(CHECK, 0, pat[i]);
+    if (varNum[i] >= 0)
+    {
+      std::map<int, unsigned>::iterator itf = firstArg.find(varNum[i]);
+      if (itf == firstArg.end())
+      {
+        firstArg[varNum[i]] = i;
+        inst = Instruction(BIND, 0, Node::null());
+      }
+      else
+      {
+        inst = Instruction(COMPARE, itf->second, Node::null());
+      }
+    }
+    path.push_back(inst);
+  }
+  return addPath(op, path, 1);
+}
+
+bool CodeTree::isCompilable(Node q, const std::vector<Node>& pats)
+{
+  if (options::ufHo())
+  {
+    return false;
+  }
+  quantifiers::TermDb* tdb = d_qe->getTermDatabase();
+  std::vector<Node> visit(pats.begin(), pats.end());
+  while (!visit.empty())
+  {
+    Node pat = visit.back();
+    visit.pop_back();
+    if (!Trigger::isAtomicTrigger(pat) || tdb->getMatchOperator(pat).isNull())
+    {
+      return false;
+    }
+    for (const Node& pc : pat)
+    {
+      if (pc.getKind() == INST_CONSTANT)
+      {
+        if (quantifiers::TermUtil::getInstConstAttr(pc) != q)
+        {
+          return false;
+        }
+      }
+      else if (quantifiers::TermUtil::hasInstConstAttr(pc))
+      {
+        visit.push_back(pc);
+      }
+    }
+  }
+  return true;
+}
+
+unsigned CodeTree::addTrigger(
+    Node q,
+    const std::vector<Node>& pats,
+    Node& op,
+    unsigned& numTerms,
+    std::map<int, std::pair<unsigned, unsigned> >& varArg)
+{
+  Assert(isCompilable(q, pats));
+  quantifiers::TermDb* tdb = d_qe->getTermDatabase();
+  op = tdb->getMatchOperator(pats[0]);
+  std::vector<Instruction> path;
+  std::map<Node, unsigned> slot;
+  unsigned numSlots = 0;
+  numTerms = 0;
+  for (unsigned i = 0, npats = pats.size(); i < npats; i++)
+  {
+    if (i > 0)
+    {
+      path.push_back(
+          Instruction(NEXT, 0, tdb->getMatchOperator(pats[i])));
+    }
+    compilePattern(q, pats[i], path, slot, numSlots, numTerms, varArg);
+  }
+  return addPath(op, path, numTerms);
+}
+
+unsigned CodeTree::compilePattern(
+    Node q,
+    Node pat,
+    std::vector<Instruction>& path,
+    std::map<Node, unsigned>& slot,
+    unsigned& numSlots,
+    unsigned& numTerms,
+    std::map<int, std::pair<unsigned, unsigned> >& varArg)
+{
+  // the variables bound by the arguments of pat
+  std::vector<std::pair<int, unsigned> > bound;
+  for (unsigned i = 0, nchild = pat.getNumChildren(); i < nchild; i++)
+  {
+    Node pc = pat[i];
+    if (pc.getKind() == INST_CONSTANT)
+    {
+      std::map<Node, unsigned>::iterator its = slot.find(pc);
+      if (its == slot.end())
+      {
+        slot[pc] = numSlots;
+        path.push_back(Instruction(BIND, 0, Node::null()));
+        bound.push_back(std::pair<int, unsigned>(
+            pc.getAttribute(InstVarNumAttribute()), i));
+      }
+      else
+      {
+        path.push_back(Instruction(COMPARE, its->second, Node::null()));
+      }
+      numSlots++;
+    }
+    else if (!quantifiers::TermUtil::hasInstConstAttr(pc))
+    {
+      path.push_back(Instruction(CHECK, 0, pc));
+      numSlots++;
+    }
+    else
+    {
+      path.push_back(Instruction(
+          ENTER, 0, d_qe->getTermDatabase()->getMatchOperator(pc)));
+      numSlots++;
+      compilePattern(q, pc, path, slot, numSlots, numTerms, varArg);
+      path.push_back(Instruction(EXIT, 0, Node::null()));
+    }
+  }
+  unsigned index = numTerms++;
+  for (const std::pair<int, unsigned>& b : bound)
+  {
+    varArg[b.first] = std::pair<unsigned, unsigned>(index, b.second);
+  }
+  return index;
+}
+
+unsigned CodeTree::addPath(Node op,
+                           const std::vector<Instruction>& path,
+                           unsigned numTerms)
+{
+  std::map<Node, unsigned>::iterator itr = d_roots.find(op);
+  unsigned node;
+  if (itr == d_roots.end())
+  {
+    node = d_nodes.size();
+    d_nodes.push_back(CodeNode());
+    d_roots[op] = node;
+  }
+  else
+  {
+    node = itr->second;
+  }
+  for (const Instruction& inst : path)
+  {
+    std::map<Instruction, unsigned>::iterator itc =
+        d_nodes[node].d_children.find(inst);
+    if (itc == d_nodes[node].d_children.end())
+    {
+      unsigned child = d_nodes.size();
+      d_nodes.push_back(CodeNode());
+      d_nodes[node].d_children[inst] = child;
+      node = child;
+    }
+    else
+    {
+      node = itc->second;
+    }
+  }
+  ++(d_qe->d_statistics.d_triggers_compiled);
+  if (d_nodes[node].d_yield < 0)
+  {
+    unsigned yield = d_matches.size();
+    d_nodes[node].d_yield = yield;
+    d_leaves[op].push_back(yield);
+    d_tupleSize.push_back(numTerms);
+    d_numTriggers.push_back(0);
+    d_matches.push_back(std::vector<Node>());
+    d_buffered.push_back(false);
+  }
+  else
+  {
+    Trace("code-tree") << "Trigger of " << op << " shares its leaf"
+                       << std::endl;
+  }
+  unsigned yield = d_nodes[node].d_yield;
+  Assert(d_tupleSize[yield] == numTerms);
+  d_numTriggers[yield]++;
+  return yield;
+}
+
+void CodeTree::getMatches(Node op,
+                          unsigned yield,
+                          const MatchCallback& callback)
+{
+  if (d_executed.find(op) == d_executed.end())
+  {
+    // the first request of the round executes the tree for all its leaves
+    if (execute(op, yield, callback, true))
+    {
+      d_executed[op] = true;
+    }
+    else
+    {
+      // the buffers are incomplete, the next request executes it again
+      clearBuffers(op);
+    }
+  }
+  else if (d_buffered[yield])
+  {
+    const std::vector<Node>& matches = d_matches[yield];
+    for (size_t i = 0, size = matches.size(); i < size;
+         i += d_tupleSize[yield])
+    {
+      if (!callback(&matches[i]))
+      {
+        return;
+      }
+    }
+  }
+  else
+  {
+    // the tuples of yield did not fit in the buffers
+    Trace("code-tree") << "Execute code tree for " << op << " again"
+                       << std::endl;
+    execute(op, yield, callback, false);
+  }
+}
+
+void CodeTree::clearBuffers(Node op)
+{
+  for (unsigned yield : d_leaves[op])
+  {
+    d_numBuffered -= d_matches[yield].size();
+    std::vector<Node>().swap(d_matches[yield]);
+    d_buffered[yield] = false;
+  }
+}
+
+bool CodeTree::execute(Node op,
+                       unsigned yield,
+                       const MatchCallback& callback,
+                       bool buffer)
+{
+  Trace("code-tree") << "Execute code tree for " << op << std::endl;
+  if (buffer)
+  {
+    for (unsigned y : d_leaves[op])
+    {
+      // the tuples of yield are passed to callback, and are only buffered
+      // for the other triggers sharing its leaf
+      d_buffered[y] = y != yield || d_numTriggers[y] > 1;
+    }
+  }
+  quantifiers::TermArgTrie* tat = d_qe->getTermDatabase()->getTermArgTrie(op);
+  if (!tat)
+  {
+    return true;
+  }
+  d_target = yield;
+  d_callback = &callback;
+  d_buffer = buffer;
+  std::vector<TNode> args;
+  std::vector<Node> terms;
+  std::vector<quantifiers::TermArgTrie*> cont;
+  bool ret = execute(d_roots[op], tat, args, terms, cont);
+  d_callback = nullptr;
+  return ret;
+}
+
+bool CodeTree::execute(unsigned node,
+                       quantifiers::TermArgTrie* tat,
+                       std::vector<TNode>& args,
+                       std::vector<Node>& terms,
+                       std::vector<quantifiers::TermArgTrie*>& cont)
+{
+  int yield = d_nodes[node].d_yield;
+  if (yield >= 0)
+  {
+    Assert(!tat->d_data.empty());
+    terms.push_back(tat->getNodeData());
+    if (d_buffer && d_buffered[yield])
+    {
+      std::vector<Node>& matches = d_matches[yield];
+      if (d_numBuffered + terms.size() > s_maxBufferedTerms)
+      {
+        // give up on buffering this leaf, it is executed again on request
+        Trace("code-tree") << "Leaf " << yield << " is not buffered"
+                           << std::endl;
+        d_numBuffered -= matches.size();
+        std::vector<Node>().swap(matches);
+        d_buffered[yield] = false;
+      }
+      else
+      {
+        matches.insert(matches.end(), terms.begin(), terms.end());
+        d_numBuffered += terms.size();
+      }
+    }
+    bool success = static_cast<unsigned>(yield) != d_target
+                   || (*d_callback)(terms.data());
+    terms.pop_back();
+    if (!success)
+    {
+      return false;
+    }
+  }
+  quantifiers::TermDb* tdb = d_qe->getTermDatabase();
+  for (const std::pair<const Instruction, unsigned>& c :
+       d_nodes[node].d_children)
+  {
+    const Instruction& inst = c.first;
+    if (inst.d_kind == BIND)
+    {
+      for (quantifiers::TermArgTrieMap::Entry& t : tat->d_data)
+      {
+        args.push_back(t.first);
+        bool success = execute(c.second, &t.second, args, terms, cont);
+        args.pop_back();
+        if (!success)
+        {
+          return false;
+        }
+      }
+    }
+    else if (inst.d_kind == ENTER)
+    {
+      // choose the equivalence class of the argument, and backtrack
+      for (quantifiers::TermArgTrieMap::Entry& t : tat->d_data)
+      {
+        quantifiers::TermArgTrie* tatn =
+            tdb->getTermArgTrie(t.first, inst.d_term);
+        if (tatn)
+        {
+          args.push_back(t.first);
+          cont.push_back(&t.second);
+          bool success = execute(c.second, tatn, args, terms, cont);
+          cont.pop_back();
+          args.pop_back();
+          if (!success)
+          {
+            return false;
+          }
+        }
+      }
+    }
+    else if (inst.d_kind == EXIT || inst.d_kind == NEXT)
+    {
+      // the pattern is matched, continue with the remaining arguments of its
+      // parent, or with the next pattern
+      Assert(!tat->d_data.empty());
+      quantifiers::TermArgTrie* tatn;
+      if (inst.d_kind == EXIT)
+      {
+        Assert(!cont.empty());
+        tatn = cont.back();
+        cont.pop_back();
+      }
+      else
+      {
+        tatn = tdb->getTermArgTrie(inst.d_term);
+      }
+      bool success = true;
+      if (tatn)
+      {
+        terms.push_back(tat->getNodeData());
+        success = execute(c.second, tatn, args, terms, cont);
+        terms.pop_back();
+      }
+      if (inst.d_kind == EXIT)
+      {
+        cont.push_back(tatn);
+      }
+      if (!success)
+      {
+        return false;
+      }
+    }
+    else
+    {
+      Node r = inst.d_kind == COMPARE
+                   ? Node(args[inst.d_arg])
+                   : d_qe->getEqualityQuery()->getRepresentative(inst.d_term);
+      quantifiers::TermArgTrieMap::iterator it =
+          tat->d_data.find(r);
+      if (it != tat->d_data.end())
+      {
+        args.push_back(r);
+        bool success = execute(c.second, &it->second, args, terms, cont);
+        args.pop_back();
+        if (!success)
+        {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+}/* CVC4::theory::inst namespace */
+}/* CVC4::theory namespace */
+}/* CVC4 namespace */
@@ -0,0 +1,250 @@
+/*********************                                                        */
+/*! \file code_tree.h
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2018 by the authors listed in the file AUTHORS
+ ** in the top-level source directory) and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief Code trees for matching triggers
+ **/
+
+#include "cvc4_private.h"
+
+#ifndef __CVC4__THEORY__QUANTIFIERS__CODE_TREE_H
+#define __CVC4__THEORY__QUANTIFIERS__CODE_TREE_H
+
+#include <functional>
+#include <map>
+#include <vector>
+
+#include "expr/node.h"
+#include "theory/quantifiers/quant_util.h"
+
+namespace CVC4 {
+namespace theory {
+
+class QuantifiersEngine;
+
+namespace quantifiers {
+class TermArgTrie;
+}
+
+namespace inst {
+
+/** Code tree
+ *
+ * This class compiles the triggers of all quantified formulas into one tree
+ * per match operator, whose edges are matching instructions. A trigger is
+ * compiled into a path, whose instructions are, for each argument of its
+ * patterns in depth-first order:
+ * - BIND binds the argument to any term, it is the first occurrence of a
+ * variable,
+ * - COMPARE requires the argument to be equal to an earlier argument, it is
+ * a repeated occurrence of a variable,
+ * - CHECK requires the argument to be equal to a ground term,
+ * - ENTER chooses any term for the argument and continues with the term
+ * index of the (nested) pattern of the argument in the equivalence class of
+ * that term, the continuation being restored by the matching EXIT once the
+ * arguments of the nested pattern are matched,
+ * and, between the patterns of a multi-trigger, NEXT continues with the term
+ * index of the match operator of the next pattern. Each choice of BIND or
+ * ENTER is backtracked over once the path below it is executed.
+ *
+ * Triggers that start with the same instructions share a path in the tree,
+ * for example f( x, a ), f( y, a ) and f( x, b ) share their BIND edge, and
+ * the first two (which differ only in the names of their variables) also
+ * share their leaf, as does the multi-trigger { f( x, a ), g( x ) } with the
+ * first one up to its NEXT edge.
+ *
+ * Its leaves yield tuples of matched terms, one for each pattern and nested
+ * pattern in the order their EXIT, NEXT or leaf is reached. The tree of an
+ * operator is executed over the term index of TermDb the first time the
+ * matches of one of its triggers are requested in an instantiation round.
+ * The tuples of that trigger are passed to the callback of the request as
+ * they are found, and those of the other leaves are buffered, so that the
+ * scans of the term index are shared by all the triggers of the operator.
+ * The buffers hold at most s_maxBufferedTerms terms in total. A leaf whose
+ * tuples do not fit is not buffered, and the tree is executed again for it
+ * when its matches are requested.
+ */
+class CodeTree : public QuantifiersUtil
+{
+ public:
+  CodeTree(QuantifiersEngine* qe);
+  ~CodeTree() {}
+  /** clears the matches of the previous round */
+  bool reset(Theory::Effort e) override;
+  /** register quantifier */
+  void registerQuantifier(Node q) override {}
+  /** identify */
+  std::string identify() const override { return "CodeTree"; }
+  /** add pattern
+   *
+   * Compiles the simple trigger pat whose match operator is op. The vector
+   * varNum maps each argument of pat to the number of its variable, or to -1
+   * if it is not a variable of the quantified formula being matched.
+   * Returns the identifier of the leaf of pat, whose tuples are the matched
+   * terms.
+   */
+  unsigned addPattern(Node op, Node pat, const std::vector<int>& varNum);
+  /** is compilable
+   *
+   * Returns true if the trigger of q whose patterns are pats can be compiled
+   * by addTrigger, that is, if its patterns and nested patterns are
+   * applications of match operators whose arguments are variables of q,
+   * ground terms or nested patterns.
+   */
+  bool isCompilable(Node q, const std::vector<Node>& pats);
+  /** add trigger
+   *
+   * Compiles the trigger of q whose patterns are pats, which is compilable.
+   * Returns the identifier of its leaf in the tree of the match operator op
+   * of pats[0]. The tuples of the leaf have numTerms terms, and the variable
+   * number v of q is matched with argument varArg[v].second of term
+   * varArg[v].first of the tuples.
+   */
+  unsigned addTrigger(Node q,
+                      const std::vector<Node>& pats,
+                      Node& op,
+                      unsigned& numTerms,
+                      std::map<int, std::pair<unsigned, unsigned> >& varArg);
+  /**
+   * A function receiving a tuple of matched terms, which returns false if no
+   * more tuples should be passed to it.
+   */
+  typedef std::function<bool(const Node* tuple)> MatchCallback;
+  /** get matches
+   *
+   * Passes the tuples of ground terms matched in the current round by the
+   * trigger whose leaf is yield, which was added with operator op, to
+   * callback, until it returns false.
+   */
+  void getMatches(Node op, unsigned yield, const MatchCallback& callback);
+
+ private:
+  /** the kinds of instructions */
+  enum InstructionKind
+  {
+    BIND,
+    COMPARE,
+    CHECK,
+    ENTER,
+    EXIT,
+    NEXT
+  };
+  /** an instruction for one argument, or the end of a pattern */
+  struct Instruction
+  {
+    Instruction(InstructionKind k, unsigned arg, Node t)
+        : d_kind(k), d_arg(arg), d_term(t)
+    {
+    }
+    InstructionKind d_kind;
+    /** for COMPARE, the earlier argument */
+    unsigned d_arg;
+    /** for CHECK, the ground term, for ENTER and NEXT, the match operator */
+    Node d_term;
+    bool operator<(const Instruction& i) const
+    {
+      if (d_kind != i.d_kind)
+      {
+        return d_kind < i.d_kind;
+      }
+      if (d_arg != i.d_arg)
+      {
+        return d_arg < i.d_arg;
+      }
+      return d_term < i.d_term;
+    }
+  };
+  /** a node of the tree */
+  struct CodeNode
+  {
+    CodeNode() : d_yield(-1) {}
+    /** the children, indices in d_nodes */
+    std::map<Instruction, unsigned> d_children;
+    /** the leaf identifier, or -1 if no pattern ends here */
+    int d_yield;
+  };
+  /**
+   * Add the path of instructions path, whose tuples have numTerms terms, to
+   * the tree of op. Returns its leaf.
+   */
+  unsigned addPath(Node op,
+                   const std::vector<Instruction>& path,
+                   unsigned numTerms);
+  /** compile pattern, helper function for addTrigger
+   *
+   * Adds the instructions for the arguments of pat to path. The map slot
+   * maps the variables matched so far to their argument in the order of the
+   * instructions, and numSlots is the number of arguments so far. Returns the
+   * index of pat in the tuples, after its nested patterns.
+   */
+  unsigned compilePattern(Node q,
+                          Node pat,
+                          std::vector<Instruction>& path,
+                          std::map<Node, unsigned>& slot,
+                          unsigned& numSlots,
+                          unsigned& numTerms,
+                          std::map<int, std::pair<unsigned, unsigned> >& varArg);
+  /**
+   * Execute the tree of op over the term index, passing the tuples of leaf
+   * yield to callback, and buffering those of the other leaves if buffer is
+   * true. Returns false if callback stopped the execution.
+   */
+  bool execute(Node op,
+               unsigned yield,
+               const MatchCallback& callback,
+               bool buffer);
+  /** execute, helper function
+   *
+   * Executes the children of node over the term index tat, where args are
+   * the representatives matched by the previous arguments, terms are the
+   * terms of the patterns matched so far, and cont are the term indices to
+   * continue with after the nested patterns being matched. Returns false if
+   * the callback stopped the execution.
+   */
+  bool execute(unsigned node,
+               quantifiers::TermArgTrie* tat,
+               std::vector<TNode>& args,
+               std::vector<Node>& terms,
+               std::vector<quantifiers::TermArgTrie*>& cont);
+  /** clear the buffers of the leaves of the tree of op */
+  void clearBuffers(Node op);
+  /** pointer to the quantifiers engine */
+  QuantifiersEngine* d_qe;
+  /** the nodes of all trees */
+  std::vector<CodeNode> d_nodes;
+  /** the roots of the trees, for each match operator */
+  std::map<Node, unsigned> d_roots;
+  /** the leaves of the tree of each match operator */
+  std::map<Node, std::vector<unsigned> > d_leaves;
+  /** the number of terms of the tuples of each leaf */
+  std::vector<unsigned> d_tupleSize;
+  /** the number of triggers that were added with each leaf */
+  std::vector<unsigned> d_numTriggers;
+  /** the buffered tuples of each leaf in the current round, concatenated */
+  std::vector<std::vector<Node> > d_matches;
+  /** whether the buffer of each leaf holds all of its tuples */
+  std::vector<bool> d_buffered;
+  /** the number of terms in all buffers */
+  size_t d_numBuffered;
+  /** the maximum number of terms in all buffers */
+  static const size_t s_maxBufferedTerms = 1 << 16;
+  /** the operators whose trees were executed in the current round */
+  std::map<Node, bool> d_executed;
+  /** the leaf whose tuples are passed to d_callback by execute */
+  unsigned d_target;
+  /** the callback of the current execution */
+  const MatchCallback* d_callback;
+  /** whether the current execution buffers the tuples of the other leaves */
+  bool d_buffer;
+};
+
+}/* CVC4::theory::inst namespace */
+}/* CVC4::theory namespace */
+}/* CVC4 namespace */
+
+#endif /* __CVC4__THEORY__QUANTIFIERS__CODE_TREE_H */
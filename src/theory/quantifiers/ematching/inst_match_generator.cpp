@@ -18,6 +18,7 @@
 #include "options/datatypes_options.h"
 #include "options/quantifiers_options.h"
 #include "theory/quantifiers/ematching/candidate_generator.h"
+#include "theory/quantifiers/ematching/code_tree.h"
 #include "theory/quantifiers/ematching/trigger.h"
 #include "theory/quantifiers/instantiate.h"
 #include "theory/quantifiers/term_database.h"
@@ -988,7 +989,7 @@ void InstMatchGeneratorMulti::processNewInstantiations(QuantifiersEngine* qe,
 InstMatchGeneratorSimple::InstMatchGeneratorSimple(Node q,
                                                    Node pat,
                                                    QuantifiersEngine* qe)
-    : d_quant(q), d_match_pattern(pat)
+    : d_quant(q), d_match_pattern(pat), d_code_yield(-1)
 {
   if( d_match_pattern.getKind()==NOT ){
     d_match_pattern = d_match_pattern[0];
@@ -1013,6 +1014,18 @@ InstMatchGeneratorSimple::InstMatchGeneratorSimple(Node q,
     d_match_pattern_arg_types.push_back( d_match_pattern[i].getType() );
   }
   d_op = qe->getTermDatabase()->getMatchOperator( d_match_pattern );
+  CodeTree* ct = qe->getCodeTree();
+  if (ct != nullptr && d_eqc.isNull())
+  {
+    std::vector<int> varNum;
+    for (unsigned i = 0, nchild = d_match_pattern.getNumChildren(); i < nchild;
+         i++)
+    {
+      std::map<unsigned, int>::iterator it = d_var_num.find(i);
+      varNum.push_back(it == d_var_num.end() ? -1 : it->second);
+    }
+    d_code_yield = ct->addPattern(d_op, d_match_pattern, varNum);
+  }
 }
 
 void InstMatchGeneratorSimple::resetInstantiationRound( QuantifiersEngine* qe ) {
@@ -1023,6 +1036,16 @@ int InstMatchGeneratorSimple::addInstantiations(Node q,
                                                 Trigger* tparent)
 {
   int addedLemmas = 0;
+  if (d_code_yield >= 0)
+  {
+    // the matches are computed by the code tree
+    if (!qe->inConflict())
+    {
+      InstMatch m(q);
+      addCodeTreeInstantiations(m, qe, addedLemmas);
+    }
+    return addedLemmas;
+  }
   quantifiers::TermArgTrie* tat;
   if( d_eqc.isNull() ){
     tat = qe->getTermDatabase()->getTermArgTrie( d_op );
@@ -1035,7 +1058,7 @@ int InstMatchGeneratorSimple::addInstantiations(Node q,
       if (tat && !qe->inConflict())
       {
         Node r = qe->getEqualityQuery()->getRepresentative(d_eqc);
-        for( std::map< TNode, quantifiers::TermArgTrie >::iterator it = tat->d_data.begin(); it != tat->d_data.end(); ++it ){
+        for( quantifiers::TermArgTrieMap::iterator it = tat->d_data.begin(); it != tat->d_data.end(); ++it ){
           if( it->first!=r ){
             InstMatch m( q );
             addInstantiations( m, qe, addedLemmas, 0, &(it->second) );
@@ -1057,6 +1080,64 @@ int InstMatchGeneratorSimple::addInstantiations(Node q,
   return addedLemmas;
 }
 
+void InstMatchGeneratorSimple::addCodeTreeInstantiations(InstMatch& m,
+                                                         QuantifiersEngine* qe,
+                                                         int& addedLemmas)
+{
+  qe->getCodeTree()->getMatches(d_op, d_code_yield, [&](const Node* tuple) {
+    Node t = tuple[0];
+    Debug("simple-trigger") << "Actual term is " << t << std::endl;
+    for (std::map<unsigned, int>::iterator it = d_var_num.begin();
+         it != d_var_num.end();
+         ++it)
+    {
+      if (it->second >= 0)
+      {
+        m.setValue(it->second, t[it->first]);
+      }
+    }
+    if (qe->getInstantiate()->addInstantiation(d_quant, m))
+    {
+      addedLemmas++;
+      Debug("simple-trigger") << "-> Produced instantiation " << m << std::endl;
+    }
+    return !qe->inConflict();
+  });
+}
+
+InstMatchGeneratorCodeTree::InstMatchGeneratorCodeTree(
+    Node q, const std::vector<Node>& pats, QuantifiersEngine* qe)
+{
+  d_code_yield =
+      qe->getCodeTree()->addTrigger(q, pats, d_op, d_num_terms, d_var_arg);
+}
+
+int InstMatchGeneratorCodeTree::addInstantiations(Node q,
+                                                  QuantifiersEngine* qe,
+                                                  Trigger* tparent)
+{
+  int addedLemmas = 0;
+  if (qe->inConflict())
+  {
+    return addedLemmas;
+  }
+  InstMatch m(q);
+  qe->getCodeTree()->getMatches(d_op, d_code_yield, [&](const Node* tuple) {
+    for (const std::pair<const int, std::pair<unsigned, unsigned> >& va :
+         d_var_arg)
+    {
+      m.setValue(va.first, tuple[va.second.first][va.second.second]);
+    }
+    if (sendInstantiation(tparent, m))
+    {
+      addedLemmas++;
+      Debug("code-tree") << "-> Produced instantiation " << m << std::endl;
+    }
+    return !qe->inConflict();
+  });
+  return addedLemmas;
+}
+
 void InstMatchGeneratorSimple::addInstantiations(InstMatch& m,
                                                  QuantifiersEngine* qe,
                                                  int& addedLemmas,
@@ -1091,7 +1172,7 @@ void InstMatchGeneratorSimple::addInstantiations(InstMatch& m,
     if( d_match_pattern[argIndex].getKind()==INST_CONSTANT ){
       int v = d_var_num[argIndex];
       if( v!=-1 ){
-        for( std::map< TNode, quantifiers::TermArgTrie >::iterator it = tat->d_data.begin(); it != tat->d_data.end(); ++it ){
+        for( quantifiers::TermArgTrieMap::iterator it = tat->d_data.begin(); it != tat->d_data.end(); ++it ){
           Node t = it->first;
           Node prev = m.get( v );
           //using representatives, just check if equal
@@ -1110,7 +1191,7 @@ void InstMatchGeneratorSimple::addInstantiations(InstMatch& m,
       //inst constant from another quantified formula, treat as ground term  TODO: remove this?
     }
     Node r = qe->getEqualityQuery()->getRepresentative( d_match_pattern[argIndex] );
-    std::map< TNode, quantifiers::TermArgTrie >::iterator it = tat->d_data.find( r );
+    quantifiers::TermArgTrieMap::iterator it = tat->d_data.find( r );
     if( it!=tat->d_data.end() ){
       addInstantiations( m, qe, addedLemmas, argIndex+1, &(it->second) );
     }
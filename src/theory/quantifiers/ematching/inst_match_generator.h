@@ -649,6 +649,15 @@ class InstMatchGeneratorSimple : public IMGenerator {
    * child is not a variable.
    */
   std::map<unsigned, int> d_var_num;
+  /**
+   * The leaf of d_match_pattern in the code tree of the quantifiers engine,
+   * or -1 if it is not matched by the code tree.
+   */
+  int d_code_yield;
+  /** add instantiations for the terms matched by the code tree */
+  void addCodeTreeInstantiations(InstMatch& m,
+                                 QuantifiersEngine* qe,
+                                 int& addedLemmas);
   /** add instantiations, helper function.
    *
    * m is the current match we are building,
@@ -664,6 +673,40 @@ class InstMatchGeneratorSimple : public IMGenerator {
                          unsigned argIndex,
                          quantifiers::TermArgTrie* tat);
 };/* class InstMatchGeneratorSimple */
+
+/** InstMatchGeneratorCodeTree class
+ *
+ * This is the generator class for the non-simple single triggers and the
+ * multi-triggers that are compiled into the code tree of the quantifiers
+ * engine (see CodeTree::isCompilable), for example { f( g( x ), x ) } and
+ * { f( x ), g( x, y ) }. It adds the instantiations for the tuples of terms
+ * matched by the code tree.
+ */
+class InstMatchGeneratorCodeTree : public IMGenerator {
+ public:
+  /** constructors */
+  InstMatchGeneratorCodeTree(Node q,
+                             const std::vector<Node>& pats,
+                             QuantifiersEngine* qe);
+
+  /** Add instantiations. */
+  int addInstantiations(Node q,
+                        QuantifiersEngine* qe,
+                        Trigger* tparent) override;
+
+ private:
+  /** the match operator of the first pattern */
+  Node d_op;
+  /** the leaf of the trigger in the code tree */
+  unsigned d_code_yield;
+  /** the number of terms of the tuples of the leaf */
+  unsigned d_num_terms;
+  /**
+   * Map from variable index to the term of the tuples and its argument that
+   * the variable is matched with.
+   */
+  std::map<int, std::pair<unsigned, unsigned> > d_var_arg;
+};/* class InstMatchGeneratorCodeTree */
 }
 }
 }
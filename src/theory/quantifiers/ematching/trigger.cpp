@@ -17,8 +17,10 @@
 #include "expr/node_algorithm.h"
 #include "theory/arith/arith_msum.h"
 #include "theory/quantifiers/ematching/candidate_generator.h"
+#include "theory/quantifiers/ematching/code_tree.h"
 #include "theory/quantifiers/ematching/ho_trigger.h"
 #include "theory/quantifiers/ematching/inst_match_generator.h"
+#include "theory/quantifiers/ematching/trigger_events.h"
 #include "theory/quantifiers/instantiate.h"
 #include "theory/quantifiers/term_database.h"
 #include "theory/quantifiers/term_util.h"
@@ -50,22 +52,33 @@ void TriggerTermInfo::init( Node q, Node n, int reqPol, Node reqPolEq ){
 
 /** trigger class constructor */
 Trigger::Trigger(QuantifiersEngine* qe, Node q, std::vector<Node>& nodes)
-    : d_quantEngine(qe), d_quant(q)
+    : d_quantEngine(qe),
+      d_quant(q),
+      d_eventMerges(true),
+      d_eventAlways(true),
+      d_matchedStamp(qe->getSatContext(), 0)
 {
   d_nodes.insert( d_nodes.begin(), nodes.begin(), nodes.end() );
   Trace("trigger") << "Trigger for " << q << ": " << std::endl;
   for( unsigned i=0; i<d_nodes.size(); i++ ){
     Trace("trigger") << "   " << d_nodes[i] << std::endl;
   }
+  // the code tree compiles the triggers that are not simple, except for the
+  // multi-triggers whose matches are cached
+  CodeTree* ct = qe->getCodeTree();
   if( d_nodes.size()==1 ){
     if( isSimpleTrigger( d_nodes[0] ) ){
       d_mg = new InstMatchGeneratorSimple(q, d_nodes[0], qe);
+    }else if( ct!=nullptr && ct->isCompilable( q, d_nodes ) ){
+      d_mg = new InstMatchGeneratorCodeTree(q, d_nodes, qe);
     }else{
       d_mg = InstMatchGenerator::mkInstMatchGenerator(q, d_nodes[0], qe);
     }
   }else{
     if( options::multiTriggerCache() ){
       d_mg = new InstMatchGeneratorMulti(q, d_nodes, qe);
+    }else if( ct!=nullptr && ct->isCompilable( q, d_nodes ) ){
+      d_mg = new InstMatchGeneratorCodeTree(q, d_nodes, qe);
     }else{
       d_mg = InstMatchGenerator::mkInstMatchGeneratorMulti(q, d_nodes, qe);
     }
@@ -83,6 +96,10 @@ Trigger::Trigger(QuantifiersEngine* qe, Node q, std::vector<Node>& nodes)
     }
     ++(qe->d_statistics.d_multi_triggers);
   }
+  if (qe->getTriggerEvents() != nullptr)
+  {
+    computeEventOperators();
+  }
 
   // Notice() << "Trigger : " << (*this) << "  for " << q << std::endl;
   Trace("trigger-debug") << "Finished making trigger." << std::endl;
@@ -104,9 +121,83 @@ Node Trigger::getInstPattern(){
   return NodeManager::currentNM()->mkNode( INST_PATTERN, d_nodes );
 }
 
+void Trigger::computeEventOperators()
+{
+  d_eventAlways = false;
+  std::unordered_set<TNode, TNodeHashFunction> visited;
+  std::vector<TNode> visit;
+  for (const Node& n : d_nodes)
+  {
+    Node t = n.getKind() == NOT ? n[0] : n;
+    if (t.getKind() == EQUAL && !quantifiers::TermUtil::hasInstConstAttr(t[1]))
+    {
+      t = t[0];
+    }
+    visit.push_back(t);
+  }
+  while (!visit.empty())
+  {
+    TNode cur = visit.back();
+    visit.pop_back();
+    if (cur.getKind() == INST_CONSTANT
+        || !quantifiers::TermUtil::hasInstConstAttr(cur)
+        || !visited.insert(cur).second)
+    {
+      continue;
+    }
+    if (!isAtomicTrigger(cur))
+    {
+      d_eventAlways = true;
+      return;
+    }
+    Node op = d_quantEngine->getTermDatabase()->getMatchOperator(cur);
+    if (std::find(d_eventOps.begin(), d_eventOps.end(), op) == d_eventOps.end())
+    {
+      d_eventOps.push_back(op);
+    }
+    visit.insert(visit.end(), cur.begin(), cur.end());
+  }
+  // the matches of f( x1, ..., xn ) for distinct variables are the terms
+  // f( t1, ..., tn ), which merges do not add to
+  if (d_nodes.size() == 1 && d_nodes[0].getKind() != NOT
+      && d_nodes[0].getKind() != EQUAL && isSimpleTrigger(d_nodes[0]))
+  {
+    std::unordered_set<TNode, TNodeHashFunction> vars;
+    d_eventMerges = false;
+    for (const Node& v : d_nodes[0])
+    {
+      if (v.getKind() != INST_CONSTANT
+          || quantifiers::TermUtil::getInstConstAttr(v) != d_quant
+          || !vars.insert(v).second)
+      {
+        d_eventMerges = true;
+        break;
+      }
+    }
+  }
+}
+
 int Trigger::addInstantiations()
 {
+  // if no event happened since this trigger was last matched completely,
+  // it has no new matches
+  unsigned stamp = 0;
+  inst::TriggerEvents* te = d_quantEngine->getTriggerEvents();
+  if (te != nullptr && !d_eventAlways
+      && !d_quantEngine->usingModelEqualityEngine())
+  {
+    stamp = te->getStamp(d_eventOps, d_eventMerges) + 1;
+    if (stamp == d_matchedStamp.get())
+    {
+      ++(d_quantEngine->d_statistics.d_triggers_unchanged);
+      return 0;
+    }
+  }
   int addedLemmas = d_mg->addInstantiations(d_quant, d_quantEngine, this);
+  if (stamp > 0 && !d_quantEngine->inConflict())
+  {
+    d_matchedStamp = stamp;
+  }
   if( addedLemmas>0 ){
     if (Debug.isOn("inst-trigger"))
     {
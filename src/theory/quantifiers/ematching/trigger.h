@@ -19,6 +19,7 @@
 
 #include <map>
 
+#include "context/cdo.h"
 #include "expr/node.h"
 #include "theory/quantifiers/inst_match.h"
 #include "options/quantifiers_options.h"
@@ -423,6 +424,29 @@ class Trigger {
   QuantifiersEngine* d_quantEngine;
   /** The quantified formula this trigger is for. */
   Node d_quant;
+  /** compute event operators
+   *
+   * Computes d_eventOps, d_eventMerges and d_eventAlways, which determine
+   * the events of TriggerEvents that may give this trigger new matches.
+   */
+  void computeEventOperators();
+  /** the match operators of the atomic subterms of d_nodes */
+  std::vector<Node> d_eventOps;
+  /**
+   * Whether merges may give new matches, which is the case unless this is a
+   * single simple trigger whose arguments are distinct variables.
+   */
+  bool d_eventMerges;
+  /**
+   * Whether this trigger must always be matched, since its matches depend on
+   * more than the terms and equalities (e.g. arithmetic entailment).
+   */
+  bool d_eventAlways;
+  /**
+   * One plus the stamp of TriggerEvents when this trigger was last matched
+   * completely in the current context, or zero if it was not.
+   */
+  context::CDO<unsigned> d_matchedStamp;
   /** match generator
    *
   * This is the back-end utility that implements the underlying matching
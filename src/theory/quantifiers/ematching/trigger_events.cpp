@@ -0,0 +1,61 @@
+/*********************                                                        */
+/*! \file trigger_events.cpp
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2018 by the authors listed in the file AUTHORS
+ ** in the top-level source directory) and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief Changes of the ground terms that may give triggers new matches
+ **/
+
+#include "theory/quantifiers/ematching/trigger_events.h"
+
+#include "theory/quantifiers/ematching/trigger.h"
+#include "theory/quantifiers/term_database.h"
+#include "theory/quantifiers/term_util.h"
+#include "theory/quantifiers_engine.h"
+
+using namespace std;
+
+namespace CVC4 {
+namespace theory {
+namespace inst {
+
+TriggerEvents::TriggerEvents(context::Context* c, QuantifiersEngine* qe)
+    : d_qe(qe), d_newTerms(c), d_merges(c, 0)
+{
+}
+
+void TriggerEvents::notifyNewClass(TNode t)
+{
+  if (!Trigger::isAtomicTrigger(t) || quantifiers::TermUtil::hasInstConstAttr(t))
+  {
+    return;
+  }
+  Node op = d_qe->getTermDatabase()->getMatchOperator(t);
+  context::CDHashMap<Node, unsigned, NodeHashFunction>::const_iterator it =
+      d_newTerms.find(op);
+  d_newTerms[op] = it == d_newTerms.end() ? 1 : (*it).second + 1;
+}
+
+unsigned TriggerEvents::getStamp(const std::vector<Node>& ops,
+                                 bool withMerges) const
+{
+  unsigned stamp = withMerges ? d_merges.get() : 0;
+  for (const Node& op : ops)
+  {
+    context::CDHashMap<Node, unsigned, NodeHashFunction>::const_iterator it =
+        d_newTerms.find(op);
+    if (it != d_newTerms.end())
+    {
+      stamp += (*it).second;
+    }
+  }
+  return stamp;
+}
+
+}/* CVC4::theory::inst namespace */
+}/* CVC4::theory namespace */
+}/* CVC4 namespace */
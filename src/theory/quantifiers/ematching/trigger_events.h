@@ -0,0 +1,74 @@
+/*********************                                                        */
+/*! \file trigger_events.h
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2018 by the authors listed in the file AUTHORS
+ ** in the top-level source directory) and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief Changes of the ground terms that may give triggers new matches
+ **/
+
+#include "cvc4_private.h"
+
+#ifndef __CVC4__THEORY__QUANTIFIERS__TRIGGER_EVENTS_H
+#define __CVC4__THEORY__QUANTIFIERS__TRIGGER_EVENTS_H
+
+#include <vector>
+
+#include "context/cdhashmap.h"
+#include "context/cdo.h"
+#include "expr/node.h"
+
+namespace CVC4 {
+namespace theory {
+
+class QuantifiersEngine;
+
+namespace inst {
+
+/** Trigger events
+ *
+ * This class counts the events of the master equality engine that may give
+ * a trigger new matches: the new terms of each match operator, and the
+ * merges of equivalence classes. The counters are context dependent, so
+ * that they are restored with the state of the equality engine on
+ * backtracking.
+ *
+ * A trigger that was matched completely when the sum of the counters of its
+ * operators (and of the merges, if its matches depend on them) was some
+ * value, stored in the same context, has no new matches while this sum is
+ * unchanged. Since the counters only increase between a context and its
+ * descendants, the sum is unchanged exactly when no such event happened.
+ */
+class TriggerEvents
+{
+ public:
+  TriggerEvents(context::Context* c, QuantifiersEngine* qe);
+  ~TriggerEvents() {}
+  /** notify that t is a new term of the master equality engine */
+  void notifyNewClass(TNode t);
+  /** notify that two equivalence classes were merged */
+  void notifyMerge() { d_merges = d_merges + 1; }
+  /** get stamp
+   *
+   * Returns the sum of the counters of the match operators ops, plus the
+   * number of merges if withMerges is true.
+   */
+  unsigned getStamp(const std::vector<Node>& ops, bool withMerges) const;
+
+ private:
+  /** pointer to the quantifiers engine */
+  QuantifiersEngine* d_qe;
+  /** the number of new terms of each match operator */
+  context::CDHashMap<Node, unsigned, NodeHashFunction> d_newTerms;
+  /** the number of merges */
+  context::CDO<unsigned> d_merges;
+};
+
+}/* CVC4::theory::inst namespace */
+}/* CVC4::theory namespace */
+}/* CVC4 namespace */
+
+#endif /* __CVC4__THEORY__QUANTIFIERS__TRIGGER_EVENTS_H */
@@ -0,0 +1,443 @@
+/*********************                                                        */
+/*! \file fmc_batch_eval.cpp
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2018 by the authors listed in the file AUTHORS
+ ** in the top-level source directory) and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief Implementation of batched evaluation for full model checking
+ **/
+
+#include "theory/quantifiers/fmf/fmc_batch_eval.h"
+
+#include <algorithm>
+
+#include "theory/quantifiers/first_order_model.h"
+#include "theory/quantifiers/fmf/full_model_check.h"
+
+using namespace CVC4::kind;
+
+namespace CVC4 {
+namespace theory {
+namespace quantifiers {
+namespace fmcheck {
+
+const uint64_t FmcBatchEvaluator::s_maxTuples;
+const unsigned FmcBatchEvaluator::s_blockSize;
+const uint64_t FmcBatchEvaluator::s_maxTableSize;
+
+FmcBatchEvaluator::FmcBatchEvaluator()
+    : d_fm(nullptr), d_repIds(nullptr), d_models(nullptr)
+{
+}
+
+void FmcBatchEvaluator::reset(
+    FirstOrderModelFmc* fm,
+    const std::map<TypeNode, std::map<Node, int> >& repIds,
+    const std::map<Node, Def*>& models)
+{
+  d_fm = fm;
+  d_repIds = &repIds;
+  d_models = &models;
+  d_tables.clear();
+  d_reps.clear();
+}
+
+bool FmcBatchEvaluator::compile(Node q, Program& p)
+{
+  std::map<Node, unsigned> vars;
+  for (unsigned i = 0, nvars = q[0].getNumChildren(); i < nvars; i++)
+  {
+    TypeNode tn = q[0][i].getType();
+    if (!tn.isSort() && !tn.isBoolean())
+    {
+      return false;
+    }
+    vars[q[0][i]] = i;
+  }
+  std::map<Node, int> visited;
+  return compileTerm(q[1], vars, p, visited) >= 0;
+}
+
+int FmcBatchEvaluator::compileTerm(Node n,
+                                   std::map<Node, unsigned>& vars,
+                                   Program& p,
+                                   std::map<Node, int>& visited)
+{
+  std::map<Node, int>::iterator itv = visited.find(n);
+  if (itv != visited.end())
+  {
+    return itv->second;
+  }
+  int ret = -1;
+  Instr instr;
+  TypeNode tn = n.getType();
+  Kind k = n.getKind();
+  std::map<Node, unsigned>::iterator itx = vars.find(n);
+  if (!tn.isSort() && !tn.isBoolean())
+  {
+    // not handled
+  }
+  else if (itx != vars.end())
+  {
+    instr.d_op = OP_VAR;
+    instr.d_arg = itx->second;
+    ret = 0;
+  }
+  else if (n.getNumChildren() == 0)
+  {
+    if (k != BOUND_VARIABLE)
+    {
+      instr.d_op = OP_CONST;
+      instr.d_arg = p.d_consts.size();
+      p.d_consts.push_back(n);
+      ret = 0;
+    }
+  }
+  else
+  {
+    ret = 0;
+    switch (k)
+    {
+      case APPLY_UF:
+        instr.d_op = OP_APPLY;
+        instr.d_arg = p.d_ops.size();
+        p.d_ops.push_back(n.getOperator());
+        break;
+      case EQUAL: instr.d_op = OP_EQUAL; break;
+      case NOT: instr.d_op = OP_NOT; break;
+      case AND: instr.d_op = OP_AND; break;
+      case OR: instr.d_op = OP_OR; break;
+      case IMPLIES: instr.d_op = OP_IMPLIES; break;
+      case XOR: instr.d_op = OP_XOR; break;
+      case ITE: instr.d_op = OP_ITE; break;
+      default: ret = -1; break;
+    }
+    for (unsigned i = 0, nchild = n.getNumChildren(); i < nchild && ret >= 0;
+         i++)
+    {
+      int c = compileTerm(n[i], vars, p, visited);
+      if (c < 0)
+      {
+        ret = -1;
+      }
+      instr.d_children.push_back(c);
+    }
+  }
+  if (ret >= 0)
+  {
+    ret = p.d_instrs.size();
+    p.d_instrs.push_back(instr);
+  }
+  visited[n] = ret;
+  return ret;
+}
+
+unsigned FmcBatchEvaluator::getDomainSize(TypeNode tn)
+{
+  if (tn.isBoolean())
+  {
+    return 2;
+  }
+  std::map<TypeNode, std::vector<Node> >::iterator itr = d_reps.find(tn);
+  if (itr != d_reps.end())
+  {
+    return itr->second.size();
+  }
+  std::vector<Node>& reps = d_reps[tn];
+  std::map<TypeNode, std::map<Node, int> >::const_iterator it =
+      d_repIds->find(tn);
+  if (it == d_repIds->end() || it->second.size() > UINT16_MAX)
+  {
+    return 0;
+  }
+  reps.resize(it->second.size());
+  for (const std::pair<const Node, int>& r : it->second)
+  {
+    reps[r.second] = r.first;
+  }
+  return reps.size();
+}
+
+bool FmcBatchEvaluator::getCode(TypeNode tn, Node v, uint16_t& code)
+{
+  if (!v.isConst())
+  {
+    if (!d_fm->hasTerm(v))
+    {
+      return false;
+    }
+    v = d_fm->getRepresentative(v);
+  }
+  if (tn.isBoolean())
+  {
+    if (!v.isConst())
+    {
+      return false;
+    }
+    code = v.getConst<bool>() ? 1 : 0;
+    return true;
+  }
+  std::map<TypeNode, std::map<Node, int> >::const_iterator it =
+      d_repIds->find(tn);
+  if (it == d_repIds->end())
+  {
+    return false;
+  }
+  std::map<Node, int>::const_iterator itc = it->second.find(v);
+  if (itc == it->second.end())
+  {
+    return false;
+  }
+  code = itc->second;
+  return true;
+}
+
+Node FmcBatchEvaluator::getValue(TypeNode tn, uint16_t code)
+{
+  if (tn.isBoolean())
+  {
+    return NodeManager::currentNM()->mkConst(code != 0);
+  }
+  return d_fm->getRepSet()->getRepresentative(tn, code);
+}
+
+FmcBatchEvaluator::Table& FmcBatchEvaluator::getTable(Node op)
+{
+  std::map<Node, Table>::iterator itt = d_tables.find(op);
+  if (itt != d_tables.end())
+  {
+    return itt->second;
+  }
+  Table& t = d_tables[op];
+  std::map<Node, Def*>::const_iterator itm = d_models->find(op);
+  TypeNode ft = op.getType();
+  if (itm == d_models->end() || !ft.isFunction())
+  {
+    return t;
+  }
+  std::vector<TypeNode> argTypes = ft.getArgTypes();
+  unsigned nargs = argTypes.size();
+  std::vector<unsigned> sizes(nargs);
+  t.d_strides.resize(nargs);
+  uint64_t size = 1;
+  for (unsigned i = nargs; i > 0; i--)
+  {
+    sizes[i - 1] = getDomainSize(argTypes[i - 1]);
+    t.d_strides[i - 1] = size;
+    size *= sizes[i - 1];
+    if (size == 0 || size > s_maxTableSize)
+    {
+      return t;
+    }
+  }
+  Trace("fmc-batch") << "Table for " << op << " has " << size << " entries"
+                     << std::endl;
+  TypeNode rt = ft.getRangeType();
+  std::vector<Node> inst(nargs);
+  t.d_values.resize(size);
+  for (uint64_t idx = 0; idx < size; idx++)
+  {
+    for (unsigned i = 0; i < nargs; i++)
+    {
+      uint16_t c = (idx / t.d_strides[i]) % sizes[i];
+      inst[i] = argTypes[i].isBoolean() ? getValue(argTypes[i], c)
+                                        : d_reps[argTypes[i]][c];
+    }
+    Node v = itm->second->evaluate(d_fm, inst);
+    if (v.isNull() || !getCode(rt, v, t.d_values[idx]))
+    {
+      Trace("fmc-batch") << "...no value for " << op << " at " << idx
+                         << std::endl;
+      t.d_values.clear();
+      return t;
+    }
+  }
+  t.d_valid = true;
+  return t;
+}
+
+FmcBatchEvaluator::Result FmcBatchEvaluator::check(
+    Node q, std::function<bool(std::vector<Node>&)> accept)
+{
+  std::map<Node, Program>::iterator itp = d_programs.find(q);
+  if (itp == d_programs.end())
+  {
+    Program& p = d_programs[q];
+    p.d_valid = compile(q, p);
+    Trace("fmc-batch") << "Compiled " << q << " : " << p.d_valid << std::endl;
+    itp = d_programs.find(q);
+  }
+  Program& p = itp->second;
+  if (!p.d_valid)
+  {
+    return BATCH_UNHANDLED;
+  }
+  // the domains of the variables
+  unsigned nvars = q[0].getNumChildren();
+  std::vector<TypeNode> types;
+  std::vector<unsigned> sizes;
+  uint64_t total = 1;
+  for (unsigned i = 0; i < nvars; i++)
+  {
+    types.push_back(q[0][i].getType());
+    sizes.push_back(getDomainSize(types[i]));
+    total *= sizes[i];
+    if (total == 0 || total > s_maxTuples)
+    {
+      return BATCH_UNHANDLED;
+    }
+  }
+  // the codes of the ground terms, and the tables of the function symbols
+  std::vector<uint16_t> consts(p.d_consts.size());
+  for (unsigned i = 0, nconsts = p.d_consts.size(); i < nconsts; i++)
+  {
+    if (!getCode(p.d_consts[i].getType(), p.d_consts[i], consts[i]))
+    {
+      return BATCH_UNHANDLED;
+    }
+  }
+  std::vector<Table*> tables;
+  for (const Node& op : p.d_ops)
+  {
+    tables.push_back(&getTable(op));
+    if (!tables.back()->d_valid)
+    {
+      return BATCH_UNHANDLED;
+    }
+  }
+  unsigned ninstrs = p.d_instrs.size();
+  d_block.resize(ninstrs);
+  for (std::vector<uint16_t>& b : d_block)
+  {
+    b.resize(s_blockSize);
+  }
+  std::vector<std::vector<uint16_t> > varCodes(
+      nvars, std::vector<uint16_t>(s_blockSize));
+  std::vector<uint16_t> cur(nvars, 0);
+  bool rejected = false;
+  for (uint64_t done = 0; done < total;)
+  {
+    unsigned bsize = std::min<uint64_t>(s_blockSize, total - done);
+    // the next block of tuples, the last variable varies fastest
+    for (unsigned b = 0; b < bsize; b++)
+    {
+      for (unsigned i = 0; i < nvars; i++)
+      {
+        varCodes[i][b] = cur[i];
+      }
+      for (unsigned i = nvars; i > 0; i--)
+      {
+        if (++cur[i - 1] < sizes[i - 1])
+        {
+          break;
+        }
+        cur[i - 1] = 0;
+      }
+    }
+    for (unsigned i = 0; i < ninstrs; i++)
+    {
+      const Instr& instr = p.d_instrs[i];
+      std::vector<uint16_t>& out = d_block[i];
+      const std::vector<unsigned>& ch = instr.d_children;
+      switch (instr.d_op)
+      {
+        case OP_VAR:
+          std::copy(varCodes[instr.d_arg].begin(),
+                    varCodes[instr.d_arg].begin() + bsize,
+                    out.begin());
+          break;
+        case OP_CONST:
+          std::fill(out.begin(), out.begin() + bsize, consts[instr.d_arg]);
+          break;
+        case OP_APPLY:
+        {
+          const Table& t = *tables[instr.d_arg];
+          for (unsigned b = 0; b < bsize; b++)
+          {
+            uint64_t idx = 0;
+            for (unsigned j = 0, nch = ch.size(); j < nch; j++)
+            {
+              idx += d_block[ch[j]][b] * t.d_strides[j];
+            }
+            out[b] = t.d_values[idx];
+          }
+          break;
+        }
+        case OP_EQUAL:
+          for (unsigned b = 0; b < bsize; b++)
+          {
+            out[b] = d_block[ch[0]][b] == d_block[ch[1]][b];
+          }
+          break;
+        case OP_NOT:
+          for (unsigned b = 0; b < bsize; b++)
+          {
+            out[b] = !d_block[ch[0]][b];
+          }
+          break;
+        case OP_AND:
+        case OP_OR:
+        {
+          uint16_t unit = instr.d_op == OP_AND ? 1 : 0;
+          std::fill(out.begin(), out.begin() + bsize, unit);
+          for (unsigned c : ch)
+          {
+            for (unsigned b = 0; b < bsize; b++)
+            {
+              out[b] = unit ? (out[b] & d_block[c][b])
+                            : (out[b] | d_block[c][b]);
+            }
+          }
+          break;
+        }
+        case OP_IMPLIES:
+          for (unsigned b = 0; b < bsize; b++)
+          {
+            out[b] = !d_block[ch[0]][b] || d_block[ch[1]][b];
+          }
+          break;
+        case OP_XOR:
+          for (unsigned b = 0; b < bsize; b++)
+          {
+            out[b] = d_block[ch[0]][b] != d_block[ch[1]][b];
+          }
+          break;
+        case OP_ITE:
+          for (unsigned b = 0; b < bsize; b++)
+          {
+            out[b] = d_block[ch[0]][b] ? d_block[ch[1]][b] : d_block[ch[2]][b];
+          }
+          break;
+      }
+    }
+    const std::vector<uint16_t>& body = d_block[ninstrs - 1];
+    for (unsigned b = 0; b < bsize; b++)
+    {
+      if (body[b] == 0)
+      {
+        std::vector<Node> inst;
+        for (unsigned i = 0; i < nvars; i++)
+        {
+          inst.push_back(getValue(types[i], varCodes[i][b]));
+        }
+        Trace("fmc-batch-debug") << "Counterexample for " << q << " at "
+                                 << (done + b) << std::endl;
+        if (accept(inst))
+        {
+          return BATCH_FALSE;
+        }
+        rejected = true;
+      }
+    }
+    done += bsize;
+  }
+  return rejected ? BATCH_REJECTED : BATCH_TRUE;
+}
+
+}/* CVC4::theory::quantifiers::fmcheck namespace */
+}/* CVC4::theory::quantifiers namespace */
+}/* CVC4::theory namespace */
+}/* CVC4 namespace */
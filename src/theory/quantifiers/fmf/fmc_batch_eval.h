@@ -0,0 +1,174 @@
+/*********************                                                        */
+/*! \file fmc_batch_eval.h
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2018 by the authors listed in the file AUTHORS
+ ** in the top-level source directory) and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief Batched evaluation of quantified formulas for full model checking
+ **/
+
+#include "cvc4_private.h"
+
+#ifndef __CVC4__THEORY__QUANTIFIERS__FMC_BATCH_EVAL_H
+#define __CVC4__THEORY__QUANTIFIERS__FMC_BATCH_EVAL_H
+
+#include <stdint.h>
+#include <functional>
+#include <map>
+#include <vector>
+
+#include "expr/node.h"
+
+namespace CVC4 {
+namespace theory {
+namespace quantifiers {
+namespace fmcheck {
+
+class Def;
+class FirstOrderModelFmc;
+
+/** Batched evaluator for the full model checker
+ *
+ * This class checks whether the body of a quantified formula is true in the
+ * current model for all tuples of domain elements, without constructing the
+ * term definitions of its subterms as FullModelChecker::doCheck does.
+ *
+ * Each domain element of an uninterpreted sort is coded by its index in the
+ * representative set, and Booleans by 0 and 1. The interpretation of each
+ * function symbol is a table of the codes of its values, indexed by the codes
+ * of its arguments, computed from its (simplified) definition in the model.
+ * The body is compiled into a program in post-order whose instructions
+ * evaluate a subterm on a block of tuples at once. The tuples are enumerated
+ * block by block, and the check stops at the first block containing a tuple
+ * that falsifies the body that is accepted by the caller.
+ *
+ * This class only handles quantified formulas over uninterpreted sorts and
+ * Booleans, whose bodies are built from uninterpreted functions, equality and
+ * Boolean connectives, and whose number of tuples is at most s_maxTuples.
+ */
+class FmcBatchEvaluator
+{
+ public:
+  FmcBatchEvaluator();
+  ~FmcBatchEvaluator() {}
+  /** the results of check */
+  enum Result
+  {
+    /** the quantified formula is not handled by this class */
+    BATCH_UNHANDLED,
+    /** the body is true for all tuples */
+    BATCH_TRUE,
+    /** a falsifying tuple was accepted */
+    BATCH_FALSE,
+    /** the body was false for some tuples, none of which were accepted */
+    BATCH_REJECTED,
+  };
+  /** reset
+   *
+   * Called when a new model is built, where repIds are the codes of the
+   * representatives of each uninterpreted sort, and models the definitions of
+   * the function symbols.
+   */
+  void reset(FirstOrderModelFmc* fm,
+             const std::map<TypeNode, std::map<Node, int> >& repIds,
+             const std::map<Node, Def*>& models);
+  /** check
+   *
+   * Checks whether the body of q is true in the current model. For each tuple
+   * of representatives that falsifies it, until one of them is accepted, it
+   * calls accept, which returns true if the tuple is accepted.
+   */
+  Result check(Node q, std::function<bool(std::vector<Node>&)> accept);
+
+ private:
+  /** the maximum number of tuples of a quantified formula */
+  static const uint64_t s_maxTuples = 1 << 24;
+  /** the number of tuples in a block */
+  static const unsigned s_blockSize = 256;
+  /** the maximum number of entries of the table of a function symbol */
+  static const uint64_t s_maxTableSize = 1 << 22;
+  /** the kinds of instructions */
+  enum Opcode
+  {
+    OP_VAR,
+    OP_CONST,
+    OP_APPLY,
+    OP_EQUAL,
+    OP_NOT,
+    OP_AND,
+    OP_OR,
+    OP_IMPLIES,
+    OP_XOR,
+    OP_ITE,
+  };
+  /** An instruction */
+  struct Instr
+  {
+    Opcode d_op;
+    /** the variable, constant, or function symbol */
+    unsigned d_arg;
+    /** the instructions of the children */
+    std::vector<unsigned> d_children;
+  };
+  /** A compiled quantified formula */
+  struct Program
+  {
+    Program() : d_valid(false) {}
+    bool d_valid;
+    /** the instructions, the last one is the body */
+    std::vector<Instr> d_instrs;
+    /** the function symbols of OP_APPLY instructions */
+    std::vector<Node> d_ops;
+    /** the ground terms of OP_CONST instructions */
+    std::vector<Node> d_consts;
+  };
+  /** The interpretation of a function symbol */
+  struct Table
+  {
+    Table() : d_valid(false) {}
+    bool d_valid;
+    /** the codes of the values, indexed by the codes of the arguments */
+    std::vector<uint16_t> d_values;
+    /** the stride of each argument in d_values */
+    std::vector<uint64_t> d_strides;
+  };
+  /** compile q into p, returns false if q is not handled */
+  bool compile(Node q, Program& p);
+  /** compile n into p, returns the index of its instruction, or -1 */
+  int compileTerm(Node n,
+                  std::map<Node, unsigned>& vars,
+                  Program& p,
+                  std::map<Node, int>& visited);
+  /** get the table of op, computing it if necessary */
+  Table& getTable(Node op);
+  /** get the number of domain elements of tn, or 0 if it is not handled */
+  unsigned getDomainSize(TypeNode tn);
+  /** get the code of the value v of type tn, returns false if there is none */
+  bool getCode(TypeNode tn, Node v, uint16_t& code);
+  /** get the value whose code is code, of type tn */
+  Node getValue(TypeNode tn, uint16_t code);
+  /** the model */
+  FirstOrderModelFmc* d_fm;
+  /** the codes of the representatives of the uninterpreted sorts */
+  const std::map<TypeNode, std::map<Node, int> >* d_repIds;
+  /** the definitions of the function symbols */
+  const std::map<Node, Def*>* d_models;
+  /** the representatives of each uninterpreted sort, indexed by code */
+  std::map<TypeNode, std::vector<Node> > d_reps;
+  /** the compiled quantified formulas */
+  std::map<Node, Program> d_programs;
+  /** the tables of the function symbols in the current model */
+  std::map<Node, Table> d_tables;
+  /** the values of the instructions on the current block */
+  std::vector<std::vector<uint16_t> > d_block;
+};
+
+}/* CVC4::theory::quantifiers::fmcheck namespace */
+}/* CVC4::theory::quantifiers namespace */
+}/* CVC4::theory namespace */
+}/* CVC4 namespace */
+
+#endif /* __CVC4__THEORY__QUANTIFIERS__FMC_BATCH_EVAL_H */
@@ -504,7 +504,8 @@ bool FullModelChecker::processBuildModel(TheoryModel* m){
     */
   }
   Assert( d_addedLemmas==0 );
-  
+  d_batch.reset(fm, d_rep_ids, fm->d_models);
+
   //make function values
   for( std::map<Node, Def * >::iterator it = fm->d_models.begin(); it != fm->d_models.end(); ++it ){
     Node f_def = getFunctionValue( fm, it->first, "$x" );
@@ -600,6 +601,33 @@ int FullModelChecker::doExhaustiveInstantiation( FirstOrderModel * fm, Node f, i
         d_quant_models[f].addEntry( fmfmc, c, d_false );
         return exhaustiveInstantiate( fmfmc, f, c, -1);
       }else{
+        if (options::fmcBatch())
+        {
+          // evaluate the body on all tuples of the domain, and add the first
+          // falsifying tuple that is not a duplicate
+          FmcBatchEvaluator::Result res =
+              d_batch.check(f, [&](std::vector<Node>& inst) {
+                d_triedLemmas++;
+                if (d_qe->getInstantiate()->addInstantiation(f, inst, true))
+                {
+                  d_addedLemmas++;
+                  return true;
+                }
+                return false;
+              });
+          Trace("fmc") << "Batched evaluation of " << f << " : " << res
+                       << std::endl;
+          if (res == FmcBatchEvaluator::BATCH_TRUE)
+          {
+            Node c = mkCondDefault(fmfmc, f);
+            d_quant_models[f].addEntry(fmfmc, c, d_true);
+            return 1;
+          }
+          else if (res == FmcBatchEvaluator::BATCH_FALSE)
+          {
+            return 1;
+          }
+        }
         //model check the quantifier
         doCheck(fmfmc, f, d_quant_models[f], f[1]);
         Trace("fmc") << "Definition for quantifier " << f << " is : " << std::endl;
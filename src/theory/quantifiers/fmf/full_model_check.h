@@ -17,6 +17,7 @@
 #ifndef __CVC4__THEORY__QUANTIFIERS__FULL_MODEL_CHECK_H
 #define __CVC4__THEORY__QUANTIFIERS__FULL_MODEL_CHECK_H
 
+#include "theory/quantifiers/fmf/fmc_batch_eval.h"
 #include "theory/quantifiers/fmf/model_builder.h"
 #include "theory/quantifiers/first_order_model.h"
 
@@ -90,6 +91,8 @@ protected:
   std::map< TypeNode, Node > d_array_cond;
   std::map< Node, Node > d_array_term_cond;
   std::map< Node, std::vector< int > > d_star_insts;
+  /** the batched evaluator, used if the option --fmc-batch is enabled */
+  FmcBatchEvaluator d_batch;
   //--------------------for preinitialization
   /** preInitializeType
    *
@@ -0,0 +1,303 @@
+/*********************                                                        */
+/*! \file inst_scheduler.cpp
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2018 by the authors listed in the file AUTHORS
+ ** in the top-level source directory) and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief Implementation of cost-based scheduling of instantiation lemmas
+ **/
+
+#include "theory/quantifiers/inst_scheduler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <unordered_set>
+
+#include "options/quantifiers_options.h"
+#include "smt/smt_statistics_registry.h"
+#include "theory/quantifiers/first_order_model.h"
+#include "theory/quantifiers/quantifiers_attributes.h"
+#include "theory/quantifiers/term_database.h"
+#include "theory/quantifiers/term_util.h"
+#include "theory/quantifiers_engine.h"
+
+using namespace CVC4::kind;
+
+namespace CVC4 {
+namespace theory {
+namespace quantifiers {
+
+namespace {
+
+/** get the number of distinct subterms of n */
+size_t getTermSize(TNode n)
+{
+  std::unordered_set<TNode, TNodeHashFunction> visited;
+  std::vector<TNode> visit;
+  visit.push_back(n);
+  while (!visit.empty())
+  {
+    TNode cur = visit.back();
+    visit.pop_back();
+    if (visited.insert(cur).second)
+    {
+      visit.insert(visit.end(), cur.begin(), cur.end());
+    }
+  }
+  return visited.size();
+}
+
+}  // namespace
+
+InstScheduler::InstScheduler(QuantifiersEngine* qe, context::UserContext* u)
+    : d_qe(qe), d_userContext(u), d_order(0), d_userPopNotify(u, *this)
+{
+}
+
+bool InstScheduler::notifyInstantiation(QuantifiersModule::QEffort quant_e,
+                                        Node q,
+                                        Node lem,
+                                        std::vector<Node>& terms,
+                                        Node body)
+{
+  Candidate c;
+  c.d_cost = getCost(q, terms);
+  c.d_order = d_order++;
+  c.d_quant = q;
+  c.d_lem = lem;
+  c.d_userLevel = d_userContext->getLevel();
+  Trace("inst-schedule-debug") << "Cost of " << lem << " is " << c.d_cost
+                               << std::endl;
+  d_pending.push_back(c);
+  return true;
+}
+
+double InstScheduler::getCost(Node q, const std::vector<Node>& terms)
+{
+  uint64_t depth = 0;
+  size_t size = 0;
+  for (const Node& t : terms)
+  {
+    uint64_t tdepth = TermUtil::getTermDepth(t);
+    if (t.hasAttribute(InstLevelAttribute()))
+    {
+      tdepth = std::max(tdepth, t.getAttribute(InstLevelAttribute()));
+    }
+    depth = std::max(depth, tdepth);
+    size += getTermSize(t);
+  }
+  double cost = depth;
+  if (!terms.empty())
+  {
+    cost += double(size) / terms.size();
+  }
+  std::map<Node, unsigned>::const_iterator iti = d_insts.find(q);
+  if (iti != d_insts.end())
+  {
+    cost += std::log2(double(iti->second + 1) / (d_useful[q] + 1));
+  }
+  return cost;
+}
+
+void InstScheduler::markSent(const Candidate& c)
+{
+  d_insts[c.d_quant]++;
+  d_statistics.d_sentPerQuant << getStatName(c.d_quant);
+  d_sent.push_back(c);
+}
+
+const std::string& InstScheduler::getStatName(Node q)
+{
+  std::map<Node, std::string>::iterator it = d_statNames.find(q);
+  if (it == d_statNames.end())
+  {
+    std::stringstream ss;
+    ss << q;
+    it = d_statNames.insert(std::pair<Node, std::string>(q, ss.str())).first;
+  }
+  return it->second;
+}
+
+unsigned InstScheduler::sendDelayed(
+    std::unordered_set<Node, NodeHashFunction>& pending)
+{
+  FirstOrderModel* fm = d_qe->getModel();
+  unsigned budget = std::max(options::instScheduleBudget(), 1u);
+  unsigned nsent = 0;
+  unsigned nreleased = 0;
+  // the lemmas whose quantified formula is not asserted, which are requeued
+  std::vector<Candidate> inactive;
+  while (nsent < budget && !d_delayed.empty())
+  {
+    std::pop_heap(d_delayed.begin(), d_delayed.end());
+    Candidate c = d_delayed.back();
+    d_delayed.pop_back();
+    if (pending.erase(c.d_lem) > 0)
+    {
+      // it is already a lemma of the quantifiers engine
+      markSent(c);
+      nsent++;
+    }
+    else if (!fm->isQuantifierAsserted(c.d_quant))
+    {
+      // The quantified formula is not asserted in this SAT context. We keep
+      // the lemma, since its instance is recorded and will not be produced
+      // again when the quantified formula is asserted again.
+      inactive.push_back(c);
+    }
+    else if (d_qe->addLemma(c.d_lem, true, false))
+    {
+      ++(d_statistics.d_released);
+      markSent(c);
+      nsent++;
+      nreleased++;
+    }
+  }
+  for (const Candidate& c : inactive)
+  {
+    d_delayed.push_back(c);
+    std::push_heap(d_delayed.begin(), d_delayed.end());
+  }
+  return nreleased;
+}
+
+void InstScheduler::filterInstantiations()
+{
+  if (d_pending.empty())
+  {
+    return;
+  }
+  // the pending lemmas compete with the delayed ones
+  std::unordered_set<Node, NodeHashFunction> pending;
+  for (const Candidate& c : d_pending)
+  {
+    pending.insert(c.d_lem);
+    d_delayed.push_back(c);
+    std::push_heap(d_delayed.begin(), d_delayed.end());
+  }
+  d_pending.clear();
+  sendDelayed(pending);
+  if (!pending.empty())
+  {
+    Trace("inst-schedule") << "Delay " << pending.size()
+                           << " instantiation lemmas" << std::endl;
+    d_statistics.d_delayed += pending.size();
+    d_qe->removeLemmas(pending);
+  }
+}
+
+bool InstScheduler::releaseDelayedLemmas()
+{
+  std::unordered_set<Node, NodeHashFunction> pending;
+  unsigned nsent = sendDelayed(pending);
+  Trace("inst-schedule") << "Released " << nsent << " delayed lemmas, "
+                         << d_delayed.size() << " remain" << std::endl;
+  return nsent > 0;
+}
+
+bool InstScheduler::hasDelayedLemmas() const
+{
+  FirstOrderModel* fm = d_qe->getModel();
+  for (const Candidate& c : d_delayed)
+  {
+    if (fm->isQuantifierAsserted(c.d_quant))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+void InstScheduler::notifyUserPop()
+{
+  // Instantiate records instances in user-context-dependent tries when
+  // incremental solving is enabled, which is required for user pops. Hence
+  // the instances of the lemmas that are dropped here were unrecorded by the
+  // pop, and may be produced again.
+  int level = d_userContext->getLevel();
+  std::vector<Candidate>::iterator it =
+      std::remove_if(d_delayed.begin(),
+                     d_delayed.end(),
+                     [level](const Candidate& c) {
+                       return c.d_userLevel > level;
+                     });
+  d_statistics.d_dropped += std::distance(it, d_delayed.end());
+  d_delayed.erase(it, d_delayed.end());
+  std::make_heap(d_delayed.begin(), d_delayed.end());
+  d_pending.clear();
+  d_sent.clear();
+}
+
+void InstScheduler::reset()
+{
+  TermDb* tdb = d_qe->getTermDatabase();
+  for (const Candidate& c : d_sent)
+  {
+    Node nq = c.d_quant.negate();
+    unsigned nlits = 0;
+    unsigned nfalse = 0;
+    if (c.d_lem.getKind() == OR)
+    {
+      for (const Node& lc : c.d_lem)
+      {
+        if (lc != nq)
+        {
+          nlits++;
+          nfalse += tdb->isEntailed(lc, false) ? 1 : 0;
+        }
+      }
+    }
+    if (nlits > 0 && nfalse + 1 >= nlits)
+    {
+      d_useful[c.d_quant]++;
+      ++(d_statistics.d_useful);
+      d_statistics.d_usefulPerQuant << getStatName(c.d_quant);
+    }
+  }
+  d_sent.clear();
+}
+
+void InstScheduler::debugPrint(const char* c) const
+{
+  for (const std::pair<const Node, unsigned>& i : d_insts)
+  {
+    std::map<Node, unsigned>::const_iterator it = d_useful.find(i.first);
+    unsigned useful = it == d_useful.end() ? 0 : it->second;
+    Trace(c) << " * " << useful << " / " << i.second << " useful for "
+             << i.first << std::endl;
+  }
+}
+
+InstScheduler::Statistics::Statistics()
+    : d_delayed("InstScheduler::Delayed", 0),
+      d_released("InstScheduler::Released", 0),
+      d_dropped("InstScheduler::Dropped", 0),
+      d_useful("InstScheduler::Useful", 0),
+      d_sentPerQuant("InstScheduler::Sent_Per_Quant"),
+      d_usefulPerQuant("InstScheduler::Useful_Per_Quant")
+{
+  smtStatisticsRegistry()->registerStat(&d_delayed);
+  smtStatisticsRegistry()->registerStat(&d_released);
+  smtStatisticsRegistry()->registerStat(&d_dropped);
+  smtStatisticsRegistry()->registerStat(&d_useful);
+  smtStatisticsRegistry()->registerStat(&d_sentPerQuant);
+  smtStatisticsRegistry()->registerStat(&d_usefulPerQuant);
+}
+
+InstScheduler::Statistics::~Statistics()
+{
+  smtStatisticsRegistry()->unregisterStat(&d_delayed);
+  smtStatisticsRegistry()->unregisterStat(&d_released);
+  smtStatisticsRegistry()->unregisterStat(&d_dropped);
+  smtStatisticsRegistry()->unregisterStat(&d_useful);
+  smtStatisticsRegistry()->unregisterStat(&d_sentPerQuant);
+  smtStatisticsRegistry()->unregisterStat(&d_usefulPerQuant);
+}
+
+} /* CVC4::theory::quantifiers namespace */
+} /* CVC4::theory namespace */
+} /* CVC4 namespace */
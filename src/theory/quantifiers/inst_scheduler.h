@@ -0,0 +1,182 @@
+/*********************                                                        */
+/*! \file inst_scheduler.h
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2018 by the authors listed in the file AUTHORS
+ ** in the top-level source directory) and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief Cost-based scheduling of instantiation lemmas
+ **/
+
+#include "cvc4_private.h"
+
+#ifndef __CVC4__THEORY__QUANTIFIERS__INST_SCHEDULER_H
+#define __CVC4__THEORY__QUANTIFIERS__INST_SCHEDULER_H
+
+#include <map>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "context/context.h"
+#include "expr/node.h"
+#include "theory/quantifiers/instantiate.h"
+#include "util/statistics_registry.h"
+
+namespace CVC4 {
+namespace theory {
+namespace quantifiers {
+
+/** Instantiation scheduler
+ *
+ * This class is notified of the instantiation lemmas added by Instantiate
+ * (other than those added at conflict effort), and limits the number of them
+ * that are sent on the output channel when the quantifiers engine flushes its
+ * lemmas to options::instScheduleBudget(). The others are kept in a queue of
+ * delayed lemmas, which compete with the new lemmas of later rounds, and are
+ * released when a round adds no lemmas.
+ *
+ * The lemmas are chosen by increasing cost, where the cost of an
+ * instantiation of q by terms is the sum of:
+ * - the maximal depth of terms, or their instantiation level if it is larger,
+ * - the average size of terms,
+ * - the logarithm of the ratio of the number of instances of q that were sent
+ * to those that were useful.
+ * An instance is useful if, in the round after it was sent, all of its
+ * literals but at most one are entailed to be false, that is, if it
+ * propagated a literal or was conflicting. Thus, quantified formulas whose
+ * instances are rarely useful, e.g. those in matching loops, are delayed in
+ * favor of the others.
+ *
+ * A delayed lemma stays queued while its quantified formula is not asserted
+ * in the current SAT context, since the instance is recorded by Instantiate
+ * and would not be produced again. Delayed lemmas are only dropped when the
+ * user context level at which they were added is popped, which also removes
+ * the instance from the (user-context-dependent) instantiation tries.
+ */
+class InstScheduler : public InstantiationNotify
+{
+ public:
+  InstScheduler(QuantifiersEngine* qe, context::UserContext* u);
+  ~InstScheduler() {}
+  /** notify instantiation, records the cost of lem */
+  bool notifyInstantiation(QuantifiersModule::QEffort quant_e,
+                           Node q,
+                           Node lem,
+                           std::vector<Node>& terms,
+                           Node body) override;
+  /** delays the instantiation lemmas that are not within the budget */
+  void filterInstantiations() override;
+  /** reset, computes the instances sent in the last round that were useful */
+  void reset();
+  /** are there delayed lemmas for quantified formulas that are asserted? */
+  bool hasDelayedLemmas() const;
+  /** release delayed lemmas
+   *
+   * Adds the delayed lemmas of least cost, up to the budget, to the lemmas of
+   * the quantifiers engine. Returns true if a lemma was added.
+   */
+  bool releaseDelayedLemmas();
+  /** print the counts of each quantified formula on trace c */
+  void debugPrint(const char* c) const;
+
+ private:
+  /** An instantiation lemma */
+  struct Candidate
+  {
+    /** its cost */
+    double d_cost;
+    /** the order in which it was added, to break ties */
+    uint64_t d_order;
+    /** the quantified formula */
+    Node d_quant;
+    /** the lemma */
+    Node d_lem;
+    /** the user context level at which it was added */
+    int d_userLevel;
+    /** compare by cost, for a min-heap */
+    bool operator<(const Candidate& c) const
+    {
+      return d_cost > c.d_cost || (d_cost == c.d_cost && d_order > c.d_order);
+    }
+  };
+  /** get the cost of the instantiation of q by terms */
+  double getCost(Node q, const std::vector<Node>& terms);
+  /** record that the lemma of c was sent */
+  void markSent(const Candidate& c);
+  /** get the name of q in the per quantifier statistics */
+  const std::string& getStatName(Node q);
+  /**
+   * Send the delayed lemmas of least cost whose quantified formula is
+   * asserted, up to the budget. The lemmas in pending are already lemmas of
+   * the quantifiers engine, and are erased from pending when they are chosen.
+   * Returns the number of delayed lemmas that were added to the quantifiers
+   * engine.
+   */
+  unsigned sendDelayed(std::unordered_set<Node, NodeHashFunction>& pending);
+  /** drop the lemmas that were added at a user context level that is popped */
+  void notifyUserPop();
+  /** Helper class to drop the delayed lemmas on user pop */
+  class UserPopNotify : public context::ContextNotifyObj
+  {
+   public:
+    UserPopNotify(context::Context* c, InstScheduler& s)
+        : context::ContextNotifyObj(c), d_scheduler(s)
+    {
+    }
+
+   protected:
+    void contextNotifyPop() override { d_scheduler.notifyUserPop(); }
+
+   private:
+    InstScheduler& d_scheduler;
+  };
+  /** pointer to the quantifiers engine */
+  QuantifiersEngine* d_qe;
+  /** the user context */
+  context::UserContext* d_userContext;
+  /** the lemmas that were notified since the last flush */
+  std::vector<Candidate> d_pending;
+  /** the heap of delayed lemmas */
+  std::vector<Candidate> d_delayed;
+  /** the lemmas that were sent since the last reset */
+  std::vector<Candidate> d_sent;
+  /** the number of instances of each quantified formula that were sent */
+  std::map<Node, unsigned> d_insts;
+  /** the number of those that were useful */
+  std::map<Node, unsigned> d_useful;
+  /** the names of the quantified formulas in the statistics */
+  std::map<Node, std::string> d_statNames;
+  /** the number of lemmas that were notified */
+  uint64_t d_order;
+  /** notifies this class of user pops */
+  UserPopNotify d_userPopNotify;
+  /** statistics class */
+  class Statistics
+  {
+   public:
+    /** the number of lemmas that were delayed */
+    IntStat d_delayed;
+    /** the number of delayed lemmas that were later sent */
+    IntStat d_released;
+    /** the number of delayed lemmas that were dropped on a user pop */
+    IntStat d_dropped;
+    /** the number of sent lemmas that were useful */
+    IntStat d_useful;
+    /** the number of sent lemmas of each quantified formula */
+    HistogramStat<std::string> d_sentPerQuant;
+    /** the number of those that were useful */
+    HistogramStat<std::string> d_usefulPerQuant;
+    Statistics();
+    ~Statistics();
+  };
+  Statistics d_statistics;
+};
+
+} /* CVC4::theory::quantifiers namespace */
+} /* CVC4::theory namespace */
+} /* CVC4 namespace */
+
+#endif /* __CVC4__THEORY__QUANTIFIERS__INST_SCHEDULER_H */
@@ -14,7 +14,10 @@
 
 #include "theory/quantifiers/inst_strategy_enumerative.h"
 
+#include <algorithm>
+
 #include "options/quantifiers_options.h"
+#include "theory/quantifiers/inst_tuple_store.h"
 #include "theory/quantifiers/instantiate.h"
 #include "theory/quantifiers/relevant_domain.h"
 #include "theory/quantifiers/term_database.h"
@@ -31,6 +34,8 @@ using namespace inst;
 
 namespace quantifiers {
 
+const uint32_t InstStrategyEnum::s_noId;
+
 InstStrategyEnum::InstStrategyEnum(QuantifiersEngine* qe)
     : QuantifiersModule(qe)
 {
@@ -80,6 +85,7 @@ void InstStrategyEnum::check(Theory::Effort e, QEffort quant_e)
                          << std::endl;
     }
     int addedLemmas = 0;
+    std::vector<Node> qs;
     for (unsigned i = 0;
          i < d_quantEngine->getModel()->getNumAssertedQuantifiers();
          i++)
@@ -87,6 +93,18 @@ void InstStrategyEnum::check(Theory::Effort e, QEffort quant_e)
       Node q = d_quantEngine->getModel()->getAssertedQuantifier(i, true);
       if (d_quantEngine->hasOwnership(q, this)
           && d_quantEngine->getModel()->isQuantifierActive(q))
+      {
+        qs.push_back(q);
+      }
+    }
+    if (options::fullSaturateThreads() > 1
+        && d_quantEngine->getInstantiate()->getTupleStore() != nullptr)
+    {
+      addedLemmas = processParallel(qs, fullEffort);
+    }
+    else
+    {
+      for (const Node& q : qs)
       {
         if (process(q, fullEffort))
         {
@@ -125,174 +143,328 @@ bool InstStrategyEnum::process(Node f, bool fullEffort)
   {
     if (rd || r > 0)
     {
-      if (r == 0)
-      {
-        Trace("inst-alg") << "-> Relevant domain instantiate " << f << "..."
-                          << std::endl;
-        Trace("inst-alg-debug") << "Compute relevant domain..." << std::endl;
-        rd->compute();
-        Trace("inst-alg-debug") << "...finished" << std::endl;
-      }
-      else
+      std::vector<std::vector<Node> > domains;
+      std::vector<bool> max_zero;
+      if (!computeDomains(f, r, fullEffort, domains, max_zero))
       {
-        Trace("inst-alg") << "-> Ground term instantiate " << f << "..."
-                          << std::endl;
+        continue;
       }
       unsigned final_max_i = 0;
       std::vector<unsigned> maxs;
-      std::vector<bool> max_zero;
-      bool has_zero = false;
-      std::map<TypeNode, std::vector<Node> > term_db_list;
-      std::vector<TypeNode> ftypes;
-      // iterate over substitutions for variables
       for (unsigned i = 0; i < f[0].getNumChildren(); i++)
       {
-        TypeNode tn = f[0][i].getType();
-        ftypes.push_back(tn);
-        unsigned ts;
-        if (r == 0)
+        maxs.push_back(max_zero[i] ? 1 : domains[i].size());
+        final_max_i = std::max(final_max_i, maxs[i]);
+      }
+      Trace("inst-alg-rd") << "Will do " << final_max_i
+                           << " stages of instantiation." << std::endl;
+      unsigned max_i = 0;
+      while (max_i <= final_max_i)
+      {
+        Trace("inst-alg-rd") << "Try stage " << max_i << "..." << std::endl;
+        std::vector<unsigned> childIndex;
+        int index = 0;
+        while (getNextTuple(childIndex, index, maxs, max_i))
         {
-          ts = rd->getRDomain(f, i)->d_terms.size();
+          Trace("inst-alg-rd") << "Try instantiation { ";
+          for (unsigned j = 0; j < childIndex.size(); j++)
+          {
+            Trace("inst-alg-rd") << childIndex[j] << " ";
+          }
+          Trace("inst-alg-rd") << "}" << std::endl;
+          // try instantiation
+          std::vector<Node> terms;
+          getTuple(domains, max_zero, childIndex, terms);
+          if (d_quantEngine->getInstantiate()->addInstantiation(f, terms))
+          {
+            Trace("inst-alg-rd") << "Success!" << std::endl;
+            ++(d_quantEngine->d_statistics.d_instantiations_guess);
+            return true;
+          }
+          index--;
         }
-        else
+        max_i++;
+      }
+    }
+  }
+  // TODO : term enumerator instantiation?
+  return false;
+}
+
+bool InstStrategyEnum::computeDomains(Node f,
+                                      unsigned r,
+                                      bool fullEffort,
+                                      std::vector<std::vector<Node> >& domains,
+                                      std::vector<bool>& max_zero)
+{
+  RelevantDomain* rd = d_quantEngine->getRelevantDomain();
+  if (r == 0)
+  {
+    Trace("inst-alg") << "-> Relevant domain instantiate " << f << "..."
+                      << std::endl;
+    Trace("inst-alg-debug") << "Compute relevant domain..." << std::endl;
+    rd->compute();
+    Trace("inst-alg-debug") << "...finished" << std::endl;
+  }
+  else
+  {
+    Trace("inst-alg") << "-> Ground term instantiate " << f << "..."
+                      << std::endl;
+  }
+  TermDb* tdb = d_quantEngine->getTermDatabase();
+  std::map<TypeNode, std::vector<Node> > term_db_list;
+  // iterate over substitutions for variables
+  for (unsigned i = 0; i < f[0].getNumChildren(); i++)
+  {
+    TypeNode tn = f[0][i].getType();
+    if (r == 0)
+    {
+      domains.push_back(rd->getRDomain(f, i)->d_terms);
+    }
+    else
+    {
+      std::map<TypeNode, std::vector<Node> >::iterator ittd =
+          term_db_list.find(tn);
+      if (ittd == term_db_list.end())
+      {
+        std::map<Node, Node> reps_found;
+        for (unsigned j = 0, ts = tdb->getNumTypeGroundTerms(tn); j < ts; j++)
         {
-          ts = d_quantEngine->getTermDatabase()->getNumTypeGroundTerms(tn);
-          std::map<TypeNode, std::vector<Node> >::iterator ittd =
-              term_db_list.find(tn);
-          if (ittd == term_db_list.end())
+          Node gt = tdb->getTypeGroundTerm(tn, j);
+          if (!options::cbqi() || !quantifiers::TermUtil::hasInstConstAttr(gt))
           {
-            std::map<Node, Node> reps_found;
-            for (unsigned j = 0; j < ts; j++)
+            Node rep = d_quantEngine->getEqualityQuery()->getRepresentative(gt);
+            if (reps_found.find(rep) == reps_found.end())
             {
-              Node gt = d_quantEngine->getTermDatabase()->getTypeGroundTerm(
-                  ftypes[i], j);
-              if (!options::cbqi()
-                  || !quantifiers::TermUtil::hasInstConstAttr(gt))
-              {
-                Node rep =
-                    d_quantEngine->getEqualityQuery()->getRepresentative(gt);
-                if (reps_found.find(rep) == reps_found.end())
-                {
-                  reps_found[rep] = gt;
-                  term_db_list[tn].push_back(gt);
-                }
-              }
+              reps_found[rep] = gt;
+              term_db_list[tn].push_back(gt);
             }
-            ts = term_db_list[tn].size();
-          }
-          else
-          {
-            ts = ittd->second.size();
           }
         }
-        // consider a default value if at full effort
-        max_zero.push_back(fullEffort && ts == 0);
-        ts = (fullEffort && ts == 0) ? 1 : ts;
-        Trace("inst-alg-rd") << "Variable " << i << " has " << ts
-                             << " in relevant domain." << std::endl;
-        if (ts == 0)
+      }
+      domains.push_back(term_db_list[tn]);
+    }
+    unsigned ts = domains[i].size();
+    // consider a default value if at full effort
+    max_zero.push_back(fullEffort && ts == 0);
+    ts = (fullEffort && ts == 0) ? 1 : ts;
+    Trace("inst-alg-rd") << "Variable " << i << " has " << ts
+                         << " in relevant domain." << std::endl;
+    if (ts == 0)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool InstStrategyEnum::getNextTuple(std::vector<unsigned>& childIndex,
+                                    int& index,
+                                    const std::vector<unsigned>& maxs,
+                                    unsigned max_i)
+{
+  while (index >= 0 && index < (int)maxs.size())
+  {
+    if (index == (int)childIndex.size())
+    {
+      childIndex.push_back(-1);
+    }
+    else
+    {
+      Assert(index == (int)(childIndex.size()) - 1);
+      unsigned nv = childIndex[index] + 1;
+      if (nv < maxs[index] && nv <= max_i)
+      {
+        childIndex[index] = nv;
+        index++;
+      }
+      else
+      {
+        childIndex.pop_back();
+        index--;
+      }
+    }
+  }
+  return index >= 0;
+}
+
+void InstStrategyEnum::getTuple(const std::vector<std::vector<Node> >& domains,
+                                const std::vector<bool>& max_zero,
+                                const std::vector<unsigned>& childIndex,
+                                std::vector<Node>& terms)
+{
+  for (unsigned i = 0, size = childIndex.size(); i < size; i++)
+  {
+    if (max_zero[i])
+    {
+      // no terms available, will report incomplete instantiation
+      terms.push_back(Node::null());
+      Trace("inst-alg-rd") << "  null" << std::endl;
+    }
+    else
+    {
+      Assert(childIndex[i] < domains[i].size());
+      terms.push_back(domains[i][childIndex[i]]);
+      Trace("inst-alg-rd") << "  " << domains[i][childIndex[i]] << std::endl;
+    }
+  }
+}
+
+int InstStrategyEnum::processParallel(const std::vector<Node>& qs,
+                                      bool fullEffort)
+{
+  InstTupleStore* store = d_quantEngine->getInstantiate()->getTupleStore();
+  Assert(store != nullptr);
+  RelevantDomain* rd = d_quantEngine->getRelevantDomain();
+  unsigned rstart = options::fullSaturateQuantRd() ? 0 : 1;
+  unsigned rend = fullEffort ? 1 : rstart;
+  // Take a snapshot of the domains, which the threads only read. The threads
+  // identify the terms by their identifiers in the tuple store, so that they
+  // do not need to access the nodes.
+  std::vector<CandidateJob> jobs;
+  for (const Node& q : qs)
+  {
+    if (q[1].isConst() && q[1].getConst<bool>())
+    {
+      continue;
+    }
+    for (unsigned r = rstart; r <= rend; r++)
+    {
+      if (!rd && r == 0)
+      {
+        continue;
+      }
+      CandidateJob job;
+      if (!computeDomains(q, r, fullEffort, job.d_domains, job.d_maxZero))
+      {
+        continue;
+      }
+      job.d_quant = q;
+      job.d_complete = false;
+      uint32_t qid;
+      bool hasQid = store->getTermId(q, qid);
+      job.d_key.push_back(q[0].getNumChildren());
+      job.d_key.push_back(hasQid ? qid : s_noId);
+      job.d_ids.resize(job.d_domains.size());
+      for (unsigned i = 0, nvars = job.d_domains.size(); i < nvars; i++)
+      {
+        for (const Node& t : job.d_domains[i])
         {
-          has_zero = true;
-          break;
+          uint32_t id;
+          job.d_ids[i].push_back(store->getTermId(t, id) ? id : s_noId);
         }
-        else
+      }
+      jobs.push_back(job);
+    }
+  }
+
+  // Generate the candidates of the jobs.
+  size_t numThreads = options::fullSaturateThreads();
+  if (numThreads > jobs.size())
+  {
+    numThreads = std::max<size_t>(jobs.size(), 1);
+  }
+  // the options are not available to the other threads
+  unsigned maxCandidates = options::fullSaturateThreadCandidates();
+  // The pool keeps its threads between rounds, and waits for all of them
+  // before it returns or rethrows.
+  d_workers.run(numThreads,
+                [&jobs, store, maxCandidates, numThreads](size_t t) {
+                  generateCandidates(jobs, store, maxCandidates, t, numThreads);
+                });
+
+  // Add the instantiations in the order of the serial path.
+  int addedLemmas = 0;
+  unsigned j = 0;
+  for (const Node& q : qs)
+  {
+    bool success = false;
+    bool complete = true;
+    for (; j < jobs.size() && jobs[j].d_quant == q; j++)
+    {
+      if (success || !complete)
+      {
+        // the jobs of the next stages are not used
+        continue;
+      }
+      CandidateJob& job = jobs[j];
+      for (unsigned c = 0, size = job.d_candidates.size(); c < size && !success;
+           c++)
+      {
+        std::vector<Node> terms;
+        getTuple(job.d_domains, job.d_maxZero, job.d_candidates[c], terms);
+        if (d_quantEngine->getInstantiate()->addInstantiation(q, terms))
         {
-          maxs.push_back(ts);
-          if (ts > final_max_i)
-          {
-            final_max_i = ts;
-          }
+          Trace("inst-alg-rd") << "Success!" << std::endl;
+          ++(d_quantEngine->d_statistics.d_instantiations_guess);
+          success = true;
         }
       }
-      if (!has_zero)
+      complete = job.d_complete;
+    }
+    if (!success && !complete)
+    {
+      Trace("fs-engine") << "...candidates of " << q
+                         << " are incomplete, process serially" << std::endl;
+      success = process(q, fullEffort);
+    }
+    if (success)
+    {
+      addedLemmas++;
+      if (d_quantEngine->inConflict())
       {
-        Trace("inst-alg-rd") << "Will do " << final_max_i
-                             << " stages of instantiation." << std::endl;
-        unsigned max_i = 0;
-        bool success;
-        while (max_i <= final_max_i)
+        break;
+      }
+    }
+  }
+  return addedLemmas;
+}
+
+void InstStrategyEnum::generateCandidates(std::vector<CandidateJob>& jobs,
+                                          const InstTupleStore* store,
+                                          unsigned maxCandidates,
+                                          size_t first,
+                                          size_t stride)
+{
+  for (size_t j = first, njobs = jobs.size(); j < njobs; j += stride)
+  {
+    CandidateJob& job = jobs[j];
+    std::vector<unsigned> maxs;
+    unsigned final_max_i = 0;
+    for (unsigned i = 0, nvars = job.d_domains.size(); i < nvars; i++)
+    {
+      maxs.push_back(job.d_maxZero[i] ? 1 : job.d_ids[i].size());
+      final_max_i = std::max(final_max_i, maxs[i]);
+    }
+    std::vector<uint32_t>& key = job.d_key;
+    key.resize(maxs.size() + 2);
+    job.d_complete = true;
+    for (unsigned max_i = 0; max_i <= final_max_i && job.d_complete; max_i++)
+    {
+      std::vector<unsigned> childIndex;
+      int index = 0;
+      while (getNextTuple(childIndex, index, maxs, max_i))
+      {
+        // tuples that were recorded already are duplicates
+        bool known = key[1] != s_noId;
+        for (unsigned i = 0, nvars = childIndex.size(); i < nvars; i++)
         {
-          Trace("inst-alg-rd") << "Try stage " << max_i << "..." << std::endl;
-          std::vector<unsigned> childIndex;
-          int index = 0;
-          do
+          key[i + 2] = job.d_maxZero[i] ? s_noId : job.d_ids[i][childIndex[i]];
+          known = known && key[i + 2] != s_noId;
+        }
+        if (!known || !store->existsKey(key))
+        {
+          if (job.d_candidates.size() == maxCandidates)
           {
-            while (index >= 0 && index < (int)f[0].getNumChildren())
-            {
-              if (index == (int)childIndex.size())
-              {
-                childIndex.push_back(-1);
-              }
-              else
-              {
-                Assert(index == (int)(childIndex.size()) - 1);
-                unsigned nv = childIndex[index] + 1;
-                if (nv < maxs[index] && nv <= max_i)
-                {
-                  childIndex[index] = nv;
-                  index++;
-                }
-                else
-                {
-                  childIndex.pop_back();
-                  index--;
-                }
-              }
-            }
-            success = index >= 0;
-            if (success)
-            {
-              Trace("inst-alg-rd") << "Try instantiation { ";
-              for (unsigned j = 0; j < childIndex.size(); j++)
-              {
-                Trace("inst-alg-rd") << childIndex[j] << " ";
-              }
-              Trace("inst-alg-rd") << "}" << std::endl;
-              // try instantiation
-              std::vector<Node> terms;
-              for (unsigned i = 0; i < f[0].getNumChildren(); i++)
-              {
-                if (max_zero[i])
-                {
-                  // no terms available, will report incomplete instantiation
-                  terms.push_back(Node::null());
-                  Trace("inst-alg-rd") << "  null" << std::endl;
-                }
-                else if (r == 0)
-                {
-                  terms.push_back(rd->getRDomain(f, i)->d_terms[childIndex[i]]);
-                  Trace("inst-alg-rd")
-                      << "  " << rd->getRDomain(f, i)->d_terms[childIndex[i]]
-                      << std::endl;
-                }
-                else
-                {
-                  Assert(childIndex[i] < term_db_list[ftypes[i]].size());
-                  terms.push_back(term_db_list[ftypes[i]][childIndex[i]]);
-                  Trace("inst-alg-rd") << "  "
-                                       << term_db_list[ftypes[i]][childIndex[i]]
-                                       << std::endl;
-                }
-              }
-              if (d_quantEngine->getInstantiate()->addInstantiation(f, terms))
-              {
-                Trace("inst-alg-rd") << "Success!" << std::endl;
-                ++(d_quantEngine->d_statistics.d_instantiations_guess);
-                return true;
-              }
-              else
-              {
-                index--;
-              }
-            }
-          } while (success);
-          max_i++;
+            job.d_complete = false;
+            break;
+          }
+          job.d_candidates.push_back(childIndex);
         }
+        index--;
       }
     }
   }
-  // TODO : term enumerator instantiation?
-  return false;
 }
 
 } /* CVC4::theory::quantifiers namespace */
@@ -17,12 +17,21 @@
 #ifndef __CVC4__INST_STRATEGY_ENUMERATIVE_H
 #define __CVC4__INST_STRATEGY_ENUMERATIVE_H
 
+#include <stdint.h>
+#include <vector>
+
 #include "context/context.h"
 #include "context/context_mm.h"
 #include "theory/quantifiers_engine.h"
+#include "util/worker_pool.h"
 
 namespace CVC4 {
 namespace theory {
+
+namespace inst {
+class InstTupleStore;
+}
+
 namespace quantifiers {
 
 /** Enumerative instantiation
@@ -57,6 +66,9 @@ namespace quantifiers {
  * option interleaves it with other strategies
  * during quantifier effort level QEFFORT_STANDARD:
  *   --fs-interleave
+ *
+ * With the option --fs-threads=N, the candidate instances of the quantified
+ * formulas are generated by N threads (see processParallel).
  */
 class InstStrategyEnum : public QuantifiersModule
 {
@@ -94,6 +106,76 @@ class InstStrategyEnum : public QuantifiersModule
    * ground terms in the current context to instantiate with.
    */
   bool process(Node q, bool fullEffort);
+  /** compute domains
+   *
+   * Computes in domains the terms that the variables of q are instantiated
+   * with, which are the relevant domain of q if r is 0, and the ground terms
+   * of their type otherwise. The i^th variable has no term but a default one
+   * if max_zero[i] is true. Returns false if a variable has no term.
+   */
+  bool computeDomains(Node q,
+                      unsigned r,
+                      bool fullEffort,
+                      std::vector<std::vector<Node> >& domains,
+                      std::vector<bool>& max_zero);
+  /** get next tuple
+   *
+   * Updates childIndex to the next tuple of indices in the domains of sizes
+   * maxs whose indices are at most max_i, where index is the position to
+   * increment next. Returns false if there is no such tuple.
+   */
+  static bool getNextTuple(std::vector<unsigned>& childIndex,
+                           int& index,
+                           const std::vector<unsigned>& maxs,
+                           unsigned max_i);
+  /** get the terms of the tuple of indices childIndex in domains */
+  static void getTuple(const std::vector<std::vector<Node> >& domains,
+                       const std::vector<bool>& max_zero,
+                       const std::vector<unsigned>& childIndex,
+                       std::vector<Node>& terms);
+  /** the identifier of terms that are not in the tuple store */
+  static const uint32_t s_noId = UINT32_MAX;
+  /** The candidate instances of one stage of a quantified formula */
+  struct CandidateJob
+  {
+    /** the quantified formula */
+    Node d_quant;
+    /** its domains and default values, see computeDomains */
+    std::vector<std::vector<Node> > d_domains;
+    std::vector<bool> d_maxZero;
+    /** the identifiers of the terms of the domains in the tuple store */
+    std::vector<std::vector<uint32_t> > d_ids;
+    /** the key of tuples in the tuple store */
+    std::vector<uint32_t> d_key;
+    /** the tuples of indices that may not be duplicates */
+    std::vector<std::vector<unsigned> > d_candidates;
+    /** whether d_candidates are all of the tuples */
+    bool d_complete;
+  };
+  /** process in parallel
+   *
+   * This processes the quantified formulas qs as process does, but first
+   * generates their candidate instances in several threads. The threads only
+   * read a snapshot of the domains and the tuple store of Instantiate, and
+   * discard the tuples that are known duplicates. The candidates are then
+   * added in the order of the serial enumeration, so that the instantiations
+   * are the same as those of process. If a thread generated the maximum
+   * number of candidates for a quantified formula and none was added, it is
+   * processed again serially. Returns the number of instantiations added.
+   */
+  int processParallel(const std::vector<Node>& qs, bool fullEffort);
+  /** generate candidates
+   *
+   * Generates at most maxCandidates candidates for each of the jobs first,
+   * first + stride, ... of jobs.
+   */
+  static void generateCandidates(std::vector<CandidateJob>& jobs,
+                                 const inst::InstTupleStore* store,
+                                 unsigned maxCandidates,
+                                 size_t first,
+                                 size_t stride);
+  /** the threads of processParallel, kept between rounds */
+  WorkerPool d_workers;
 }; /* class InstStrategyEnum */
 
 } /* CVC4::theory::quantifiers namespace */
@@ -0,0 +1,490 @@
+/*********************                                                        */
+/*! \file inst_tuple_store.cpp
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2018 by the authors listed in the file AUTHORS
+ ** in the top-level source directory) and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief Compact store of instantiation tuples
+ **/
+
+#include "theory/quantifiers/inst_tuple_store.h"
+
+#include <algorithm>
+
+#include "theory/quantifiers_engine.h"
+#include "theory/uf/equality_engine.h"
+
+using namespace std;
+
+namespace CVC4 {
+namespace theory {
+namespace inst {
+
+const uint32_t InstTupleStore::s_empty;
+const uint32_t InstTupleStore::s_removed;
+const uint32_t InstTupleStore::s_dead;
+
+size_t InstTupleStore::TupleSet::find(const uint32_t* key,
+                                      size_t n,
+                                      uint32_t hash) const
+{
+  if (d_table.empty())
+  {
+    return d_table.size();
+  }
+  size_t mask = d_table.size() - 1;
+  for (size_t i = hash & mask; d_table[i] != s_empty; i = (i + 1) & mask)
+  {
+    if (d_table[i] != s_removed)
+    {
+      const uint32_t* rec = &d_arena[d_table[i] - 1];
+      if (rec[0] == key[0] && std::equal(key + 1, key + n, rec + 1))
+      {
+        return i;
+      }
+    }
+  }
+  return d_table.size();
+}
+
+uint32_t InstTupleStore::TupleSet::append(const uint32_t* key, size_t n)
+{
+  Assert(d_arena.size() + n < s_removed);
+  uint32_t offset = d_arena.size();
+  d_arena.insert(d_arena.end(), key, key + n);
+  return offset;
+}
+
+void InstTupleStore::TupleSet::insert(uint32_t offset)
+{
+  if (2 * (d_used + 1) > d_table.size())
+  {
+    // rehash, dropping the removed entries
+    std::vector<uint32_t> old;
+    old.swap(d_table);
+    size_t live = 0;
+    for (uint32_t e : old)
+    {
+      live += (e != s_empty && e != s_removed) ? 1 : 0;
+    }
+    size_t size = old.empty() ? 16 : old.size();
+    while (4 * (live + 1) > size)
+    {
+      size *= 2;
+    }
+    d_table.resize(size, s_empty);
+    d_used = 0;
+    for (uint32_t e : old)
+    {
+      if (e != s_empty && e != s_removed)
+      {
+        insert(e - 1);
+      }
+    }
+  }
+  const uint32_t* rec = &d_arena[offset];
+  size_t mask = d_table.size() - 1;
+  size_t i = hash(rec, (rec[0] & ~s_dead) + 2) & mask;
+  while (d_table[i] != s_empty && d_table[i] != s_removed)
+  {
+    i = (i + 1) & mask;
+  }
+  if (d_table[i] == s_empty)
+  {
+    d_used++;
+  }
+  d_table[i] = offset + 1;
+}
+
+void InstTupleStore::TupleSet::remove(uint32_t offset)
+{
+  const uint32_t* rec = &d_arena[offset];
+  size_t mask = d_table.size() - 1;
+  size_t i = hash(rec, (rec[0] & ~s_dead) + 2) & mask;
+  while (d_table[i] != offset + 1)
+  {
+    Assert(d_table[i] != s_empty);
+    i = (i + 1) & mask;
+  }
+  d_table[i] = s_removed;
+}
+
+void InstTupleStore::TupleSet::clear()
+{
+  d_arena.clear();
+  d_table.clear();
+  d_used = 0;
+}
+
+uint32_t InstTupleStore::TupleSet::hash(const uint32_t* key, size_t n)
+{
+  uint32_t h = 2166136261u ^ (key[0] & ~s_dead);
+  for (size_t i = 1; i < n; i++)
+  {
+    h = (h ^ key[i]) * 0x9e3779b1u;
+    h ^= h >> 15;
+  }
+  return h;
+}
+
+InstTupleStore::InstTupleStore(context::Context* c)
+    : d_trailSize(nullptr), d_size(0)
+{
+  if (c != nullptr)
+  {
+    d_trailSize = new (true) context::CDO<size_t>(c, 0);
+  }
+}
+
+InstTupleStore::~InstTupleStore()
+{
+  if (d_trailSize != nullptr)
+  {
+    d_trailSize->deleteSelf();
+  }
+}
+
+uint32_t InstTupleStore::getId(TNode n)
+{
+  std::unordered_map<Node, uint32_t, NodeHashFunction>::iterator it =
+      d_ids.find(n);
+  if (it != d_ids.end())
+  {
+    return it->second;
+  }
+  uint32_t id = d_terms.size();
+  d_terms.push_back(n);
+  d_ids[n] = id;
+  return id;
+}
+
+bool InstTupleStore::mkKey(Node q,
+                           const std::vector<Node>& terms,
+                           bool intern)
+{
+  d_key.clear();
+  d_key.push_back(terms.size());
+  for (unsigned i = 0, size = terms.size(); i <= size; i++)
+  {
+    Node t = i == 0 ? q : terms[i - 1];
+    if (intern)
+    {
+      d_key.push_back(getId(t));
+      continue;
+    }
+    std::unordered_map<Node, uint32_t, NodeHashFunction>::iterator it =
+        d_ids.find(t);
+    if (it == d_ids.end())
+    {
+      // t is in no record
+      return false;
+    }
+    d_key.push_back(it->second);
+  }
+  return true;
+}
+
+int64_t InstTupleStore::findRecord() const
+{
+  size_t i = d_tuples.find(
+      d_key.data(), d_key.size(), TupleSet::hash(d_key.data(), d_key.size()));
+  if (i == d_tuples.d_table.size())
+  {
+    return -1;
+  }
+  return d_tuples.d_table[i] - 1;
+}
+
+void InstTupleStore::mkRepKey(QuantifiersEngine* qe, const uint32_t* key)
+{
+  eq::EqualityEngine* ee = qe->getEqualityQuery()->getEngine();
+  uint32_t n = key[0] & ~s_dead;
+  d_repKey.clear();
+  d_repKey.push_back(n);
+  d_repKey.push_back(key[1]);
+  for (uint32_t i = 0; i < n; i++)
+  {
+    Node t = d_terms[key[i + 2]];
+    if (!t.isNull() && ee->hasTerm(t))
+    {
+      t = ee->getRepresentative(t);
+    }
+    // representatives are numbered separately, so that they are released at
+    // the end of the round rather than interned forever
+    std::unordered_map<Node, uint32_t, NodeHashFunction>::iterator it =
+        d_repIds.find(t);
+    if (it == d_repIds.end())
+    {
+      uint32_t id = d_repIds.size();
+      it = d_repIds.insert(std::pair<Node, uint32_t>(t, id)).first;
+    }
+    d_repKey.push_back(it->second);
+  }
+}
+
+void InstTupleStore::indexModEq(QuantifiersEngine* qe, uint32_t qid)
+{
+  Trace("inst-tuple-store") << "Index modulo equality the instantiations of "
+                            << d_terms[qid] << std::endl;
+  d_repIndexed.insert(qid);
+  size_t offset = 0;
+  while (offset < d_tuples.d_arena.size())
+  {
+    const uint32_t* rec = &d_tuples.d_arena[offset];
+    uint32_t n = rec[0] & ~s_dead;
+    if (rec[1] == qid && (rec[0] & s_dead) == 0)
+    {
+      mkRepKey(qe, rec);
+      uint32_t h = TupleSet::hash(d_repKey.data(), d_repKey.size());
+      if (d_reps.find(d_repKey.data(), d_repKey.size(), h)
+          == d_reps.d_table.size())
+      {
+        d_reps.insert(d_reps.append(d_repKey.data(), d_repKey.size()));
+      }
+    }
+    offset += n + 2;
+  }
+}
+
+bool InstTupleStore::existsModEq(QuantifiersEngine* qe, bool add)
+{
+  if (d_repIndexed.find(d_key[1]) == d_repIndexed.end())
+  {
+    if (add)
+    {
+      // the record of d_key will be indexed with the others
+      return false;
+    }
+    indexModEq(qe, d_key[1]);
+  }
+  mkRepKey(qe, d_key.data());
+  uint32_t h = TupleSet::hash(d_repKey.data(), d_repKey.size());
+  if (d_reps.find(d_repKey.data(), d_repKey.size(), h)
+      != d_reps.d_table.size())
+  {
+    return true;
+  }
+  if (add)
+  {
+    d_reps.insert(d_reps.append(d_repKey.data(), d_repKey.size()));
+  }
+  return false;
+}
+
+bool InstTupleStore::addInstantiation(QuantifiersEngine* qe,
+                                      Node q,
+                                      const std::vector<Node>& terms,
+                                      bool modEq)
+{
+  restore();
+  mkKey(q, terms, true);
+  if (findRecord() >= 0 || (modEq && existsModEq(qe, false)))
+  {
+    return false;
+  }
+  uint32_t offset = d_tuples.append(d_key.data(), d_key.size());
+  d_tuples.insert(offset);
+  d_size++;
+  if (d_trailSize != nullptr)
+  {
+    d_trail.push_back(std::pair<TrailKind, uint32_t>(TRAIL_ADD, offset));
+    d_trailSize->set(d_trail.size());
+  }
+  // keep the index modulo equality of q up to date
+  existsModEq(qe, true);
+  return true;
+}
+
+bool InstTupleStore::existsInstantiation(QuantifiersEngine* qe,
+                                         Node q,
+                                         const std::vector<Node>& terms,
+                                         bool modEq)
+{
+  restore();
+  if (!mkKey(q, terms, modEq))
+  {
+    return false;
+  }
+  return findRecord() >= 0 || (modEq && existsModEq(qe, false));
+}
+
+bool InstTupleStore::removeInstantiation(Node q,
+                                         const std::vector<Node>& terms)
+{
+  restore();
+  if (!mkKey(q, terms, false))
+  {
+    return false;
+  }
+  int64_t offset = findRecord();
+  if (offset < 0)
+  {
+    return false;
+  }
+  d_tuples.remove(offset);
+  d_tuples.d_arena[offset] |= s_dead;
+  d_size--;
+  if (d_trailSize != nullptr)
+  {
+    d_trail.push_back(std::pair<TrailKind, uint32_t>(TRAIL_REMOVE, offset));
+    d_trailSize->set(d_trail.size());
+  }
+  else
+  {
+    d_lemmas.erase(offset);
+  }
+  // the representatives of the removed record may be indexed
+  resetRound();
+  return true;
+}
+
+bool InstTupleStore::recordInstLemma(Node q,
+                                     const std::vector<Node>& terms,
+                                     Node lem)
+{
+  restore();
+  if (!mkKey(q, terms, false))
+  {
+    return false;
+  }
+  int64_t offset = findRecord();
+  if (offset < 0)
+  {
+    return false;
+  }
+  d_lemmas[offset] = lem;
+  return true;
+}
+
+void InstTupleStore::resetRound()
+{
+  d_reps.clear();
+  d_repIndexed.clear();
+  d_repIds.clear();
+}
+
+void InstTupleStore::restore()
+{
+  if (d_trailSize == nullptr || d_trail.size() <= d_trailSize->get())
+  {
+    return;
+  }
+  Trace("inst-tuple-store") << "Undo " << (d_trail.size() - d_trailSize->get())
+                            << " changes" << std::endl;
+  while (d_trail.size() > d_trailSize->get())
+  {
+    uint32_t offset = d_trail.back().second;
+    if (d_trail.back().first == TRAIL_ADD)
+    {
+      // records are added and undone in the same order
+      Assert(offset + d_tuples.d_arena[offset] + 2 == d_tuples.d_arena.size());
+      d_tuples.remove(offset);
+      d_tuples.d_arena.resize(offset);
+      d_lemmas.erase(offset);
+      d_size--;
+    }
+    else
+    {
+      d_tuples.d_arena[offset] &= ~s_dead;
+      d_tuples.insert(offset);
+      d_size++;
+    }
+    d_trail.pop_back();
+  }
+  resetRound();
+}
+
+void InstTupleStore::getInstantiatedQuantifiedFormulas(std::vector<Node>& qs)
+{
+  restore();
+  std::unordered_set<uint32_t> processed;
+  size_t offset = 0;
+  while (offset < d_tuples.d_arena.size())
+  {
+    const uint32_t* rec = &d_tuples.d_arena[offset];
+    if ((rec[0] & s_dead) == 0 && processed.insert(rec[1]).second)
+    {
+      qs.push_back(d_terms[rec[1]]);
+    }
+    offset += (rec[0] & ~s_dead) + 2;
+  }
+}
+
+void InstTupleStore::getInstantiations(Node q,
+                                       std::vector<std::vector<Node> >& tvecs,
+                                       std::vector<Node>& lems)
+{
+  restore();
+  std::unordered_map<Node, uint32_t, NodeHashFunction>::iterator it =
+      d_ids.find(q);
+  if (it == d_ids.end())
+  {
+    return;
+  }
+  size_t offset = 0;
+  while (offset < d_tuples.d_arena.size())
+  {
+    const uint32_t* rec = &d_tuples.d_arena[offset];
+    uint32_t n = rec[0] & ~s_dead;
+    if ((rec[0] & s_dead) == 0 && rec[1] == it->second)
+    {
+      tvecs.push_back(std::vector<Node>());
+      for (uint32_t i = 0; i < n; i++)
+      {
+        tvecs.back().push_back(d_terms[rec[i + 2]]);
+      }
+      std::unordered_map<uint32_t, Node>::iterator itl = d_lemmas.find(offset);
+      lems.push_back(itl == d_lemmas.end() ? Node::null() : itl->second);
+    }
+    offset += n + 2;
+  }
+}
+
+bool InstTupleStore::getTermId(Node n, uint32_t& id)
+{
+  restore();
+  std::unordered_map<Node, uint32_t, NodeHashFunction>::iterator it =
+      d_ids.find(n);
+  if (it == d_ids.end())
+  {
+    return false;
+  }
+  id = it->second;
+  return true;
+}
+
+bool InstTupleStore::existsKey(const std::vector<uint32_t>& key) const
+{
+  return d_tuples.find(
+             key.data(), key.size(), TupleSet::hash(key.data(), key.size()))
+         != d_tuples.d_table.size();
+}
+
+size_t InstTupleStore::size()
+{
+  restore();
+  return d_size;
+}
+
+size_t InstTupleStore::getMemoryUsage() const
+{
+  // an estimate of the nodes of the hash maps
+  size_t mapNode = 2 * sizeof(void*);
+  return sizeof(uint32_t)
+             * (d_tuples.d_arena.capacity() + d_tuples.d_table.capacity()
+                + d_reps.d_arena.capacity() + d_reps.d_table.capacity())
+         + d_terms.capacity() * sizeof(Node)
+         + d_ids.size() * (sizeof(Node) + sizeof(uint32_t) + mapNode)
+         + d_ids.bucket_count() * sizeof(void*)
+         + d_repIds.size() * (sizeof(Node) + sizeof(uint32_t) + mapNode)
+         + d_repIds.bucket_count() * sizeof(void*)
+         + d_lemmas.size() * (sizeof(uint32_t) + sizeof(Node) + mapNode)
+         + d_trail.capacity() * sizeof(std::pair<TrailKind, uint32_t>);
+}
+
+}/* CVC4::theory::inst namespace */
+}/* CVC4::theory namespace */
+}/* CVC4 namespace */
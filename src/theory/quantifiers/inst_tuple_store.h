@@ -0,0 +1,201 @@
+/*********************                                                        */
+/*! \file inst_tuple_store.h
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2018 by the authors listed in the file AUTHORS
+ ** in the top-level source directory) and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief Compact store of instantiation tuples
+ **/
+
+#include "cvc4_private.h"
+
+#ifndef __CVC4__THEORY__QUANTIFIERS__INST_TUPLE_STORE_H
+#define __CVC4__THEORY__QUANTIFIERS__INST_TUPLE_STORE_H
+
+#include <stdint.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "context/cdo.h"
+#include "expr/node.h"
+
+namespace CVC4 {
+namespace theory {
+
+class QuantifiersEngine;
+
+namespace inst {
+
+/** Instantiation tuple store
+ *
+ * This class is an alternative to InstMatchTrie and CDInstMatchTrie for
+ * filtering duplicate instantiations. Instead of one trie of maps per
+ * quantified formula, it interns each term as a 32-bit identifier, and stores
+ * the instantiations of all quantified formulas as records in a single arena:
+ *   [ n, id( q ), id( t_1 ), ..., id( t_n ) ]
+ * The records are found using an open addressing hash table of their offsets
+ * in the arena, which costs about n+2 words per instantiation, plus the hash
+ * table and the terms that are interned.
+ *
+ * Duplicates modulo equality are checked using the representatives of the
+ * terms in the current equality engine. Since these may change between
+ * instantiation rounds, the records are indexed by their representatives
+ * lazily, the first time a quantified formula is checked modulo equality in
+ * a round, and this index is cleared by resetRound. The representatives
+ * have their own identifiers, which are also cleared by resetRound, so that
+ * they are not kept alive by this class after the round.
+ *
+ * If this class is given a context, it is context dependent: each change
+ * is recorded on a trail, and the changes made in popped contexts are undone
+ * before this class is next accessed.
+ */
+class InstTupleStore
+{
+ public:
+  /** c is the context this store depends on, or null */
+  InstTupleStore(context::Context* c = nullptr);
+  ~InstTupleStore();
+  /** add instantiation
+   *
+   * Adds the instantiation of q by terms, and returns true if it was not a
+   * duplicate of a previous instantiation of q, either syntactically or, if
+   * modEq is true, modulo equality.
+   */
+  bool addInstantiation(QuantifiersEngine* qe,
+                        Node q,
+                        const std::vector<Node>& terms,
+                        bool modEq = false);
+  /** exists instantiation
+   *
+   * Returns true if q was instantiated by terms, or, if modEq is true, by
+   * terms that are equal to terms in the current context.
+   */
+  bool existsInstantiation(QuantifiersEngine* qe,
+                           Node q,
+                           const std::vector<Node>& terms,
+                           bool modEq = false);
+  /** remove the instantiation of q by terms, returns true if it existed */
+  bool removeInstantiation(Node q, const std::vector<Node>& terms);
+  /** record that lem is the instantiation lemma of q by terms */
+  bool recordInstLemma(Node q, const std::vector<Node>& terms, Node lem);
+  /** reset round
+   *
+   * Clears the index modulo equality, which must be called when the
+   * representatives of the equality engine may have changed.
+   */
+  void resetRound();
+  /** get the quantified formulas that have instantiations */
+  void getInstantiatedQuantifiedFormulas(std::vector<Node>& qs);
+  /** get instantiations
+   *
+   * Adds the instantiations of q to tvecs, in the order they were added. If
+   * the instantiation lemma of the i^th one was recorded, it is lems[i],
+   * otherwise lems[i] is null.
+   */
+  void getInstantiations(Node q,
+                         std::vector<std::vector<Node> >& tvecs,
+                         std::vector<Node>& lems);
+  /** get term identifier
+   *
+   * Returns true if n occurs in an instantiation of this store, in which
+   * case id is set to its identifier.
+   */
+  bool getTermId(Node n, uint32_t& id);
+  /** exists key
+   *
+   * Returns true if the record key, which is
+   *   [ n, id( q ), id( t_1 ), ..., id( t_n ) ]
+   * is in this store. Unlike the other methods, this does not modify this
+   * class, and may be called concurrently from several threads.
+   */
+  bool existsKey(const std::vector<uint32_t>& key) const;
+  /** get the number of instantiations in this store */
+  size_t size();
+  /** get the number of bytes allocated by this store */
+  size_t getMemoryUsage() const;
+
+ private:
+  /** the value of an empty entry of a hash table */
+  static const uint32_t s_empty = 0;
+  /** the value of a removed entry of a hash table */
+  static const uint32_t s_removed = UINT32_MAX;
+  /** the flag of removed records in their first word */
+  static const uint32_t s_dead = 1u << 31;
+  /** A set of records, indexed by a hash table */
+  struct TupleSet
+  {
+    TupleSet() : d_used(0) {}
+    /** the records */
+    std::vector<uint32_t> d_arena;
+    /** the offsets of the records plus one, or s_empty or s_removed */
+    std::vector<uint32_t> d_table;
+    /** the number of entries of the table that are not empty */
+    size_t d_used;
+    /** find the entry of the table for the record key of length n */
+    size_t find(const uint32_t* key, size_t n, uint32_t hash) const;
+    /** append the record key, returns its offset */
+    uint32_t append(const uint32_t* key, size_t n);
+    /** insert the entry of the record at offset */
+    void insert(uint32_t offset);
+    /** remove the entry of the record at offset */
+    void remove(uint32_t offset);
+    /** clear this set */
+    void clear();
+    /** the hash of the record key of length n */
+    static uint32_t hash(const uint32_t* key, size_t n);
+  };
+  /** the kinds of changes that are recorded on the trail */
+  enum TrailKind
+  {
+    TRAIL_ADD,
+    TRAIL_REMOVE
+  };
+  /** get the identifier of n, interning it if necessary */
+  uint32_t getId(TNode n);
+  /** make the key of q and terms in d_key, returns false if it is unknown */
+  bool mkKey(Node q, const std::vector<Node>& terms, bool intern);
+  /** find the record with key d_key, returns its offset or -1 */
+  int64_t findRecord() const;
+  /** does a record for the representatives of d_key exist? */
+  bool existsModEq(QuantifiersEngine* qe, bool add);
+  /** index the records of the quantified formula qid modulo equality */
+  void indexModEq(QuantifiersEngine* qe, uint32_t qid);
+  /** make the key of the representatives of the record key in d_repKey */
+  void mkRepKey(QuantifiersEngine* qe, const uint32_t* key);
+  /** undo the changes made in popped contexts */
+  void restore();
+  /** the identifiers of the interned terms */
+  std::unordered_map<Node, uint32_t, NodeHashFunction> d_ids;
+  /** the interned terms */
+  std::vector<Node> d_terms;
+  /** the records of the instantiations */
+  TupleSet d_tuples;
+  /** the lemmas of the records, if recordInstLemma was called */
+  std::unordered_map<uint32_t, Node> d_lemmas;
+  /** the records of the representatives of instantiations in this round */
+  TupleSet d_reps;
+  /** the identifiers of the representatives in d_reps */
+  std::unordered_map<Node, uint32_t, NodeHashFunction> d_repIds;
+  /** the quantified formulas that were indexed in d_reps */
+  std::unordered_set<uint32_t> d_repIndexed;
+  /** the changes, if context dependent */
+  std::vector<std::pair<TrailKind, uint32_t> > d_trail;
+  /** the size of the trail in the current context */
+  context::CDO<size_t>* d_trailSize;
+  /** the number of live records */
+  size_t d_size;
+  /** the key of the current operation */
+  std::vector<uint32_t> d_key;
+  /** the key of representatives of the current operation */
+  std::vector<uint32_t> d_repKey;
+};
+
+}/* CVC4::theory::inst namespace */
+}/* CVC4::theory namespace */
+}/* CVC4 namespace */
+
+#endif /* __CVC4__THEORY__QUANTIFIERS__INST_TUPLE_STORE_H */
@@ -18,6 +18,7 @@
 #include "smt/smt_statistics_registry.h"
 #include "theory/quantifiers/first_order_model.h"
 #include "theory/quantifiers/cegqi/inst_strategy_cbqi.h"
+#include "theory/quantifiers/inst_scheduler.h"
 #include "theory/quantifiers/quantifiers_attributes.h"
 #include "theory/quantifiers/quantifiers_rewriter.h"
 #include "theory/quantifiers/term_database.h"
@@ -38,6 +39,16 @@ Instantiate::Instantiate(QuantifiersEngine* qe, context::UserContext* u)
       d_total_inst_count_debug(0),
       d_c_inst_match_trie_dom(u)
 {
+  if (options::instTupleStore())
+  {
+    d_inst_store.reset(new inst::InstTupleStore(
+        options::incrementalSolving() ? u : nullptr));
+  }
+  if (options::instSchedule())
+  {
+    d_scheduler.reset(new InstScheduler(qe, u));
+    addNotify(d_scheduler.get());
+  }
 }
 
 Instantiate::~Instantiate()
@@ -62,8 +73,17 @@ bool Instantiate::reset(Theory::Effort e)
     }
     d_recorded_inst.clear();
   }
+  if (d_inst_store)
+  {
+    // the representatives of the terms may have changed
+    d_inst_store->resetRound();
+  }
   d_term_db = d_qe->getTermDatabase();
   d_term_util = d_qe->getTermUtil();
+  if (d_scheduler)
+  {
+    d_scheduler->reset();
+  }
   return true;
 }
 
@@ -76,6 +96,12 @@ bool Instantiate::checkComplete()
         << "Set incomplete due to recorded instantiations." << std::endl;
     return false;
   }
+  if (d_scheduler && d_scheduler->hasDelayedLemmas())
+  {
+    Trace("quant-engine-debug")
+        << "Set incomplete due to delayed instantiations." << std::endl;
+    return false;
+  }
   return true;
 }
 
@@ -92,6 +118,11 @@ void Instantiate::notifyFlushLemmas()
   }
 }
 
+bool Instantiate::releaseDelayedLemmas()
+{
+  return d_scheduler && d_scheduler->releaseDelayedLemmas();
+}
+
 bool Instantiate::addInstantiation(
     Node q, InstMatch& m, bool mkRep, bool modEq, bool doVts)
 {
@@ -342,7 +373,11 @@ bool Instantiate::addInstantiation(
   if (options::trackInstLemmas())
   {
     bool recorded;
-    if (options::incrementalSolving())
+    if (d_inst_store)
+    {
+      recorded = d_inst_store->recordInstLemma(q, terms, lem);
+    }
+    else if (options::incrementalSolving())
     {
       recorded = d_c_inst_match_trie[q]->recordInstLemma(q, terms, lem);
     }
@@ -382,6 +417,11 @@ bool Instantiate::existsInstantiation(Node q,
                                       std::vector<Node>& terms,
                                       bool modEq)
 {
+  if (d_inst_store)
+  {
+    TimerStat::CodeTimer codeTimer(d_statistics.d_inst_store_time);
+    return d_inst_store->existsInstantiation(d_qe, q, terms, modEq);
+  }
   if (options::incrementalSolving())
   {
     std::map<Node, inst::CDInstMatchTrie*>::iterator it =
@@ -450,6 +490,18 @@ bool Instantiate::recordInstantiationInternal(Node q,
     // record the instantiation for deletion later
     d_recorded_inst.push_back(std::pair<Node, std::vector<Node> >(q, terms));
   }
+  if (d_inst_store)
+  {
+    Trace("inst-add-debug") << "Adding into inst tuple store, modEq = " << modEq
+                            << std::endl;
+    bool added;
+    {
+      TimerStat::CodeTimer codeTimer(d_statistics.d_inst_store_time);
+      added = d_inst_store->addInstantiation(d_qe, q, terms, modEq);
+    }
+    d_statistics.d_inst_store_memory.setData(d_inst_store->getMemoryUsage());
+    return added;
+  }
   if (options::incrementalSolving())
   {
     Trace("inst-add-debug")
@@ -476,6 +528,11 @@ bool Instantiate::recordInstantiationInternal(Node q,
 
 bool Instantiate::removeInstantiationInternal(Node q, std::vector<Node>& terms)
 {
+  if (d_inst_store)
+  {
+    TimerStat::CodeTimer codeTimer(d_statistics.d_inst_store_time);
+    return d_inst_store->removeInstantiation(q, terms);
+  }
   if (options::incrementalSolving())
   {
     std::map<Node, inst::CDInstMatchTrie*>::iterator it =
@@ -507,7 +564,46 @@ bool Instantiate::printInstantiations(std::ostream& out)
     useUnsatCore = true;
   }
   bool printed = false;
-  if (options::incrementalSolving())
+  if (d_inst_store)
+  {
+    std::vector<Node> qs;
+    d_inst_store->getInstantiatedQuantifiedFormulas(qs);
+    for (const Node& q : qs)
+    {
+      std::vector<std::vector<Node> > tvecs;
+      std::vector<Node> lems;
+      d_inst_store->getInstantiations(q, tvecs, lems);
+      bool firstTime = true;
+      for (unsigned i = 0, size = tvecs.size(); i < size; i++)
+      {
+        if (useUnsatCore
+            && (lems[i].isNull()
+                || std::find(
+                       active_lemmas.begin(), active_lemmas.end(), lems[i])
+                       == active_lemmas.end()))
+        {
+          continue;
+        }
+        if (firstTime)
+        {
+          out << "(instantiation " << q << std::endl;
+          firstTime = false;
+        }
+        out << "  ( ";
+        for (unsigned j = 0, nterms = tvecs[i].size(); j < nterms; j++)
+        {
+          out << (j > 0 ? ", " : "") << tvecs[i][j];
+        }
+        out << " )" << std::endl;
+      }
+      if (!firstTime)
+      {
+        out << ")" << std::endl;
+      }
+      printed = printed || !firstTime;
+    }
+  }
+  else if (options::incrementalSolving())
   {
     for (std::pair<const Node, inst::CDInstMatchTrie*>& t : d_c_inst_match_trie)
     {
@@ -538,7 +634,11 @@ bool Instantiate::printInstantiations(std::ostream& out)
 
 void Instantiate::getInstantiatedQuantifiedFormulas(std::vector<Node>& qs)
 {
-  if (options::incrementalSolving())
+  if (d_inst_store)
+  {
+    d_inst_store->getInstantiatedQuantifiedFormulas(qs);
+  }
+  else if (options::incrementalSolving())
   {
     for (context::CDHashSet<Node, NodeHashFunction>::const_iterator it =
              d_c_inst_match_trie_dom.begin();
@@ -623,7 +723,16 @@ void Instantiate::getInstantiationTermVectors(
 void Instantiate::getInstantiationTermVectors(
     std::map<Node, std::vector<std::vector<Node> > >& insts)
 {
-  if (options::incrementalSolving())
+  if (d_inst_store)
+  {
+    std::vector<Node> qs;
+    d_inst_store->getInstantiatedQuantifiedFormulas(qs);
+    for (const Node& q : qs)
+    {
+      getInstantiationTermVectors(q, insts[q]);
+    }
+  }
+  else if (options::incrementalSolving())
   {
     for (std::pair<const Node, inst::CDInstMatchTrie*>& t : d_c_inst_match_trie)
     {
@@ -646,7 +755,27 @@ void Instantiate::getExplanationForInstLemmas(
 {
   if (options::trackInstLemmas())
   {
-    if (options::incrementalSolving())
+    if (d_inst_store)
+    {
+      std::vector<Node> qs;
+      d_inst_store->getInstantiatedQuantifiedFormulas(qs);
+      for (const Node& q : qs)
+      {
+        std::vector<std::vector<Node> > tvecs;
+        std::vector<Node> slems;
+        d_inst_store->getInstantiations(q, tvecs, slems);
+        for (unsigned i = 0, size = tvecs.size(); i < size; i++)
+        {
+          if (!slems[i].isNull()
+              && std::find(lems.begin(), lems.end(), slems[i]) != lems.end())
+          {
+            quant[slems[i]] = q;
+            tvec[slems[i]] = tvecs[i];
+          }
+        }
+      }
+    }
+    else if (options::incrementalSolving())
     {
       for (std::pair<const Node, inst::CDInstMatchTrie*>& t :
            d_c_inst_match_trie)
@@ -681,7 +810,16 @@ void Instantiate::getInstantiations(std::map<Node, std::vector<Node> >& insts)
     useUnsatCore = true;
   }
 
-  if (options::incrementalSolving())
+  if (d_inst_store)
+  {
+    std::vector<Node> qs;
+    d_inst_store->getInstantiatedQuantifiedFormulas(qs);
+    for (const Node& q : qs)
+    {
+      getStoredInstantiations(q, insts[q], useUnsatCore, active_lemmas);
+    }
+  }
+  else if (options::incrementalSolving())
   {
     for (std::pair<const Node, inst::CDInstMatchTrie*>& t : d_c_inst_match_trie)
     {
@@ -701,7 +839,12 @@ void Instantiate::getInstantiations(std::map<Node, std::vector<Node> >& insts)
 
 void Instantiate::getInstantiations(Node q, std::vector<Node>& insts)
 {
-  if (options::incrementalSolving())
+  if (d_inst_store)
+  {
+    std::vector<Node> active_lemmas;
+    getStoredInstantiations(q, insts, false, active_lemmas);
+  }
+  else if (options::incrementalSolving())
   {
     std::map<Node, inst::CDInstMatchTrie*>::iterator it =
         d_c_inst_match_trie.find(q);
@@ -725,6 +868,35 @@ void Instantiate::getInstantiations(Node q, std::vector<Node>& insts)
   }
 }
 
+void Instantiate::getStoredInstantiations(Node q,
+                                          std::vector<Node>& insts,
+                                          bool useActive,
+                                          std::vector<Node>& active)
+{
+  std::vector<std::vector<Node> > tvecs;
+  std::vector<Node> lems;
+  d_inst_store->getInstantiations(q, tvecs, lems);
+  for (unsigned i = 0, size = tvecs.size(); i < size; i++)
+  {
+    if (useActive)
+    {
+      if (!lems[i].isNull()
+          && std::find(active.begin(), active.end(), lems[i]) != active.end())
+      {
+        insts.push_back(lems[i]);
+      }
+    }
+    else if (!lems[i].isNull())
+    {
+      insts.push_back(lems[i]);
+    }
+    else
+    {
+      insts.push_back(getInstantiation(q, tvecs[i], true));
+    }
+  }
+}
+
 Node Instantiate::getInstantiatedConjunction(Node q)
 {
   Assert(q.getKind() == FORALL);
@@ -775,6 +947,10 @@ void Instantiate::debugPrintModel()
                               << std::endl;
     }
   }
+  if (d_scheduler && Trace.isOn("inst-schedule-quant"))
+  {
+    d_scheduler->debugPrint("inst-schedule-quant");
+  }
 }
 
 Instantiate::Statistics::Statistics()
@@ -782,13 +958,17 @@ Instantiate::Statistics::Statistics()
       d_inst_duplicate("Instantiate::Duplicate_Inst", 0),
       d_inst_duplicate_eq("Instantiate::Duplicate_Inst_Eq", 0),
       d_inst_duplicate_ent("Instantiate::Duplicate_Inst_Entailed", 0),
-      d_inst_duplicate_model_true("Instantiate::Duplicate_Inst_Model_True", 0)
+      d_inst_duplicate_model_true("Instantiate::Duplicate_Inst_Model_True", 0),
+      d_inst_store_memory("Instantiate::Inst_Store_Memory", 0),
+      d_inst_store_time("Instantiate::Inst_Store_Time")
 {
   smtStatisticsRegistry()->registerStat(&d_instantiations);
   smtStatisticsRegistry()->registerStat(&d_inst_duplicate);
   smtStatisticsRegistry()->registerStat(&d_inst_duplicate_eq);
   smtStatisticsRegistry()->registerStat(&d_inst_duplicate_ent);
   smtStatisticsRegistry()->registerStat(&d_inst_duplicate_model_true);
+  smtStatisticsRegistry()->registerStat(&d_inst_store_memory);
+  smtStatisticsRegistry()->registerStat(&d_inst_store_time);
 }
 
 Instantiate::Statistics::~Statistics()
@@ -798,6 +978,8 @@ Instantiate::Statistics::~Statistics()
   smtStatisticsRegistry()->unregisterStat(&d_inst_duplicate_eq);
   smtStatisticsRegistry()->unregisterStat(&d_inst_duplicate_ent);
   smtStatisticsRegistry()->unregisterStat(&d_inst_duplicate_model_true);
+  smtStatisticsRegistry()->unregisterStat(&d_inst_store_memory);
+  smtStatisticsRegistry()->unregisterStat(&d_inst_store_time);
 }
 
 } /* CVC4::theory::quantifiers namespace */
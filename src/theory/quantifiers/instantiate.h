@@ -21,6 +21,7 @@
 
 #include "expr/node.h"
 #include "theory/quantifiers/inst_match_trie.h"
+#include "theory/quantifiers/inst_tuple_store.h"
 #include "theory/quantifiers/quant_util.h"
 #include "theory/quantifiers_engine.h"
 #include "util/statistics_registry.h"
@@ -29,6 +30,7 @@ namespace CVC4 {
 namespace theory {
 namespace quantifiers {
 
+class InstScheduler;
 class TermDb;
 class TermUtil;
 
@@ -72,7 +74,8 @@ class InstantiationNotify
  * This class is used for generating instantiation lemmas.  It maintains an
  * instantiation trie, which is represented by a different data structure
  * depending on whether incremental solving is enabled (see d_inst_match_trie
- * and d_c_inst_match_trie).
+ * and d_c_inst_match_trie), or a compact store of tuples if the option
+ * --inst-tuple-store is enabled (see d_inst_store).
  *
  * Below, we say an instantiation lemma for q = forall x. F under substitution
  * { x -> t } is the formula:
@@ -200,6 +203,18 @@ class Instantiate : public QuantifiersUtil
    * Same as above but with vars equal to the bound variables of q.
    */
   Node getInstantiation(Node q, std::vector<Node>& terms, bool doVts = false);
+  /** release delayed lemmas
+   *
+   * If the option --inst-schedule is enabled, this adds the delayed
+   * instantiation lemmas of least cost to the lemmas of the quantifiers
+   * engine, and returns true if any were added. It is called when a round of
+   * instantiation adds no lemmas.
+   */
+  bool releaseDelayedLemmas();
+  /** get the instantiation scheduler, or null if it is not used */
+  InstScheduler* getScheduler() { return d_scheduler.get(); }
+  /** get the instantiation tuple store, or null if it is not used */
+  inst::InstTupleStore* getTupleStore() { return d_inst_store.get(); }
   /** get term for type
    *
    * This returns an arbitrary term for type tn.
@@ -312,6 +327,10 @@ class Instantiate : public QuantifiersUtil
     IntStat d_inst_duplicate_eq;
     IntStat d_inst_duplicate_ent;
     IntStat d_inst_duplicate_model_true;
+    /** the number of bytes of the instantiation tuple store */
+    IntStat d_inst_store_memory;
+    /** the time spent in the instantiation tuple store */
+    TimerStat d_inst_store_time;
     Statistics();
     ~Statistics();
   }; /* class Instantiate::Statistics */
@@ -331,6 +350,15 @@ class Instantiate : public QuantifiersUtil
                                    bool addedLem = true);
   /** remove instantiation from the cache */
   bool removeInstantiationInternal(Node q, std::vector<Node>& terms);
+  /** get instantiations from d_inst_store
+   *
+   * Adds the instantiation lemmas of q to insts. If useActive is true, only
+   * the recorded lemmas that are in active are added.
+   */
+  void getStoredInstantiations(Node q,
+                               std::vector<Node>& insts,
+                               bool useActive,
+                               std::vector<Node>& active);
 
   /** pointer to the quantifiers engine */
   QuantifiersEngine* d_qe;
@@ -360,6 +388,15 @@ class Instantiate : public QuantifiersUtil
    * is valid.
    */
   context::CDHashSet<Node, NodeHashFunction> d_c_inst_match_trie_dom;
+  /** the store of all instantiations, if the option --inst-tuple-store is
+   * enabled, in which case it is used instead of the tries above. It is
+   * context dependent if incremental solving is enabled.
+   */
+  std::unique_ptr<inst::InstTupleStore> d_inst_store;
+  /** the scheduler of instantiation lemmas, if the option --inst-schedule is
+   * enabled. It is one of the notify classes of this class.
+   */
+  std::unique_ptr<InstScheduler> d_scheduler;
 
   /** explicitly recorded instantiations
    *
@@ -0,0 +1,620 @@
+/*********************                                                        */
+/*! \file join_plan.cpp
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2018 by the authors listed in the file AUTHORS
+ ** in the top-level source directory) and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief Join plans for conflict-based instantiation
+ **/
+
+#include "theory/quantifiers/join_plan.h"
+
+#include <algorithm>
+
+#include "options/uf_options.h"
+#include "theory/quantifiers/term_database.h"
+#include "theory/quantifiers/term_util.h"
+#include "theory/quantifiers_engine.h"
+#include "theory/uf/equality_engine.h"
+
+using namespace CVC4::kind;
+
+namespace CVC4 {
+namespace theory {
+namespace quantifiers {
+
+namespace {
+
+/** collect tuples
+ *
+ * Adds to tuples the values of the variables of the columns for each leaf of
+ * tat, where cols maps each column to the index of its variable, or to -1 if
+ * its value must be the representative in reps. The last column is the value
+ * of the terms, the others are their arguments.
+ */
+void collectTuples(TermArgTrie* tat,
+                   std::vector<TNode>& args,
+                   const std::vector<int>& cols,
+                   const std::vector<TNode>& reps,
+                   unsigned numVars,
+                   eq::EqualityEngine* ee,
+                   std::vector<std::vector<TNode> >& tuples)
+{
+  if (args.size() + 1 < cols.size())
+  {
+    for (TermArgTrieMap::Entry& c : tat->d_data)
+    {
+      args.push_back(c.first);
+      collectTuples(&c.second, args, cols, reps, numVars, ee, tuples);
+      args.pop_back();
+    }
+    return;
+  }
+  TNode t = tat->getNodeData();
+  if (!ee->hasTerm(t))
+  {
+    return;
+  }
+  std::vector<TNode> tuple(numVars);
+  for (unsigned k = 0, ncols = cols.size(); k < ncols; k++)
+  {
+    TNode val = k < args.size() ? args[k] : ee->getRepresentative(t);
+    if (cols[k] < 0)
+    {
+      if (val != reps[k])
+      {
+        return;
+      }
+    }
+    else if (tuple[cols[k]].isNull())
+    {
+      tuple[cols[k]] = val;
+    }
+    else if (tuple[cols[k]] != val)
+    {
+      return;
+    }
+  }
+  tuples.push_back(tuple);
+}
+
+}  // namespace
+
+JoinPlan::JoinPlan() : d_valid(false), d_numVars(0) {}
+
+int JoinPlan::mkVar()
+{
+  d_parent.push_back(d_parent.size());
+  return d_parent.size() - 1;
+}
+
+int JoinPlan::findVar(int v)
+{
+  while (d_parent[v] != v)
+  {
+    d_parent[v] = d_parent[d_parent[v]];
+    v = d_parent[v];
+  }
+  return v;
+}
+
+void JoinPlan::markVars(const Atom& a, std::vector<bool>& vars)
+{
+  for (const Column& c : a.d_args)
+  {
+    if (c.d_var >= 0)
+    {
+      vars[c.d_var] = true;
+    }
+  }
+  if (a.d_value.d_var >= 0)
+  {
+    vars[a.d_value.d_var] = true;
+  }
+}
+
+JoinPlan::Column JoinPlan::compileTerm(Node n,
+                                       unsigned lit,
+                                       std::vector<Atom>& atoms,
+                                       bool& success)
+{
+  Column c;
+  std::map<Node, unsigned>::iterator it = d_varIndex.find(n);
+  if (it != d_varIndex.end())
+  {
+    c.d_var = d_qvars[it->second];
+  }
+  else if (!TermUtil::hasBoundVarAttr(n))
+  {
+    c.d_term = n;
+  }
+  else if (n.getKind() == APPLY_UF)
+  {
+    Atom a;
+    a.d_op = n.getOperator();
+    a.d_lit = lit;
+    for (const Node& nc : n)
+    {
+      a.d_args.push_back(compileTerm(nc, lit, atoms, success));
+    }
+    a.d_value.d_var = mkVar();
+    c.d_var = a.d_value.d_var;
+    atoms.push_back(a);
+  }
+  else
+  {
+    success = false;
+  }
+  return c;
+}
+
+bool JoinPlan::compile(Node q)
+{
+  d_valid = false;
+  d_quant = q;
+  if (options::ufHo())
+  {
+    return false;
+  }
+  for (unsigned i = 0, nvars = q[0].getNumChildren(); i < nvars; i++)
+  {
+    d_varIndex[q[0][i]] = i;
+    d_qvars.push_back(mkVar());
+  }
+  if (q[1].getKind() == OR)
+  {
+    d_lits.insert(d_lits.end(), q[1].begin(), q[1].end());
+  }
+  else
+  {
+    d_lits.push_back(q[1]);
+  }
+  NodeManager* nm = NodeManager::currentNM();
+  for (unsigned i = 0, nlits = d_lits.size(); i < nlits; i++)
+  {
+    bool pol = d_lits[i].getKind() != NOT;
+    Node atom = pol ? d_lits[i] : d_lits[i][0];
+    std::vector<Atom> atoms;
+    std::vector<std::pair<int, int> > eqs;
+    unsigned numVars = d_parent.size();
+    bool success = true;
+    if (atom.getKind() == APPLY_UF && atom.getType().isBoolean())
+    {
+      // the instance of the atom must have the value !pol
+      Atom a;
+      a.d_op = atom.getOperator();
+      a.d_lit = i;
+      for (const Node& nc : atom)
+      {
+        a.d_args.push_back(compileTerm(nc, i, atoms, success));
+      }
+      a.d_value.d_term = nm->mkConst(!pol);
+      atoms.push_back(a);
+    }
+    else if (atom.getKind() == EQUAL && !pol && !atom[0].getType().isBoolean())
+    {
+      // the instances of the sides of the equality must be equal
+      Column c0 = compileTerm(atom[0], i, atoms, success);
+      Column c1 = compileTerm(atom[1], i, atoms, success);
+      if (c0.d_var >= 0 && c1.d_var >= 0)
+      {
+        eqs.push_back(std::pair<int, int>(c0.d_var, c1.d_var));
+      }
+      else if (c0.d_var >= 0 || c1.d_var >= 0)
+      {
+        Atom a;
+        a.d_lit = i;
+        a.d_args.push_back(c0.d_var >= 0 ? c0 : c1);
+        a.d_value = c0.d_var >= 0 ? c1 : c0;
+        atoms.push_back(a);
+      }
+      else
+      {
+        success = false;
+      }
+    }
+    else
+    {
+      success = false;
+    }
+    if (!success)
+    {
+      Trace("qcf-join") << "...literal " << d_lits[i] << " is checked"
+                        << std::endl;
+      d_parent.resize(numVars);
+      continue;
+    }
+    d_atoms.insert(d_atoms.end(), atoms.begin(), atoms.end());
+    for (const std::pair<int, int>& e : eqs)
+    {
+      d_parent[findVar(e.first)] = findVar(e.second);
+    }
+  }
+
+  // number the representatives of the variables
+  std::map<int, int> number;
+  for (unsigned v = 0, nvars = d_parent.size(); v < nvars; v++)
+  {
+    int r = findVar(v);
+    if (number.find(r) == number.end())
+    {
+      int n = number.size();
+      number[r] = n;
+    }
+  }
+  d_numVars = number.size();
+  for (int& v : d_qvars)
+  {
+    v = number[findVar(v)];
+  }
+  for (Atom& a : d_atoms)
+  {
+    for (Column& c : a.d_args)
+    {
+      if (c.d_var >= 0)
+      {
+        c.d_var = number[findVar(c.d_var)];
+      }
+    }
+    if (a.d_value.d_var >= 0)
+    {
+      a.d_value.d_var = number[findVar(a.d_value.d_var)];
+    }
+  }
+
+  // the variables of q must be in atoms
+  std::vector<bool> occurs(d_numVars, false);
+  for (const Atom& a : d_atoms)
+  {
+    markVars(a, occurs);
+  }
+  for (int v : d_qvars)
+  {
+    if (!occurs[v])
+    {
+      Trace("qcf-join") << "No join plan for " << q << std::endl;
+      return false;
+    }
+  }
+  // literals whose atoms can be left out, which includes the literals that
+  // are only checked, e.g. a positive equality, since all variables are in
+  // the atoms of the other literals
+  for (unsigned i = 0, nlits = d_lits.size(); i < nlits; i++)
+  {
+    std::vector<bool> covered(d_numVars, false);
+    for (const Atom& a : d_atoms)
+    {
+      if (a.d_lit != i)
+      {
+        markVars(a, covered);
+      }
+    }
+    bool success = true;
+    for (unsigned j = 0, nvars = d_qvars.size(); j < nvars && success; j++)
+    {
+      success = covered[d_qvars[j]];
+    }
+    if (success)
+    {
+      d_propLits.push_back(i);
+    }
+  }
+  Trace("qcf-join") << "Join plan for " << q << " has " << d_atoms.size()
+                    << " atoms over " << d_numVars << " variables, "
+                    << d_propLits.size() << " literals can propagate"
+                    << std::endl;
+  d_valid = true;
+  return true;
+}
+
+bool JoinPlan::computeTuples(QuantifiersEngine* qe, Atom& a)
+{
+  eq::EqualityEngine* ee = qe->getEqualityQuery()->getEngine();
+  // the variables and ground representatives of the columns
+  std::vector<int> cols;
+  std::vector<TNode> reps;
+  std::map<int, int> local;
+  a.d_vars.clear();
+  a.d_tuples.clear();
+  a.d_computed = true;
+  a.d_sorted = false;
+  for (unsigned k = 0, nargs = a.d_args.size(); k <= nargs; k++)
+  {
+    const Column& c = k < nargs ? a.d_args[k] : a.d_value;
+    if (c.d_var < 0)
+    {
+      if (!ee->hasTerm(c.d_term))
+      {
+        return false;
+      }
+      cols.push_back(-1);
+      reps.push_back(ee->getRepresentative(c.d_term));
+      continue;
+    }
+    std::map<int, int>::iterator it = local.find(c.d_var);
+    if (it == local.end())
+    {
+      local[c.d_var] = a.d_vars.size();
+      a.d_vars.push_back(c.d_var);
+    }
+    cols.push_back(local[c.d_var]);
+    reps.push_back(TNode::null());
+  }
+  if (a.d_op.isNull())
+  {
+    // the variable is equal to the ground term
+    a.d_tuples.push_back(std::vector<TNode>(1, reps[1]));
+    return true;
+  }
+  TermArgTrie* tat = qe->getTermDatabase()->getTermArgTrie(a.d_op);
+  if (tat == nullptr)
+  {
+    return false;
+  }
+  std::vector<TNode> args;
+  collectTuples(tat, args, cols, reps, a.d_vars.size(), ee, a.d_tuples);
+  return !a.d_tuples.empty();
+}
+
+void JoinPlan::evaluate(QuantifiersEngine* qe,
+                        int skip,
+                        std::function<bool(const std::vector<TNode>&)> found)
+{
+  Assert(d_valid);
+  d_active.clear();
+  d_order.clear();
+  std::vector<size_t> estimate(d_numVars, 0);
+  std::vector<bool> inJoin(d_numVars, false);
+  for (unsigned i = 0, natoms = d_atoms.size(); i < natoms; i++)
+  {
+    Atom& a = d_atoms[i];
+    if ((int)a.d_lit == skip)
+    {
+      continue;
+    }
+    d_active.push_back(i);
+    if (!a.d_computed)
+    {
+      computeTuples(qe, a);
+    }
+    if (a.d_tuples.empty())
+    {
+      Trace("qcf-join-debug") << "...atom " << i << " has no tuples"
+                              << std::endl;
+      d_active.clear();
+      break;
+    }
+    for (int v : a.d_vars)
+    {
+      if (!inJoin[v] || a.d_tuples.size() < estimate[v])
+      {
+        estimate[v] = a.d_tuples.size();
+      }
+      inJoin[v] = true;
+    }
+  }
+  if (!d_active.empty())
+  {
+    // order the variables greedily by their estimated number of values,
+    // preferring the variables of atoms with a variable that is already bound
+    std::vector<int> pos(d_numVars, -1);
+    for (;;)
+    {
+      int best = -1;
+      bool bestConnected = false;
+      for (unsigned v = 0; v < d_numVars; v++)
+      {
+        if (!inJoin[v] || pos[v] >= 0)
+        {
+          continue;
+        }
+        bool connected = false;
+        for (unsigned i : d_active)
+        {
+          const std::vector<int>& avars = d_atoms[i].d_vars;
+          if (std::find(avars.begin(), avars.end(), (int)v) != avars.end())
+          {
+            for (int w : avars)
+            {
+              connected = connected || pos[w] >= 0;
+            }
+          }
+        }
+        if (best < 0 || (connected && !bestConnected)
+            || (connected == bestConnected && estimate[v] < estimate[best]))
+        {
+          best = v;
+          bestConnected = connected;
+        }
+      }
+      if (best < 0)
+      {
+        break;
+      }
+      pos[best] = d_order.size();
+      d_order.push_back(best);
+    }
+    // sort the tuples by the columns of the variables in this order
+    for (unsigned i : d_active)
+    {
+      sortTuples(d_atoms[i], pos);
+    }
+    if (Trace.isOn("qcf-join-debug"))
+    {
+      Trace("qcf-join-debug") << "Join order for " << d_quant << " :";
+      for (int v : d_order)
+      {
+        Trace("qcf-join-debug") << " " << v << "(" << estimate[v] << ")";
+      }
+      Trace("qcf-join-debug") << std::endl;
+    }
+    std::vector<std::pair<size_t, size_t> > ranges;
+    for (unsigned i : d_active)
+    {
+      ranges.push_back(
+          std::pair<size_t, size_t>(0, d_atoms[i].d_tuples.size()));
+    }
+    std::vector<unsigned> bound(d_active.size(), 0);
+    std::vector<TNode> binding(d_numVars);
+    bool stop = false;
+    join(0, ranges, bound, binding, found, stop);
+  }
+}
+
+void JoinPlan::sortTuples(Atom& a, const std::vector<int>& pos)
+{
+  std::vector<unsigned> perm(a.d_vars.size());
+  for (unsigned k = 0; k < perm.size(); k++)
+  {
+    perm[k] = k;
+  }
+  std::sort(perm.begin(), perm.end(), [&](unsigned k1, unsigned k2) {
+    return pos[a.d_vars[k1]] < pos[a.d_vars[k2]];
+  });
+  bool identity = true;
+  for (unsigned k = 0; k < perm.size() && identity; k++)
+  {
+    identity = perm[k] == k;
+  }
+  if (identity && a.d_sorted)
+  {
+    return;
+  }
+  if (!identity)
+  {
+    std::vector<int> vars;
+    for (unsigned k : perm)
+    {
+      vars.push_back(a.d_vars[k]);
+    }
+    a.d_vars = vars;
+    std::vector<TNode> pt(perm.size());
+    for (std::vector<TNode>& t : a.d_tuples)
+    {
+      for (unsigned k = 0; k < perm.size(); k++)
+      {
+        pt[k] = t[perm[k]];
+      }
+      t.swap(pt);
+    }
+  }
+  std::sort(a.d_tuples.begin(), a.d_tuples.end());
+  a.d_tuples.erase(std::unique(a.d_tuples.begin(), a.d_tuples.end()),
+                   a.d_tuples.end());
+  a.d_sorted = true;
+}
+
+void JoinPlan::clearTuples()
+{
+  for (Atom& a : d_atoms)
+  {
+    a.d_tuples.clear();
+    a.d_computed = false;
+    a.d_sorted = false;
+  }
+}
+
+void JoinPlan::join(unsigned d,
+                    std::vector<std::pair<size_t, size_t> >& ranges,
+                    std::vector<unsigned>& bound,
+                    std::vector<TNode>& binding,
+                    std::function<bool(const std::vector<TNode>&)>& found,
+                    bool& stop)
+{
+  if (d == d_order.size())
+  {
+    std::vector<TNode> values;
+    for (int v : d_qvars)
+    {
+      values.push_back(binding[v]);
+    }
+    stop = !found(values);
+    return;
+  }
+  int v = d_order[d];
+  // the atoms whose next column is v
+  std::vector<unsigned> parts;
+  unsigned smallest = 0;
+  for (unsigned k = 0, nactive = d_active.size(); k < nactive; k++)
+  {
+    const Atom& a = d_atoms[d_active[k]];
+    if (bound[k] < a.d_vars.size() && a.d_vars[bound[k]] == v)
+    {
+      if (parts.empty()
+          || ranges[k].second - ranges[k].first
+                 < ranges[smallest].second - ranges[smallest].first)
+      {
+        smallest = k;
+      }
+      parts.push_back(k);
+    }
+  }
+  Assert(!parts.empty());
+  // intersect the values of v in the smallest atom with the others
+  const std::vector<std::vector<TNode> >& stuples =
+      d_atoms[d_active[smallest]].d_tuples;
+  unsigned scol = bound[smallest];
+  std::pair<size_t, size_t> srange = ranges[smallest];
+  size_t i = srange.first;
+  while (i < srange.second && !stop)
+  {
+    TNode val = stuples[i][scol];
+    size_t j = i + 1;
+    while (j < srange.second && stuples[j][scol] == val)
+    {
+      j++;
+    }
+    std::vector<std::pair<size_t, size_t> > saved;
+    bool empty = false;
+    for (unsigned k : parts)
+    {
+      saved.push_back(ranges[k]);
+      if (k == smallest)
+      {
+        ranges[k] = std::pair<size_t, size_t>(i, j);
+        continue;
+      }
+      const std::vector<std::vector<TNode> >& tuples =
+          d_atoms[d_active[k]].d_tuples;
+      unsigned col = bound[k];
+      std::vector<std::vector<TNode> >::const_iterator lo = std::lower_bound(
+          tuples.begin() + ranges[k].first,
+          tuples.begin() + ranges[k].second,
+          val,
+          [col](const std::vector<TNode>& t, TNode x) { return t[col] < x; });
+      std::vector<std::vector<TNode> >::const_iterator hi = std::upper_bound(
+          lo,
+          tuples.begin() + ranges[k].second,
+          val,
+          [col](TNode x, const std::vector<TNode>& t) { return x < t[col]; });
+      ranges[k] = std::pair<size_t, size_t>(lo - tuples.begin(),
+                                            hi - tuples.begin());
+      empty = empty || lo == hi;
+    }
+    if (!empty)
+    {
+      for (unsigned k : parts)
+      {
+        bound[k]++;
+      }
+      binding[v] = val;
+      join(d + 1, ranges, bound, binding, found, stop);
+      for (unsigned k : parts)
+      {
+        bound[k]--;
+      }
+    }
+    for (unsigned p = 0, nparts = parts.size(); p < nparts; p++)
+    {
+      ranges[parts[p]] = saved[p];
+    }
+    i = j;
+  }
+}
+
+} /* CVC4::theory::quantifiers namespace */
+} /* CVC4::theory namespace */
+} /* CVC4 namespace */
@@ -0,0 +1,185 @@
+/*********************                                                        */
+/*! \file join_plan.h
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2018 by the authors listed in the file AUTHORS
+ ** in the top-level source directory) and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief Join plans for conflict-based instantiation
+ **/
+
+#include "cvc4_private.h"
+
+#ifndef __CVC4__THEORY__QUANTIFIERS__JOIN_PLAN_H
+#define __CVC4__THEORY__QUANTIFIERS__JOIN_PLAN_H
+
+#include <functional>
+#include <map>
+#include <vector>
+
+#include "expr/node.h"
+
+namespace CVC4 {
+namespace theory {
+
+class QuantifiersEngine;
+
+namespace quantifiers {
+
+/** Join plan
+ *
+ * This class finds the instances of a quantified formula
+ *   forall x. L_1 V ... V L_n
+ * whose literals are false in the current context, as a relational query.
+ * Each literal L_i whose instances must be false is compiled into atoms over
+ * the relations of the function symbols, whose tuples are the
+ * representatives of the arguments and value of the ground terms in the term
+ * database:
+ * - P( t_1, ..., t_k ) becomes P( t_1, ..., t_k ; false ), and its negation
+ * becomes P( t_1, ..., t_k ; true ),
+ * - ~( s = t ) equates the variables of s and t,
+ * - a nested application f( t_1, ..., t_k ) becomes f( t_1, ..., t_k ; y ) for
+ * a fresh variable y, which is its value.
+ * The other literals are only checked once the variables are bound.
+ *
+ * The query is evaluated by a worst-case optimal join: the variables are bound
+ * one at a time, in an order where the variables with the fewest candidate
+ * values come first, and the values of a variable are those of the
+ * intersection of the columns of all atoms that contain it. Each atom is a
+ * sorted array of tuples whose columns follow the order of the variables, so
+ * that the tuples matching the bound variables are a range of the array.
+ *
+ * The tuples of an atom are collected from the term database the first time
+ * the atom is used in a round, and kept until clearTuples is called at the
+ * end of the round. An evaluation only permutes and re-sorts the tuples of
+ * the atoms whose variables are in a different order than in the previous
+ * evaluation.
+ */
+class JoinPlan
+{
+ public:
+  JoinPlan();
+  ~JoinPlan() {}
+  /** compile
+   *
+   * Compiles the join plan of q. Returns false if some variable of q is in no
+   * atom, in which case this plan cannot be used.
+   */
+  bool compile(Node q);
+  /** is this plan valid? */
+  bool isValid() const { return d_valid; }
+  /** get the literals of the body of q */
+  const std::vector<Node>& getLiterals() const { return d_lits; }
+  /**
+   * get the indices of the literals that can be left out of the query, i.e.
+   * the literals such that the atoms of the other literals contain all
+   * variables of q
+   */
+  const std::vector<unsigned>& getPropagatingLiterals() const
+  {
+    return d_propLits;
+  }
+  /** evaluate
+   *
+   * Calls found with the values of the variables of q for each instance that
+   * makes the atoms of all literals but the skip^th one false (or all of
+   * them if skip is -1), until found returns false.
+   */
+  void evaluate(QuantifiersEngine* qe,
+                int skip,
+                std::function<bool(const std::vector<TNode>&)> found);
+  /**
+   * Clears the tuples of the atoms, which refer to the representatives of
+   * the current round.
+   */
+  void clearTuples();
+
+ private:
+  /** A column of an atom: a variable, or a ground term if d_var is -1 */
+  struct Column
+  {
+    Column() : d_var(-1) {}
+    int d_var;
+    Node d_term;
+  };
+  /** An atom of the query */
+  struct Atom
+  {
+    Atom() : d_computed(false), d_sorted(false) {}
+    /** the function symbol, or null if d_args[0] is equal to d_value */
+    Node d_op;
+    /** the columns of the arguments */
+    std::vector<Column> d_args;
+    /** the column of the value */
+    Column d_value;
+    /** the literal of the body this atom was compiled from */
+    unsigned d_lit;
+    /** the variables of this atom, in the order of the join */
+    std::vector<int> d_vars;
+    /** the tuples of values of d_vars */
+    std::vector<std::vector<TNode> > d_tuples;
+    /** whether d_tuples were computed in this round */
+    bool d_computed;
+    /** whether d_tuples are sorted and without duplicates */
+    bool d_sorted;
+  };
+  /** compile term
+   *
+   * Returns the column of n, adding the atoms of its nested applications to
+   * atoms. Sets success to false if n cannot be compiled.
+   */
+  Column compileTerm(Node n,
+                     unsigned lit,
+                     std::vector<Atom>& atoms,
+                     bool& success);
+  /** make a fresh variable */
+  int mkVar();
+  /** get the representative of variable v */
+  int findVar(int v);
+  /** set vars[v] to true for the variables v of atom a */
+  static void markVars(const Atom& a, std::vector<bool>& vars);
+  /** compute the tuples of atom a, returns false if there are none */
+  bool computeTuples(QuantifiersEngine* qe, Atom& a);
+  /**
+   * sort the tuples of atom a by the columns of its variables in the order
+   * pos, unless they already are
+   */
+  void sortTuples(Atom& a, const std::vector<int>& pos);
+  /** bind the variables from position d of the join order, see evaluate */
+  void join(unsigned d,
+            std::vector<std::pair<size_t, size_t> >& ranges,
+            std::vector<unsigned>& bound,
+            std::vector<TNode>& binding,
+            std::function<bool(const std::vector<TNode>&)>& found,
+            bool& stop);
+  /** whether this plan is valid */
+  bool d_valid;
+  /** the quantified formula */
+  Node d_quant;
+  /** the literals of the body */
+  std::vector<Node> d_lits;
+  /** the literals that can be left out of the query */
+  std::vector<unsigned> d_propLits;
+  /** the atoms of the query */
+  std::vector<Atom> d_atoms;
+  /** the union find of the variables */
+  std::vector<int> d_parent;
+  /** the variable of each variable of q */
+  std::vector<int> d_qvars;
+  /** the number of variables of the query */
+  unsigned d_numVars;
+  /** the index of each variable of q */
+  std::map<Node, unsigned> d_varIndex;
+  /** the atoms used by the current evaluation */
+  std::vector<unsigned> d_active;
+  /** the order of the variables in the current evaluation */
+  std::vector<int> d_order;
+};
+
+} /* CVC4::theory::quantifiers namespace */
+} /* CVC4::theory namespace */
+} /* CVC4 namespace */
+
+#endif /* __CVC4__THEORY__QUANTIFIERS__JOIN_PLAN_H */
@@ -231,7 +231,7 @@ void LtePartialInst::getPartialInstantiations( std::vector< Node >& conj, Node q
           //start traversing term index for the operator
           curr = d_quantEngine->getTermDatabase()->getTermArgTrie( pat.getOperator() );
         }
-        for( std::map< TNode, TermArgTrie >::iterator it = curr->d_data.begin(); it != curr->d_data.end(); ++it ){
+        for( TermArgTrieMap::iterator it = curr->d_data.begin(); it != curr->d_data.end(); ++it ){
           terms[d_pat_var_order[q][iindex]] = it->first;
           getPartialInstantiations( conj, q, bvl, vars, terms, types, &it->second, pindex, paindex+1, iindex+1 );
         }
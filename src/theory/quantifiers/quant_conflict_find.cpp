@@ -1671,7 +1671,7 @@ bool MatchGen::doMatching( QuantConflictFind * p, QuantInfo * qi ) {
             }else{
               //binding a variable
               d_qni_bound[index] = repVar;
-              std::map< TNode, TermArgTrie >::iterator it = d_qn[index]->d_data.begin();
+              TermArgTrieMap::iterator it = d_qn[index]->d_data.begin();
               if( it != d_qn[index]->d_data.end() ) {
                 d_qni.push_back( it );
                 //set the match
@@ -1698,7 +1698,7 @@ bool MatchGen::doMatching( QuantConflictFind * p, QuantInfo * qi ) {
           }
           if( !val.isNull() ){
             //constrained by val
-            std::map< TNode, TermArgTrie >::iterator it = d_qn[index]->d_data.find( val );
+            TermArgTrieMap::iterator it = d_qn[index]->d_data.find( val );
             if( it!=d_qn[index]->d_data.end() ){
               Debug("qcf-match-debug") << "       Match" << std::endl;
               d_qni.push_back( it );
@@ -1854,6 +1854,10 @@ void QuantConflictFind::registerQuantifier( Node q ) {
     //make QcfNode structure
     Trace("qcf-qregister") << "- Get relevant equality/disequality pairs, calculate flattening..." << std::endl;
     d_qinfo[q].initialize( this, q, q[1] );
+    if (options::qcfJoinPlan())
+    {
+      d_join_plans[q].compile(q);
+    }
 
     //debug print
     if( Trace.isOn("qcf-qregister") ){
@@ -1982,7 +1986,18 @@ void QuantConflictFind::check(Theory::Effort level, QEffort quant_e)
             QuantInfo * qi = &d_qinfo[q];
 
             Assert( d_qinfo.find( q )!=d_qinfo.end() );
-            if( qi->matchGeneratorIsValid() ){
+            std::map<Node, JoinPlan>::iterator itj = d_join_plans.find(q);
+            if (itj != d_join_plans.end() && itj->second.isValid())
+            {
+              checkJoinPlan(q, itj->second, addedLemmas, isConflict);
+              if (d_conflict || d_quantEngine->inConflict())
+              {
+                break;
+              }
+            }
+            else if (qi->matchGeneratorIsValid())
+            {
+              CodeTimer matchTimer(d_statistics.d_match_time);
               Trace("qcf-check") << "Check quantified formula ";
               debugPrintQuant("qcf-check", q);
               Trace("qcf-check") << " : " << q << "..." << std::endl;
@@ -2027,6 +2042,7 @@ void QuantConflictFind::check(Theory::Effort level, QEffort quant_e)
                             if (e == EFFORT_CONFLICT) {
                               d_quantEngine->markRelevant( q );
                               ++(d_quantEngine->d_statistics.d_instantiations_qcf);
+                              ++(d_statistics.d_match_conflicts);
                               if( options::qcfAllConflict() ){
                                 isConflict = true;
                               }else{
@@ -2073,6 +2089,11 @@ void QuantConflictFind::check(Theory::Effort level, QEffort quant_e)
       if( isConflict ){
         d_conflict.set( true );
       }
+      // the tuples of the join plans are kept during the round
+      for (std::pair<const Node, JoinPlan>& jp : d_join_plans)
+      {
+        jp.second.clearTuples();
+      }
       if( Trace.isOn("qcf-engine") ){
         double clSet2 = double(clock())/double(CLOCKS_PER_SEC);
         Trace("qcf-engine") << "Finished conflict find engine, time = " << (clSet2-clSet);
@@ -2095,6 +2116,105 @@ void QuantConflictFind::check(Theory::Effort level, QEffort quant_e)
   }
 }
 
+void QuantConflictFind::checkJoinPlan(Node q,
+                                      JoinPlan& plan,
+                                      int& addedLemmas,
+                                      bool& isConflict)
+{
+  CodeTimer codeTimer(d_statistics.d_join_time);
+  Trace("qcf-check") << "Check join plan of ";
+  debugPrintQuant("qcf-check", q);
+  Trace("qcf-check") << " : " << q << "..." << std::endl;
+  TermDb* tdb = getTermDatabase();
+  const std::vector<Node>& lits = plan.getLiterals();
+  std::vector<int> skips;
+  if (d_effort == EFFORT_CONFLICT)
+  {
+    skips.push_back(-1);
+  }
+  else
+  {
+    skips.insert(skips.end(),
+                 plan.getPropagatingLiterals().begin(),
+                 plan.getPropagatingLiterals().end());
+  }
+  bool foundConflict = false;
+  for (int skip : skips)
+  {
+    plan.evaluate(d_quantEngine, skip, [&](const std::vector<TNode>& vals) {
+      if (d_quantEngine->inConflict())
+      {
+        return false;
+      }
+      std::map<TNode, TNode> subs;
+      for (unsigned i = 0, nvars = vals.size(); i < nvars; i++)
+      {
+        subs[q[0][i]] = vals[i];
+      }
+      // the literals that are not in the query must be false as well
+      for (unsigned i = 0, nlits = lits.size(); i < nlits; i++)
+      {
+        if ((int)i != skip && !tdb->isEntailed(lits[i], subs, true, false))
+        {
+          Trace("qcf-join-debug") << "...not entailed : " << lits[i]
+                                  << std::endl;
+          return true;
+        }
+      }
+      if (skip >= 0)
+      {
+        // the skipped literal must propagate an equality between terms
+        if (tdb->isEntailed(lits[skip], subs, true, true))
+        {
+          return true;
+        }
+        TNode lit = lits[skip].getKind() == NOT ? lits[skip][0] : lits[skip];
+        for (const Node& lc : lit)
+        {
+          if (tdb->getEntailedTerm(lc, subs, true).isNull())
+          {
+            return true;
+          }
+        }
+      }
+      std::vector<Node> terms(vals.begin(), vals.end());
+      if (!d_quantEngine->getInstantiate()->addInstantiation(q, terms))
+      {
+        Trace("qcf-inst") << "   ... Failed to add instantiation" << std::endl;
+        return true;
+      }
+      Trace("qcf-check") << "   ... Added instantiation from join plan"
+                         << std::endl;
+      ++addedLemmas;
+      d_quantEngine->markRelevant(q);
+      ++(d_quantEngine->d_statistics.d_instantiations_qcf);
+      if (skip >= 0)
+      {
+        ++(d_statistics.d_join_propagations);
+        return true;
+      }
+      ++(d_statistics.d_join_conflicts);
+      foundConflict = true;
+      return false;
+    });
+    if (d_quantEngine->inConflict())
+    {
+      break;
+    }
+  }
+  if (foundConflict)
+  {
+    if (options::qcfAllConflict())
+    {
+      isConflict = true;
+    }
+    else
+    {
+      d_conflict.set(true);
+    }
+  }
+}
+
 void QuantConflictFind::computeRelevantEqr() {
   if( d_needs_computeRelEqr ){
     d_needs_computeRelEqr = false;
@@ -2168,15 +2288,30 @@ void QuantConflictFind::debugPrintQuantBody( const char * c, Node q, Node n, boo
 
 QuantConflictFind::Statistics::Statistics():
   d_inst_rounds("QuantConflictFind::Inst_Rounds", 0),
-  d_entailment_checks("QuantConflictFind::Entailment_Checks",0)
+  d_entailment_checks("QuantConflictFind::Entailment_Checks",0),
+  d_match_time("QuantConflictFind::Match_Time"),
+  d_match_conflicts("QuantConflictFind::Match_Conflicts", 0),
+  d_join_time("QuantConflictFind::Join_Time"),
+  d_join_conflicts("QuantConflictFind::Join_Conflicts", 0),
+  d_join_propagations("QuantConflictFind::Join_Propagations", 0)
 {
   smtStatisticsRegistry()->registerStat(&d_inst_rounds);
   smtStatisticsRegistry()->registerStat(&d_entailment_checks);
+  smtStatisticsRegistry()->registerStat(&d_match_time);
+  smtStatisticsRegistry()->registerStat(&d_match_conflicts);
+  smtStatisticsRegistry()->registerStat(&d_join_time);
+  smtStatisticsRegistry()->registerStat(&d_join_conflicts);
+  smtStatisticsRegistry()->registerStat(&d_join_propagations);
 }
 
 QuantConflictFind::Statistics::~Statistics(){
   smtStatisticsRegistry()->unregisterStat(&d_inst_rounds);
   smtStatisticsRegistry()->unregisterStat(&d_entailment_checks);
+  smtStatisticsRegistry()->unregisterStat(&d_match_time);
+  smtStatisticsRegistry()->unregisterStat(&d_match_conflicts);
+  smtStatisticsRegistry()->unregisterStat(&d_join_time);
+  smtStatisticsRegistry()->unregisterStat(&d_join_conflicts);
+  smtStatisticsRegistry()->unregisterStat(&d_join_propagations);
 }
 
 TNode QuantConflictFind::getZero( Kind k ) {
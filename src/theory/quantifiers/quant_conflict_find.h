@@ -22,6 +22,7 @@
 
 #include "context/cdhashmap.h"
 #include "context/cdlist.h"
+#include "theory/quantifiers/join_plan.h"
 #include "theory/quantifiers/term_database.h"
 #include "theory/quantifiers_engine.h"
 
@@ -46,7 +47,7 @@ private:
   //MatchGen * getChild( int i ) { return &d_children[i]; }
   //current matching information
   std::vector< TermArgTrie * > d_qn;
-  std::vector< std::map< TNode, TermArgTrie >::iterator > d_qni;
+  std::vector< TermArgTrieMap::iterator > d_qni;
   bool doMatching( QuantConflictFind * p, QuantInfo * qi );
   //for matching : each index is either a variable or a ground term
   unsigned d_qni_size;
@@ -213,6 +214,19 @@ public:  //for ground terms
   TNode getZero( Kind k );
 private:
   std::map< Node, QuantInfo > d_qinfo;
+  /** the join plans of the quantified formulas, if qcfJoinPlan is true */
+  std::map<Node, JoinPlan> d_join_plans;
+  /** check join plan
+   *
+   * Adds the conflicting instances of q at the current effort if it is
+   * EFFORT_CONFLICT, or its propagating instances otherwise, found by
+   * evaluating plan. Increments addedLemmas for each instance that is added,
+   * and sets isConflict as in check.
+   */
+  void checkJoinPlan(Node q,
+                     JoinPlan& plan,
+                     int& addedLemmas,
+                     bool& isConflict);
 private:  //for equivalence classes
   // type -> list(eqc)
   std::map< TypeNode, std::vector< TNode > > d_eqcs;
@@ -266,6 +280,16 @@ public:
   public:
     IntStat d_inst_rounds;
     IntStat d_entailment_checks;
+    /** time spent matching by match generators */
+    TimerStat d_match_time;
+    /** conflicting instances found by match generators */
+    IntStat d_match_conflicts;
+    /** time spent evaluating join plans */
+    TimerStat d_join_time;
+    /** conflicting instances found by join plans */
+    IntStat d_join_conflicts;
+    /** propagating instances found by join plans */
+    IntStat d_join_propagations;
     Statistics();
     ~Statistics();
   };
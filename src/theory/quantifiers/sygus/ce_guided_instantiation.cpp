@@ -393,7 +393,8 @@ CegInstantiation::Statistics::Statistics()
       d_cegqi_si_lemmas("CegInstantiation::cegqi_lemmas_si", 0),
       d_solutions("CegConjecture::solutions", 0),
       d_candidate_rewrites_print("CegConjecture::candidate_rewrites_print", 0),
-      d_candidate_rewrites("CegConjecture::candidate_rewrites", 0)
+      d_candidate_rewrites("CegConjecture::candidate_rewrites", 0),
+      d_bottom_up_terms("CegConjecture::bottom_up_terms", 0)
 
 {
   smtStatisticsRegistry()->registerStat(&d_cegqi_lemmas_ce);
@@ -402,6 +403,7 @@ CegInstantiation::Statistics::Statistics()
   smtStatisticsRegistry()->registerStat(&d_solutions);
   smtStatisticsRegistry()->registerStat(&d_candidate_rewrites_print);
   smtStatisticsRegistry()->registerStat(&d_candidate_rewrites);
+  smtStatisticsRegistry()->registerStat(&d_bottom_up_terms);
 }
 
 CegInstantiation::Statistics::~Statistics(){
@@ -411,6 +413,7 @@ CegInstantiation::Statistics::~Statistics(){
   smtStatisticsRegistry()->unregisterStat(&d_solutions);
   smtStatisticsRegistry()->unregisterStat(&d_candidate_rewrites_print);
   smtStatisticsRegistry()->unregisterStat(&d_candidate_rewrites);
+  smtStatisticsRegistry()->unregisterStat(&d_bottom_up_terms);
 }
 
 }/* namespace CVC4::theory::quantifiers */
@@ -88,6 +88,7 @@ public:
     IntStat d_solutions;
     IntStat d_candidate_rewrites_print;
     IntStat d_candidate_rewrites;
+    IntStat d_bottom_up_terms;
     Statistics();
     ~Statistics();
   };/* class CegInstantiation::Statistics */
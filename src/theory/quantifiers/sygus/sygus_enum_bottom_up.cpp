@@ -0,0 +1,327 @@
+/*********************                                                        */
+/*! \file sygus_enum_bottom_up.cpp
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2018 by the authors listed in the file AUTHORS
+ ** in the top-level source directory) and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief Implementation of bottom-up enumeration of sygus terms up to
+ ** examples
+ **/
+
+#include "theory/quantifiers/sygus/sygus_enum_bottom_up.h"
+
+#include <algorithm>
+
+#include "expr/datatype.h"
+#include "theory/evaluator.h"
+#include "theory/quantifiers/sygus/term_database_sygus.h"
+#include "theory/rewriter.h"
+
+using namespace CVC4::kind;
+
+namespace CVC4 {
+namespace theory {
+namespace quantifiers {
+
+SygusEnumBottomUp::SygusEnumBottomUp()
+    : d_tds(nullptr),
+      d_size(0),
+      d_jobIndex(0),
+      d_numTerms(0),
+      d_numCandidates(0),
+      d_work(0),
+      d_maxArity(0),
+      d_maxNonEmptySize(0),
+      d_done(false)
+{
+}
+
+void SygusEnumBottomUp::initialize(
+    TermDbSygus* tds,
+    TypeNode tn,
+    const std::vector<std::vector<Node> >& examples)
+{
+  d_tds = tds;
+  d_tn = tn;
+  d_examples = examples;
+  d_done = !collectTypes(tn);
+  Trace("sygus-enum-bu") << "Initialize bottom-up enumeration for " << tn
+                         << " on " << examples.size() << " examples"
+                         << (d_done ? " (unsupported)" : "") << std::endl;
+}
+
+bool SygusEnumBottomUp::collectTypes(TypeNode tn)
+{
+  NodeManager* nm = NodeManager::currentNM();
+  std::vector<TypeNode> visit;
+  visit.push_back(tn);
+  while (!visit.empty())
+  {
+    TypeNode cur = visit.back();
+    visit.pop_back();
+    if (d_types.find(cur) != d_types.end())
+    {
+      continue;
+    }
+    if (!cur.isDatatype() || !cur.getDatatype().isSygus())
+    {
+      return false;
+    }
+    TypeInfo& ti = d_types[cur];
+    const Datatype& dt = cur.getDatatype();
+    std::vector<Node> vars;
+    Node vl = Node::fromExpr(dt.getSygusVarList());
+    if (!vl.isNull())
+    {
+      vars.insert(vars.end(), vl.begin(), vl.end());
+    }
+    for (const std::vector<Node>& ex : d_examples)
+    {
+      if (ex.size() != vars.size())
+      {
+        return false;
+      }
+    }
+    for (unsigned k = 0, ncons = dt.getNumConstructors(); k < ncons; k++)
+    {
+      ConsInfo ci;
+      ci.d_cons = Node::fromExpr(dt[k].getConstructor());
+      ci.d_vars = vars;
+      std::map<int, Node> pre;
+      bool success = true;
+      for (unsigned i = 0, nargs = dt[k].getNumArgs(); i < nargs; i++)
+      {
+        TypeNode at = d_tds->getArgType(dt[k], i);
+        // constructors with builtin arguments, e.g. for "any constant", are
+        // not supported
+        if (!at.isDatatype() || !at.getDatatype().isSygus())
+        {
+          success = false;
+          break;
+        }
+        ci.d_argTypes.push_back(at);
+        Node v = nm->mkBoundVar(
+            TypeNode::fromType(at.getDatatype().getSygusType()));
+        ci.d_vars.push_back(v);
+        pre[i] = v;
+      }
+      if (!success)
+      {
+        Trace("sygus-enum-bu") << "  skip constructor " << dt[k].getName()
+                               << " of " << cur << std::endl;
+        continue;
+      }
+      ci.d_builtin = d_tds->mkGeneric(dt, k, pre);
+      d_maxArity = std::max(d_maxArity, unsigned(ci.d_argTypes.size()));
+      visit.insert(visit.end(), ci.d_argTypes.begin(), ci.d_argTypes.end());
+      ti.d_cons.push_back(ci);
+    }
+  }
+  return true;
+}
+
+bool SygusEnumBottomUp::enumerate(unsigned maxWork, std::vector<Node>& terms)
+{
+  if (d_done)
+  {
+    return false;
+  }
+  TypeInfo& ti = d_types[d_tn];
+  unsigned nterms = ti.d_terms.size();
+  uint64_t maxTotalWork = d_work + maxWork;
+  while (!d_done && d_work < maxTotalWork)
+  {
+    if (d_jobIndex == d_jobs.size())
+    {
+      if (!startSize())
+      {
+        d_done = true;
+      }
+      continue;
+    }
+    const Job& job = d_jobs[d_jobIndex];
+    addCandidate(job);
+    if (!nextCursor(job))
+    {
+      d_jobIndex++;
+      d_cursor.clear();
+    }
+  }
+  for (unsigned i = nterms, size = ti.d_terms.size(); i < size; i++)
+  {
+    terms.push_back(ti.d_terms[i]);
+  }
+  return true;
+}
+
+bool SygusEnumBottomUp::startSize()
+{
+  // starting a size counts as one unit of work, so that the sizes without any
+  // jobs are bounded as well
+  d_work++;
+  if (d_size > 0)
+  {
+    Trace("sygus-enum-bu") << "Bottom-up enumeration for " << d_tn
+                           << ", size " << d_size << " : "
+                           << d_types[d_tn].d_bySize[d_size].size()
+                           << " new terms, " << d_numTerms << " / "
+                           << d_numCandidates << " terms kept" << std::endl;
+    if (d_size > d_maxArity * d_maxNonEmptySize)
+    {
+      // no job of size d_size+1 exists, nor of any larger size
+      Trace("sygus-enum-bu") << "Bottom-up enumeration for " << d_tn
+                             << " saturated at size " << d_maxNonEmptySize
+                             << std::endl;
+      return false;
+    }
+  }
+  d_size++;
+  for (std::pair<const TypeNode, TypeInfo>& t : d_types)
+  {
+    t.second.d_bySize.resize(d_size + 1);
+  }
+  d_jobs.clear();
+  d_jobIndex = 0;
+  d_cursor.clear();
+  for (std::pair<const TypeNode, TypeInfo>& t : d_types)
+  {
+    for (unsigned k = 0, ncons = t.second.d_cons.size(); k < ncons; k++)
+    {
+      unsigned nargs = t.second.d_cons[k].d_argTypes.size();
+      if (nargs == 0 ? d_size == 1 : d_size > nargs)
+      {
+        std::vector<unsigned> sizes;
+        enumerateSizes(t.first, k, d_size - 1, sizes);
+      }
+    }
+  }
+  return true;
+}
+
+void SygusEnumBottomUp::enumerateSizes(TypeNode tn,
+                                       unsigned cons,
+                                       unsigned size,
+                                       std::vector<unsigned>& sizes)
+{
+  d_work++;
+  const ConsInfo& ci = d_types[tn].d_cons[cons];
+  unsigned k = sizes.size();
+  unsigned nargs = ci.d_argTypes.size();
+  if (k == nargs)
+  {
+    if (size == 0)
+    {
+      Job job;
+      job.d_tn = tn;
+      job.d_cons = cons;
+      job.d_sizes = sizes;
+      d_jobs.push_back(job);
+    }
+    return;
+  }
+  // each remaining argument has size at least one
+  unsigned nrem = nargs - k - 1;
+  TypeInfo& ta = d_types[ci.d_argTypes[k]];
+  for (unsigned s = 1; s + nrem <= size; s++)
+  {
+    if (!ta.d_bySize[s].empty())
+    {
+      sizes.push_back(s);
+      enumerateSizes(tn, cons, size - s, sizes);
+      sizes.pop_back();
+    }
+  }
+}
+
+bool SygusEnumBottomUp::nextCursor(const Job& job)
+{
+  const ConsInfo& ci = d_types[job.d_tn].d_cons[job.d_cons];
+  // the terms of the argument types of size job.d_sizes[i] are not modified,
+  // since job.d_sizes[i] is less than the current size
+  for (unsigned i = d_cursor.size(); i-- > 0;)
+  {
+    unsigned ncands =
+        d_types[ci.d_argTypes[i]].d_bySize[job.d_sizes[i]].size();
+    if (++d_cursor[i] < ncands)
+    {
+      return true;
+    }
+    d_cursor[i] = 0;
+  }
+  return false;
+}
+
+void SygusEnumBottomUp::addCandidate(const Job& job)
+{
+  const ConsInfo& ci = d_types[job.d_tn].d_cons[job.d_cons];
+  unsigned nargs = ci.d_argTypes.size();
+  d_cursor.resize(nargs, 0);
+  // the points are the examples followed by the values of the children
+  std::vector<std::vector<Node> > points = d_examples;
+  std::vector<Node> children;
+  children.push_back(ci.d_cons);
+  for (unsigned i = 0; i < nargs; i++)
+  {
+    TypeInfo& ta = d_types[ci.d_argTypes[i]];
+    unsigned c = ta.d_bySize[job.d_sizes[i]][d_cursor[i]];
+    children.push_back(ta.d_terms[c]);
+    const std::vector<Node>& cvalues = ta.d_values[c];
+    for (unsigned j = 0, nex = points.size(); j < nex; j++)
+    {
+      points[j].push_back(cvalues[j]);
+    }
+  }
+  std::vector<Node> values;
+  evaluate(ci, points, values);
+  addTerm(job.d_tn, children, values);
+}
+
+void SygusEnumBottomUp::evaluate(const ConsInfo& ci,
+                                 const std::vector<std::vector<Node> >& points,
+                                 std::vector<Node>& values)
+{
+  d_tds->getEvaluator()->evalBatch(ci.d_builtin, ci.d_vars, points, values);
+  for (unsigned i = 0, npts = points.size(); i < npts; i++)
+  {
+    if (values[i].isNull())
+    {
+      // fall back on the rewriter
+      values[i] = Rewriter::rewrite(ci.d_builtin.substitute(ci.d_vars.begin(),
+                                                            ci.d_vars.end(),
+                                                            points[i].begin(),
+                                                            points[i].end()));
+    }
+  }
+}
+
+void SygusEnumBottomUp::addTerm(TypeNode tn,
+                                const std::vector<Node>& children,
+                                std::vector<Node>& values)
+{
+  d_numCandidates++;
+  d_work++;
+  TypeInfo& ti = d_types[tn];
+  if (ti.d_seen.insert(values).second)
+  {
+    Node n = NodeManager::currentNM()->mkNode(APPLY_CONSTRUCTOR, children);
+    Trace("sygus-enum-bu-debug") << "  keep " << n << std::endl;
+    ti.d_bySize[d_size].push_back(ti.d_terms.size());
+    ti.d_terms.push_back(n);
+    ti.d_values.push_back(values);
+    d_numTerms++;
+    d_maxNonEmptySize = d_size;
+  }
+  if (d_numTerms >= s_maxTerms || d_numCandidates >= s_maxCandidates)
+  {
+    Trace("sygus-enum-bu") << "Bottom-up enumeration for " << d_tn
+                           << " reached its limit" << std::endl;
+    d_done = true;
+  }
+}
+
+} /* CVC4::theory::quantifiers namespace */
+} /* CVC4::theory namespace */
+} /* CVC4 namespace */
@@ -0,0 +1,203 @@
+/*********************                                                        */
+/*! \file sygus_enum_bottom_up.h
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2018 by the authors listed in the file AUTHORS
+ ** in the top-level source directory) and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief Bottom-up enumeration of sygus terms up to examples
+ **/
+
+#include "cvc4_private.h"
+
+#ifndef __CVC4__THEORY__QUANTIFIERS__SYGUS_ENUM_BOTTOM_UP_H
+#define __CVC4__THEORY__QUANTIFIERS__SYGUS_ENUM_BOTTOM_UP_H
+
+#include <map>
+#include <set>
+#include <vector>
+
+#include "expr/node.h"
+
+namespace CVC4 {
+namespace theory {
+namespace quantifiers {
+
+class TermDbSygus;
+
+/** SygusEnumBottomUp
+ *
+ * This class enumerates the values of a sygus datatype type by increasing
+ * size, where the size of a term is its number of constructor applications,
+ * directly from the grammar instead of through the datatypes solver.
+ *
+ * Each term is evaluated on all input examples, and is kept only if its
+ * vector of values is different from those of the terms of the same type that
+ * were kept before. Since the value of a term on an example only depends on
+ * the values of its children, the terms of size n are built from the kept
+ * terms of smaller sizes, and their values are computed from the values of
+ * their children. The builtin term of each constructor is compiled once by the
+ * evaluator, and evaluated on all examples at once.
+ *
+ * For example, for the grammar:
+ *   A -> x | 1 | A+A
+ * and the examples x = 0, x = 1, the terms of size 1 are x and 1, with values
+ * (0,1) and (1,1), and the terms of size 3 are x+x, x+1 and 1+1, with values
+ * (0,2), (1,2) and (2,2), whereas 1+x is not kept since it has the values of
+ * x+1.
+ *
+ * The enumeration is incremental: each call to enumerate evaluates a bounded
+ * number of terms, and the next call resumes where it stopped.
+ */
+class SygusEnumBottomUp
+{
+ public:
+  SygusEnumBottomUp();
+  ~SygusEnumBottomUp() {}
+  /**
+   * Initialize this class to enumerate the values of the sygus datatype type
+   * tn, up to the examples, which are values for the variables of the
+   * grammar of tn.
+   */
+  void initialize(TermDbSygus* tds,
+                  TypeNode tn,
+                  const std::vector<std::vector<Node> >& examples);
+  /**
+   * Continue the enumeration by doing at most maxWork units of work (see
+   * getWork), and add the terms of type tn that were kept to terms. Returns
+   * false if the enumeration was already finished, either because there are
+   * no terms of larger size or because the maximum number of terms was
+   * reached.
+   */
+  bool enumerate(unsigned maxWork, std::vector<Node>& terms);
+  /** get the size of the terms being enumerated */
+  unsigned getSize() const { return d_size; }
+  /** get the number of terms that were evaluated */
+  unsigned getNumCandidates() const { return d_numCandidates; }
+  /**
+   * Get the units of work done so far, which are the number of terms that
+   * were evaluated plus the number of steps spent computing the jobs of each
+   * size.
+   */
+  uint64_t getWork() const { return d_work; }
+
+ private:
+  /** the maximum number of terms that are kept */
+  static const unsigned s_maxTerms = 100000;
+  /** the maximum number of terms that are evaluated */
+  static const unsigned s_maxCandidates = 10000000;
+  /** Information about a constructor of a sygus datatype */
+  struct ConsInfo
+  {
+    /** the constructor */
+    Node d_cons;
+    /** the types of its arguments */
+    std::vector<TypeNode> d_argTypes;
+    /** its builtin term, whose arguments are the variables below */
+    Node d_builtin;
+    /** the variables of the grammar followed by those of the arguments */
+    std::vector<Node> d_vars;
+  };
+  /** The terms of a sygus datatype type */
+  struct TypeInfo
+  {
+    /** the constructors that are supported */
+    std::vector<ConsInfo> d_cons;
+    /** the terms that were kept */
+    std::vector<Node> d_terms;
+    /** their values on the examples */
+    std::vector<std::vector<Node> > d_values;
+    /** the indices of the terms of each size */
+    std::vector<std::vector<unsigned> > d_bySize;
+    /** the values of the terms that were kept */
+    std::set<std::vector<Node> > d_seen;
+  };
+  /** The applications of a constructor whose arguments have fixed sizes */
+  struct Job
+  {
+    /** the type of the constructor */
+    TypeNode d_tn;
+    /** the index of the constructor in the information of d_tn */
+    unsigned d_cons;
+    /** the sizes of the arguments */
+    std::vector<unsigned> d_sizes;
+  };
+  /** collect the types of the grammar of tn, returns false if unsupported */
+  bool collectTypes(TypeNode tn);
+  /**
+   * Start the enumeration of the terms of the next size by computing its
+   * jobs, returns false if there are no terms of larger size.
+   *
+   * A term of size n applies a constructor to at most d_maxArity arguments
+   * whose sizes sum to n-1, each of which is at most the largest size that
+   * has terms. Hence once n-1 exceeds d_maxArity times that size, there are
+   * no terms of size n or larger, which happens when the values of the
+   * grammar saturate on the examples.
+   */
+  bool startSize();
+  /**
+   * Add the jobs of the constructor cons of tn for the sizes of its
+   * arguments whose sum is size, where the first sizes are in sizes.
+   */
+  void enumerateSizes(TypeNode tn,
+                      unsigned cons,
+                      unsigned size,
+                      std::vector<unsigned>& sizes);
+  /**
+   * Move d_cursor to the next arguments of job, returns false if there are
+   * none.
+   */
+  bool nextCursor(const Job& job);
+  /** evaluate and add the application of job to the arguments of d_cursor */
+  void addCandidate(const Job& job);
+  /** evaluate the builtin term of ci on points, stores the results in values */
+  void evaluate(const ConsInfo& ci,
+                const std::vector<std::vector<Node> >& points,
+                std::vector<Node>& values);
+  /**
+   * Add the term of type tn of the current size whose constructor and
+   * arguments are children, if its values are new.
+   */
+  void addTerm(TypeNode tn,
+               const std::vector<Node>& children,
+               std::vector<Node>& values);
+  /** pointer to the sygus term database */
+  TermDbSygus* d_tds;
+  /** the type being enumerated */
+  TypeNode d_tn;
+  /** the examples */
+  std::vector<std::vector<Node> > d_examples;
+  /** the information of each type of the grammar of d_tn */
+  std::map<TypeNode, TypeInfo> d_types;
+  /** the size of the terms being enumerated */
+  unsigned d_size;
+  /** the jobs of the current size */
+  std::vector<Job> d_jobs;
+  /** the index of the current job */
+  unsigned d_jobIndex;
+  /**
+   * the index of each argument of the current job among the terms of its
+   * type and size
+   */
+  std::vector<unsigned> d_cursor;
+  /** the number of terms that were kept */
+  unsigned d_numTerms;
+  /** the number of terms that were evaluated */
+  unsigned d_numCandidates;
+  /** the units of work done so far */
+  uint64_t d_work;
+  /** the maximum number of arguments of a supported constructor */
+  unsigned d_maxArity;
+  /** the largest size that has terms, of any type */
+  unsigned d_maxNonEmptySize;
+  /** whether the enumeration is finished */
+  bool d_done;
+};
+
+} /* CVC4::theory::quantifiers namespace */
+} /* CVC4::theory namespace */
+} /* CVC4 namespace */
+
+#endif /* __CVC4__THEORY__QUANTIFIERS__SYGUS_ENUM_BOTTOM_UP_H */
@@ -16,6 +16,8 @@
 
 #include "expr/datatype.h"
 #include "options/quantifiers_options.h"
+#include "options/smt_options.h"
+#include "theory/quantifiers/sygus/ce_guided_instantiation.h"
 #include "theory/quantifiers/sygus/term_database_sygus.h"
 #include "theory/quantifiers/term_util.h"
 #include "theory/datatypes/datatypes_rewriter.h"
@@ -204,6 +206,11 @@ bool CegConjecturePbe::initialize(Node n,
       Node g = d_tds->getActiveGuardForEnumerator(e);
       d_enum_to_active_guard[e] = g;
       d_enum_to_candidate[e] = c;
+      if (options::sygusPbeBottomUp())
+      {
+        d_enum_bottom_up[e].reset(new SygusEnumBottomUp);
+        d_enum_bottom_up[e]->initialize(d_tds, etn, d_examples[c]);
+      }
       TNode te = e;
       // initialize static symmetry breaking lemmas for it
       // we register only one "master" enumerator per type
@@ -466,6 +473,10 @@ bool CegConjecturePbe::constructCandidates(const std::vector<Node>& enums,
   }
   for( unsigned i=0; i<candidates.size(); i++ ){
     Node c = candidates[i];
+    if (options::sygusPbeBottomUp())
+    {
+      enumerateBottomUp(c);
+    }
     //build decision tree for candidate
     std::vector<Node> sol;
     if (d_sygus_unif[c].constructSolution(sol, lems))
@@ -481,6 +492,47 @@ bool CegConjecturePbe::constructCandidates(const std::vector<Node>& enums,
   return true;
 }
 
+void CegConjecturePbe::enumerateBottomUp(Node c)
+{
+  std::map<Node, std::vector<Node> >::iterator it =
+      d_candidate_to_enum.find(c);
+  if (it == d_candidate_to_enum.end())
+  {
+    return;
+  }
+  for (const Node& e : it->second)
+  {
+    std::map<Node, std::unique_ptr<SygusEnumBottomUp> >::iterator itb =
+        d_enum_bottom_up.find(e);
+    if (itb == d_enum_bottom_up.end())
+    {
+      continue;
+    }
+    std::vector<Node> values;
+    uint64_t work = itb->second->getWork();
+    if (!itb->second->enumerate(s_bottomUpWorkPerCall, values))
+    {
+      continue;
+    }
+    // charge the work of the enumeration, which also checks for an interrupt
+    work = itb->second->getWork() - work;
+    d_qe->getOutputChannel().safePoint(options::quantifierStep() * work);
+    Trace("sygus-pbe-enum") << "Register " << values.size()
+                            << " values up to size " << itb->second->getSize()
+                            << " enumerated bottom-up for " << e << std::endl;
+    d_qe->getCegInstantiation()->d_statistics.d_bottom_up_terms +=
+        values.size();
+    for (const Node& v : values)
+    {
+      // The exclusion lemmas for these values are not sent, since they would
+      // be as many as the values. The datatypes solver may thus enumerate
+      // them again, in which case the unification utility ignores them.
+      std::vector<Node> enum_lems;
+      d_sygus_unif[c].notifyEnumeration(e, v, enum_lems);
+    }
+  }
+}
+
 }
 }
 }
@@ -17,7 +17,10 @@
 #ifndef __CVC4__THEORY__QUANTIFIERS__CE_GUIDED_PBE_H
 #define __CVC4__THEORY__QUANTIFIERS__CE_GUIDED_PBE_H
 
+#include <memory>
+
 #include "context/cdhashmap.h"
+#include "theory/quantifiers/sygus/sygus_enum_bottom_up.h"
 #include "theory/quantifiers/sygus/sygus_module.h"
 #include "theory/quantifiers/sygus/sygus_unif_io.h"
 
@@ -89,6 +92,9 @@ class CegConjecture;
 *     current model. This call also requests that based on these
 *     newly enumerated values, whether this class is now able to construct a
 *     solution based on the high-level strategy (stored in d_sygus_unif).
+*     If options::sygusPbeBottomUp() is true, the values of the enumerators
+*     of the next size that are enumerated bottom-up from the grammar
+*     (see SygusEnumBottomUp) are also registered.
 *
 * This class is not designed to work in incremental mode, since there is no way
 * to specify incremental problems in SyguS.
@@ -227,6 +233,19 @@ class CegConjecturePbe : public SygusModule
   std::map<Node, Node> d_enum_to_candidate;
   /** map from enumerators to active guards */
   std::map<Node, Node> d_enum_to_active_guard;
+  /** map from enumerators to their bottom-up enumeration */
+  std::map<Node, std::unique_ptr<SygusEnumBottomUp> > d_enum_bottom_up;
+  /**
+   * The maximum units of work that the bottom-up enumeration of an
+   * enumerator does per call to enumerateBottomUp, see
+   * SygusEnumBottomUp::getWork.
+   */
+  static const unsigned s_bottomUpWorkPerCall = 10000;
+  /**
+   * Continue the bottom-up enumeration of the enumerators of candidate c,
+   * and register the terms it kept.
+   */
+  void enumerateBottomUp(Node c);
   /** for each candidate variable (function-to-synthesize), input of I/O
    * examples */
   std::map<Node, std::vector<std::vector<Node> > > d_examples;
@@ -512,17 +512,17 @@ void SygusUnifIo::notifyEnumeration(Node e, Node v, std::vector<Node>& lemmas)
   Node bv = d_tds->sygusToBuiltin(v, xtn);
   std::vector<Node> base_results;
   // compte the results
-  for (unsigned j = 0, size = d_examples.size(); j < size; j++)
+  d_tds->evaluateBuiltin(xtn, bv, d_examples, base_results);
+  for (const Node& res : base_results)
   {
-    Node res = d_tds->evaluateBuiltin(xtn, bv, d_examples[j]);
     Trace("sygus-sui-enum-debug")
         << "...got res = " << res << " from " << bv << std::endl;
-    base_results.push_back(res);
   }
   // get the results for each slave enumerator
   std::map<Node, std::vector<Node>> srmap;
   Evaluator* ev = d_tds->getEvaluator();
   bool tryEval = options::sygusEvalOpt();
+  bool compiled = tryEval && options::sygusEvalCompile();
   for (const Node& xs : ei.d_enum_slave)
   {
     Assert(srmap.find(xs) == srmap.end());
@@ -534,14 +534,25 @@ void SygusUnifIo::notifyEnumeration(Node e, Node v, std::vector<Node>& lemmas)
       std::vector<Node> args;
       args.push_back(templ_var);
       std::vector<Node> sresults;
-      for (const Node& res : base_results)
+      if (compiled)
       {
-        TNode tres = res;
-        std::vector<Node> vals;
-        vals.push_back(tres);
-        Node sres;
-        if (tryEval)
+        // evaluate the template on all results at once
+        std::vector<std::vector<Node>> points;
+        for (const Node& res : base_results)
         {
+          points.push_back(std::vector<Node>(1, res));
+        }
+        ev->evalBatch(templ, args, points, sresults);
+      }
+      sresults.resize(base_results.size());
+      for (unsigned j = 0, size = base_results.size(); j < size; j++)
+      {
+        TNode tres = base_results[j];
+        Node& sres = sresults[j];
+        if (tryEval && !compiled)
+        {
+          std::vector<Node> vals;
+          vals.push_back(tres);
           sres = ev->eval(templ, args, vals);
         }
         if (sres.isNull())
@@ -550,7 +561,6 @@ void SygusUnifIo::notifyEnumeration(Node e, Node v, std::vector<Node>& lemmas)
           sres = templ.substitute(templ_var, tres);
           sres = Rewriter::rewrite(sres);
         }
-        sresults.push_back(sres);
       }
       srmap[xs] = sresults;
     }
@@ -1329,6 +1329,40 @@ Node TermDbSygus::evaluateBuiltin(TypeNode tn,
   }
 }
 
+void TermDbSygus::evaluateBuiltin(
+    TypeNode tn,
+    Node bn,
+    const std::vector<std::vector<Node> >& points,
+    std::vector<Node>& results)
+{
+  results.clear();
+  std::map<TypeNode, std::vector<Node> >::iterator it = d_var_list.find(tn);
+  bool compiled = options::sygusEvalOpt() && options::sygusEvalCompile()
+                  && it != d_var_list.end();
+  if (compiled)
+  {
+    d_eval->evalBatch(bn, it->second, points, results);
+  }
+  results.resize(points.size());
+  for (unsigned i = 0, npts = points.size(); i < npts; i++)
+  {
+    if (results[i].isNull())
+    {
+      // the evaluator was already tried if bn was compiled
+      std::vector<Node> args = points[i];
+      results[i] = evaluateBuiltin(tn, bn, args, !compiled);
+    }
+    else
+    {
+      Assert(results[i]
+             == Rewriter::rewrite(bn.substitute(it->second.begin(),
+                                                it->second.end(),
+                                                points[i].begin(),
+                                                points[i].end())));
+    }
+  }
+}
+
 Node TermDbSygus::evaluateWithUnfolding(
     Node n, std::unordered_map<Node, Node, NodeHashFunction>& visited)
 {
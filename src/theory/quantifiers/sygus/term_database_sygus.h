@@ -201,6 +201,16 @@ class TermDbSygus {
                        Node bn,
                        std::vector<Node>& args,
                        bool tryEval = true);
+  /** evaluate builtin on many points
+   *
+   * Stores in results the result of evaluateBuiltin( tn, bn, pt ) for each pt
+   * in points. If options::sygusEvalCompile() is true, bn is compiled by the
+   * evaluator and evaluated on all points at once.
+   */
+  void evaluateBuiltin(TypeNode tn,
+                       Node bn,
+                       const std::vector<std::vector<Node> >& points,
+                       std::vector<Node>& results);
   /** evaluate with unfolding
    *
    * n is any term that may involve sygus evaluation functions. This function
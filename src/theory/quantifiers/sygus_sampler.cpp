@@ -452,7 +452,9 @@ Node SygusSampler::evaluate(Node n, unsigned index)
   // do beta-reductions in n first
   n = Rewriter::rewrite(n);
   // use efficient rewrite for substitution + rewrite
-  Node ev = d_eval.eval(n, d_vars, d_samples[index]);
+  Node ev = options::sygusEvalCompile()
+                ? d_eval.evalCached(n, d_vars, d_samples[index])
+                : d_eval.eval(n, d_vars, d_samples[index]);
   Trace("sygus-sample-ev") << "Evaluate ( " << n << ", " << index << " ) -> ";
   if (!ev.isNull())
   {
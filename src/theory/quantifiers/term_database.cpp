@@ -32,6 +32,174 @@ namespace CVC4 {
 namespace theory {
 namespace quantifiers {
 
+TermArgTrieMap::TermArgTrieMap(const TermArgTrieMap& m)
+    : d_numEntries(0), d_size(0), d_indexSlots(0)
+{
+  for (unsigned i = 0; i < m.d_numEntries; i++)
+  {
+    const Entry& e = m.getEntry(i);
+    if (!e.first.isNull())
+    {
+      (*this)[e.first] = e.second;
+    }
+  }
+}
+
+TermArgTrieMap::TermArgTrieMap(TermArgTrieMap&& m)
+    : d_chunks(std::move(m.d_chunks)),
+      d_numEntries(m.d_numEntries),
+      d_size(m.d_size),
+      d_index(std::move(m.d_index)),
+      d_indexSlots(m.d_indexSlots)
+{
+  m.d_chunks.clear();
+  m.d_numEntries = 0;
+  m.d_size = 0;
+  m.d_index.clear();
+  m.d_indexSlots = 0;
+}
+
+TermArgTrieMap::~TermArgTrieMap() { clear(); }
+
+TermArgTrieMap& TermArgTrieMap::operator=(TermArgTrieMap m)
+{
+  std::swap(d_chunks, m.d_chunks);
+  std::swap(d_numEntries, m.d_numEntries);
+  std::swap(d_size, m.d_size);
+  std::swap(d_index, m.d_index);
+  std::swap(d_indexSlots, m.d_indexSlots);
+  return *this;
+}
+
+TermArgTrieMap::iterator TermArgTrieMap::find(TNode n)
+{
+  return iterator(this, findIndex(n));
+}
+
+unsigned TermArgTrieMap::findIndex(TNode n) const
+{
+  if (n.isNull())
+  {
+    return d_numEntries;
+  }
+  if (d_index.empty())
+  {
+    for (unsigned i = 0; i < d_numEntries; i++)
+    {
+      if (getEntry(i).first == n)
+      {
+        return i;
+      }
+    }
+    return d_numEntries;
+  }
+  size_t mask = d_index.size() - 1;
+  for (size_t h = TNodeHashFunction()(n) & mask; d_index[h] != 0;
+       h = (h + 1) & mask)
+  {
+    // slots of erased entries may refer to entries reused by other nodes
+    if (getEntry(d_index[h] - 1).first == n)
+    {
+      return d_index[h] - 1;
+    }
+  }
+  return d_numEntries;
+}
+
+TermArgTrie& TermArgTrieMap::operator[](TNode n)
+{
+  Assert(!n.isNull());
+  unsigned i = findIndex(n);
+  if (i < d_numEntries)
+  {
+    return getEntry(i).second;
+  }
+  if (d_size < d_numEntries)
+  {
+    // reuse the place of an erased entry
+    for (i = 0; !getEntry(i).first.isNull(); i++)
+    {
+    }
+  }
+  else
+  {
+    if (d_numEntries + 1 == (1u << d_chunks.size()))
+    {
+      d_chunks.push_back(new Entry[1u << d_chunks.size()]);
+    }
+    d_numEntries++;
+  }
+  d_size++;
+  Entry& e = getEntry(i);
+  e.first = n;
+  if (d_numEntries > s_linearSize)
+  {
+    addToIndex(i);
+  }
+  return e.second;
+}
+
+void TermArgTrieMap::erase(iterator it)
+{
+  Entry& e = getEntry(it.d_index);
+  Assert(!e.first.isNull());
+  e.first = TNode::null();
+  e.second.clear();
+  d_size--;
+}
+
+void TermArgTrieMap::clear()
+{
+  for (Entry* chunk : d_chunks)
+  {
+    delete[] chunk;
+  }
+  d_chunks.clear();
+  d_numEntries = 0;
+  d_size = 0;
+  d_index.clear();
+  d_indexSlots = 0;
+}
+
+void TermArgTrieMap::addToIndex(unsigned i)
+{
+  // keep the table at most half full, the slots of erased entries included
+  if (2 * (d_indexSlots + 1) > d_index.size())
+  {
+    rebuildIndex(4 * (size_t(1) << d_chunks.size()));
+    return;
+  }
+  size_t mask = d_index.size() - 1;
+  size_t h = TNodeHashFunction()(getEntry(i).first) & mask;
+  while (d_index[h] != 0)
+  {
+    h = (h + 1) & mask;
+  }
+  d_index[h] = i + 1;
+  d_indexSlots++;
+}
+
+void TermArgTrieMap::rebuildIndex(size_t capacity)
+{
+  d_index.assign(capacity, 0);
+  d_indexSlots = 0;
+  size_t mask = capacity - 1;
+  for (unsigned i = 0; i < d_numEntries; i++)
+  {
+    TNode n = getEntry(i).first;
+    if (!n.isNull())
+    {
+      size_t h = TNodeHashFunction()(n) & mask;
+      while (d_index[h] != 0)
+      {
+        h = (h + 1) & mask;
+      }
+      d_index[h] = i + 1;
+      d_indexSlots++;
+    }
+  }
+}
+
 TNode TermArgTrie::existsTerm( std::vector< TNode >& reps, int argIndex ) {
   if( argIndex==(int)reps.size() ){
     if( d_data.empty() ){
@@ -40,7 +208,7 @@ TNode TermArgTrie::existsTerm( std::vector< TNode >& reps, int argIndex ) {
       return d_data.begin()->first;
     }
   }else{
-    std::map< TNode, TermArgTrie >::iterator it = d_data.find( reps[argIndex] );
+    TermArgTrieMap::iterator it = d_data.find( reps[argIndex] );
     if( it==d_data.end() ){
       return Node::null();
     }else{
@@ -53,6 +221,24 @@ bool TermArgTrie::addTerm( TNode n, std::vector< TNode >& reps, int argIndex ){
   return addOrGetTerm( n, reps, argIndex )==n;
 }
 
+void TermArgTrie::remove(std::vector<TNode>& reps, int argIndex)
+{
+  if (argIndex == (int)reps.size())
+  {
+    d_data.clear();
+    return;
+  }
+  TermArgTrieMap::iterator it = d_data.find(reps[argIndex]);
+  if (it != d_data.end())
+  {
+    it->second.remove(reps, argIndex + 1);
+    if (it->second.empty())
+    {
+      d_data.erase(it);
+    }
+  }
+}
+
 TNode TermArgTrie::addOrGetTerm( TNode n, std::vector< TNode >& reps, int argIndex ) {
   if( argIndex==(int)reps.size() ){
     if( d_data.empty() ){
@@ -68,7 +254,7 @@ TNode TermArgTrie::addOrGetTerm( TNode n, std::vector< TNode >& reps, int argInd
 }
 
 void TermArgTrie::debugPrint( const char * c, Node n, unsigned depth ) {
-  for( std::map< TNode, TermArgTrie >::iterator it = d_data.begin(); it != d_data.end(); ++it ){
+  for( TermArgTrieMap::iterator it = d_data.begin(); it != d_data.end(); ++it ){
     for( unsigned i=0; i<depth; i++ ){ Trace(c) << "  "; }
     Trace(c) << it->first << std::endl;
     it->second.debugPrint( c, n, depth+1 );
@@ -78,8 +264,16 @@ void TermArgTrie::debugPrint( const char * c, Node n, unsigned depth ) {
 TermDb::TermDb(context::Context* c, context::UserContext* u,
                QuantifiersEngine* qe)
     : d_quantEngine(qe),
-      d_inactive_map(c) {
+      d_inactive_map(c),
+      d_index_version(c, 0),
+      d_index_last_version(0)
+{
   d_consistent_ee = true;
+  // the relevant terms and the operators of higher-order terms change
+  // without notice between rounds
+  d_incremental_index = options::termDbIncremental()
+                        && options::termDbMode() == TERM_DB_ALL
+                        && !options::ufHo();
   d_true = NodeManager::currentNM()->mkConst(true);
   d_false = NodeManager::currentNM()->mkConst(false);
 }
@@ -329,6 +523,11 @@ void TermDb::computeUfTerms( TNode f ) {
   }
   Assert( f==getOperatorRepresentative( f ) );
   d_op_nonred_count[f] = 0;
+  if (d_incremental_index && !d_quantEngine->usingModelEqualityEngine())
+  {
+    indexUfTerms(f);
+    return;
+  }
   // get the matchable operators in the equivalence class of f
   std::vector<TNode> ops;
   ops.push_back(f);
@@ -467,6 +666,119 @@ void TermDb::computeUfTerms( TNode f ) {
   }
 }
 
+void TermDb::indexUfTerms(TNode f)
+{
+  eq::EqualityEngine* ee = d_quantEngine->getActiveEqualityEngine();
+  TermArgTrie& tat = d_func_map_trie[f];
+  std::vector<Node>& indexed = d_op_indexed[f];
+  std::vector<Node>& unindexed = d_op_unindexed[f];
+  // the terms to add to the index
+  std::vector<Node> toAdd;
+  // remove the terms whose argument representatives changed
+  size_t nkeep = 0;
+  for (const Node& n : indexed)
+  {
+    std::vector<TNode>& reps = d_indexed_reps[n];
+    if (isTermActive(n))
+    {
+      computeArgReps(n);
+      if (reps == d_arg_reps[n])
+      {
+        indexed[nkeep++] = n;
+        continue;
+      }
+      toAdd.push_back(n);
+    }
+    tat.remove(reps);
+    d_indexed_reps.erase(n);
+  }
+  Trace("term-db-index") << "Index " << f << " : keep " << nkeep << " / "
+                         << indexed.size() << " terms" << std::endl;
+  indexed.resize(nkeep);
+  toAdd.insert(toAdd.end(), unindexed.begin(), unindexed.end());
+  unindexed.clear();
+  std::map<Node, std::vector<Node> >::iterator it = d_op_map.find(f);
+  if (it != d_op_map.end())
+  {
+    toAdd.insert(
+        toAdd.end(), it->second.begin() + d_op_examined[f], it->second.end());
+    d_op_examined[f] = it->second.size();
+  }
+  for (const Node& n : toAdd)
+  {
+    if (!isTermActive(n))
+    {
+      continue;
+    }
+    if (!ee->hasTerm(n))
+    {
+      unindexed.push_back(n);
+      continue;
+    }
+    computeArgReps(n);
+    Node at = tat.addOrGetTerm(n, d_arg_reps[n]);
+    if (at == n)
+    {
+      indexed.push_back(n);
+      d_indexed_reps[n] = d_arg_reps[n];
+      continue;
+    }
+    if (ee->areEqual(at, n))
+    {
+      setTermInactive(n);
+      Trace("term-db-debug") << n << " is redundant." << std::endl;
+      continue;
+    }
+    if (ee->areDisequal(at, n, false))
+    {
+      NodeManager* nm = NodeManager::currentNM();
+      std::vector<Node> lits;
+      lits.push_back(nm->mkNode(EQUAL, at, n));
+      for (unsigned k = 0, size = at.getNumChildren(); k < size; k++)
+      {
+        if (at[k] != n[k])
+        {
+          lits.push_back(nm->mkNode(EQUAL, at[k], n[k]).negate());
+        }
+      }
+      Node lem = lits.size() == 1 ? lits[0] : nm->mkNode(OR, lits);
+      Trace("term-db-lemma") << "Disequal congruent terms : " << at << " " << n
+                             << ", add lemma : " << lem << std::endl;
+      d_quantEngine->addLemma(lem);
+      d_quantEngine->setConflict();
+      d_consistent_ee = false;
+      // the index is incomplete, rebuild it on the next round
+      d_index_last_version++;
+      return;
+    }
+    unindexed.push_back(n);
+  }
+  // compute the relevant domain and the non-redundant terms
+  std::map<unsigned, std::vector<Node> >& relDom = d_func_map_rel_dom[f];
+  int nonred = 0;
+  for (unsigned l = 0; l < 2; l++)
+  {
+    for (const Node& n : l == 0 ? indexed : unindexed)
+    {
+      if (l == 1 && !ee->hasTerm(n))
+      {
+        continue;
+      }
+      nonred++;
+      std::vector<TNode>& reps = d_arg_reps[n];
+      for (unsigned i = 0, size = reps.size(); i < size; i++)
+      {
+        if (std::find(relDom[i].begin(), relDom[i].end(), reps[i])
+            == relDom[i].end())
+        {
+          relDom[i].push_back(reps[i]);
+        }
+      }
+    }
+  }
+  d_op_nonred_count[f] = nonred;
+}
+
 void TermDb::addTermHo(Node n,
                        std::set<Node>& added,
                        bool withinQuant,
@@ -908,10 +1220,26 @@ void TermDb::presolve() {
 bool TermDb::reset( Theory::Effort effort ){
   d_op_nonred_count.clear();
   d_arg_reps.clear();
-  d_func_map_trie.clear();
   d_func_map_eqc_trie.clear();
   d_func_map_rel_dom.clear();
   d_consistent_ee = true;
+  // keep the term indices of the previous round if we did not backtrack
+  // since then, and they were built with the master equality engine
+  bool useMaster = !d_quantEngine->usingModelEqualityEngine();
+  if (!d_incremental_index || !useMaster
+      || d_index_version.get() != d_index_last_version)
+  {
+    d_func_map_trie.clear();
+    d_op_indexed.clear();
+    d_op_unindexed.clear();
+    d_op_examined.clear();
+    d_indexed_reps.clear();
+  }
+  d_index_last_version++;
+  if (d_incremental_index && useMaster)
+  {
+    d_index_version = d_index_last_version;
+  }
 
   eq::EqualityEngine* ee = d_quantEngine->getActiveEqualityEngine();
 
@@ -1081,7 +1409,7 @@ TermArgTrie * TermDb::getTermArgTrie( Node eqc, Node f ) {
     if( eqc.isNull() ){
       return &itut->second;
     }else{
-      std::map< TNode, TermArgTrie >::iterator itute = itut->second.d_data.find( eqc );
+      TermArgTrieMap::iterator itute = itut->second.d_data.find( eqc );
       if( itute!=itut->second.d_data.end() ){
         return &itute->second;
       }else{
@@ -19,7 +19,9 @@
 
 #include <map>
 #include <unordered_set>
+#include <vector>
 
+#include "context/cdo.h"
 #include "expr/attribute.h"
 #include "theory/theory.h"
 #include "theory/type_enumerator.h"
@@ -37,6 +39,92 @@ namespace inst{
 
 namespace quantifiers {
 
+class TermArgTrie;
+
+/** Term arg trie map
+ *
+ * The children of a node of a TermArgTrie, which map representatives to
+ * tries. It has the part of the interface of std::map that the users of
+ * TermArgTrie::d_data rely on, but is more compact: most nodes of a trie have
+ * a single child, for which std::map allocates a tree node.
+ *
+ * The entries are allocated in chunks of sizes 1, 2, 4, ... that are never
+ * moved, so that, as for std::map, references and iterators to entries stay
+ * valid until they are erased. Lookups scan the entries if there are at most
+ * s_linearSize of them, and use an open addressing hash table on the node ids
+ * otherwise. Iteration is in the order the entries were added, except that
+ * an entry may reuse the place of an erased one.
+ */
+class TermArgTrieMap
+{
+ public:
+  /** an entry, whose first is null if it was erased */
+  struct Entry;
+  class iterator
+  {
+   public:
+    iterator() : d_map(nullptr), d_index(0) {}
+    iterator(TermArgTrieMap* m, unsigned i) : d_map(m), d_index(i) {}
+    Entry& operator*() const;
+    Entry* operator->() const;
+    iterator& operator++();
+    iterator operator++(int)
+    {
+      iterator it = *this;
+      ++(*this);
+      return it;
+    }
+    bool operator==(const iterator& it) const { return d_index == it.d_index; }
+    bool operator!=(const iterator& it) const { return d_index != it.d_index; }
+
+   private:
+    friend class TermArgTrieMap;
+    TermArgTrieMap* d_map;
+    unsigned d_index;
+  };
+  TermArgTrieMap() : d_numEntries(0), d_size(0), d_indexSlots(0) {}
+  TermArgTrieMap(const TermArgTrieMap& m);
+  TermArgTrieMap(TermArgTrieMap&& m);
+  ~TermArgTrieMap();
+  TermArgTrieMap& operator=(TermArgTrieMap m);
+  iterator begin();
+  iterator end() { return iterator(this, d_numEntries); }
+  /** the entry of n, or end() */
+  iterator find(TNode n);
+  /** the trie of n, which is added if there is none */
+  TermArgTrie& operator[](TNode n);
+  /** erase the entry of it */
+  void erase(iterator it);
+  void clear();
+  bool empty() const { return d_size == 0; }
+  size_t size() const { return d_size; }
+
+ private:
+  /** the number of entries up to which lookups do not use d_index */
+  static const unsigned s_linearSize = 8;
+  /** d_chunks[c] is an array of 2^c entries */
+  std::vector<Entry*> d_chunks;
+  /** the number of entries used, including the erased ones */
+  unsigned d_numEntries;
+  /** the number of entries that are not erased */
+  unsigned d_size;
+  /**
+   * Open addressing hash table of the entries if there are more than
+   * s_linearSize, where 0 is an empty slot and i+1 refers to entry i.
+   */
+  std::vector<unsigned> d_index;
+  /** the number of slots of d_index that are not empty */
+  unsigned d_indexSlots;
+  /** get entry i */
+  Entry& getEntry(unsigned i) const;
+  /** the index of the entry of n, or d_numEntries */
+  unsigned findIndex(TNode n) const;
+  /** add i to d_index, rebuilding it if it is too full */
+  void addToIndex(unsigned i);
+  /** rebuild d_index with capacity slots */
+  void rebuildIndex(size_t capacity);
+};/* class TermArgTrieMap */
+
 /** Term arg trie class
 *
 * This also referred to as a "term index" or a "signature table".
@@ -70,12 +158,12 @@ namespace quantifiers {
 class TermArgTrie {
 public:
   /** the data */
-  std::map< TNode, TermArgTrie > d_data;
+  TermArgTrieMap d_data;
 public:
  /** for leaf nodes : does this trie have data? */
  bool hasNodeData() { return !d_data.empty(); }
  /** for leaf nodes : get term corresponding to this leaf */
- TNode getNodeData() { return d_data.begin()->first; }
+ TNode getNodeData();
  /** exists term
  * Returns the term that is indexed by reps, if one exists, or
  * or returns null otherwise.
@@ -92,6 +180,8 @@ public:
  *   and adds n to the trie, indexed by reps, and returns n.
  */
  bool addTerm(TNode n, std::vector<TNode>& reps, int argIndex = 0);
+ /** remove the term indexed by reps (if one exists) */
+ void remove(std::vector<TNode>& reps, int argIndex = 0);
  /** debug print this trie */
  void debugPrint(const char* c, Node n, unsigned depth = 0);
  /** clear all data from this trie */
@@ -100,6 +190,51 @@ public:
  bool empty() { return d_data.empty(); }
 };/* class TermArgTrie */
 
+struct TermArgTrieMap::Entry
+{
+  TNode first;
+  TermArgTrie second;
+};
+
+inline TermArgTrieMap::Entry& TermArgTrieMap::getEntry(unsigned i) const
+{
+  // entry i is at i + 1 - 2^c in chunk c, where 2^c <= i + 1 < 2^(c+1)
+  unsigned c = 31 - __builtin_clz(i + 1);
+  return d_chunks[c][i + 1 - (1u << c)];
+}
+
+inline TermArgTrieMap::Entry& TermArgTrieMap::iterator::operator*() const
+{
+  return d_map->getEntry(d_index);
+}
+
+inline TermArgTrieMap::Entry* TermArgTrieMap::iterator::operator->() const
+{
+  return &d_map->getEntry(d_index);
+}
+
+inline TermArgTrieMap::iterator& TermArgTrieMap::iterator::operator++()
+{
+  do
+  {
+    d_index++;
+  } while (d_index < d_map->d_numEntries
+           && d_map->getEntry(d_index).first.isNull());
+  return *this;
+}
+
+inline TermArgTrieMap::iterator TermArgTrieMap::begin()
+{
+  iterator it(this, 0);
+  if (d_numEntries > 0 && getEntry(0).first.isNull())
+  {
+    ++it;
+  }
+  return it;
+}
+
+inline TNode TermArgTrie::getNodeData() { return d_data.begin()->first; }
+
 namespace fmcheck {
   class FullModelChecker;
 }
@@ -362,6 +497,39 @@ class TermDb : public QuantifiersUtil {
   std::map< Node, TermArgTrie > d_func_map_eqc_trie;
   /** mapping from operators to their representative relevant domains */
   std::map< Node, std::map< unsigned, std::vector< Node > > > d_func_map_rel_dom;
+  //------------------------------incremental term indexing
+  /**
+   * Whether d_func_map_trie is kept between instantiation rounds, in which
+   * case only the terms whose argument representatives changed are indexed
+   * again (see indexUfTerms).
+   */
+  bool d_incremental_index;
+  /**
+   * Context dependent version of the term indices, which is changed at each
+   * reset. If it differs from d_index_last_version, then we backtracked
+   * since the last reset and the term indices are rebuilt.
+   */
+  context::CDO<unsigned> d_index_version;
+  /** the version of the term indices set at the last reset */
+  unsigned d_index_last_version;
+  /** map from operators to the terms stored in d_func_map_trie */
+  std::map< Node, std::vector< Node > > d_op_indexed;
+  /**
+   * Map from operators to the active terms that are not stored in
+   * d_func_map_trie, e.g. since they are not in the equality engine yet.
+   */
+  std::map< Node, std::vector< Node > > d_op_unindexed;
+  /** map from operators to the number of terms of d_op_map examined */
+  std::map< Node, size_t > d_op_examined;
+  /** the argument representatives under which terms are stored */
+  std::map< TNode, std::vector< TNode > > d_indexed_reps;
+  /** index uf terms
+   *
+   * Incremental version of computeUfTerms, which updates d_func_map_trie[f]
+   * from the previous round.
+   */
+  void indexUfTerms(TNode f);
+  //------------------------------end incremental term indexing
   /** has map */
   std::map< Node, bool > d_has_map;
   /** map from reps to a term in eqc in d_has_map */
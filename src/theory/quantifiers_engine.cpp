@@ -24,9 +24,11 @@
 #include "theory/quantifiers/bv_inverter.h"
 #include "theory/quantifiers/cegqi/inst_strategy_cbqi.h"
 #include "theory/quantifiers/conjecture_generator.h"
+#include "theory/quantifiers/ematching/code_tree.h"
 #include "theory/quantifiers/ematching/inst_strategy_e_matching.h"
 #include "theory/quantifiers/ematching/instantiation_engine.h"
 #include "theory/quantifiers/ematching/trigger.h"
+#include "theory/quantifiers/ematching/trigger_events.h"
 #include "theory/quantifiers/equality_infer.h"
 #include "theory/quantifiers/equality_query.h"
 #include "theory/quantifiers/first_order_model.h"
@@ -75,6 +77,8 @@ QuantifiersEngine::QuantifiersEngine(context::Context* c,
       d_eq_inference(nullptr),
       d_inst_prop(nullptr),
       d_tr_trie(new inst::TriggerTrie),
+      d_code_tree(nullptr),
+      d_tr_events(nullptr),
       d_model(nullptr),
       d_quant_rel(nullptr),
       d_rel_dom(nullptr),
@@ -123,6 +127,19 @@ QuantifiersEngine::QuantifiersEngine(context::Context* c,
   d_util.push_back(d_term_util.get());
   d_util.push_back(d_term_db.get());
 
+  if (options::eMatchingCodeTree())
+  {
+    d_code_tree.reset(new inst::CodeTree(this));
+    d_util.push_back(d_code_tree.get());
+  }
+  // the events do not cover the terms that become relevant and the
+  // operators of higher-order matching
+  if (options::incrementalEMatching()
+      && options::termDbMode() == quantifiers::TERM_DB_ALL && !options::ufHo())
+  {
+    d_tr_events.reset(new inst::TriggerEvents(c, this));
+  }
+
   if (options::ceGuidedInst()) {
     d_sygus_tdb.reset(new quantifiers::TermDbSygus(c, this));
   }
@@ -361,6 +378,14 @@ inst::TriggerTrie* QuantifiersEngine::getTriggerDatabase() const
 {
   return d_tr_trie.get();
 }
+inst::CodeTree* QuantifiersEngine::getCodeTree() const
+{
+  return d_code_tree.get();
+}
+inst::TriggerEvents* QuantifiersEngine::getTriggerEvents() const
+{
+  return d_tr_events.get();
+}
 
 quantifiers::BoundedIntegers* QuantifiersEngine::getBoundedIntegers() const
 {
@@ -763,6 +788,12 @@ void QuantifiersEngine::check( Theory::Effort e ){
       }
     }
     d_curr_effort_level = QuantifiersModule::QEFFORT_NONE;
+    // if this round added no lemmas, send the delayed instantiations
+    if (!d_hasAddedLemma && !d_conflict
+        && d_instantiate->releaseDelayedLemmas())
+    {
+      flushLemmas();
+    }
     Trace("quant-engine-debug") << "Done check modules that needed check." << std::endl;
     if( d_hasAddedLemma ){
       d_instantiate->debugPrint();
@@ -974,6 +1005,10 @@ void QuantifiersEngine::addTermToDatabase( Node n, bool withinQuant, bool within
 }
 
 void QuantifiersEngine::eqNotifyNewClass(TNode t) {
+  if (d_tr_events)
+  {
+    d_tr_events->notifyNewClass(t);
+  }
   addTermToDatabase( t );
   if( d_eq_inference ){
     d_eq_inference->eqNotifyNewClass( t );
@@ -987,7 +1022,10 @@ void QuantifiersEngine::eqNotifyPreMerge(TNode t1, TNode t2) {
 }
 
 void QuantifiersEngine::eqNotifyPostMerge(TNode t1, TNode t2) {
-
+  if (d_tr_events)
+  {
+    d_tr_events->notifyMerge();
+  }
 }
 
 void QuantifiersEngine::eqNotifyDisequal(TNode t1, TNode t2, TNode reason) {
@@ -1031,6 +1069,20 @@ bool QuantifiersEngine::removeLemma( Node lem ) {
   }
 }
 
+void QuantifiersEngine::removeLemmas(
+    const std::unordered_set<Node, NodeHashFunction>& lems)
+{
+  std::vector<Node>::iterator it = std::remove_if(
+      d_lemmas_waiting.begin(), d_lemmas_waiting.end(), [&](const Node& lem) {
+        return lems.find(lem) != lems.end();
+      });
+  d_lemmas_waiting.erase(it, d_lemmas_waiting.end());
+  for (const Node& lem : lems)
+  {
+    d_lemmas_produced_c[lem] = false;
+  }
+}
+
 void QuantifiersEngine::addRequirePhase( Node lit, bool req ){
   d_phase_req_waiting[lit] = req;
 }
@@ -1194,6 +1246,8 @@ QuantifiersEngine::Statistics::Statistics()
       d_triggers("QuantifiersEngine::Triggers", 0),
       d_simple_triggers("QuantifiersEngine::Triggers_Simple", 0),
       d_multi_triggers("QuantifiersEngine::Triggers_Multi", 0),
+      d_triggers_unchanged("QuantifiersEngine::Triggers_Unchanged", 0),
+      d_triggers_compiled("QuantifiersEngine::Triggers_Compiled", 0),
       d_multi_trigger_instantiations("QuantifiersEngine::Multi_Trigger_Instantiations", 0),
       d_red_alpha_equiv("QuantifiersEngine::Reductions_Alpha_Equivalence", 0),
       d_instantiations_user_patterns("QuantifiersEngine::Instantiations_User_Patterns", 0),
@@ -1215,6 +1269,8 @@ QuantifiersEngine::Statistics::Statistics()
   smtStatisticsRegistry()->registerStat(&d_triggers);
   smtStatisticsRegistry()->registerStat(&d_simple_triggers);
   smtStatisticsRegistry()->registerStat(&d_multi_triggers);
+  smtStatisticsRegistry()->registerStat(&d_triggers_unchanged);
+  smtStatisticsRegistry()->registerStat(&d_triggers_compiled);
   smtStatisticsRegistry()->registerStat(&d_multi_trigger_instantiations);
   smtStatisticsRegistry()->registerStat(&d_red_alpha_equiv);
   smtStatisticsRegistry()->registerStat(&d_instantiations_user_patterns);
@@ -1238,6 +1294,8 @@ QuantifiersEngine::Statistics::~Statistics(){
   smtStatisticsRegistry()->unregisterStat(&d_triggers);
   smtStatisticsRegistry()->unregisterStat(&d_simple_triggers);
   smtStatisticsRegistry()->unregisterStat(&d_multi_triggers);
+  smtStatisticsRegistry()->unregisterStat(&d_triggers_unchanged);
+  smtStatisticsRegistry()->unregisterStat(&d_triggers_compiled);
   smtStatisticsRegistry()->unregisterStat(&d_multi_trigger_instantiations);
   smtStatisticsRegistry()->unregisterStat(&d_red_alpha_equiv);
   smtStatisticsRegistry()->unregisterStat(&d_instantiations_user_patterns);
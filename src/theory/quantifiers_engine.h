@@ -21,6 +21,7 @@
 #include <map>
 #include <memory>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "context/cdhashset.h"
 #include "context/cdlist.h"
@@ -79,6 +80,8 @@ namespace quantifiers {
 }/* CVC4::theory::quantifiers */
 
 namespace inst {
+  class CodeTree;
+  class TriggerEvents;
   class TriggerTrie;
 }/* CVC4::theory::inst */
 
@@ -141,6 +144,10 @@ public:
   quantifiers::TermEnumeration* getTermEnumeration() const;
   /** get trigger database */
   inst::TriggerTrie* getTriggerDatabase() const;
+  /** get the code tree of simple triggers (if it exists) */
+  inst::CodeTree* getCodeTree() const;
+  /** get the events of incremental E-matching (if they are counted) */
+  inst::TriggerEvents* getTriggerEvents() const;
   //---------------------- end utilities
   //---------------------- modules
   /** get bounded integers utility */
@@ -209,6 +216,8 @@ public:
   bool addLemma( Node lem, bool doCache = true, bool doRewrite = true );
   /** remove pending lemma */
   bool removeLemma( Node lem );
+  /** remove the pending lemmas in lems */
+  void removeLemmas(const std::unordered_set<Node, NodeHashFunction>& lems);
   /** add require phase */
   void addRequirePhase( Node lit, bool req );
   /** add EPR axiom */
@@ -300,6 +309,8 @@ public:
     IntStat d_triggers;
     IntStat d_simple_triggers;
     IntStat d_multi_triggers;
+    IntStat d_triggers_unchanged;
+    IntStat d_triggers_compiled;
     IntStat d_multi_trigger_instantiations;
     IntStat d_red_alpha_equiv;
     IntStat d_instantiations_user_patterns;
@@ -332,6 +343,10 @@ public:
   std::unique_ptr<quantifiers::InstPropagator> d_inst_prop;
   /** all triggers will be stored in this trie */
   std::unique_ptr<inst::TriggerTrie> d_tr_trie;
+  /** code tree of simple triggers */
+  std::unique_ptr<inst::CodeTree> d_code_tree;
+  /** events of incremental E-matching */
+  std::unique_ptr<inst::TriggerEvents> d_tr_events;
   /** extended model object */
   std::unique_ptr<quantifiers::FirstOrderModel> d_model;
   /** for computing relevance of quantifiers */
@@ -0,0 +1,208 @@
+/*********************                                                        */
+/*! \file relevance_manager.cpp
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2018 by the authors listed in the file AUTHORS
+ ** in the top-level source directory) and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief Relevance of theory atoms under the current Boolean assignment
+ **/
+
+#include "theory/relevance_manager.h"
+
+#include "base/output.h"
+
+using namespace std;
+
+namespace CVC4 {
+namespace theory {
+
+RelevanceManager::RelevanceManager(context::Context* satContext,
+                                   context::UserContext* userContext,
+                                   Valuation valuation)
+  : d_valuation(valuation),
+    d_assertions(userContext),
+    d_assertionsVisited(satContext, 0),
+    d_relevant(satContext),
+    d_relevantAtoms(satContext),
+    d_justified(satContext),
+    d_pending(satContext),
+    d_pendingIndex(satContext, 0)
+{}
+
+void RelevanceManager::addAssertions(const std::vector<Node>& assertions) {
+  for (unsigned i = 0; i < assertions.size(); ++ i) {
+    addAssertion(assertions[i]);
+  }
+}
+
+void RelevanceManager::addAssertion(TNode assertion) {
+  Debug("theory::relevance") << "RelevanceManager::addAssertion(" << assertion << ")" << endl;
+  d_assertions.push_back(assertion);
+}
+
+int RelevanceManager::getValue(TNode n, int implied) const {
+  bool value;
+  if (d_valuation.hasSatValue(n, value)) {
+    return value ? 1 : 0;
+  }
+  return implied;
+}
+
+bool RelevanceManager::isConnective(TNode n) {
+  switch (n.getKind()) {
+  case kind::NOT:
+  case kind::AND:
+  case kind::OR:
+  case kind::IMPLIES:
+  case kind::XOR:
+    return true;
+  case kind::ITE:
+    return n.getType().isBoolean();
+  case kind::EQUAL:
+    return n[0].getType().isBoolean();
+  default:
+    return false;
+  }
+}
+
+bool RelevanceManager::justify(const Obligation& ob, std::vector<Obligation>& toVisit) const {
+  TNode n = ob.first;
+  int value = getValue(n, ob.second);
+
+  switch (n.getKind()) {
+  case kind::AND:
+  case kind::OR: {
+    // A conjunction that is true (a disjunction that is false) needs all of
+    // its children, otherwise one child with the same value is enough
+    int all = n.getKind() == kind::AND ? 1 : 0;
+    if (value == all) {
+      for (unsigned i = 0; i < n.getNumChildren(); ++ i) {
+        toVisit.push_back(Obligation(n[i], all));
+      }
+      return true;
+    }
+    if (value == 1 - all) {
+      for (unsigned i = 0; i < n.getNumChildren(); ++ i) {
+        if (getValue(n[i], -1) == value) {
+          toVisit.push_back(Obligation(n[i], value));
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+  case kind::IMPLIES:
+    if (value == 0) {
+      toVisit.push_back(Obligation(n[0], 1));
+      toVisit.push_back(Obligation(n[1], 0));
+      return true;
+    }
+    if (value == 1) {
+      if (getValue(n[0], -1) == 0) {
+        toVisit.push_back(Obligation(n[0], 0));
+        return true;
+      }
+      if (getValue(n[1], -1) == 1) {
+        toVisit.push_back(Obligation(n[1], 1));
+        return true;
+      }
+    }
+    return false;
+  case kind::ITE: {
+    // Only the selected branch is relevant
+    int condition = getValue(n[0], -1);
+    toVisit.push_back(Obligation(n[0], condition));
+    if (condition == -1) {
+      return false;
+    }
+    toVisit.push_back(Obligation(n[condition == 1 ? 1 : 2], value));
+    return true;
+  }
+  case kind::EQUAL:
+  case kind::XOR:
+    toVisit.push_back(Obligation(n[0], -1));
+    toVisit.push_back(Obligation(n[1], -1));
+    return true;
+  default:
+    Unreachable();
+  }
+}
+
+void RelevanceManager::visit(std::vector<Obligation>& toVisit) {
+  while (!toVisit.empty()) {
+    Obligation ob = toVisit.back();
+    toVisit.pop_back();
+    TNode n = ob.first;
+
+    if (n.getKind() == kind::NOT) {
+      toVisit.push_back(Obligation(n[0], ob.second == -1 ? -1 : 1 - ob.second));
+      continue;
+    }
+    if (d_relevant.contains(n)) {
+      continue;
+    }
+    Debug("theory::relevance") << "RelevanceManager::visit(): relevant " << n << endl;
+    d_relevant.insert(n);
+
+    if (isConnective(n)) {
+      if (justify(ob, toVisit)) {
+        d_justified.insert(n);
+      } else {
+        d_pending.push_back(ob);
+      }
+    } else {
+      d_relevantAtoms.push_back(n);
+    }
+  }
+}
+
+void RelevanceManager::update() {
+  std::vector<Obligation> toVisit;
+
+  // The new formulas are true
+  for (unsigned i = d_assertionsVisited; i < d_assertions.size(); ++ i) {
+    toVisit.push_back(Obligation(d_assertions[i], 1));
+  }
+  d_assertionsVisited = d_assertions.size();
+  visit(toVisit);
+
+  // Retry the connectives that could not be justified, visit adds new ones
+  unsigned start = d_pendingIndex;
+  unsigned prefix = start;
+  unsigned justified = 0;
+  std::vector<Obligation> unjustified;
+  for (unsigned i = start; i < d_pending.size(); ++ i) {
+    Obligation ob = d_pending[i];
+    if (d_justified.contains(ob.first)) {
+      ++ justified;
+    } else if (justify(ob, toVisit)) {
+      d_justified.insert(ob.first);
+      ++ justified;
+      visit(toVisit);
+    } else {
+      unjustified.push_back(ob);
+      visit(toVisit);
+      continue;
+    }
+    if (prefix == i) {
+      prefix = i + 1;
+    }
+  }
+
+  // Skip the justified entries, compacting the list if most of them are
+  unsigned end = d_pending.size();
+  if (2 * justified >= end - start) {
+    d_pendingIndex = end;
+    for (unsigned i = 0; i < unjustified.size(); ++ i) {
+      d_pending.push_back(unjustified[i]);
+    }
+  } else {
+    d_pendingIndex = prefix;
+  }
+}
+
+}/* CVC4::theory namespace */
+}/* CVC4 namespace */
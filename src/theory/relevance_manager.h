@@ -0,0 +1,117 @@
+/*********************                                                        */
+/*! \file relevance_manager.h
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2018 by the authors listed in the file AUTHORS
+ ** in the top-level source directory) and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief Relevance of theory atoms under the current Boolean assignment
+ **
+ ** An atom is relevant if it is needed to justify that the input assertions
+ ** and the lemmas are satisfied by the current assignment of the SAT solver.
+ ** Starting from these formulas (which are true), the Boolean connectives
+ ** are justified top-down as in the justification heuristic: a true
+ ** conjunction needs all of its children, a true disjunction only one of
+ ** its true children, an ITE its condition and the selected branch, and so
+ ** on.  Connectives that cannot be justified yet are revisited on the next
+ ** update.  The relevant atoms only grow as the assignment grows and are
+ ** backtracked with the SAT context.
+ **/
+
+#include "cvc4_private.h"
+
+#ifndef __CVC4__THEORY__RELEVANCE_MANAGER_H
+#define __CVC4__THEORY__RELEVANCE_MANAGER_H
+
+#include <utility>
+#include <vector>
+
+#include "context/cdhashset.h"
+#include "context/cdlist.h"
+#include "context/cdo.h"
+#include "expr/node.h"
+#include "theory/valuation.h"
+
+namespace CVC4 {
+namespace theory {
+
+class RelevanceManager {
+public:
+  RelevanceManager(context::Context* satContext,
+                   context::UserContext* userContext,
+                   Valuation valuation);
+
+  /** Adds formulas that are true in the current user context. */
+  void addAssertions(const std::vector<Node>& assertions);
+
+  /** Adds a formula that is true, e.g. a lemma. */
+  void addAssertion(TNode assertion);
+
+  /**
+   * Extends the relevant atoms under the current assignment of the SAT
+   * solver.
+   */
+  void update();
+
+  /** Returns true if the atom is known to be relevant. */
+  bool isRelevant(TNode atom) const { return d_relevant.contains(atom); }
+
+  /** Returns the number of atoms that have become relevant. */
+  unsigned getNumRelevantAtoms() const { return d_relevantAtoms.size(); }
+
+  /** Returns the i-th atom that has become relevant. */
+  TNode getRelevantAtom(unsigned i) const { return d_relevantAtoms[i]; }
+
+private:
+  /** A formula and the value it is known to have (-1 if unknown) */
+  typedef std::pair<Node, int> Obligation;
+
+  /** Returns the value of n, or implied if n has no value in the SAT solver */
+  int getValue(TNode n, int implied) const;
+
+  /** Returns true if n is a Boolean connective */
+  static bool isConnective(TNode n);
+
+  /**
+   * Tries to justify the obligation, pushing the children it needs onto
+   * toVisit.  Returns true if the obligation needs no more children.
+   */
+  bool justify(const Obligation& ob, std::vector<Obligation>& toVisit) const;
+
+  /** Marks the obligations relevant and justifies them as far as possible */
+  void visit(std::vector<Obligation>& toVisit);
+
+  Valuation d_valuation;
+
+  /** The formulas that are true */
+  context::CDList<Node> d_assertions;
+
+  /** How many of d_assertions have been visited in the SAT context */
+  context::CDO<unsigned> d_assertionsVisited;
+
+  /** The relevant atoms and connectives */
+  context::CDHashSet<Node, NodeHashFunction> d_relevant;
+
+  /** The relevant atoms, in the order they became relevant */
+  context::CDList<Node> d_relevantAtoms;
+
+  /** The relevant connectives that need no more children */
+  context::CDHashSet<Node, NodeHashFunction> d_justified;
+
+  /** The relevant connectives, some of which are not justified yet */
+  context::CDList<Obligation> d_pending;
+
+  /**
+   * The entries of d_pending before this index are justified.  When at
+   * least half of the entries after it are justified, the others are
+   * appended again and the index moves past all of them.
+   */
+  context::CDO<unsigned> d_pendingIndex;
+};/* class RelevanceManager */
+
+}/* CVC4::theory namespace */
+}/* CVC4 namespace */
+
+#endif /* __CVC4__THEORY__RELEVANCE_MANAGER_H */
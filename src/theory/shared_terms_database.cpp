@@ -29,7 +29,7 @@ SharedTermsDatabase::SharedTermsDatabase(TheoryEngine* theoryEngine,
       d_statSharedTerms("theory::shared_terms", 0),
       d_addedSharedTermsSize(context, 0),
       d_termsToTheories(context),
-      d_alreadyNotifiedMap(context),
+      d_alreadyNotified(context),
       d_registeredEqualities(context),
       d_EENotify(*this),
       d_equalityEngine(d_EENotify, context, "SharedTermsDatabase", true),
@@ -101,11 +101,7 @@ Theory::Set SharedTermsDatabase::getTheoriesToNotify(TNode atom, TNode term) con
   Assert(find != d_termsToTheories.end());
 
   // Get the theories that were already notified
-  Theory::Set alreadyNotified = 0;
-  AlreadyNotifiedMap::iterator theoriesFind = d_alreadyNotifiedMap.find(term);
-  if (theoriesFind != d_alreadyNotifiedMap.end()) {
-    alreadyNotified = (*theoriesFind).second;
-  }
+  Theory::Set alreadyNotified = d_alreadyNotified.get(term);
 
   // Return the ones that haven't been notified yet
   return Theory::setDifference((*find).second, alreadyNotified);
@@ -114,12 +110,7 @@ Theory::Set SharedTermsDatabase::getTheoriesToNotify(TNode atom, TNode term) con
 
 Theory::Set SharedTermsDatabase::getNotifiedTheories(TNode term) const {
   // Get the theories that were already notified
-  AlreadyNotifiedMap::iterator theoriesFind = d_alreadyNotifiedMap.find(term);
-  if (theoriesFind != d_alreadyNotifiedMap.end()) {
-    return (*theoriesFind).second;
-  } else {
-    return 0;
-  }
+  return d_alreadyNotified.get(term);
 }
 
 bool SharedTermsDatabase::propagateSharedEquality(TheoryId theory, TNode a, TNode b, bool value)
@@ -145,11 +136,7 @@ bool SharedTermsDatabase::propagateSharedEquality(TheoryId theory, TNode a, TNod
 void SharedTermsDatabase::markNotified(TNode term, Theory::Set theories) {
 
   // Find out if there are any new theories that were notified about this term
-  Theory::Set alreadyNotified = 0;
-  AlreadyNotifiedMap::iterator theoriesFind = d_alreadyNotifiedMap.find(term);
-  if (theoriesFind != d_alreadyNotifiedMap.end()) {
-    alreadyNotified = (*theoriesFind).second;
-  }
+  Theory::Set alreadyNotified = d_alreadyNotified.get(term);
   Theory::Set newlyNotified = Theory::setDifference(theories, alreadyNotified);
 
   // If no new theories were notified, we are done
@@ -160,7 +147,7 @@ void SharedTermsDatabase::markNotified(TNode term, Theory::Set theories) {
   Debug("shared-terms-database") << "SharedTermsDatabase::markNotified(" << term << ")" << endl;
 
   // First update the set of notified theories for this term
-  d_alreadyNotifiedMap[term] = Theory::setUnion(newlyNotified, alreadyNotified);
+  d_alreadyNotified.set(term, Theory::setUnion(newlyNotified, alreadyNotified));
 
   // Mark the shared terms in the equality engine
   theory::TheoryId currentTheory;
@@ -21,6 +21,7 @@
 
 #include "context/cdhashset.h"
 #include "expr/node.h"
+#include "theory/node_theory_sets.h"
 #include "theory/theory.h"
 #include "theory/uf/equality_engine.h"
 #include "util/statistics_registry.h"
@@ -61,8 +62,7 @@ private:
   SharedTermsTheoriesMap d_termsToTheories;
 
   /** Map from term to theories that have already been notified about the shared term */
-  typedef context::CDHashMap<TNode, theory::Theory::Set, TNodeHashFunction> AlreadyNotifiedMap;
-  AlreadyNotifiedMap d_alreadyNotifiedMap;
+  theory::NodeTheorySets d_alreadyNotified;
 
   /** The registered equalities for propagation */
   typedef context::CDHashSet<Node, NodeHashFunction> RegisteredEqualitiesSet;
@@ -220,7 +220,7 @@ public:
    * Returns true if the term is currently registered as shared with some theory.
    */
   bool isShared(TNode term) const {
-    return d_alreadyNotifiedMap.find(term) != d_alreadyNotifiedMap.end();
+    return d_alreadyNotified.contains(term);
   }
 
   /**
@@ -15,6 +15,8 @@
 
 #include "theory/term_registration_visitor.h"
 
+#include <algorithm>
+
 #include "options/quantifiers_options.h"
 #include "theory/theory_engine.h"
 
@@ -22,15 +24,6 @@ using namespace std;
 using namespace CVC4;
 using namespace theory;
 
-std::string PreRegisterVisitor::toString() const {
-  std::stringstream ss;
-  TNodeToTheorySetMap::const_iterator it = d_visited.begin();
-  for (; it != d_visited.end(); ++ it) {
-    ss << (*it).first << ": " << Theory::setToString((*it).second) << std::endl;
-  }
-  return ss.str();
-}
-
 bool PreRegisterVisitor::alreadyVisited(TNode current, TNode parent) {
 
   Debug("register::internal") << "PreRegisterVisitor::alreadyVisited(" << current << "," << parent << ")" << std::endl;
@@ -78,15 +71,14 @@ bool PreRegisterVisitor::alreadyVisited(TNode current, TNode parent) {
   }
   
   // Get the theories that have already visited this node
-  TNodeToTheorySetMap::iterator find = d_visited.find(current);
-  if (find == d_visited.end()) {
+  Theory::Set visitedTheories = d_visited.get(current);
+  if (visitedTheories == 0) {
     if (useType) {
       d_theories = Theory::setInsert(typeTheoryId, d_theories);
     }
     return false;
   }
 
-  Theory::Set visitedTheories = (*find).second;
   if (Theory::setContains(currentTheoryId, visitedTheories)) {
     // The current theory has already visited it, so now it depends on the parent and the type
     if (Theory::setContains(parentTheoryId, visitedTheories)) {
@@ -108,9 +100,6 @@ bool PreRegisterVisitor::alreadyVisited(TNode current, TNode parent) {
 void PreRegisterVisitor::visit(TNode current, TNode parent) {
 
   Debug("register") << "PreRegisterVisitor::visit(" << current << "," << parent << ")" << std::endl;
-  if (Debug.isOn("register::internal")) {
-    Debug("register::internal") << toString() << std::endl;
-  }
 
   // Get the theories of the terms
   TheoryId currentTheoryId = Theory::theoryOf(current);
@@ -137,18 +126,18 @@ void PreRegisterVisitor::visit(TNode current, TNode parent) {
     }
   }
   
-  Theory::Set visitedTheories = d_visited[current];
+  Theory::Set visitedTheories = d_visited.get(current);
   Debug("register::internal") << "PreRegisterVisitor::visit(" << current << "," << parent << "): previously registered with " << Theory::setToString(visitedTheories) << std::endl;
   if (!Theory::setContains(currentTheoryId, visitedTheories)) {
     visitedTheories = Theory::setInsert(currentTheoryId, visitedTheories);
-    d_visited[current] = visitedTheories;
+    d_visited.set(current, visitedTheories);
     Theory* th = d_engine->theoryOf(currentTheoryId);
     th->preRegisterTerm(current);
     Debug("register::internal") << "PreRegisterVisitor::visit(" << current << "," << parent << "): adding " << currentTheoryId << std::endl;
   }
   if (!Theory::setContains(parentTheoryId, visitedTheories)) {
     visitedTheories = Theory::setInsert(parentTheoryId, visitedTheories);
-    d_visited[current] = visitedTheories;
+    d_visited.set(current, visitedTheories);
     Theory* th = d_engine->theoryOf(parentTheoryId);
     th->preRegisterTerm(current);
     Debug("register::internal") << "PreRegisterVisitor::visit(" << current << "," << parent << "): adding " << parentTheoryId << std::endl;
@@ -156,7 +145,7 @@ void PreRegisterVisitor::visit(TNode current, TNode parent) {
   if (useType) {
     if (!Theory::setContains(typeTheoryId, visitedTheories)) {
       visitedTheories = Theory::setInsert(typeTheoryId, visitedTheories);
-      d_visited[current] = visitedTheories;
+      d_visited.set(current, visitedTheories);
       Theory* th = d_engine->theoryOf(typeTheoryId);
       th->preRegisterTerm(current);
       Debug("register::internal") << "PreRegisterVisitor::visit(" << current << "," << parent << "): adding " << parentTheoryId << std::endl;
@@ -164,15 +153,15 @@ void PreRegisterVisitor::visit(TNode current, TNode parent) {
   }
   Debug("register::internal") << "PreRegisterVisitor::visit(" << current << "," << parent << "): now registered with " << Theory::setToString(visitedTheories) << std::endl;
 
-  Assert(d_visited.find(current) != d_visited.end());
+  Assert(d_visited.contains(current));
   Assert(alreadyVisited(current, parent));
 }
 
 std::string SharedTermsVisitor::toString() const {
   std::stringstream ss;
-  TNodeVisitedMap::const_iterator it = d_visited.begin();
-  for (; it != d_visited.end(); ++ it) {
-    ss << (*it).first << ": " << Theory::setToString((*it).second) << std::endl;
+  for (unsigned i = 0; i < d_visitedTerms.size(); ++ i) {
+    TNode term = d_visitedTerms[i];
+    ss << term << ": " << Theory::setToString(getVisited(term)) << std::endl;
   }
   return ss.str();
 }
@@ -195,16 +184,14 @@ bool SharedTermsVisitor::alreadyVisited(TNode current, TNode parent) const {
     Debug("register::internal") << "quantifier:true" << std::endl;
     return true;
   }
-  TNodeVisitedMap::const_iterator find = d_visited.find(current);
+  Theory::Set theories = getVisited(current);
 
   // If node is not visited at all, just return false
-  if (find == d_visited.end()) {
+  if (theories == 0) {
     Debug("register::internal") << "1:false" << std::endl;
     return false;
   }
 
-  Theory::Set theories = (*find).second;
-
   TheoryId currentTheoryId = Theory::theoryOf(current);
   TheoryId parentTheoryId  = Theory::theoryOf(parent);
 
@@ -292,7 +279,7 @@ void SharedTermsVisitor::visit(TNode current, TNode parent) {
     }
   }
 
-  Theory::Set visitedTheories = d_visited[current];
+  Theory::Set visitedTheories = getVisited(current);
   Debug("register::internal") << "SharedTermsVisitor::visit(" << current << "," << parent << "): previously registered with " << Theory::setToString(visitedTheories) << std::endl;
   if (!Theory::setContains(currentTheoryId, visitedTheories)) {
     visitedTheories = Theory::setInsert(currentTheoryId, visitedTheories);
@@ -311,17 +298,46 @@ void SharedTermsVisitor::visit(TNode current, TNode parent) {
   Debug("register::internal") << "SharedTermsVisitor::visit(" << current << "," << parent << "): now registered with " << Theory::setToString(visitedTheories) << std::endl;
 
   // Record the new theories that we visited
-  d_visited[current] = visitedTheories;
+  size_t id = current.getId();
+  if (id >= NodeTheorySets::s_maxDenseId) {
+    Theory::Set& visited = d_visitedSparse[id];
+    if (visited == 0) {
+      d_visitedTerms.push_back(current);
+    }
+    visited = visitedTheories;
+  } else {
+    if (id >= d_visited.size()) {
+      d_visited.resize(std::min(std::max(id + 1, 2 * d_visited.size()),
+                                NodeTheorySets::s_maxDenseId), 0);
+    }
+    if (d_visited[id] == 0) {
+      d_visitedTerms.push_back(current);
+    }
+    d_visited[id] = visitedTheories;
+  }
 
   // If there is more than two theories and a new one has been added notify the shared terms database
   if (Theory::setDifference(visitedTheories, Theory::setInsert(currentTheoryId))) {
     d_sharedTerms.addSharedTerm(d_atom, current, visitedTheories);
   }
 
-  Assert(d_visited.find(current) != d_visited.end());
+  Assert(getVisited(current) != 0);
   Assert(alreadyVisited(current, parent));
 }
 
+Theory::Set SharedTermsVisitor::getVisited(TNode term) const {
+  size_t id = term.getId();
+  if (id < d_visited.size()) {
+    return d_visited[id];
+  }
+  if (id < NodeTheorySets::s_maxDenseId) {
+    return 0;
+  }
+  std::unordered_map<size_t, Theory::Set>::const_iterator it =
+    d_visitedSparse.find(id);
+  return it == d_visitedSparse.end() ? 0 : (*it).second;
+}
+
 void SharedTermsVisitor::start(TNode node) {
   clear();
   d_atom = node;
@@ -333,5 +349,12 @@ void SharedTermsVisitor::done(TNode node) {
 
 void SharedTermsVisitor::clear() {
   d_atom = TNode();
-  d_visited.clear();
+  for (unsigned i = 0; i < d_visitedTerms.size(); ++ i) {
+    size_t id = d_visitedTerms[i].getId();
+    if (id < d_visited.size()) {
+      d_visited[id] = 0;
+    }
+  }
+  d_visitedTerms.clear();
+  d_visitedSparse.clear();
 }
@@ -18,9 +18,11 @@
 #pragma once
 
 #include "context/context.h"
+#include "theory/node_theory_sets.h"
 #include "theory/shared_terms_database.h"
 
 #include <unordered_map>
+#include <vector>
 
 namespace CVC4 {
 
@@ -42,23 +44,16 @@ class PreRegisterVisitor {
   /** The engine */
   TheoryEngine* d_engine;
 
-  typedef context::CDHashMap<TNode, theory::Theory::Set, TNodeHashFunction> TNodeToTheorySetMap;
-
   /**
    * Map from terms to the theories that have already had this term pre-registered.
    */
-  TNodeToTheorySetMap d_visited;
+  theory::NodeTheorySets d_visited;
 
   /**
    * A set of all theories in the term
    */
   theory::Theory::Set d_theories;
 
-  /**
-   * String representation of the visited map, for debugging purposes.
-   */
-  std::string toString() const;
-
 public:
 
   /** Returned set tells us which theories there are */
@@ -103,10 +98,26 @@ class SharedTermsVisitor {
   SharedTermsDatabase& d_sharedTerms;
 
   /**
-   * Cache from preprocessing of atoms.
+   * Cache from preprocessing of atoms, indexed by node id. Only the entries
+   * of the terms in d_visitedTerms are non-empty.
+   */
+  std::vector<theory::Theory::Set> d_visited;
+
+  /**
+   * The entries of the terms with an id of at least
+   * NodeTheorySets::s_maxDenseId, which are not stored densely.
+   */
+  std::unordered_map<size_t, theory::Theory::Set> d_visitedSparse;
+
+  /**
+   * The terms visited since the last clear().
+   */
+  std::vector<TNode> d_visitedTerms;
+
+  /**
+   * Returns the theories that visited the term.
    */
-  typedef std::unordered_map<TNode, theory::Theory::Set, TNodeHashFunction> TNodeVisitedMap;
-  TNodeVisitedMap d_visited;
+  theory::Theory::Set getVisited(TNode term) const;
 
   /**
    * String representation of the visited map, for debugging purposes.
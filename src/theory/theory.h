@@ -19,6 +19,7 @@
 #ifndef __CVC4__THEORY__THEORY_H
 #define __CVC4__THEORY__THEORY_H
 
+#include <functional>
 #include <iosfwd>
 #include <map>
 #include <set>
@@ -497,6 +498,28 @@ public:
    */
   virtual void check(Effort level = EFFORT_FULL) { }
 
+  /**
+   * Get the concurrent part of the next full effort check of this theory.
+   *
+   * This is called at the start of a full effort check if
+   * options::theoryCheckThreads() is greater than one. The returned task
+   * computes part of the check over a snapshot of the state of this theory,
+   * which this call takes. TheoryEngine runs the tasks of the theories on
+   * several threads, and checks the theories once all tasks are done, in the
+   * usual order. Their check() uses the result of the task if their state
+   * did not change since the snapshot, so that they behave as if the part
+   * was computed by check() itself.
+   *
+   * The task runs concurrently with the tasks of other theories. It must
+   * only access its snapshot, and must not create, copy or destroy nodes,
+   * since NodeManager is not thread safe. Returns an empty function if this
+   * theory has no such part.
+   */
+  virtual std::function<void()> getFullCheckTask()
+  {
+    return std::function<void()>();
+  }
+
   /** Needs last effort check? */
   virtual bool needsCheckLastEffort() { return false; }
 
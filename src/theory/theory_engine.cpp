@@ -16,6 +16,8 @@
 
 #include "theory/theory_engine.h"
 
+#include <algorithm>
+#include <atomic>
 #include <list>
 #include <vector>
 
@@ -29,6 +31,7 @@
 #include "options/options.h"
 #include "options/proof_options.h"
 #include "options/quantifiers_options.h"
+#include "options/theory_options.h"
 #include "proof/cnf_proof.h"
 #include "proof/lemma_proof.h"
 #include "proof/proof_manager.h"
@@ -91,6 +94,12 @@ theory::LemmaStatus TheoryEngine::EngineOutputChannel::lemma(TNode lemma,
   theory::LemmaStatus result =
       d_engine->lemma(lemma, rule, false, removable, preprocess,
                       sendAtoms ? d_theory : theory::THEORY_LAST);
+  if (d_engine->d_lastLemmaDuplicate) {
+    ++d_statistics.duplicateLemmas;
+    if (preprocess) {
+      ++d_statistics.preprocessingSkipped;
+    }
+  }
   return result;
 }
 
@@ -190,6 +199,9 @@ theory::LemmaStatus TheoryEngine::EngineOutputChannel::splitLemma(
                        << lemma << " )" << std::endl;
   theory::LemmaStatus result =
       d_engine->lemma(lemma, RULE_SPLIT, false, removable, false, d_theory);
+  if (d_engine->d_lastLemmaDuplicate) {
+    ++d_statistics.duplicateLemmas;
+  }
   return result;
 }
 
@@ -300,11 +312,31 @@ TheoryEngine::TheoryEngine(context::Context* context,
   d_incomplete(context, false),
   d_propagationMap(context),
   d_propagationMapTimestamp(context, 0),
+  d_explanationMemo(),
+  d_explanationMemoByTimestamp(),
+  d_explanationMemoInvalidator(context, *this),
+  d_checkingExplanationMemo(false),
   d_propagatedLiterals(context),
   d_propagatedLiteralsIndex(context, 0),
   d_atomRequests(context),
+  d_lemmaTable(userContext),
+  d_lastLemmaDuplicate(false),
+  d_relevanceManager(NULL),
+  d_deferredFacts(context),
+  d_deferredFactsByAtom(context),
+  d_deferredFactsIndex(context, 0),
+  d_relevantAtomsAsserted(context, 0),
   d_tform_remover(iteRemover),
   d_combineTheoriesTime("TheoryEngine::combineTheoriesTime"),
+  d_careGraphSize("TheoryEngine::combineTheories::careGraphSize", 0),
+  d_careGraphSplits("TheoryEngine::combineTheories::splits", 0),
+  d_careGraphModelSkipped("TheoryEngine::combineTheories::modelSkipped", 0),
+  d_careGraphRepeatSkipped("TheoryEngine::combineTheories::repeatSkipped", 0),
+  d_explanationMemoHits("TheoryEngine::explanationMemoHits", 0),
+  d_explanationDepth("TheoryEngine::explanationDepth"),
+  d_preRegisterTime("TheoryEngine::preRegisterTime"),
+  d_relevanceDeferred("TheoryEngine::relevance::deferred", 0),
+  d_relevanceFullEffort("TheoryEngine::relevance::assertedAtFullEffort", 0),
   d_true(),
   d_false(),
   d_interrupted(false),
@@ -314,6 +346,7 @@ TheoryEngine::TheoryEngine(context::Context* context,
   d_factsAsserted(context, false),
   d_preRegistrationVisitor(this, context),
   d_sharedTermsVisitor(d_sharedTerms),
+  d_careSplits(userContext),
   d_theoryAlternatives(),
   d_attr_handle(),
   d_arithSubstitutionsAdded("theory::arith::zzz::arith::substitutions", 0)
@@ -326,9 +359,22 @@ TheoryEngine::TheoryEngine(context::Context* context,
   }
   
   smtStatisticsRegistry()->registerStat(&d_combineTheoriesTime);
+  smtStatisticsRegistry()->registerStat(&d_careGraphSize);
+  smtStatisticsRegistry()->registerStat(&d_careGraphSplits);
+  smtStatisticsRegistry()->registerStat(&d_careGraphModelSkipped);
+  smtStatisticsRegistry()->registerStat(&d_careGraphRepeatSkipped);
+  smtStatisticsRegistry()->registerStat(&d_explanationMemoHits);
+  smtStatisticsRegistry()->registerStat(&d_explanationDepth);
+  smtStatisticsRegistry()->registerStat(&d_preRegisterTime);
+  smtStatisticsRegistry()->registerStat(&d_relevanceDeferred);
+  smtStatisticsRegistry()->registerStat(&d_relevanceFullEffort);
   d_true = NodeManager::currentNM()->mkConst<bool>(true);
   d_false = NodeManager::currentNM()->mkConst<bool>(false);
 
+  if (options::theoryRelevance()) {
+    d_relevanceManager = new RelevanceManager(context, userContext, Valuation(this));
+  }
+
 #ifdef CVC4_PROOF
   ProofManager::currentPM()->initTheoryProofEngine();
 #endif
@@ -357,7 +403,18 @@ TheoryEngine::~TheoryEngine() {
 
   delete d_masterEqualityEngine;
 
+  delete d_relevanceManager;
+
   smtStatisticsRegistry()->unregisterStat(&d_combineTheoriesTime);
+  smtStatisticsRegistry()->unregisterStat(&d_careGraphSize);
+  smtStatisticsRegistry()->unregisterStat(&d_careGraphSplits);
+  smtStatisticsRegistry()->unregisterStat(&d_careGraphModelSkipped);
+  smtStatisticsRegistry()->unregisterStat(&d_careGraphRepeatSkipped);
+  smtStatisticsRegistry()->unregisterStat(&d_explanationMemoHits);
+  smtStatisticsRegistry()->unregisterStat(&d_explanationDepth);
+  smtStatisticsRegistry()->unregisterStat(&d_preRegisterTime);
+  smtStatisticsRegistry()->unregisterStat(&d_relevanceDeferred);
+  smtStatisticsRegistry()->unregisterStat(&d_relevanceFullEffort);
   smtStatisticsRegistry()->unregisterStat(&d_arithSubstitutionsAdded);
 }
 
@@ -371,58 +428,64 @@ void TheoryEngine::preRegister(TNode preprocessed) {
   d_preregisterQueue.push(preprocessed);
 
   if (!d_inPreregister) {
-    // We're in pre-register
-    d_inPreregister = true;
-
-    // Process the pre-registration queue
-    while (!d_preregisterQueue.empty()) {
-      // Get the next atom to pre-register
-      preprocessed = d_preregisterQueue.front();
-      d_preregisterQueue.pop();
-
-      if (d_logicInfo.isSharingEnabled() && preprocessed.getKind() == kind::EQUAL) {
-        // When sharing is enabled, we propagate from the shared terms manager also
-        d_sharedTerms.addEqualityToPropagate(preprocessed);
-      }
-
-      // the atom should not have free variables
-      Debug("theory") << "TheoryEngine::preRegister: " << preprocessed
-                      << std::endl;
-      Assert(!expr::hasFreeVar(preprocessed));
-      // Pre-register the terms in the atom
-      Theory::Set theories = NodeVisitor<PreRegisterVisitor>::run(d_preRegistrationVisitor, preprocessed);
-      theories = Theory::setRemove(THEORY_BOOL, theories);
-      // Remove the top theory, if any more that means multiple theories were involved
-      bool multipleTheories = Theory::setRemove(Theory::theoryOf(preprocessed), theories);
-      TheoryId i;
-      // These checks don't work with finite model finding, because it
-      // uses Rational constants to represent cardinality constraints,
-      // even though arithmetic isn't actually involved.
-      if(!options::finiteModelFind()) {
-        while((i = Theory::setPop(theories)) != THEORY_LAST) {
-          if(!d_logicInfo.isTheoryEnabled(i)) {
-            LogicInfo newLogicInfo = d_logicInfo.getUnlockedCopy();
-            newLogicInfo.enableTheory(i);
-            newLogicInfo.lock();
-            stringstream ss;
-            ss << "The logic was specified as " << d_logicInfo.getLogicString()
-               << ", which doesn't include " << i
-               << ", but found a term in that theory." << endl
-               << "You might want to extend your logic to "
-               << newLogicInfo.getLogicString() << endl;
-            throw LogicException(ss.str());
-          }
+    processPreregisterQueue();
+  }
+}
+
+void TheoryEngine::processPreregisterQueue() {
+  Assert(!d_inPreregister);
+  TimerStat::CodeTimer preRegisterTimer(d_preRegisterTime);
+  // We're in pre-register
+  d_inPreregister = true;
+
+  // Process the pre-registration queue
+  while (!d_preregisterQueue.empty()) {
+    // Get the next atom to pre-register
+    TNode preprocessed = d_preregisterQueue.front();
+    d_preregisterQueue.pop();
+
+    if (d_logicInfo.isSharingEnabled() && preprocessed.getKind() == kind::EQUAL) {
+      // When sharing is enabled, we propagate from the shared terms manager also
+      d_sharedTerms.addEqualityToPropagate(preprocessed);
+    }
+
+    // the atom should not have free variables
+    Debug("theory") << "TheoryEngine::preRegister: " << preprocessed
+                    << std::endl;
+    Assert(!expr::hasFreeVar(preprocessed));
+    // Pre-register the terms in the atom
+    Theory::Set theories = NodeVisitor<PreRegisterVisitor>::run(d_preRegistrationVisitor, preprocessed);
+    theories = Theory::setRemove(THEORY_BOOL, theories);
+    // Remove the top theory, if any more that means multiple theories were involved
+    bool multipleTheories = Theory::setRemove(Theory::theoryOf(preprocessed), theories);
+    TheoryId i;
+    // These checks don't work with finite model finding, because it
+    // uses Rational constants to represent cardinality constraints,
+    // even though arithmetic isn't actually involved.
+    if(!options::finiteModelFind()) {
+      while((i = Theory::setPop(theories)) != THEORY_LAST) {
+        if(!d_logicInfo.isTheoryEnabled(i)) {
+          LogicInfo newLogicInfo = d_logicInfo.getUnlockedCopy();
+          newLogicInfo.enableTheory(i);
+          newLogicInfo.lock();
+          stringstream ss;
+          ss << "The logic was specified as " << d_logicInfo.getLogicString()
+             << ", which doesn't include " << i
+             << ", but found a term in that theory." << endl
+             << "You might want to extend your logic to "
+             << newLogicInfo.getLogicString() << endl;
+          throw LogicException(ss.str());
         }
       }
-      if (multipleTheories) {
-        // Collect the shared terms if there are multiple theories
-        NodeVisitor<SharedTermsVisitor>::run(d_sharedTermsVisitor, preprocessed);
-      }
     }
-
-    // Leaving pre-register
-    d_inPreregister = false;
+    if (multipleTheories) {
+      // Collect the shared terms if there are multiple theories
+      NodeVisitor<SharedTermsVisitor>::run(d_sharedTermsVisitor, preprocessed);
+    }
   }
+
+  // Leaving pre-register
+  d_inPreregister = false;
 }
 
 void TheoryEngine::printAssertions(const char* tag) {
@@ -513,7 +576,7 @@ void TheoryEngine::check(Theory::Effort effort) {
 #endif
 #define CVC4_FOR_EACH_THEORY_STATEMENT(THEORY) \
     if (theory::TheoryTraits<THEORY>::hasCheck && d_logicInfo.isTheoryEnabled(THEORY)) { \
-       theoryOf(THEORY)->check(effort); \
+       checkTheory(THEORY, effort); \
        if (d_inConflict) { \
          Debug("conflict") << THEORY << " in conflict. " << std::endl; \
          break; \
@@ -532,6 +595,12 @@ void TheoryEngine::check(Theory::Effort effort) {
 
     Debug("theory") << "TheoryEngine::check(" << effort << "): d_factsAsserted = " << (d_factsAsserted ? "true" : "false") << endl;
 
+    // Assert the deferred facts that became relevant, and all of them at full
+    // effort
+    if (d_relevanceManager != NULL) {
+      assertDeferredFacts(Theory::fullEffort(effort));
+    }
+
     // If in full effort, we have a fake new assertion just to jumpstart the checking
     if (Theory::fullEffort(effort)) {
       d_factsAsserted = true;
@@ -558,7 +627,11 @@ void TheoryEngine::check(Theory::Effort effort) {
       d_factsAsserted = false;
 
       // Do the checking
-      CVC4_FOR_EACH_THEORY;
+      if (Theory::fullEffort(effort) && options::theoryCheckThreads() > 1) {
+        checkTheoriesConcurrently(effort);
+      } else {
+        CVC4_FOR_EACH_THEORY;
+      }
 
       if(Dump.isOn("missed-t-conflicts")) {
         Dump("missed-t-conflicts")
@@ -600,7 +673,7 @@ void TheoryEngine::check(Theory::Effort effort) {
                   break;
                 }
               }
-              theory->check(Theory::EFFORT_LAST_CALL);
+              checkTheory(theoryId, Theory::EFFORT_LAST_CALL);
             }
           }
         }
@@ -656,6 +729,75 @@ void TheoryEngine::check(Theory::Effort effort) {
   }
 }
 
+void TheoryEngine::checkTheoriesConcurrently(Theory::Effort effort) {
+  Assert(Theory::fullEffort(effort));
+
+#ifdef CVC4_FOR_EACH_THEORY_STATEMENT
+#undef CVC4_FOR_EACH_THEORY_STATEMENT
+#endif
+#define CVC4_FOR_EACH_THEORY_STATEMENT(THEORY) \
+    if (theory::TheoryTraits<THEORY>::hasCheck && d_logicInfo.isTheoryEnabled(THEORY)) { \
+       theories.push_back(THEORY); \
+    }
+
+  std::vector<TheoryId> theories;
+  CVC4_FOR_EACH_THEORY;
+
+  // Take the snapshots, in the order of the theories
+  std::vector<std::function<void()> > tasks;
+  std::vector<HistogramTimerStat*> timers;
+  for (TheoryId theoryId : theories) {
+    std::function<void()> task = theoryOf(theoryId)->getFullCheckTask();
+    if (task) {
+      tasks.push_back(task);
+      timers.push_back(&d_theoryOut[theoryId]->d_statistics.fullCheckTaskTime);
+    }
+  }
+  Debug("theory") << "TheoryEngine::checkTheoriesConcurrently(): "
+                  << tasks.size() << " tasks" << endl;
+
+  // The threads take the tasks in order, the pool joins them even if a task
+  // throws
+  std::atomic<size_t> next(0);
+  size_t numThreads = std::min<size_t>(options::theoryCheckThreads(),
+                                       tasks.size());
+  d_checkWorkers.run(numThreads, [&tasks, &timers, &next](size_t) {
+    for (size_t i = next++; i < tasks.size(); i = next++) {
+      HistogramTimerStat::CodeTimer taskTimer(*timers[i]);
+      tasks[i]();
+    }
+  });
+
+  // Check the theories in the order of the serial loop
+  for (TheoryId theoryId : theories) {
+    checkTheory(theoryId, effort);
+    if (d_inConflict) {
+      Debug("conflict") << theoryId << " in conflict. " << std::endl;
+      break;
+    }
+  }
+}
+
+void TheoryEngine::checkTheory(TheoryId theoryId, Theory::Effort effort) {
+  Statistics& statistics = d_theoryOut[theoryId]->d_statistics;
+  if (effort == Theory::EFFORT_LAST_CALL) {
+    HistogramTimerStat::CodeTimer checkTimer(statistics.lastCallCheckTime);
+    theoryOf(theoryId)->check(effort);
+  } else if (Theory::fullEffort(effort)) {
+    HistogramTimerStat::CodeTimer checkTimer(statistics.fullCheckTime);
+    theoryOf(theoryId)->check(effort);
+  } else {
+    // Standard effort checks are frequent, only time some of them
+    unsigned sampling = options::theoryCheckTimeSampling();
+    if (sampling > 0 && ++ statistics.standardChecks % sampling == 0) {
+      HistogramTimerStat::CodeTimer checkTimer(statistics.sampledStandardCheckTime);
+      theoryOf(theoryId)->check(effort);
+    } else {
+      theoryOf(theoryId)->check(effort);
+    }
+  }
+}
+
 void TheoryEngine::combineTheories() {
 
   Trace("combineTheories") << "TheoryEngine::combineTheories()" << endl;
@@ -677,6 +819,7 @@ void TheoryEngine::combineTheories() {
   CVC4_FOR_EACH_THEORY;
 
   Trace("combineTheories") << "TheoryEngine::combineTheories(): care graph size = " << careGraph.size() << endl;
+  d_careGraphSize += careGraph.size();
 
   // Now add splitters for the ones we are interested in
   CareGraph::const_iterator care_it = careGraph.begin();
@@ -692,6 +835,21 @@ void TheoryEngine::combineTheories() {
 
     // The equality in question (order for no repetition)
     Node equality = carePair.a.eqNode(carePair.b);
+
+    if (options::tcModelBased()) {
+      // The split lemma is still there from an earlier round
+      if (d_careSplits.contains(equality)) {
+        ++ d_careGraphRepeatSkipped;
+        continue;
+      }
+      // Only split if the models disagree
+      if (modelsAgreeOn(carePair.a, carePair.b, carePair.theory)) {
+        Debug("combineTheories") << "TheoryEngine::combineTheories(): models agree" << endl;
+        ++ d_careGraphModelSkipped;
+        continue;
+      }
+      d_careSplits.insert(equality);
+    }
     // EqualityStatus es = getEqualityStatus(carePair.a, carePair.b);
     // Debug("combineTheories") << "TheoryEngine::combineTheories(): " <<
     //   (es == EQUALITY_TRUE_AND_PROPAGATED ? "EQUALITY_TRUE_AND_PROPAGATED" :
@@ -707,6 +865,7 @@ void TheoryEngine::combineTheories() {
     Debug("combineTheories") << "TheoryEngine::combineTheories(): requesting a split " << endl;
 
     lemma(equality.orNode(equality.notNode()), RULE_INVALID, false, false, false, carePair.theory);
+    ++ d_careGraphSplits;
 
     // This code is supposed to force preference to follow what the theory models already have
     // but it doesn't seem to make a big difference - need to explore more -Clark
@@ -723,6 +882,37 @@ void TheoryEngine::combineTheories() {
   }
 }
 
+bool TheoryEngine::modelsAgreeOn(TNode a, TNode b, TheoryId careTheory) {
+  // The theories that know about a or b
+  Theory::Set theories = Theory::setInsert(careTheory);
+  theories = Theory::setInsert(Theory::theoryOf(a.getType()), theories);
+  if (d_sharedTerms.isShared(a)) {
+    theories = Theory::setUnion(theories, d_sharedTerms.getNotifiedTheories(a));
+  }
+  if (d_sharedTerms.isShared(b)) {
+    theories = Theory::setUnion(theories, d_sharedTerms.getNotifiedTheories(b));
+  }
+
+  EqualityStatus first = EQUALITY_UNKNOWN;
+  TheoryId id;
+  while ((id = Theory::setPop(theories)) != THEORY_LAST) {
+    if (!d_logicInfo.isTheoryEnabled(id)) {
+      continue;
+    }
+    EqualityStatus es = theoryOf(id)->getEqualityStatus(a, b);
+    Debug("combineTheories") << "TheoryEngine::modelsAgreeOn(): " << id << " says " << es << endl;
+    if (es == EQUALITY_UNKNOWN) {
+      return false;
+    }
+    if (first == EQUALITY_UNKNOWN) {
+      first = es;
+    } else if (!equalityStatusCompatible(first, es)) {
+      return false;
+    }
+  }
+  return first != EQUALITY_UNKNOWN;
+}
+
 void TheoryEngine::propagate(Theory::Effort effort) {
   // Reset the interrupt flag
   d_interrupted = false;
@@ -1187,6 +1377,9 @@ void TheoryEngine::notifyPreprocessedAssertions(
       theoryOf(theoryId)->ppNotifyAssertions(assertions);
     }
   }
+  if (d_relevanceManager != NULL) {
+    d_relevanceManager->addAssertions(assertions);
+  }
 }
 
 bool TheoryEngine::markPropagation(TNode assertion, TNode originalAssertion, theory::TheoryId toTheoryId, theory::TheoryId fromTheoryId) {
@@ -1353,6 +1546,56 @@ void TheoryEngine::assertFact(TNode literal)
   bool polarity = literal.getKind() != kind::NOT;
   TNode atom = polarity ? literal : literal[0];
 
+  // Irrelevant facts wait until they become relevant, or until full effort
+  if (d_relevanceManager != NULL && !d_relevanceManager->isRelevant(atom)) {
+    Trace("theory::relevance") << "TheoryEngine::assertFact(): deferring " << literal << endl;
+    d_deferredFacts.push_back(literal);
+    d_deferredFactsByAtom[atom] = literal;
+    ++ d_relevanceDeferred;
+    return;
+  }
+
+  assertFactToTheories(literal);
+}
+
+bool TheoryEngine::assertDeferredFact(TNode atom) {
+  DeferredFactsMap::const_iterator find = d_deferredFactsByAtom.find(atom);
+  if (find == d_deferredFactsByAtom.end() || (*find).second.isNull()) {
+    return false;
+  }
+  Node literal = (*find).second;
+  d_deferredFactsByAtom[atom] = Node::null();
+  assertFactToTheories(literal);
+  return true;
+}
+
+void TheoryEngine::assertDeferredFacts(bool all) {
+  d_relevanceManager->update();
+  // Only the atoms that became relevant since the last call are looked up
+  unsigned nrelevant = d_relevanceManager->getNumRelevantAtoms();
+  for (unsigned i = d_relevantAtomsAsserted; i < nrelevant && !d_inConflict; ++ i) {
+    d_relevantAtomsAsserted = i + 1;
+    assertDeferredFact(d_relevanceManager->getRelevantAtom(i));
+  }
+  if (!all) {
+    return;
+  }
+  for (unsigned i = d_deferredFactsIndex; i < d_deferredFacts.size() && !d_inConflict; ++ i) {
+    d_deferredFactsIndex = i + 1;
+    TNode literal = d_deferredFacts[i];
+    TNode atom = literal.getKind() == kind::NOT ? literal[0] : literal;
+    if (assertDeferredFact(atom)) {
+      ++ d_relevanceFullEffort;
+    }
+  }
+}
+
+void TheoryEngine::assertFactToTheories(TNode literal)
+{
+  // Get the atom
+  bool polarity = literal.getKind() != kind::NOT;
+  TNode atom = polarity ? literal : literal[0];
+
   if (d_logicInfo.isSharingEnabled()) {
 
     // If any shared terms, it's time to do sharing work
@@ -1805,6 +2048,22 @@ theory::LemmaStatus TheoryEngine::lemma(TNode node,
                      << QueryCommand(n.toExpr());
   }
 
+  // A permanent lemma that was sent before in this user context is already
+  // in the SAT solver, unless it was not preprocessed and now should be
+  d_lastLemmaDuplicate = false;
+  bool useLemmaTable = options::lemmaTable() && !negated && !removable;
+  PROOF({ useLemmaTable = false; });
+  if (useLemmaTable) {
+    LemmaTable::const_iterator find = d_lemmaTable.find(node);
+    if (find != d_lemmaTable.end() && ((*find).second.second || !preprocess)) {
+      Debug("theory::lemma") << "TheoryEngine::lemma(): duplicate " << node << endl;
+      d_lastLemmaDuplicate = true;
+      // The theories expect another round after sending a lemma
+      d_lemmasAdded = true;
+      return theory::LemmaStatus((*find).second.first, d_userContext->getLevel());
+    }
+  }
+
   // Share with other portfolio threads
   if(d_channels->getLemmaOutputChannel() != NULL) {
     d_channels->getLemmaOutputChannel()->notifyNewLemma(node.toExpr());
@@ -1836,11 +2095,18 @@ theory::LemmaStatus TheoryEngine::lemma(TNode node,
   }
 
   // assert to prop engine
+  // The atoms of all the clauses are queued and pre-registered in one pass
+  bool inPreregister = d_inPreregister;
+  d_inPreregister = true;
   d_propEngine->assertLemma(additionalLemmas[0], negated, removable, rule, node);
   for (unsigned i = 1; i < additionalLemmas.size(); ++ i) {
     additionalLemmas[i] = theory::Rewriter::rewrite(additionalLemmas[i]);
     d_propEngine->assertLemma(additionalLemmas[i], false, removable, rule, node);
   }
+  d_inPreregister = inPreregister;
+  if (!d_inPreregister && !d_preregisterQueue.empty()) {
+    processPreregisterQueue();
+  }
 
   // WARNING: Below this point don't assume additionalLemmas[0] to be not negated.
   if(negated) {
@@ -1848,6 +2114,11 @@ theory::LemmaStatus TheoryEngine::lemma(TNode node,
     negated = false;
   }
 
+  // The lemmas are true, so the atoms justifying them are relevant
+  if (d_relevanceManager != NULL) {
+    d_relevanceManager->addAssertions(additionalLemmas);
+  }
+
   // assert to decision engine
   if(!removable) {
     d_decisionEngine->addAssertions(additionalLemmas, 1, iteSkolemMap);
@@ -1856,6 +2127,10 @@ theory::LemmaStatus TheoryEngine::lemma(TNode node,
   // Mark that we added some lemmas
   d_lemmasAdded = true;
 
+  if (useLemmaTable) {
+    d_lemmaTable[node] = std::make_pair(additionalLemmas[0], preprocess);
+  }
+
   // Lemma analysis isn't online yet; this lemma may only live for this
   // user level.
   return theory::LemmaStatus(additionalLemmas[0], d_userContext->getLevel());
@@ -1985,6 +2260,22 @@ void TheoryEngine::staticInitializeBVOptions(
   }
 }
 
+void TheoryEngine::purgeExplanationMemo() {
+  // The propagations from the current timestamp on are gone
+  std::map<size_t, std::vector<NodeTheoryPair> >::iterator it =
+    d_explanationMemoByTimestamp.lower_bound(d_propagationMapTimestamp);
+  for (std::map<size_t, std::vector<NodeTheoryPair> >::iterator it_end = d_explanationMemoByTimestamp.end(); it != it_end; ) {
+    const std::vector<NodeTheoryPair>& pairs = (*it).second;
+    for (unsigned k = 0; k < pairs.size(); ++ k) {
+      ExplanationMemo::iterator memo = d_explanationMemo.find(pairs[k]);
+      if (memo != d_explanationMemo.end() && (*memo).second.timestamp == (*it).first) {
+        d_explanationMemo.erase(memo);
+      }
+    }
+    d_explanationMemoByTimestamp.erase(it ++);
+  }
+}
+
 void TheoryEngine::getExplanation(std::vector<NodeTheoryPair>& explanationVector, LemmaProofRecipe* proofRecipe) {
   Assert(explanationVector.size() > 0);
 
@@ -2000,19 +2291,42 @@ void TheoryEngine::getExplanation(std::vector<NodeTheoryPair>& explanationVector
     }
   });
 
+  // The memo is not used when a proof is recorded. For the memo we keep
+  // the processed pairs, the pair each one was expanded from and its kind.
+  bool useMemo = options::theoryExplanationMemo() && proofRecipe == NULL
+                 && !d_checkingExplanationMemo;
+  enum ExplainedKind { EXPLAINED_TRIVIAL, EXPLAINED_LEAF, EXPLAINED_EXPANDED, EXPLAINED_MEMO };
+  std::vector<NodeTheoryPair> explained;
+  std::vector<ExplainedKind> explainedKinds;
+  const unsigned noParent = static_cast<unsigned>(-1);
+  std::vector<unsigned> parents(explanationVector.size(), noParent);
+  std::vector<unsigned> depths(explanationVector.size(), 0);
+  unsigned maxDepth = 0;
+
   while (i < explanationVector.size()) {
     // Get the current literal to explain
     NodeTheoryPair toExplain = explanationVector[i];
+    explained.push_back(toExplain);
+    explainedKinds.push_back(EXPLAINED_EXPANDED);
+    for (unsigned k = parents.size(); k < explanationVector.size(); ++ k) {
+      parents.push_back(i - 1);
+      depths.push_back(depths[i - 1] + 1);
+    }
+    if (depths[i] > maxDepth) {
+      maxDepth = depths[i];
+    }
 
     Debug("theory::explain") << "[i=" << i << "] TheoryEngine::explain(): processing [" << toExplain.timestamp << "] " << toExplain.node << " sent from " << toExplain.theory << endl;
 
 
     // If a true constant or a negation of a false constant we can ignore it
     if (toExplain.node.isConst() && toExplain.node.getConst<bool>()) {
+      explainedKinds[i] = EXPLAINED_TRIVIAL;
       ++ i;
       continue;
     }
     if (toExplain.node.getKind() == kind::NOT && toExplain.node[0].isConst() && !toExplain.node[0].getConst<bool>()) {
+      explainedKinds[i] = EXPLAINED_TRIVIAL;
       ++ i;
       continue;
     }
@@ -2020,6 +2334,7 @@ void TheoryEngine::getExplanation(std::vector<NodeTheoryPair>& explanationVector
     // If from the SAT solver, keep it
     if (toExplain.theory == THEORY_SAT_SOLVER) {
       Debug("theory::explain") << "\tLiteral came from THEORY_SAT_SOLVER. Kepping it." << endl;
+      explainedKinds[i] = EXPLAINED_LEAF;
       explanationVector[j++] = explanationVector[i++];
       continue;
     }
@@ -2035,6 +2350,36 @@ void TheoryEngine::getExplanation(std::vector<NodeTheoryPair>& explanationVector
       continue;
     }
 
+    // See if it was explained before
+    if (useMemo) {
+      ExplanationMemo::const_iterator memo = d_explanationMemo.find(toExplain);
+      if (memo != d_explanationMemo.end() && (*memo).second.timestamp == toExplain.timestamp) {
+        Debug("theory::explain") << "\tExplanation found in the memo" << std::endl;
+        ++ d_explanationMemoHits;
+        const std::vector<Node>& literals = (*memo).second.literals;
+#ifdef CVC4_ASSERTIONS
+        // The memoized literals must be those of a fresh expansion
+        std::vector<NodeTheoryPair> fresh;
+        fresh.push_back(toExplain);
+        d_checkingExplanationMemo = true;
+        getExplanation(fresh, NULL);
+        d_checkingExplanationMemo = false;
+        std::set<Node> freshLiterals;
+        for (unsigned k = 0; k < fresh.size(); ++ k) {
+          freshLiterals.insert(fresh[k].node);
+        }
+        Assert(freshLiterals == std::set<Node>(literals.begin(), literals.end()),
+               "memoized explanation differs from a fresh expansion");
+#endif /* CVC4_ASSERTIONS */
+        for (unsigned k = 0; k < literals.size(); ++ k) {
+          explanationVector.push_back(NodeTheoryPair(literals[k], THEORY_SAT_SOLVER, toExplain.timestamp));
+        }
+        explainedKinds[i] = EXPLAINED_MEMO;
+        ++ i;
+        continue;
+      }
+    }
+
     // See if it was sent to the theory by another theory
     PropagationMap::const_iterator find = d_propagationMap.find(toExplain);
     if (find != d_propagationMap.end()) {
@@ -2123,6 +2468,39 @@ void TheoryEngine::getExplanation(std::vector<NodeTheoryPair>& explanationVector
     });
   }
 
+  d_explanationDepth.addEntry(maxDepth);
+
+  if (useMemo) {
+    // Collect the literals each pair expands to, from the last pair back,
+    // and memoize the expansions of the pairs with an older timestamp
+    std::vector< std::vector<unsigned> > leaves(explained.size());
+    std::vector<bool> tooLarge(explained.size(), false);
+    for (unsigned k = explained.size(); k -- > 0; ) {
+      const NodeTheoryPair& pair = explained[k];
+      if (explainedKinds[k] == EXPLAINED_LEAF) {
+        leaves[k].push_back(k);
+      } else if (explainedKinds[k] == EXPLAINED_EXPANDED && !tooLarge[k]
+                 && pair.node.getKind() != kind::AND
+                 && pair.timestamp < d_propagationMapTimestamp) {
+        ExplanationMemoEntry& entry = d_explanationMemo[pair];
+        entry.timestamp = pair.timestamp;
+        entry.literals.clear();
+        for (unsigned l = 0; l < leaves[k].size(); ++ l) {
+          entry.literals.push_back(explained[leaves[k][l]].node);
+        }
+        d_explanationMemoByTimestamp[pair.timestamp].push_back(pair);
+      }
+      unsigned parent = parents[k];
+      if (parent != noParent) {
+        if (tooLarge[k] || leaves[parent].size() + leaves[k].size() > s_maxExplanationMemoSize) {
+          tooLarge[parent] = true;
+        } else {
+          leaves[parent].insert(leaves[parent].end(), leaves[k].begin(), leaves[k].end());
+        }
+      }
+    }
+  }
+
   // Keep only the relevant literals
   explanationVector.resize(j);
 
@@ -2268,13 +2646,26 @@ TheoryEngine::Statistics::Statistics(theory::TheoryId theory):
     propagations(getStatsPrefix(theory) + "::propagations", 0),
     lemmas(getStatsPrefix(theory) + "::lemmas", 0),
     requirePhase(getStatsPrefix(theory) + "::requirePhase", 0),
-    restartDemands(getStatsPrefix(theory) + "::restartDemands", 0)
+    restartDemands(getStatsPrefix(theory) + "::restartDemands", 0),
+    duplicateLemmas(getStatsPrefix(theory) + "::duplicateLemmas", 0),
+    preprocessingSkipped(getStatsPrefix(theory) + "::preprocessingSkipped", 0),
+    fullCheckTime(getStatsPrefix(theory) + "::fullCheckTime"),
+    fullCheckTaskTime(getStatsPrefix(theory) + "::fullCheckTaskTime"),
+    lastCallCheckTime(getStatsPrefix(theory) + "::lastCallCheckTime"),
+    sampledStandardCheckTime(getStatsPrefix(theory) + "::sampledStandardCheckTime"),
+    standardChecks(0)
 {
   smtStatisticsRegistry()->registerStat(&conflicts);
   smtStatisticsRegistry()->registerStat(&propagations);
   smtStatisticsRegistry()->registerStat(&lemmas);
   smtStatisticsRegistry()->registerStat(&requirePhase);
   smtStatisticsRegistry()->registerStat(&restartDemands);
+  smtStatisticsRegistry()->registerStat(&duplicateLemmas);
+  smtStatisticsRegistry()->registerStat(&preprocessingSkipped);
+  smtStatisticsRegistry()->registerStat(&fullCheckTime);
+  smtStatisticsRegistry()->registerStat(&fullCheckTaskTime);
+  smtStatisticsRegistry()->registerStat(&lastCallCheckTime);
+  smtStatisticsRegistry()->registerStat(&sampledStandardCheckTime);
 }
 
 TheoryEngine::Statistics::~Statistics() {
@@ -2283,6 +2674,12 @@ TheoryEngine::Statistics::~Statistics() {
   smtStatisticsRegistry()->unregisterStat(&lemmas);
   smtStatisticsRegistry()->unregisterStat(&requirePhase);
   smtStatisticsRegistry()->unregisterStat(&restartDemands);
+  smtStatisticsRegistry()->unregisterStat(&duplicateLemmas);
+  smtStatisticsRegistry()->unregisterStat(&preprocessingSkipped);
+  smtStatisticsRegistry()->unregisterStat(&fullCheckTime);
+  smtStatisticsRegistry()->unregisterStat(&fullCheckTaskTime);
+  smtStatisticsRegistry()->unregisterStat(&lastCallCheckTime);
+  smtStatisticsRegistry()->unregisterStat(&sampledStandardCheckTime);
 }
 
 }/* CVC4 namespace */
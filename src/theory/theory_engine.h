@@ -20,6 +20,7 @@
 #define __CVC4__THEORY_ENGINE_H
 
 #include <deque>
+#include <map>
 #include <memory>
 #include <set>
 #include <unordered_map>
@@ -28,6 +29,7 @@
 
 #include "base/cvc4_assert.h"
 #include "context/cdhashset.h"
+#include "context/cdlist.h"
 #include "expr/node.h"
 #include "options/options.h"
 #include "options/smt_options.h"
@@ -36,6 +38,7 @@
 #include "smt_util/lemma_channels.h"
 #include "theory/atom_requests.h"
 #include "theory/interrupted.h"
+#include "theory/relevance_manager.h"
 #include "theory/rewriter.h"
 #include "theory/shared_terms_database.h"
 #include "theory/sort_inference.h"
@@ -47,6 +50,7 @@
 #include "util/hash.h"
 #include "util/statistics_registry.h"
 #include "util/unsafe_interrupt_exception.h"
+#include "util/worker_pool.h"
 
 namespace CVC4 {
 
@@ -248,6 +252,35 @@ class TheoryEngine {
    public:
     IntStat conflicts, propagations, lemmas, requirePhase, restartDemands;
 
+    /** Lemmas that were sent before and not processed again */
+    IntStat duplicateLemmas;
+
+    /** Preprocessing calls saved by the duplicate lemmas */
+    IntStat preprocessingSkipped;
+
+    /** Wall time spent in the full effort checks of the theory */
+    HistogramTimerStat fullCheckTime;
+
+    /**
+     * Wall time spent in the concurrent parts of the full effort checks of
+     * the theory (see Theory::getFullCheckTask). Only the thread that runs
+     * the task of the theory starts and stops it, and it is only read once
+     * all the tasks are done.
+     */
+    HistogramTimerStat fullCheckTaskTime;
+
+    /** Wall time spent in the last call effort checks of the theory */
+    HistogramTimerStat lastCallCheckTime;
+
+    /**
+     * Wall time spent in the sampled standard effort checks of the theory,
+     * one in every --theory-check-time-sampling of them
+     */
+    HistogramTimerStat sampledStandardCheckTime;
+
+    /** Number of standard effort checks, for the sampling */
+    unsigned standardChecks;
+
     Statistics(theory::TheoryId theory);
     ~Statistics();
   };/* class TheoryEngine::Statistics */
@@ -339,6 +372,12 @@ class TheoryEngine {
    */
   EngineOutputChannel* d_theoryOut[theory::THEORY_LAST];
 
+  /**
+   * The worker threads of the full effort checks, if
+   * options::theoryCheckThreads() is greater than one.
+   */
+  WorkerPool d_checkWorkers;
+
   /**
    * Are we in conflict.
    */
@@ -380,6 +419,53 @@ class TheoryEngine {
    */
   context::CDO<size_t> d_propagationMapTimestamp;
 
+  /** A fully expanded explanation of a propagation */
+  struct ExplanationMemoEntry {
+    /** The timestamp of the explained pair */
+    size_t timestamp;
+    /** The literals from the SAT solver it expands to */
+    std::vector<Node> literals;
+  };
+
+  /**
+   * Memo of the explanations of the pairs with a timestamp below the
+   * current one. Such an explanation only depends on the propagations
+   * with smaller timestamps, so it stays valid until a pop takes the
+   * propagation timestamp back to the timestamp of the pair.
+   */
+  typedef std::unordered_map<NodeTheoryPair, ExplanationMemoEntry, NodeTheoryPairHashFunction> ExplanationMemo;
+  ExplanationMemo d_explanationMemo;
+
+  /** The pairs in the memo by their timestamp, for purging */
+  std::map<size_t, std::vector<NodeTheoryPair> > d_explanationMemoByTimestamp;
+
+  /** The largest number of literals of a memoized explanation */
+  static const size_t s_maxExplanationMemoSize = 128;
+
+  /** Removes the memoized explanations that a pop has invalidated */
+  void purgeExplanationMemo();
+
+  /** Helper class to purge the explanation memo on pop */
+  class ExplanationMemoInvalidator : public context::ContextNotifyObj {
+    TheoryEngine& d_engine;
+  protected:
+    void contextNotifyPop() override { d_engine.purgeExplanationMemo(); }
+
+  public:
+    ExplanationMemoInvalidator(context::Context* context, TheoryEngine& engine) :
+      context::ContextNotifyObj(context),
+      d_engine(engine) {
+    }
+  };/* class TheoryEngine::ExplanationMemoInvalidator */
+
+  ExplanationMemoInvalidator d_explanationMemoInvalidator;
+
+  /**
+   * True while a memo hit is checked against a fresh expansion, which
+   * must not use the memo.
+   */
+  bool d_checkingExplanationMemo;
+
   /**
    * Literals that are propagated by the theory. Note that these are TNodes.
    * The theory can only propagate nodes that have an assigned literal in the
@@ -421,6 +507,48 @@ class TheoryEngine {
   /** Atom requests from lemmas */
   AtomRequests d_atomRequests;
 
+  /**
+   * The permanent lemmas sent in the current user context, mapped to their
+   * rewritten form and whether they were preprocessed. Sending one of them
+   * again would only add the same clauses again.
+   */
+  typedef context::CDHashMap<Node, std::pair<Node, bool>, NodeHashFunction> LemmaTable;
+  LemmaTable d_lemmaTable;
+
+  /** Whether the last lemma was found in the lemma table */
+  bool d_lastLemmaDuplicate;
+
+  /** The relevance of the atoms, if only relevant facts are asserted */
+  theory::RelevanceManager* d_relevanceManager;
+
+  /** The facts from the SAT solver not asserted as they were irrelevant */
+  context::CDList<Node> d_deferredFacts;
+
+  /**
+   * The deferred facts by atom, mapped to null once they have been
+   * asserted
+   */
+  typedef context::CDHashMap<Node, Node, NodeHashFunction> DeferredFactsMap;
+  DeferredFactsMap d_deferredFactsByAtom;
+
+  /** The deferred facts before this index have been asserted */
+  context::CDO<unsigned> d_deferredFactsIndex;
+
+  /**
+   * The number of relevant atoms of the relevance manager whose deferred
+   * facts have been asserted
+   */
+  context::CDO<unsigned> d_relevantAtomsAsserted;
+
+  /** Asserts the deferred fact on atom, if any, returns true if it did */
+  bool assertDeferredFact(TNode atom);
+
+  /**
+   * Asserts the deferred facts that have become relevant, or all of them if
+   * all is true.
+   */
+  void assertDeferredFacts(bool all);
+
   /**
    * Adds a new lemma, returning its status.
    * @param node the lemma
@@ -446,6 +574,33 @@ class TheoryEngine {
   /** Time spent in theory combination */
   TimerStat d_combineTheoriesTime;
 
+  /** Number of care pairs computed in theory combination */
+  IntStat d_careGraphSize;
+
+  /** Number of split lemmas sent in theory combination */
+  IntStat d_careGraphSplits;
+
+  /** Number of care pairs skipped as the models agree on them */
+  IntStat d_careGraphModelSkipped;
+
+  /** Number of care pairs skipped as they were split on before */
+  IntStat d_careGraphRepeatSkipped;
+
+  /** Number of propagations explained from the memo */
+  IntStat d_explanationMemoHits;
+
+  /** Depth of the expansions of the explanations */
+  AverageStat d_explanationDepth;
+
+  /** Time spent pre-registering atoms */
+  TimerStat d_preRegisterTime;
+
+  /** Number of facts whose assertion was deferred as they were irrelevant */
+  IntStat d_relevanceDeferred;
+
+  /** Number of deferred facts that were still irrelevant at full effort */
+  IntStat d_relevanceFullEffort;
+
   Node d_true;
   Node d_false;
 
@@ -542,6 +697,12 @@ private:
    */
   bool d_inPreregister;
 
+  /**
+   * Pre-registers the atoms in the pre-registration queue, including the
+   * ones queued while doing so.
+   */
+  void processPreregisterQueue();
+
   /**
    * Did the theories get any new facts since the last time we called
    * check()
@@ -651,14 +812,50 @@ public:
    */
   void assertFact(TNode node);
 
+  /**
+   * Assert the formula to the appropriate theory, regardless of its
+   * relevance.
+   * @param node the assertion
+   */
+  void assertFactToTheories(TNode node);
+
   /**
    * Check all (currently-active) theories for conflicts.
    * @param effort the effort level to use
    */
   void check(theory::Theory::Effort effort);
 
+  /**
+   * Runs the check of a single theory, timing it if it is a full or last
+   * call effort check, or a sampled standard effort check.
+   */
+  void checkTheory(theory::TheoryId theoryId, theory::Theory::Effort effort);
+
+  /**
+   * Runs the full effort checks of the theories with
+   * options::theoryCheckThreads() threads. The tasks of the theories (see
+   * Theory::getFullCheckTask) run on these threads first. Once they are all
+   * done, the theories are checked on this thread in the order of the serial
+   * loop, and the checks stop at the first conflict.
+   *
+   * Only the tasks run concurrently: check() itself creates nodes and sends
+   * lemmas, conflicts and propagations, and NodeManager is not thread safe.
+   */
+  void checkTheoriesConcurrently(theory::Theory::Effort effort);
+
   /**
    * Run the combination framework.
+   *
+   * The care graphs are computed by the parametric theories in every round,
+   * over all the shared terms. They are not computed from the shared terms
+   * added since the last round only: the theories compute their care pairs
+   * from their current equivalence classes, e.g. the arguments of congruent
+   * applications in UF, so merges can make a pair of old shared terms a
+   * care pair. Also, with --tc-model-based, a pair whose models agreed in an
+   * earlier round must be checked again, since the models change between
+   * rounds. What is incremental is the splitting: with --tc-model-based, an
+   * equality that was split on is not split on again in the user context
+   * (see d_careSplits).
    */
   void combineTheories();
 
@@ -826,6 +1023,19 @@ private:
   /** Dump the assertions to the dump */
   void dumpAssertions(const char* tag);
 
+  /**
+   * Returns true if all the theories sharing a or b have a model in which
+   * a = b has the same value, so no split on a = b is needed.
+   */
+  bool modelsAgreeOn(TNode a, TNode b, theory::TheoryId careTheory);
+
+  /**
+   * The equalities split on in theory combination with --tc-model-based.
+   * The split lemmas stay for the rest of the user context, so they need not
+   * be sent again.
+   */
+  context::CDHashSet<Node, NodeHashFunction> d_careSplits;
+
   /** For preprocessing pass lifting bit-vectors of size 1 to booleans */
 public:
   void staticInitializeBVOptions(const std::vector<Node>& assertions);
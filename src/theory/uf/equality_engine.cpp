@@ -17,6 +17,7 @@
 
 #include "theory/uf/equality_engine.h"
 
+#include "options/uf_options.h"
 #include "smt/smt_statistics_registry.h"
 
 namespace CVC4 {
@@ -27,12 +28,16 @@ EqualityEngine::Statistics::Statistics(std::string name)
     : mergesCount(name + "::mergesCount", 0),
       termsCount(name + "::termsCount", 0),
       functionTermsCount(name + "::functionTermsCount", 0),
-      constantTermsCount(name + "::constantTermsCount", 0)
+      constantTermsCount(name + "::constantTermsCount", 0),
+      explanationCacheHits(name + "::explanationCacheHits", 0),
+      explanationSize(name + "::explanationSize")
 {
   smtStatisticsRegistry()->registerStat(&mergesCount);
   smtStatisticsRegistry()->registerStat(&termsCount);
   smtStatisticsRegistry()->registerStat(&functionTermsCount);
   smtStatisticsRegistry()->registerStat(&constantTermsCount);
+  smtStatisticsRegistry()->registerStat(&explanationCacheHits);
+  smtStatisticsRegistry()->registerStat(&explanationSize);
 }
 
 EqualityEngine::Statistics::~Statistics() {
@@ -40,6 +45,8 @@ EqualityEngine::Statistics::~Statistics() {
   smtStatisticsRegistry()->unregisterStat(&termsCount);
   smtStatisticsRegistry()->unregisterStat(&functionTermsCount);
   smtStatisticsRegistry()->unregisterStat(&constantTermsCount);
+  smtStatisticsRegistry()->unregisterStat(&explanationCacheHits);
+  smtStatisticsRegistry()->unregisterStat(&explanationSize);
 }
 
 /**
@@ -112,6 +119,8 @@ EqualityEngine::EqualityEngine(context::Context* context, std::string name, bool
 , d_applicationLookupsCount(context, 0)
 , d_nodesCount(context, 0)
 , d_assertedEqualitiesCount(context, 0)
+, d_proofForestUpdatesSize(context, 0)
+, d_proofForestVisit(0)
 , d_equalityTriggersCount(context, 0)
 , d_subtermEvaluatesSize(context, 0)
 , d_stats(name)
@@ -137,6 +146,8 @@ EqualityEngine::EqualityEngine(EqualityEngineNotify& notify, context::Context* c
 , d_applicationLookupsCount(context, 0)
 , d_nodesCount(context, 0)
 , d_assertedEqualitiesCount(context, 0)
+, d_proofForestUpdatesSize(context, 0)
+, d_proofForestVisit(0)
 , d_equalityTriggersCount(context, 0)
 , d_subtermEvaluatesSize(context, 0)
 , d_stats(name)
@@ -183,23 +194,23 @@ EqualityNodeId EqualityEngine::newApplicationNode(TNode original, EqualityNodeId
   d_applications[funId] = FunctionApplicationPair(funOriginal, funNormalized);
 
   // Add the lookup data, if it's not already there
-  ApplicationIdsMap::iterator find = d_applicationLookup.find(funNormalized);
-  if (find == d_applicationLookup.end()) {
+  EqualityNodeId lookup = d_applicationLookup.find(funNormalized);
+  if (lookup == null_id) {
     Debug("equality") << d_name << "::eq::newApplicationNode(" << original << ", " << t1 << ", " << t2 << "): no lookup, setting up" << std::endl;
     // Mark the normalization to the lookup
     storeApplicationLookup(funNormalized, funId);
   } else {
     // If it's there, we need to merge these two
     Debug("equality") << d_name << "::eq::newApplicationNode(" << original << ", " << t1 << ", " << t2 << "): lookup exists, adding to queue" << std::endl;
-    Debug("equality") << d_name << "::eq::newApplicationNode(" << original << ", " << t1 << ", " << t2 << "): lookup = " << d_nodes[find->second] << std::endl;
-    enqueue(MergeCandidate(funId, find->second, MERGED_THROUGH_CONGRUENCE, TNode::null()));
+    Debug("equality") << d_name << "::eq::newApplicationNode(" << original << ", " << t1 << ", " << t2 << "): lookup = " << d_nodes[lookup] << std::endl;
+    enqueue(MergeCandidate(funId, lookup, MERGED_THROUGH_CONGRUENCE, TNode::null()));
   }
 
   // Add to the use lists
   Debug("equality") << d_name << "::eq::newApplicationNode(" << original << ", " << t1 << ", " << t2 << "): adding " << original << " to the uselist of " << d_nodes[t1] << std::endl;
-  d_equalityNodes[t1].usedIn(funId, d_useListNodes);
+  d_useLists[t1].push_back(funId);
   Debug("equality") << d_name << "::eq::newApplicationNode(" << original << ", " << t1 << ", " << t2 << "): adding " << original << " to the uselist of " << d_nodes[t2] << std::endl;
-  d_equalityNodes[t2].usedIn(funId, d_useListNodes);
+  d_useLists[t2].push_back(funId);
 
   // Return the new id
   Debug("equality") << d_name << "::eq::newApplicationNode(" << original << ", " << t1 << ", " << t2 << ") => " << funId << std::endl;
@@ -224,6 +235,11 @@ EqualityNodeId EqualityEngine::newNode(TNode node) {
   d_nodeTriggers.push_back(+null_trigger);
   // Add it to the equality graph
   d_equalityGraph.push_back(+null_edge);
+  // No applications use the node yet
+  d_useLists.push_back(std::vector<EqualityNodeId>());
+  // The node is the root of its proof tree
+  d_proofParent.push_back(+null_id);
+  d_proofParentEdge.push_back(+null_edge);
   // Mark the no-individual trigger
   d_nodeIndividualTrigger.push_back(+null_set_id);
   // Mark non-constant by default
@@ -627,14 +643,11 @@ bool EqualityEngine::merge(EqualityNode& class1, EqualityNode& class2, std::vect
       Debug("equality") << d_name << "::eq::merge(" << class1.getFind() << "," << class2.getFind() << "): updating lookups of node " << currentId << std::endl;
 
       // Go through the uselist and check for congruences
-      UseListNodeId currentUseId = currentNode.getUseList();
-      while (currentUseId != null_uselist_id) {
-        // Get the node of the use list
-        UseListNode& useNode = d_useListNodes[currentUseId];
+      for (size_t useIndex = 0, useEnd = d_useLists[currentId].size(); useIndex < useEnd; ++ useIndex) {
         // Get the function application
-        EqualityNodeId funId = useNode.getApplicationId();
+        EqualityNodeId funId = d_useLists[currentId][useIndex];
         Debug("equality") << d_name << "::eq::merge(" << class1.getFind() << "," << class2.getFind() << "): " << d_nodes[currentId] << " in " << d_nodes[funId] << std::endl;
-        const FunctionApplication& fun = d_applications[useNode.getApplicationId()].normalized;
+        const FunctionApplication& fun = d_applications[funId].normalized;
         // If it's interpreted and we can interpret
   if (fun.isInterpreted() && class1isConstant && !d_isInternal[currentId]) {
     // Get the actual term id
@@ -645,19 +658,16 @@ bool EqualityEngine::merge(EqualityNode& class1, EqualityNode& class2, std::vect
         EqualityNodeId aNormalized = getEqualityNode(fun.a).getFind();
         EqualityNodeId bNormalized = getEqualityNode(fun.b).getFind();
         FunctionApplication funNormalized(fun.type, aNormalized, bNormalized);
-        ApplicationIdsMap::iterator find = d_applicationLookup.find(funNormalized);
-        if (find != d_applicationLookup.end()) {
+        EqualityNodeId lookup = d_applicationLookup.find(funNormalized);
+        if (lookup != null_id) {
           // Applications fun and the funNormalized can be merged due to congruence
-          if (getEqualityNode(funId).getFind() != getEqualityNode(find->second).getFind()) {
-            enqueue(MergeCandidate(funId, find->second, MERGED_THROUGH_CONGRUENCE, TNode::null()));
+          if (getEqualityNode(funId).getFind() != getEqualityNode(lookup).getFind()) {
+            enqueue(MergeCandidate(funId, lookup, MERGED_THROUGH_CONGRUENCE, TNode::null()));
           }
         } else {
           // There is no representative, so we can add one, we remove this when backtracking
           storeApplicationLookup(funNormalized, funId);
         }
-
-        // Go to the next one in the use list
-        currentUseId = useNode.getNext();
       }
 
       // Move to the next node
@@ -816,6 +826,21 @@ void EqualityEngine::backtrack() {
     }
 
     d_equalityEdges.resize(2 * d_assertedEqualitiesCount);
+
+    // Forget the explanations that might use the removed edges
+    while (!d_explanationCacheTrail.empty() && d_explanationCacheTrail.back().second > d_equalityEdges.size()) {
+      d_explanationCache.erase(d_explanationCacheTrail.back().first);
+      d_explanationCacheTrail.pop_back();
+    }
+  }
+
+  if (d_proofForestUpdates.size() > d_proofForestUpdatesSize) {
+    for (int i = d_proofForestUpdates.size() - 1, i_end = d_proofForestUpdatesSize; i >= i_end; -- i) {
+      const ProofForestUpdate& update = d_proofForestUpdates[i];
+      d_proofParent[update.nodeId] = update.oldParent;
+      d_proofParentEdge[update.nodeId] = update.oldEdge;
+    }
+    d_proofForestUpdates.resize(d_proofForestUpdatesSize);
   }
 
   if (d_triggerTermSetUpdates.size() > d_triggerTermSetUpdatesSize) {
@@ -862,9 +887,11 @@ void EqualityEngine::backtrack() {
       const FunctionApplication& app = d_applications[i].original;
       if (!app.isNull()) {
         // Remove b from use-list
-        getEqualityNode(app.b).removeTopFromUseList(d_useListNodes);
+        Assert(d_useLists[app.b].back() == (EqualityNodeId)i);
+        d_useLists[app.b].pop_back();
         // Remove a from use-list
-        getEqualityNode(app.a).removeTopFromUseList(d_useListNodes);
+        Assert(d_useLists[app.a].back() == (EqualityNodeId)i);
+        d_useLists[app.a].pop_back();
       }
     }
 
@@ -878,6 +905,9 @@ void EqualityEngine::backtrack() {
     d_isEquality.resize(d_nodesCount);
     d_isInternal.resize(d_nodesCount);
     d_equalityGraph.resize(d_nodesCount);
+    d_useLists.resize(d_nodesCount);
+    d_proofParent.resize(d_nodesCount);
+    d_proofParentEdge.resize(d_nodesCount);
     d_equalityNodes.resize(d_nodesCount);
   }
 
@@ -903,12 +933,49 @@ void EqualityEngine::addGraphEdge(EqualityNodeId t1, EqualityNodeId t2, unsigned
   d_equalityEdges.push_back(EqualityEdge(t1, d_equalityGraph[t2], type, reason));
   d_equalityGraph[t1] = edge;
   d_equalityGraph[t2] = edge | 1;
+  addProofForestEdge(t1, t2, edge);
 
   if (Debug.isOn("equality::internal")) {
     debugPrintGraph();
   }
 }
 
+void EqualityEngine::setProofParent(EqualityNodeId nodeId, EqualityNodeId parent, EqualityEdgeId edge) {
+  d_proofForestUpdates.push_back(ProofForestUpdate(nodeId, d_proofParent[nodeId], d_proofParentEdge[nodeId]));
+  d_proofParent[nodeId] = parent;
+  d_proofParentEdge[nodeId] = edge;
+}
+
+void EqualityEngine::addProofForestEdge(EqualityNodeId t1, EqualityNodeId t2, EqualityEdgeId edge) {
+  // Reroot the tree of the smaller class at its end of the edge, so that
+  // edge (resp. edge | 1) is the edge from the new root to its parent
+  EqualityNodeId child = t1;
+  EqualityNodeId parent = t2;
+  EqualityEdgeId childEdge = edge;
+  if (getEqualityNode(getEqualityNode(t1).getFind()).getSize() > getEqualityNode(getEqualityNode(t2).getFind()).getSize()) {
+    child = t2;
+    parent = t1;
+    childEdge = edge | 1;
+  }
+
+  // Reverse the path from child to its root
+  EqualityNodeId previous = null_id;
+  EqualityEdgeId previousEdge = null_edge;
+  EqualityNodeId current = child;
+  while (current != null_id) {
+    EqualityNodeId next = d_proofParent[current];
+    EqualityEdgeId nextEdge = d_proofParentEdge[current];
+    setProofParent(current, previous, previousEdge);
+    previous = current;
+    // The two halves of an edge are 2k and 2k+1
+    previousEdge = nextEdge == null_edge ? null_edge : (nextEdge ^ 1u);
+    current = next;
+  }
+
+  setProofParent(child, parent, childEdge);
+  d_proofForestUpdatesSize = d_proofForestUpdates.size();
+}
+
 std::string EqualityEngine::edgesToString(EqualityEdgeId edgeId) const {
   std::stringstream out;
   bool first = true;
@@ -939,6 +1006,7 @@ void EqualityEngine::explainEquality(TNode t1, TNode t2, bool polarity,
   // Get the ids
   EqualityNodeId t1Id = getNodeId(t1);
   EqualityNodeId t2Id = getNodeId(t2);
+  size_t start = equalities.size();
 
   if (polarity) {
     // Get the explanation
@@ -1015,6 +1083,7 @@ void EqualityEngine::explainEquality(TNode t1, TNode t2, bool polarity,
       eqp->debug_print("pf::ee", 1);
     }
   }
+  d_stats.explanationSize.addEntry(equalities.size() - start);
 }
 
 void EqualityEngine::explainPredicate(TNode p, bool polarity,
@@ -1024,9 +1093,11 @@ void EqualityEngine::explainPredicate(TNode p, bool polarity,
                     << std::endl;
   // Must have the term
   Assert(hasTerm(p));
+  size_t start = assertions.size();
   // Get the explanation
   getExplanation(getNodeId(p), polarity ? d_trueId : d_falseId, assertions,
                  eqp);
+  d_stats.explanationSize.addEntry(assertions.size() - start);
 }
 
 void EqualityEngine::getExplanation(EqualityNodeId t1Id, EqualityNodeId t2Id,
@@ -1060,6 +1131,11 @@ void EqualityEngine::getExplanation(EqualityNodeId t1Id, EqualityNodeId t2Id,
     return;
   }
 
+  // Without a proof the path in the proof forest suffices
+  if (!eqp && options::eeProofForest()
+      && getProofForestExplanation(t1Id, t2Id, equalities)) {
+    return;
+  }
 
   if (Debug.isOn("equality::internal")) {
     debugPrintGraph();
@@ -1309,6 +1385,126 @@ void EqualityEngine::getExplanation(EqualityNodeId t1Id, EqualityNodeId t2Id,
   }
 }
 
+bool EqualityEngine::getProofForestExplanation(EqualityNodeId t1Id, EqualityNodeId t2Id,
+                                               std::vector<TNode>& equalities) const {
+  Debug("equality") << d_name << "::eq::getProofForestExplanation(" << d_nodes[t1Id] << "," << d_nodes[t2Id] << ")" << std::endl;
+
+  if (d_proofForestMarks.size() < d_nodes.size()) {
+    d_proofForestMarks.resize(d_nodes.size(), 0);
+  }
+  d_proofForestVisit += 2;
+  if (d_proofForestVisit < 2) {
+    // Wrapped around, so clear the old marks
+    std::fill(d_proofForestMarks.begin(), d_proofForestMarks.end(), 0);
+    d_proofForestVisit = 2;
+  }
+  const unsigned mark1 = d_proofForestVisit;
+  const unsigned mark2 = d_proofForestVisit + 1;
+
+  // Walk up from both nodes in turn until one reaches a node marked by the
+  // other, so that the walk is linear in the length of the path
+  EqualityNodeId ancestor = null_id;
+  EqualityNodeId current1 = t1Id;
+  EqualityNodeId current2 = t2Id;
+  d_proofForestMarks[current1] = mark1;
+  d_proofForestMarks[current2] = mark2;
+  while (ancestor == null_id) {
+    bool moved = false;
+    if (d_proofParent[current1] != null_id) {
+      current1 = d_proofParent[current1];
+      if (d_proofForestMarks[current1] == mark2) {
+        ancestor = current1;
+        break;
+      }
+      d_proofForestMarks[current1] = mark1;
+      moved = true;
+    }
+    if (d_proofParent[current2] != null_id) {
+      current2 = d_proofParent[current2];
+      if (d_proofForestMarks[current2] == mark1) {
+        ancestor = current2;
+        break;
+      }
+      d_proofForestMarks[current2] = mark2;
+      moved = true;
+    }
+    if (!moved) {
+      // Different trees
+      return false;
+    }
+  }
+
+  // Explain the edges on the path from both sides to the common ancestor
+  for (EqualityNodeId current = t1Id; current != ancestor; current = d_proofParent[current]) {
+    explainEdge(current, d_proofParentEdge[current], equalities);
+  }
+  for (EqualityNodeId current = t2Id; current != ancestor; current = d_proofParent[current]) {
+    explainEdge(current, d_proofParentEdge[current], equalities);
+  }
+  return true;
+}
+
+void EqualityEngine::explainEdge(EqualityNodeId nodeId, EqualityEdgeId edgeId,
+                                 std::vector<TNode>& equalities) const {
+  const EqualityEdge& edge = d_equalityEdges[edgeId];
+  EqualityNodeId edgeNode = edge.getNodeId();
+
+  switch (edge.getReasonType()) {
+  case MERGED_THROUGH_CONGRUENCE: {
+    // f(x1, x2) == f(y1, y2) because x1 = y1 and x2 = y2
+    const FunctionApplication& f1 = d_applications[nodeId].original;
+    const FunctionApplication& f2 = d_applications[edgeNode].original;
+    getCongruenceExplanation(f1.a, f2.a, equalities);
+    getCongruenceExplanation(f1.b, f2.b, equalities);
+    break;
+  }
+  case MERGED_THROUGH_REFLEXIVITY: {
+    // x1 == x1
+    EqualityNodeId eqId = nodeId == d_trueId ? edgeNode : nodeId;
+    const FunctionApplication& eq = d_applications[eqId].original;
+    Assert(eq.isEquality(), "Must be an equality");
+    getExplanation(eq.a, eq.b, equalities, NULL);
+    break;
+  }
+  case MERGED_THROUGH_CONSTANTS: {
+    // f(c1, ..., cn) = c semantically, explain the constants
+    TNode interpreted = d_nodes[nodeId];
+    if (interpreted.isConst()) {
+      interpreted = d_nodes[edgeNode];
+    }
+    for (unsigned i = 0; i < interpreted.getNumChildren(); ++ i) {
+      EqualityNodeId childId = getNodeId(interpreted[i]);
+      Assert(isConstant(childId));
+      getExplanation(childId, getEqualityNode(childId).getFind(), equalities, NULL);
+    }
+    break;
+  }
+  default:
+    equalities.push_back(edge.getReason());
+    break;
+  }
+}
+
+void EqualityEngine::getCongruenceExplanation(EqualityNodeId t1Id, EqualityNodeId t2Id,
+                                              std::vector<TNode>& equalities) const {
+  if (t1Id == t2Id) {
+    return;
+  }
+
+  EqualityPair pair = t1Id < t2Id ? EqualityPair(t1Id, t2Id) : EqualityPair(t2Id, t1Id);
+  ExplanationCache::const_iterator find = d_explanationCache.find(pair);
+  if (find != d_explanationCache.end()) {
+    ++ d_stats.explanationCacheHits;
+    equalities.insert(equalities.end(), find->second.begin(), find->second.end());
+    return;
+  }
+
+  size_t start = equalities.size();
+  getExplanation(t1Id, t2Id, equalities, NULL);
+  d_explanationCache[pair].assign(equalities.begin() + start, equalities.end());
+  d_explanationCacheTrail.push_back(std::make_pair(pair, (DefaultSizeType)d_equalityEdges.size()));
+}
+
 void EqualityEngine::addTriggerEquality(TNode eq) {
   Assert(eq.getKind() == kind::EQUAL);
 
@@ -1695,13 +1891,13 @@ bool EqualityEngine::areDisequal(TNode t1, TNode t2, bool ensureProof) const
 
   // Create the equality
   FunctionApplication eqNormalized(APP_EQUALITY, t1ClassId, t2ClassId);
-  ApplicationIdsMap::const_iterator find = d_applicationLookup.find(eqNormalized);
-  if (find != d_applicationLookup.end()) {
-    if (getEqualityNode(find->second).getFind() == getEqualityNode(d_falseId).getFind()) {
+  EqualityNodeId lookup = d_applicationLookup.find(eqNormalized);
+  if (lookup != null_id) {
+    if (getEqualityNode(lookup).getFind() == getEqualityNode(d_falseId).getFind()) {
       if (ensureProof) {
-        const FunctionApplication original = d_applications[find->second].original;
+        const FunctionApplication original = d_applications[lookup].original;
         nonConst->d_deducedDisequalityReasons.push_back(EqualityPair(t1Id, original.a));
-        nonConst->d_deducedDisequalityReasons.push_back(EqualityPair(find->second, d_falseId));
+        nonConst->d_deducedDisequalityReasons.push_back(EqualityPair(lookup, d_falseId));
         nonConst->d_deducedDisequalityReasons.push_back(EqualityPair(t2Id, original.b));
         nonConst->storePropagatedDisequality(THEORY_LAST, t1Id, t2Id);
       }
@@ -1712,13 +1908,13 @@ bool EqualityEngine::areDisequal(TNode t1, TNode t2, bool ensureProof) const
 
   // Check the symmetric disequality
   std::swap(eqNormalized.a, eqNormalized.b);
-  find = d_applicationLookup.find(eqNormalized);
-  if (find != d_applicationLookup.end()) {
-    if (getEqualityNode(find->second).getFind() == getEqualityNode(d_falseId).getFind()) {
+  lookup = d_applicationLookup.find(eqNormalized);
+  if (lookup != null_id) {
+    if (getEqualityNode(lookup).getFind() == getEqualityNode(d_falseId).getFind()) {
       if (ensureProof) {
-        const FunctionApplication original = d_applications[find->second].original;
+        const FunctionApplication original = d_applications[lookup].original;
         nonConst->d_deducedDisequalityReasons.push_back(EqualityPair(t2Id, original.a));
-        nonConst->d_deducedDisequalityReasons.push_back(EqualityPair(find->second, d_falseId));
+        nonConst->d_deducedDisequalityReasons.push_back(EqualityPair(lookup, d_falseId));
         nonConst->d_deducedDisequalityReasons.push_back(EqualityPair(t1Id, original.b));
         nonConst->storePropagatedDisequality(THEORY_LAST, t1Id, t2Id);
       }
@@ -1850,8 +2046,8 @@ TNode EqualityEngine::getTriggerTermRepresentative(TNode t, TheoryId tag) const
 }
 
 void EqualityEngine::storeApplicationLookup(FunctionApplication& funNormalized, EqualityNodeId funId) {
-  Assert(d_applicationLookup.find(funNormalized) == d_applicationLookup.end());
-  d_applicationLookup[funNormalized] = funId;
+  Assert(d_applicationLookup.find(funNormalized) == null_id);
+  d_applicationLookup.insert(funNormalized, funId);
   d_applicationLookups.push_back(funNormalized);
   d_applicationLookupsCount = d_applicationLookupsCount + 1;
   Debug("equality::backtrack") << "d_applicationLookupsCount = " << d_applicationLookupsCount << std::endl;
@@ -1878,15 +2074,9 @@ void EqualityEngine::getUseListTerms(TNode t, std::set<TNode>& output) {
       // Get the current node
       EqualityNode& currentNode = getEqualityNode(currentId);
       // Go through the use-list
-      UseListNodeId currentUseId = currentNode.getUseList();
-      while (currentUseId != null_uselist_id) {
-        // Get the node of the use list
-        UseListNode& useNode = d_useListNodes[currentUseId];
-        // Get the function application
-        EqualityNodeId funId = useNode.getApplicationId();
-        output.insert(d_nodes[funId]);
-        // Go to the next one in the use list
-        currentUseId = useNode.getNext();
+      const std::vector<EqualityNodeId>& useList = d_useLists[currentId];
+      for (size_t i = 0, i_end = useList.size(); i < i_end; ++ i) {
+        output.insert(d_nodes[useList[i]]);
       }
       // Move to the next node
       currentId = currentNode.getNext();
@@ -2022,14 +2212,13 @@ void EqualityEngine::getDisequalities(bool allowConstants, EqualityNodeId classI
     EqualityNode& currentNode = getEqualityNode(currentId);
 
     // Go through the uselist and look for disequalities
-    UseListNodeId currentUseId = currentNode.getUseList();
-    while (currentUseId != null_uselist_id) {
-      UseListNode& useListNode = d_useListNodes[currentUseId];
-      EqualityNodeId funId = useListNode.getApplicationId();
+    const std::vector<EqualityNodeId>& useList = d_useLists[currentId];
+    for (size_t useIndex = 0, useEnd = useList.size(); useIndex < useEnd; ++ useIndex) {
+      EqualityNodeId funId = useList[useIndex];
 
       Debug("equality::trigger") << d_name << "::getDisequalities() : checking " << d_nodes[funId] << std::endl;
 
-      const FunctionApplication& fun = d_applications[useListNode.getApplicationId()].original;
+      const FunctionApplication& fun = d_applications[funId].original;
       // If it's an equality asserted to false, we do the work
       if (fun.isEquality() && getEqualityNode(funId).getFind() == getEqualityNode(d_false).getFind()) {
         // Get the other equality member
@@ -2064,8 +2253,6 @@ void EqualityEngine::getDisequalities(bool allowConstants, EqualityNodeId classI
           }
         }
       }
-      // Go to the next one in the use list
-      currentUseId = useListNode.getNext();
     }
     // Next in equivalence class
     currentId = currentNode.getNext();
@@ -218,6 +218,10 @@ public:
     IntStat functionTermsCount;
     /** Number of constant terms managed by the system */
     IntStat constantTermsCount;
+    /** Number of congruence sub-explanations found in the cache */
+    IntStat explanationCacheHits;
+    /** Number of reasons in the explanations of equalities and predicates */
+    AverageStat explanationSize;
 
     Statistics(std::string name);
 
@@ -253,14 +257,11 @@ private:
   /** Map from nodes to their ids */
   std::unordered_map<TNode, EqualityNodeId, TNodeHashFunction> d_nodeIds;
 
-  /** Map from function applications to their ids */
-  typedef std::unordered_map<FunctionApplication, EqualityNodeId, FunctionApplicationHashFunction> ApplicationIdsMap;
-
   /**
    * A map from a pair (a', b') to a function application f(a, b), where a' and b' are the current representatives
    * of a and b.
    */
-  ApplicationIdsMap d_applicationLookup;
+  SignatureTable d_applicationLookup;
 
   /** Application lookups in order, so that we can backtrack. */
   std::vector<FunctionApplication> d_applicationLookups;
@@ -288,8 +289,12 @@ private:
   /** Number of asserted equalities we have so far */
   context::CDO<DefaultSizeType> d_assertedEqualitiesCount;
 
-  /** Memory for the use-list nodes */
-  std::vector<UseListNode> d_useListNodes;
+  /**
+   * Map from ids to the use lists, i.e. the function applications the node
+   * is an argument of. New applications are appended, and removed from the
+   * back when their nodes are backtracked.
+   */
+  std::vector< std::vector<EqualityNodeId> > d_useLists;
 
   /** A fresh merge reason type to return upon request */
   unsigned d_freshMergeReasonType;
@@ -370,6 +375,69 @@ private:
   /** Add an edge to the equality graph */
   void addGraphEdge(EqualityNodeId t1, EqualityNodeId t2, unsigned type, TNode reason);
 
+  /**
+   * The proof forest (Nieuwenhuis and Oliveras). As edges are only added
+   * between different classes the equality graph is a forest. Each tree is
+   * kept rooted, so the path between two connected nodes is found by
+   * walking towards the root from both of them.
+   */
+  std::vector<EqualityNodeId> d_proofParent;
+
+  /** The edge from each node to its parent in the proof forest */
+  std::vector<EqualityEdgeId> d_proofParentEdge;
+
+  /** A change of the parent of a node in the proof forest */
+  struct ProofForestUpdate {
+    EqualityNodeId nodeId;
+    EqualityNodeId oldParent;
+    EqualityEdgeId oldEdge;
+    ProofForestUpdate(EqualityNodeId nodeId = null_id, EqualityNodeId oldParent = null_id, EqualityEdgeId oldEdge = null_edge)
+    : nodeId(nodeId), oldParent(oldParent), oldEdge(oldEdge) {}
+  };/* struct EqualityEngine::ProofForestUpdate */
+
+  /** The changes to the proof forest, undone on backtrack */
+  std::vector<ProofForestUpdate> d_proofForestUpdates;
+
+  /** Context dependent size of the proof forest updates */
+  context::CDO<DefaultSizeType> d_proofForestUpdatesSize;
+
+  /** Sets the parent of nodeId in the proof forest, recording the old one */
+  void setProofParent(EqualityNodeId nodeId, EqualityNodeId parent, EqualityEdgeId edge);
+
+  /** Adds the edge t1 -> t2 with the given id to the proof forest */
+  void addProofForestEdge(EqualityNodeId t1, EqualityNodeId t2, EqualityEdgeId edge);
+
+  /** Per node marks for the common ancestor search, see d_proofForestVisit */
+  mutable std::vector<unsigned> d_proofForestMarks;
+
+  /** The marks of the last common ancestor search are this and this + 1 */
+  mutable unsigned d_proofForestVisit;
+
+  /**
+   * Explains t1 = t2 by the path between them in the proof forest, which is
+   * linear in the size of the path. Returns false if they are not connected.
+   */
+  bool getProofForestExplanation(EqualityNodeId t1Id, EqualityNodeId t2Id, std::vector<TNode>& equalities) const;
+
+  /** Explains the edge from nodeId without constructing a proof */
+  void explainEdge(EqualityNodeId nodeId, EqualityEdgeId edgeId, std::vector<TNode>& equalities) const;
+
+  /**
+   * Cache of the explanations of the arguments of congruent applications.
+   * An entry only depends on the edges present when it was computed.
+   */
+  typedef std::unordered_map<EqualityPair, std::vector<TNode>, EqualityPairHashFunction> ExplanationCache;
+  mutable ExplanationCache d_explanationCache;
+
+  /**
+   * The cached pairs in the order of insertion, with the number of edges at
+   * that time. Entries with more edges than are left are removed on backtrack.
+   */
+  mutable std::vector< std::pair<EqualityPair, DefaultSizeType> > d_explanationCacheTrail;
+
+  /** Explains the equality of the arguments t1 and t2 of congruent applications */
+  void getCongruenceExplanation(EqualityNodeId t1Id, EqualityNodeId t2Id, std::vector<TNode>& equalities) const;
+
   /** Returns the equality node of the given node */
   EqualityNode& getEqualityNode(TNode node);
 
@@ -494,8 +562,8 @@ private:
    */
   void addTriggerToList(EqualityNodeId nodeId, TriggerId triggerId);
 
-  /** Statistics */
-  Statistics d_stats;
+  /** Statistics, mutable as the explanations are recorded */
+  mutable Statistics d_stats;
 
   /** Add a new function application node to the database, i.e APP t1 t2 */
   EqualityNodeId newApplicationNode(TNode original, EqualityNodeId t1, EqualityNodeId t2, FunctionApplicationType type);
@@ -20,10 +20,13 @@
 #ifndef __CVC4__THEORY__UF__EQUALITY_ENGINE_TYPES_H
 #define __CVC4__THEORY__UF__EQUALITY_ENGINE_TYPES_H
 
+#include <stdint.h>
 #include <string>
 #include <iostream>
 #include <sstream>
+#include <vector>
 
+#include "base/cvc4_assert.h"
 #include "util/hash.h"
 
 namespace CVC4 {
@@ -36,9 +39,6 @@ typedef uint32_t DefaultSizeType;
 /** Id of the node */
 typedef DefaultSizeType EqualityNodeId;
 
-/** Id of the use list */
-typedef DefaultSizeType UseListNodeId;
-
 /** The trigger ids */
 typedef DefaultSizeType TriggerId;
 
@@ -48,9 +48,6 @@ typedef DefaultSizeType EqualityEdgeId;
 /** The null node */
 static const EqualityNodeId null_id = (EqualityNodeId)(-1);
 
-/** The null use list node */
-static const EqualityNodeId null_uselist_id = (EqualityNodeId)(-1);
-
 /** The null trigger */
 static const TriggerId null_trigger = (TriggerId)(-1);
 
@@ -127,50 +124,12 @@ struct DisequalityReasonRef {
   : mergesStart(mergesStart), mergesEnd(mergesEnd) {}
 };
 
-/**
- * We maintain uselist where a node appears in, and this is the node
- * of such a list.
- */
-class UseListNode {
-
-private:
-
-  /** The id of the application node where this representative is at */
-  EqualityNodeId d_applicationId;
-
-  /** The next one in the class */
-  UseListNodeId d_nextUseListNodeId;
-
-public:
-
-  /**
-   * Creates a new node, which is in a list of it's own.
-   */
-  UseListNode(EqualityNodeId nodeId = null_id, UseListNodeId nextId = null_uselist_id)
-  : d_applicationId(nodeId), d_nextUseListNodeId(nextId) {}
-
-  /**
-   * Returns the next node in the circular list.
-   */
-  UseListNodeId getNext() const {
-    return d_nextUseListNodeId;
-  }
-
-  /**
-   * Returns the id of the function application.
-   */
-  EqualityNodeId getApplicationId() const {
-    return d_applicationId;
-  }
-};
-
 /**
  * Main class for representing nodes in the equivalence class. The
  * nodes are a circular list, with the representative carrying the
- * size. Each individual node carries with itself the uselist of
- * function applications it appears in and the list of asserted
- * disequalities it belongs to. In order to get these lists one must
- * traverse the entire class and pick up all the individual lists.
+ * size. The use lists of function applications a node appears in are
+ * kept by the equality engine, so in order to get these lists of a class
+ * one must traverse the entire class and pick up all the individual lists.
  */
 class EqualityNode {
 
@@ -185,9 +144,6 @@ private:
   /** The next equality node in this class */
   EqualityNodeId d_nextId;
 
-  /** The use list of this node */
-  UseListNodeId d_useList;
-
 public:
 
   /**
@@ -197,16 +153,8 @@ public:
   : d_size(1)
   , d_findId(nodeId)
   , d_nextId(nodeId)
-  , d_useList(null_uselist_id)
   {}
 
-  /**
-   * Returns the requested uselist.
-   */
-  UseListNodeId getUseList() const {
-    return d_useList;
-  }
-
   /**
    * Returns the next node in the class circular list.
    */
@@ -244,27 +192,6 @@ public:
    * Set the class representative.
    */
   void setFind(EqualityNodeId findId) { d_findId = findId; }
-
-  /**
-   * Note that this node is used in a function application funId, or
-   * a negatively asserted equality (dis-equality) with funId.
-   */
-  template<typename memory_class>
-  void usedIn(EqualityNodeId funId, memory_class& memory) {
-    UseListNodeId newUseId = memory.size();
-    memory.push_back(UseListNode(funId, d_useList));
-    d_useList = newUseId;
-  }
-
-  /**
-   * For backtracking: remove the first element from the uselist and pop the memory.
-   */
-  template<typename memory_class>
-  void removeTopFromUseList(memory_class& memory) {
-    Assert ((int) d_useList == (int)memory.size() - 1);
-    d_useList = memory.back().getNext();
-    memory.pop_back();
-  }
 };
 
 /** A pair of ids */
@@ -328,6 +255,121 @@ struct FunctionApplicationHashFunction {
   }
 };
 
+/**
+ * Open addressing hash table from normalized function applications, i.e.
+ * the signatures (function representative, argument representative), to
+ * the ids of the applications. Collisions are resolved by linear probing
+ * and entries are removed by shifting the following entries back, so no
+ * tombstones are left behind when backtracking.
+ */
+class SignatureTable {
+public:
+
+  SignatureTable()
+  : d_entries(16)
+  , d_size(0)
+  {}
+
+  /** Returns the id of the application with the signature app, or null_id */
+  EqualityNodeId find(const FunctionApplication& app) const {
+    for (size_t i = slot(app);; i = (i + 1) & mask()) {
+      const Entry& entry = d_entries[i];
+      if (entry.id == null_id) {
+        return null_id;
+      }
+      if (entry.app == app) {
+        return entry.id;
+      }
+    }
+  }
+
+  /** Adds the signature app of the application id, which must be new */
+  void insert(const FunctionApplication& app, EqualityNodeId id) {
+    Assert(id != null_id);
+    Assert(find(app) == null_id);
+    if (2 * (d_size + 1) > d_entries.size()) {
+      grow();
+    }
+    size_t i = slot(app);
+    while (d_entries[i].id != null_id) {
+      i = (i + 1) & mask();
+    }
+    d_entries[i].app = app;
+    d_entries[i].id = id;
+    ++ d_size;
+  }
+
+  /** Removes the signature app if present */
+  void erase(const FunctionApplication& app) {
+    size_t i = slot(app);
+    for (;; i = (i + 1) & mask()) {
+      if (d_entries[i].id == null_id) {
+        return;
+      }
+      if (d_entries[i].app == app) {
+        break;
+      }
+    }
+    d_entries[i].id = null_id;
+    -- d_size;
+    // Move back the entries whose probe sequence passes through the hole
+    for (size_t j = (i + 1) & mask(); d_entries[j].id != null_id; j = (j + 1) & mask()) {
+      size_t k = slot(d_entries[j].app);
+      bool move = j > i ? (k <= i || k > j) : (k <= i && k > j);
+      if (move) {
+        d_entries[i] = d_entries[j];
+        d_entries[j].id = null_id;
+        i = j;
+      }
+    }
+  }
+
+  /** Returns the number of signatures in the table */
+  size_t size() const {
+    return d_size;
+  }
+
+private:
+
+  struct Entry {
+    FunctionApplication app;
+    EqualityNodeId id;
+    Entry() : id(null_id) {}
+  };
+
+  size_t mask() const {
+    return d_entries.size() - 1;
+  }
+
+  /** The home slot of app */
+  size_t slot(const FunctionApplication& app) const {
+    uint64_t key = ((uint64_t)app.a << 32) | app.b;
+    key = (key ^ (uint64_t)app.type) * 0x9e3779b97f4a7c15ull;
+    return (size_t)(key >> 32) & mask();
+  }
+
+  /** Doubles the capacity */
+  void grow() {
+    std::vector<Entry> old(2 * d_entries.size());
+    old.swap(d_entries);
+    for (size_t i = 0; i < old.size(); ++ i) {
+      if (old[i].id != null_id) {
+        size_t j = slot(old[i].app);
+        while (d_entries[j].id != null_id) {
+          j = (j + 1) & mask();
+        }
+        d_entries[j] = old[i];
+      }
+    }
+  }
+
+  /** The slots, the size is a power of two */
+  std::vector<Entry> d_entries;
+
+  /** The number of used slots */
+  size_t d_size;
+};/* class SignatureTable */
+
 /**
  * At time of addition a function application can already normalize to something, so
  * we keep both the original, and the normalized version.
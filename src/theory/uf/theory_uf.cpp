@@ -107,6 +107,13 @@ static Node mkAnd(const std::vector<TNode>& conjunctions) {
   return conjunction;
 }/* mkAnd() */
 
+std::function<void()> TheoryUF::getFullCheckTask() {
+  if (d_thss == NULL || d_conflict) {
+    return std::function<void()>();
+  }
+  return d_thss->getFullCheckTask();
+}
+
 void TheoryUF::check(Effort level) {
   if (done() && !fullEffort(level)) {
     return;
@@ -596,13 +603,13 @@ void TheoryUF::addCarePairs( quantifiers::TermArgTrie * t1, quantifiers::TermArg
     if( t2==NULL ){
       if( depth<(arity-1) ){
         //add care pairs internal to each child
-        for( std::map< TNode, quantifiers::TermArgTrie >::iterator it = t1->d_data.begin(); it != t1->d_data.end(); ++it ){
+        for( quantifiers::TermArgTrieMap::iterator it = t1->d_data.begin(); it != t1->d_data.end(); ++it ){
           addCarePairs( &it->second, NULL, arity, depth+1 );
         }
       }
       //add care pairs based on each pair of non-disequal arguments
-      for( std::map< TNode, quantifiers::TermArgTrie >::iterator it = t1->d_data.begin(); it != t1->d_data.end(); ++it ){
-        std::map< TNode, quantifiers::TermArgTrie >::iterator it2 = it;
+      for( quantifiers::TermArgTrieMap::iterator it = t1->d_data.begin(); it != t1->d_data.end(); ++it ){
+        quantifiers::TermArgTrieMap::iterator it2 = it;
         ++it2;
         for( ; it2 != t1->d_data.end(); ++it2 ){
           if( !d_equalityEngine.areDisequal(it->first, it2->first, false) ){
@@ -614,8 +621,8 @@ void TheoryUF::addCarePairs( quantifiers::TermArgTrie * t1, quantifiers::TermArg
       }
     }else{
       //add care pairs based on product of indices, non-disequal arguments
-      for( std::map< TNode, quantifiers::TermArgTrie >::iterator it = t1->d_data.begin(); it != t1->d_data.end(); ++it ){
-        for( std::map< TNode, quantifiers::TermArgTrie >::iterator it2 = t2->d_data.begin(); it2 != t2->d_data.end(); ++it2 ){
+      for( quantifiers::TermArgTrieMap::iterator it = t1->d_data.begin(); it != t1->d_data.end(); ++it ){
+        for( quantifiers::TermArgTrieMap::iterator it2 = t2->d_data.begin(); it2 != t2->d_data.end(); ++it2 ){
           if( !d_equalityEngine.areDisequal(it->first, it2->first, false) ){
             if( !areCareDisequal(it->first, it2->first) ){
               addCarePairs( &it->second, &it2->second, arity, depth+1 );
@@ -288,6 +288,7 @@ private:
   void finishInit() override;
 
   void check(Effort) override;
+  std::function<void()> getFullCheckTask() override;
   Node expandDefinition(LogicRequest& logicRequest, Node node) override;
   void preRegisterTerm(TNode term) override;
   Node explain(TNode n) override;
@@ -58,6 +58,7 @@ Region::~Region() {
     delete regionNodeInfo;
   }
   d_nodes.clear();
+  d_nodeIndex.clear();
 }
 
 void Region::addRep( Node n ) {
@@ -70,7 +71,7 @@ void Region::takeNode( Region* r, Node n ){
   //add representative
   setRep( n, true );
   //take disequalities from r
-  RegionNodeInfo* rni = r->d_nodes[n];
+  RegionNodeInfo* rni = r->getRegionInfo(n);
   for( int t=0; t<2; t++ ){
     DiseqList* del = rni->get(t);
     for(DiseqList::iterator it = del->begin(); it != del->end(); ++it ){
@@ -133,12 +134,12 @@ void Region::setEqual( Node a, Node b ){
   Assert( hasRep( a ) && hasRep( b ) );
   //move disequalities of b over to a
   for( int t=0; t<2; t++ ){
-    DiseqList* del = d_nodes[b]->get(t);
+    DiseqList* del = getRegionInfo(b)->get(t);
     for( DiseqList::iterator it = del->begin(); it != del->end(); ++it ){
       if( (*it).second ){
         Node n = (*it).first;
         //get the region that contains the endpoint of the disequality b != ...
-        Region* nr = d_cf->d_regions[ d_cf->d_regions_map[ n ] ];
+        Region* nr = d_cf->d_regions[ d_cf->getRegion( n ) ];
         if( !isDisequal( a, n, t ) ){
           setDisequal( a, n, t, true );
           nr->setDisequal( n, a, t, true );
@@ -158,7 +159,10 @@ void Region::setDisequal( Node n1, Node n2, int type, bool valid ){
   //debugPrint("uf-ss-region-debug");
   //Assert( isDisequal( n1, n2, type )!=valid );
   if( isDisequal( n1, n2, type )!=valid ){    //DO_THIS: make assertion
-    d_nodes[ n1 ]->get(type)->setDisequal( n2, valid );
+    getRegionInfo(n1)->get(type)->setDisequal( n2, valid );
+    if( type==1 && options::ufssCliqueBitset() ){
+      d_cf->notifyInternalDisequal( n1, n2, valid );
+    }
     if( type==0 ){
       d_total_diseq_external = d_total_diseq_external + ( valid ? 1 : -1 );
     }else{
@@ -182,10 +186,12 @@ void Region::setDisequal( Node n1, Node n2, int type, bool valid ){
 
 void Region::setRep( Node n, bool valid ) {
   Assert( hasRep( n )!=valid );
-  if( valid && d_nodes.find( n )==d_nodes.end() ){
-    d_nodes[n] = new RegionNodeInfo( d_cf->d_thss->getSatContext() );
+  if( valid && d_nodeIndex.find( n )==d_nodeIndex.end() ){
+    RegionNodeInfo* rni = new RegionNodeInfo( d_cf->d_thss->getSatContext() );
+    d_nodes[n] = rni;
+    d_nodeIndex[n] = rni;
   }
-  d_nodes[n]->setValid(valid);
+  getRegionInfo(n)->setValid(valid);
   d_reps_size = d_reps_size + ( valid ? 1 : -1 );
   //removing a member of the test clique from this region
   if( d_testClique.find( n ) != d_testClique.end() && d_testClique[n] ){
@@ -205,7 +211,7 @@ void Region::setRep( Node n, bool valid ) {
 }
 
 bool Region::isDisequal( Node n1, Node n2, int type ) {
-  RegionNodeInfo::DiseqList* del = d_nodes[ n1 ]->get(type);
+  RegionNodeInfo::DiseqList* del = getRegionInfo(n1)->get(type);
   return del->isSet(n2) && del->getDisequalityValue(n2);
 }
 
@@ -449,6 +455,11 @@ SortModel::SortModel( Node n,
   , d_thss( thss )
   , d_regions_index( c, 0 )
   , d_regions_map( c )
+  , d_region_parent_trail_size( c, 0 )
+  , d_adjacency_trail_size( c, 0 )
+  , d_new_edges( c )
+  , d_new_edges_index( c, 0 )
+  , d_adjacency_version( 0 )
   , d_split_score( c )
   , d_disequalities_index( c, 0 )
   , d_reps( c, 0 )
@@ -525,6 +536,9 @@ void SortModel::newEqClass( Node n ){
         }else{
           d_regions.push_back( new Region( this, d_thss->getSatContext() ) );
         }
+        if( options::ufssCliqueBitset() ){
+          getDenseId( n );
+        }
         d_regions[ d_regions_index ]->addRep( n );
         d_regions_index = d_regions_index + 1;
       }
@@ -549,8 +563,8 @@ void SortModel::merge( Node a, Node b ){
       if( a!=b ){
         Assert( d_regions_map.find( a )!=d_regions_map.end() );
         Assert( d_regions_map.find( b )!=d_regions_map.end() );
-        int ai = d_regions_map[a];
-        int bi = d_regions_map[b];
+        int ai = getRegion(a);
+        int bi = getRegion(b);
         Debug("uf-ss") << "   regions: " << ai << " " << bi << std::endl;
         if( ai!=bi ){
           if( d_regions[ai]->getNumReps()==1  ){
@@ -601,8 +615,8 @@ void SortModel::assertDisequal( Node a, Node b, Node reason ){
       //if they are not already disequal
       a = d_thss->getTheory()->d_equalityEngine.getRepresentative( a );
       b = d_thss->getTheory()->d_equalityEngine.getRepresentative( b );
-      int ai = d_regions_map[a];
-      int bi = d_regions_map[b];
+      int ai = getRegion(a);
+      int bi = getRegion(b);
       if( !d_regions[ai]->isDisequal( a, b, ai==bi ) ){
         Debug("uf-ss") << "Assert disequal " << a << " != " << b << "..." << std::endl;
         //if( reason.getKind()!=NOT || reason[0].getKind()!=EQUAL ||
@@ -643,8 +657,8 @@ bool SortModel::areDisequal( Node a, Node b ) {
   Assert( b == d_thss->getTheory()->d_equalityEngine.getRepresentative( b ) );
   if( d_regions_map.find( a )!=d_regions_map.end() &&
       d_regions_map.find( b )!=d_regions_map.end() ){
-    int ai = d_regions_map[a];
-    int bi = d_regions_map[b];
+    int ai = getRegion(a);
+    int bi = getRegion(b);
     return d_regions[ai]->isDisequal(a, b, ai==bi ? 1 : 0);
   }else{
     return false;
@@ -675,6 +689,15 @@ void SortModel::check( Theory::Effort level, OutputChannel* out ){
     }else{
       //first check if we can generate a clique conflict
       if( !options::ufssTotality() ){
+        if( options::ufssCliqueBitset() ){
+          std::vector< Node > clique;
+          if( level==Theory::EFFORT_FULL ? findNewCliqueFromSearch( clique )
+                                         : findNewClique( clique ) ){
+            ++( d_thss->d_statistics.d_bitset_cliques );
+            addCliqueLemma( clique, out );
+            return;
+          }
+        }
         //do a check within each region
         for( int i=0; i<(int)d_regions_index; i++ ){
           if( d_regions[i]->valid() ){
@@ -791,12 +814,12 @@ Node SortModel::getNextDecisionRequest(){
 }
 
 int SortModel::getNumDisequalitiesToRegion( Node n, int ri ){
-  int ni = d_regions_map[n];
+  int ni = getRegion(n);
   int counter = 0;
   DiseqList* del = d_regions[ni]->getRegionInfo(n)->get(0);
   for( DiseqList::iterator it = del->begin(); it != del->end(); ++it ){
     if( (*it).second ){
-      if( d_regions_map[ (*it).first ]==ri ){
+      if( getRegion( (*it).first )==ri ){
         counter++;
       }
     }
@@ -813,9 +836,9 @@ void SortModel::getDisequalitiesToRegions(int ri,
       DiseqList* del = it->second->get(0);
       for( DiseqList::iterator it2 = del->begin(); it2 != del->end(); ++it2 ){
         if( (*it2).second ){
-          Assert( isValid( d_regions_map[ (*it2).first ] ) );
-          //Notice() << "Found disequality with " << (*it2).first << ", region = " << d_regions_map[ (*it2).first ] << std::endl;
-          regions_diseq[ d_regions_map[ (*it2).first ] ]++;
+          Assert( isValid( getRegion( (*it2).first ) ) );
+          //Notice() << "Found disequality with " << (*it2).first << ", region = " << getRegion( (*it2).first ) << std::endl;
+          regions_diseq[ getRegion( (*it2).first ) ]++;
         }
       }
     }
@@ -971,13 +994,8 @@ int SortModel::combineRegions( int ai, int bi ){
 #endif
   Debug("uf-ss-region") << "uf-ss: Combine Region #" << bi << " with Region #" << ai << std::endl;
   Assert( isValid( ai ) && isValid( bi ) );
-  Region* region_bi = d_regions[bi];
-  for(Region::iterator it = region_bi->begin(); it != region_bi->end(); ++it){
-    Region::RegionNodeInfo* rni = it->second;
-    if( rni->valid() ){
-      d_regions_map[ it->first ] = ai;
-    }
-  }
+  //the nodes of bi now exist in ai
+  setRegionParent( bi, ai );
   //update regions disequal DO_THIS?
   d_regions[ai]->combine( d_regions[bi] );
   d_regions[bi]->setValid( false );
@@ -986,13 +1004,287 @@ int SortModel::combineRegions( int ai, int bi ){
 
 void SortModel::moveNode( Node n, int ri ){
   Debug("uf-ss-region") << "uf-ss: Move node " << n << " to Region #" << ri << std::endl;
-  Assert( isValid( d_regions_map[ n ] ) );
+  Assert( isValid( getRegion( n ) ) );
   Assert( isValid( ri ) );
   //move node to region ri
-  d_regions[ri]->takeNode( d_regions[ d_regions_map[n] ], n );
+  d_regions[ri]->takeNode( d_regions[ getRegion( n ) ], n );
   d_regions_map[n] = ri;
 }
 
+void SortModel::backtrackRegionParents(){
+  //undo the unions of popped contexts
+  while( d_region_parent_trail.size()>d_region_parent_trail_size ){
+    const std::pair< int, int >& p = d_region_parent_trail.back();
+    d_region_parent[p.first] = p.second;
+    d_region_parent_trail.pop_back();
+  }
+}
+
+void SortModel::setRegionParent( int ri, int parent ){
+  Assert( ri>=0 && parent>=0 );
+  backtrackRegionParents();
+  while( (int)d_region_parent.size()<=ri ){
+    d_region_parent.push_back( (int)d_region_parent.size() );
+  }
+  d_region_parent_trail.push_back( std::pair< int, int >( ri, d_region_parent[ri] ) );
+  d_region_parent_trail_size = d_region_parent_trail.size();
+  d_region_parent[ri] = parent;
+}
+
+int SortModel::findRegion( int ri ){
+  backtrackRegionParents();
+  if( ri<0 ){
+    return ri;
+  }
+  int root = ri;
+  while( root<(int)d_region_parent.size() && d_region_parent[root]!=root ){
+    root = d_region_parent[root];
+  }
+  //compress the path, in the current context
+  while( ri!=root && d_region_parent[ri]!=root ){
+    int next = d_region_parent[ri];
+    setRegionParent( ri, root );
+    ri = next;
+  }
+  return root;
+}
+
+unsigned SortModel::getDenseId( Node n ){
+  std::unordered_map< Node, unsigned, NodeHashFunction >::iterator it =
+    d_dense_id.find( n );
+  if( it!=d_dense_id.end() ){
+    return it->second;
+  }
+  unsigned id = d_dense_nodes.size();
+  d_dense_id[n] = id;
+  d_dense_nodes.push_back( n );
+  d_adjacency.push_back( std::vector< uint64_t >() );
+  return id;
+}
+
+void SortModel::backtrackAdjacency(){
+  //undo the flips of popped contexts
+  while( d_adjacency_trail.size()>d_adjacency_trail_size ){
+    const std::pair< unsigned, unsigned >& p = d_adjacency_trail.back();
+    d_adjacency[p.first][p.second / 64] ^= uint64_t(1) << ( p.second % 64 );
+    d_adjacency_trail.pop_back();
+    d_adjacency_version++;
+  }
+}
+
+bool SortModel::isAdjacent( const std::vector< std::vector< uint64_t > >& adjacency,
+                            unsigned i,
+                            unsigned j ){
+  const std::vector< uint64_t >& row = adjacency[i];
+  return j / 64 < row.size() && ( ( row[j / 64] >> ( j % 64 ) ) & 1 )!=0;
+}
+
+void SortModel::setAdjacent( unsigned i, unsigned j, bool value ){
+  backtrackAdjacency();
+  if( isAdjacent( i, j )==value ){
+    return;
+  }
+  std::vector< uint64_t >& row = d_adjacency[i];
+  if( row.size()<=j / 64 ){
+    row.resize( j / 64 + 1, 0 );
+  }
+  row[j / 64] ^= uint64_t(1) << ( j % 64 );
+  d_adjacency_trail.push_back( std::pair< unsigned, unsigned >( i, j ) );
+  d_adjacency_trail_size = d_adjacency_trail.size();
+  d_adjacency_version++;
+}
+
+void SortModel::notifyInternalDisequal( Node a, Node b, bool valid ){
+  unsigned ai = getDenseId( a );
+  unsigned bi = getDenseId( b );
+  setAdjacent( ai, bi, valid );
+  //an edge is added once both of its directions are set
+  if( valid && isAdjacent( bi, ai ) ){
+    d_new_edges.push_back( std::pair< unsigned, unsigned >( ai, bi ) );
+  }
+}
+
+bool SortModel::searchClique( const std::vector< std::vector< uint64_t > >& adjacency,
+                              std::vector< uint64_t >& cand,
+                              unsigned k,
+                              std::vector< unsigned >& clique,
+                              unsigned& steps ){
+  if( k==0 ){
+    return true;
+  }
+  unsigned count = 0;
+  for( unsigned w=0; w<cand.size(); w++ ){
+    count += __builtin_popcountll( cand[w] );
+  }
+  for( unsigned w=0; w<cand.size() && count>=k; w++ ){
+    while( cand[w]!=0 && count>=k ){
+      if( ++steps>=s_maxCliqueSearchSteps ){
+        return false;
+      }
+      unsigned v = w * 64 + __builtin_ctzll( cand[w] );
+      //remove v, the cliques containing the vertices before v were searched
+      cand[w] &= cand[w] - 1;
+      count--;
+      const std::vector< uint64_t >& row = adjacency[v];
+      std::vector< uint64_t > next( cand.size(), 0 );
+      for( unsigned x=w; x<cand.size() && x<row.size(); x++ ){
+        next[x] = cand[x] & row[x];
+      }
+      clique.push_back( v );
+      if( searchClique( adjacency, next, k - 1, clique, steps ) ){
+        return true;
+      }
+      clique.pop_back();
+      if( steps>=s_maxCliqueSearchSteps ){
+        return false;
+      }
+    }
+  }
+  return false;
+}
+
+bool SortModel::searchEdgeClique( const std::vector< std::vector< uint64_t > >& adjacency,
+                                  unsigned a,
+                                  unsigned b,
+                                  unsigned k,
+                                  std::vector< unsigned >& clique,
+                                  unsigned& steps ){
+  if( !isAdjacent( adjacency, a, b ) || !isAdjacent( adjacency, b, a ) ){
+    //the disequality was removed by a merge
+    return false;
+  }
+  //the other members are adjacent to both a and b
+  const std::vector< uint64_t >& ra = adjacency[a];
+  const std::vector< uint64_t >& rb = adjacency[b];
+  std::vector< uint64_t > cand( std::min( ra.size(), rb.size() ), 0 );
+  for( unsigned x=0; x<cand.size(); x++ ){
+    cand[x] = ra[x] & rb[x];
+  }
+  clique.push_back( std::min( a, b ) );
+  clique.push_back( std::max( a, b ) );
+  if( k<=2 || searchClique( adjacency, cand, k - 2, clique, steps ) ){
+    return true;
+  }
+  clique.clear();
+  return false;
+}
+
+bool SortModel::isRegionClique( std::vector< unsigned >& ids ){
+  int ri = getRegion( d_dense_nodes[ids[0]] );
+  for( unsigned i=0; i<ids.size(); i++ ){
+    Node ni = d_dense_nodes[ids[i]];
+    if( getRegion( ni )!=ri || !d_regions[ri]->hasRep( ni ) ){
+      return false;
+    }
+    for( unsigned j=0; j<i; j++ ){
+      if( !d_regions[ri]->isDisequal( ni, d_dense_nodes[ids[j]], 1 ) ){
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool SortModel::findNewClique( std::vector< Node >& clique, unsigned steps ){
+  backtrackAdjacency();
+  Assert( d_cardinality>0 );
+  unsigned k = d_cardinality + 1;
+  while( d_new_edges_index<d_new_edges.size() ){
+    std::pair< unsigned, unsigned > e = d_new_edges[d_new_edges_index];
+    std::vector< unsigned > ids;
+    bool found = searchEdgeClique( d_adjacency, e.first, e.second, k, ids, steps );
+    if( !found && steps>=s_maxCliqueSearchSteps ){
+      //the search of e was cut off, it is searched again at the next check
+      Trace("uf-ss-clique") << "Clique search reached its limit" << std::endl;
+      return false;
+    }
+    d_new_edges_index = d_new_edges_index + 1;
+    //check that the clique is one in the regions
+    if( found && isRegionClique( ids ) ){
+      Trace("uf-ss-clique") << "Found clique of size " << ids.size()
+                            << " from disequality " << d_dense_nodes[e.first]
+                            << " != " << d_dense_nodes[e.second] << std::endl;
+      for( unsigned i=0; i<ids.size(); i++ ){
+        clique.push_back( d_dense_nodes[ids[i]] );
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+void SortModel::CliqueSearch::run(){
+  //as findNewClique, stopping at the first clique of d_adjacency
+  while( d_searched<d_edges.size() ){
+    std::pair< unsigned, unsigned > e = d_edges[d_searched];
+    if( searchEdgeClique( d_adjacency, e.first, e.second, d_k, d_clique, d_steps ) ){
+      d_searched++;
+      d_found = true;
+      return;
+    }
+    if( d_steps>=s_maxCliqueSearchSteps ){
+      //e is not counted as searched
+      d_limit = true;
+      return;
+    }
+    d_searched++;
+  }
+}
+
+bool SortModel::findNewCliqueFromSearch( std::vector< Node >& clique ){
+  backtrackAdjacency();
+  std::unique_ptr< CliqueSearch > cs = std::move( d_clique_search );
+  if( cs==nullptr || cs->d_version!=d_adjacency_version
+      || cs->d_edges_index!=d_new_edges_index
+      || cs->d_num_edges!=d_new_edges.size()
+      || (int)cs->d_k!=d_cardinality + 1 ){
+    //the snapshot is not the current state
+    return findNewClique( clique );
+  }
+  Trace("uf-ss-clique") << "Use the concurrent clique search of "
+                        << cs->d_searched << " edges" << std::endl;
+  d_new_edges_index = d_new_edges_index + cs->d_searched;
+  if( cs->d_found ){
+    if( isRegionClique( cs->d_clique ) ){
+      Trace("uf-ss-clique") << "Found clique of size " << cs->d_clique.size()
+                            << " by the concurrent search" << std::endl;
+      for( unsigned i=0; i<cs->d_clique.size(); i++ ){
+        clique.push_back( d_dense_nodes[cs->d_clique[i]] );
+      }
+      return true;
+    }
+  }else if( cs->d_limit ){
+    Trace("uf-ss-clique") << "Clique search reached its limit" << std::endl;
+    return false;
+  }
+  //continue where the search stopped
+  return findNewClique( clique, cs->d_steps );
+}
+
+std::function<void()> SortModel::getFullCheckTask(){
+  d_clique_search.reset();
+  //the conditions of check for searching cliques in d_adjacency
+  if( !d_hasCard || d_conflict || d_reps<=(unsigned)d_cardinality
+      || options::ufssTotality() || !options::ufssCliqueBitset() ){
+    return std::function<void()>();
+  }
+  backtrackAdjacency();
+  if( d_new_edges_index==d_new_edges.size() ){
+    return std::function<void()>();
+  }
+  CliqueSearch* cs = new CliqueSearch;
+  d_clique_search.reset( cs );
+  cs->d_adjacency = d_adjacency;
+  for( unsigned i=d_new_edges_index; i<d_new_edges.size(); i++ ){
+    cs->d_edges.push_back( d_new_edges[i] );
+  }
+  cs->d_k = d_cardinality + 1;
+  cs->d_version = d_adjacency_version;
+  cs->d_edges_index = d_new_edges_index;
+  cs->d_num_edges = d_new_edges.size();
+  return [cs]() { cs->run(); };
+}
+
 void SortModel::allocateCardinality( OutputChannel* out ){
   if( d_aloc_cardinality>0 ){
     Trace("uf-ss-fmf") << "No model of size " << d_aloc_cardinality << " exists for type " << d_type << " in this branch" << std::endl;
@@ -1259,9 +1551,9 @@ void SortModel::debugPrint( const char* c ){
         Debug( c ) << std::endl;
         for( Region::iterator it = region->begin(); it != region->end(); ++it ){
           if( it->second->valid() ){
-            if( d_regions_map[ it->first ]!=(int)i ){
+            if( getRegion( it->first )!=(int)i ){
               Debug( c ) << "***Bad regions map : " << it->first
-                         << " " << d_regions_map[ it->first ].get() << std::endl;
+                         << " " << getRegion( it->first ) << std::endl;
             }
           }
         }
@@ -1628,6 +1920,27 @@ bool StrongSolverTheoryUF::areDisequal( Node a, Node b ) {
 }
 
 /** check */
+std::function<void()> StrongSolverTheoryUF::getFullCheckTask(){
+  if( d_conflict || options::ufssMode()!=UF_SS_FULL ){
+    return std::function<void()>();
+  }
+  std::vector< std::function<void()> > tasks;
+  for( std::map< TypeNode, SortModel* >::iterator it = d_rep_model.begin(); it != d_rep_model.end(); ++it ){
+    std::function<void()> task = it->second->getFullCheckTask();
+    if( task ){
+      tasks.push_back( task );
+    }
+  }
+  if( tasks.empty() ){
+    return std::function<void()>();
+  }
+  return [tasks]() {
+    for( const std::function<void()>& task : tasks ){
+      task();
+    }
+  };
+}
+
 void StrongSolverTheoryUF::check( Theory::Effort level ){
   if( !d_conflict ){
     if( options::ufssMode()==UF_SS_FULL ){
@@ -1960,7 +2273,8 @@ StrongSolverTheoryUF::Statistics::Statistics():
   d_split_lemmas("StrongSolverTheoryUF::Split_Lemmas", 0),
   d_disamb_term_lemmas("StrongSolverTheoryUF::Disambiguate_Term_Lemmas", 0),
   d_totality_lemmas("StrongSolverTheoryUF::Totality_Lemmas", 0),
-  d_max_model_size("StrongSolverTheoryUF::Max_Model_Size", 1)
+  d_max_model_size("StrongSolverTheoryUF::Max_Model_Size", 1),
+  d_bitset_cliques("StrongSolverTheoryUF::Bitset_Cliques", 0)
 {
   smtStatisticsRegistry()->registerStat(&d_clique_conflicts);
   smtStatisticsRegistry()->registerStat(&d_clique_lemmas);
@@ -1968,6 +2282,7 @@ StrongSolverTheoryUF::Statistics::Statistics():
   smtStatisticsRegistry()->registerStat(&d_disamb_term_lemmas);
   smtStatisticsRegistry()->registerStat(&d_totality_lemmas);
   smtStatisticsRegistry()->registerStat(&d_max_model_size);
+  smtStatisticsRegistry()->registerStat(&d_bitset_cliques);
 }
 
 StrongSolverTheoryUF::Statistics::~Statistics(){
@@ -1977,6 +2292,7 @@ StrongSolverTheoryUF::Statistics::~Statistics(){
   smtStatisticsRegistry()->unregisterStat(&d_disamb_term_lemmas);
   smtStatisticsRegistry()->unregisterStat(&d_totality_lemmas);
   smtStatisticsRegistry()->unregisterStat(&d_max_model_size);
+  smtStatisticsRegistry()->unregisterStat(&d_bitset_cliques);
 }
 
 }/* CVC4::theory namespace::uf */
@@ -17,7 +17,14 @@
 #ifndef __CVC4__THEORY_UF_STRONG_SOLVER_H
 #define __CVC4__THEORY_UF_STRONG_SOLVER_H
 
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 #include "context/cdhashmap.h"
+#include "context/cdlist.h"
 #include "context/context.h"
 #include "context/context_mm.h"
 #include "theory/theory.h"
@@ -144,6 +151,8 @@ public:
       void setRep( Node n, bool valid );
       //region node infomation
       std::map< Node, RegionNodeInfo* > d_nodes;
+      //hashed index of d_nodes, for lookups
+      std::unordered_map< Node, RegionNodeInfo*, NodeHashFunction > d_nodeIndex;
       //whether region is valid
       context::CDO< bool > d_valid;
 
@@ -162,8 +171,8 @@ public:
 
       /** Returns a RegionInfo. */
       RegionNodeInfo* getRegionInfo(Node n) {
-        Assert(d_nodes.find(n) != d_nodes.end());
-        return (* (d_nodes.find(n))).second;
+        Assert(d_nodeIndex.find(n) != d_nodeIndex.end());
+        return (* (d_nodeIndex.find(n))).second;
       }
 
       /** Returns whether or not d_valid is set in current context. */
@@ -188,7 +197,9 @@ public:
       int getTestCliqueSize() { return d_testCliqueSize; }
       // has representative
       bool hasRep( Node n ) {
-        return d_nodes.find(n) != d_nodes.end() && d_nodes[n]->valid();
+        std::unordered_map< Node, RegionNodeInfo*, NodeHashFunction >::const_iterator
+          it = d_nodeIndex.find(n);
+        return it != d_nodeIndex.end() && it->second->valid();
       }
       // is disequal
       bool isDisequal( Node n1, Node n2, int type );
@@ -216,8 +227,149 @@ public:
     context::CDO< unsigned > d_regions_index;
     /** vector of regions */
     std::vector< Region* > d_regions;
-    /** map from Nodes to index of d_regions they exist in, -1 means invalid */
+    /**
+     * map from Nodes to index of d_regions they were added to, -1 means
+     * invalid.  The region they exist in is the representative of this
+     * index in the union-find of combined regions.
+     */
     NodeIntMap d_regions_map;
+    /**
+     * Parents in the union-find of combined regions, where a region that
+     * is not in the vector is its own parent.  The changes are recorded on
+     * d_region_parent_trail and undone lazily after a pop.
+     */
+    std::vector< int > d_region_parent;
+    /** trail of (region, old parent) for d_region_parent */
+    std::vector< std::pair< int, int > > d_region_parent_trail;
+    /** context dependent size of d_region_parent_trail */
+    context::CDO< unsigned > d_region_parent_trail_size;
+    /** undo the changes to d_region_parent of popped contexts */
+    void backtrackRegionParents();
+    /** set the parent of region ri in the union-find */
+    void setRegionParent( int ri, int parent );
+    /** get the region that region index ri was combined into, or ri */
+    int findRegion( int ri );
+    /** get the region that n exists in */
+    int getRegion( Node n ) { return findRegion( d_regions_map[n] ); }
+    /**
+     * Dense identifiers of the representatives, in the order they were
+     * first added by newEqClass.  These are only used if
+     * options::ufssCliqueBitset() is true.
+     */
+    std::unordered_map< Node, unsigned, NodeHashFunction > d_dense_id;
+    /** the node of each dense identifier */
+    std::vector< Node > d_dense_nodes;
+    /**
+     * Bitset adjacency of the internal disequalities, where bit j of
+     * d_adjacency[i] is set if d_dense_nodes[i] is internally disequal to
+     * d_dense_nodes[j] in their region.  The changes are recorded on
+     * d_adjacency_trail and undone lazily after a pop.
+     */
+    std::vector< std::vector< uint64_t > > d_adjacency;
+    /** trail of (i, j) whose bit in d_adjacency was flipped */
+    std::vector< std::pair< unsigned, unsigned > > d_adjacency_trail;
+    /** context dependent size of d_adjacency_trail */
+    context::CDO< unsigned > d_adjacency_trail_size;
+    /** internal disequalities added, as pairs of dense identifiers */
+    context::CDList< std::pair< unsigned, unsigned > > d_new_edges;
+    /**
+     * The number of edges of d_new_edges whose search for cliques finished.
+     * An edge whose search reached s_maxCliqueSearchSteps is not counted.
+     */
+    context::CDO< unsigned > d_new_edges_index;
+    /** the maximum number of steps of a clique search */
+    static const unsigned s_maxCliqueSearchSteps = 10000;
+    /**
+     * The number of flips of bits of d_adjacency, including the ones undone
+     * by backtrackAdjacency.  It identifies the state of d_adjacency.
+     */
+    uint64_t d_adjacency_version;
+    /**
+     * A snapshot of the clique search of the next full effort check, which
+     * is run concurrently by the task returned by getFullCheckTask.  The
+     * task only accesses the snapshot.
+     */
+    class CliqueSearch {
+    public:
+      CliqueSearch() : d_found( false ), d_limit( false ), d_searched( 0 ), d_steps( 0 ) {}
+      /** copy of d_adjacency */
+      std::vector< std::vector< uint64_t > > d_adjacency;
+      /** the edges of d_new_edges that were not searched */
+      std::vector< std::pair< unsigned, unsigned > > d_edges;
+      /** the size of the cliques */
+      unsigned d_k;
+      /** the values of d_adjacency_version, d_new_edges_index and the size
+       * of d_new_edges when the snapshot was taken */
+      uint64_t d_version;
+      unsigned d_edges_index;
+      unsigned d_num_edges;
+      /** whether a clique was found, its identifiers */
+      bool d_found;
+      std::vector< unsigned > d_clique;
+      /** whether the search reached s_maxCliqueSearchSteps */
+      bool d_limit;
+      /** the number of edges of d_edges whose search finished */
+      unsigned d_searched;
+      /** the number of steps of the search */
+      unsigned d_steps;
+      /** run the search, which is findNewClique without the region checks */
+      void run();
+    };
+    /** the snapshot of the current full effort check, if any */
+    std::unique_ptr< CliqueSearch > d_clique_search;
+    /** get the dense identifier of n, allocating one if needed */
+    unsigned getDenseId( Node n );
+    /** undo the changes to d_adjacency of popped contexts */
+    void backtrackAdjacency();
+    /** is bit j of adjacency[i] set? */
+    static bool isAdjacent( const std::vector< std::vector< uint64_t > >& adjacency,
+                            unsigned i,
+                            unsigned j );
+    /** is bit j of d_adjacency[i] set? */
+    bool isAdjacent( unsigned i, unsigned j ) const { return isAdjacent( d_adjacency, i, j ); }
+    /** set bit j of d_adjacency[i] to value */
+    void setAdjacent( unsigned i, unsigned j, bool value );
+    /**
+     * Search for a clique of size k among the vertices of cand, which are
+     * all adjacent to the vertices of clique in adjacency.  The vertices are
+     * chosen by increasing identifier.  The search gives up once steps
+     * reaches s_maxCliqueSearchSteps.  Adds the vertices to clique and
+     * returns true if one is found.
+     */
+    static bool searchClique( const std::vector< std::vector< uint64_t > >& adjacency,
+                              std::vector< uint64_t >& cand,
+                              unsigned k,
+                              std::vector< unsigned >& clique,
+                              unsigned& steps );
+    /**
+     * Search for a clique of size k in adjacency that contains the edge
+     * (a, b), as searchClique.  Returns false if (a, b) is no longer an
+     * edge of adjacency.
+     */
+    static bool searchEdgeClique( const std::vector< std::vector< uint64_t > >& adjacency,
+                                  unsigned a,
+                                  unsigned b,
+                                  unsigned k,
+                                  std::vector< unsigned >& clique,
+                                  unsigned& steps );
+    /** is the clique of identifiers ids a clique of one region? */
+    bool isRegionClique( std::vector< unsigned >& ids );
+    /**
+     * Search for a clique of size d_cardinality+1 that contains one of the
+     * internal disequalities from d_new_edges_index on.  The searches of the
+     * internal disequalities before d_new_edges_index finished, and found no
+     * clique containing them, or only one that was not a clique of a region.
+     * The search starts with steps steps.  If it reaches
+     * s_maxCliqueSearchSteps, the disequality being searched is left at
+     * d_new_edges_index, to be searched again by the next call.  Adds the
+     * nodes of the clique to clique and returns true if one is found.
+     */
+    bool findNewClique( std::vector< Node >& clique, unsigned steps = 0 );
+    /**
+     * As findNewClique, but uses the result of d_clique_search if it was
+     * run and d_adjacency and d_new_edges did not change since it was taken.
+     */
+    bool findNewCliqueFromSearch( std::vector< Node >& clique );
     /** the score for each node for splitting */
     NodeIntMap d_split_score;
     /** number of valid disequalities in d_disequalities */
@@ -297,6 +449,8 @@ public:
   public:
     SortModel( Node n, context::Context* c, context::UserContext* u,
                StrongSolverTheoryUF* thss );
+    /** notify that the internal disequality of a and b is set to valid */
+    void notifyInternalDisequal( Node a, Node b, bool valid );
     virtual ~SortModel();
     /** initialize */
     void initialize( OutputChannel* out );
@@ -310,6 +464,12 @@ public:
     bool areDisequal( Node a, Node b );
     /** check */
     void check( Theory::Effort level, OutputChannel* out );
+    /**
+     * Get the task of the clique search of the next full effort check,
+     * see Theory::getFullCheckTask.  Returns an empty function if the check
+     * does not search for cliques in d_adjacency.
+     */
+    std::function<void()> getFullCheckTask();
     /** presolve */
     void presolve();
     /** propagate */
@@ -363,6 +523,9 @@ public:
   bool areDisequal( Node a, Node b );
   /** check */
   void check( Theory::Effort level );
+  /** get the concurrent part of the full effort check, see
+   * Theory::getFullCheckTask */
+  std::function<void()> getFullCheckTask();
   /** presolve */
   void presolve();
   /** get next decision request */
@@ -392,6 +555,7 @@ public:
     IntStat d_disamb_term_lemmas;
     IntStat d_totality_lemmas;
     IntStat d_max_model_size;
+    IntStat d_bitset_cliques;
     Statistics();
     ~Statistics();
   };
@@ -175,6 +175,18 @@ void StatisticsRegistry::unregisterStat(Stat* s)
 #endif /* CVC4_STATISTICS_ON */
 } /* StatisticsRegistry::unregisterStat() */
 
+void StatisticsRegistry::getHistogramTimers(
+    std::vector<const HistogramTimerStat*>& timers) const
+{
+  for(StatSet::const_iterator i = d_stats.begin(); i != d_stats.end(); ++i) {
+    const HistogramTimerStat* timer =
+        dynamic_cast<const HistogramTimerStat*>(*i);
+    if(timer != NULL) {
+      timers.push_back(timer);
+    }
+  }
+}/* StatisticsRegistry::getHistogramTimers() */
+
 void StatisticsRegistry::flushStat(std::ostream &out) const {
 #ifdef CVC4_STATISTICS_ON
   flushInformation(out);
@@ -211,6 +223,23 @@ void TimerStat::stop() {
   }
 }/* TimerStat::stop() */
 
+const unsigned HistogramTimerStat::s_histogramSize;
+
+void HistogramTimerStat::stop() {
+  if(__CVC4_USE_STATISTICS) {
+    ::timespec before = d_data;
+    TimerStat::stop();
+    ::timespec elapsed = d_data - before;
+    uint64_t usec = uint64_t(elapsed.tv_sec) * 1000000 + elapsed.tv_nsec / 1000;
+    unsigned bucket = 0;
+    while(usec > 1 && bucket + 1 < s_histogramSize) {
+      usec >>= 1;
+      ++bucket;
+    }
+    ++d_histogram[bucket];
+  }
+}/* HistogramTimerStat::stop() */
+
 bool TimerStat::running() const {
   return d_running;
 }/* TimerStat::running() */
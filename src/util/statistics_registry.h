@@ -645,6 +645,8 @@ public:
 /* Statistics Registry                                                      */
 /****************************************************************************/
 
+class HistogramTimerStat;
+
 /**
  * The main statistics registry.  This registry maintains the list of
  * currently active statistics and is able to "flush" them all.
@@ -694,6 +696,10 @@ public:
   /** Unregister a new statistic */
   void unregisterStat(Stat* s);
 
+  /** Get the timer statistics of this registry that keep a histogram */
+  void getHistogramTimers(
+      std::vector<const HistogramTimerStat*>& timers) const;
+
 };/* class StatisticsRegistry */
 
 class CodeTimer;
@@ -777,6 +783,60 @@ public:
   }
 };/* class CodeTimer */
 
+/**
+ * A timer statistic that also counts its (start,stop) pairs by duration,
+ * for the telemetry of the queries.  It is a separate type so that the
+ * other timers do not keep a histogram.  Since start() and stop() are not
+ * virtual, it must be stopped through this type, e.g. by its CodeTimer.
+ */
+class HistogramTimerStat : public TimerStat {
+public:
+
+  /** The number of buckets of the histogram */
+  static const unsigned s_histogramSize = 32;
+
+  /** As CVC4::CodeTimer, for this type */
+  class CodeTimer {
+    HistogramTimerStat& d_timer;
+    bool d_reentrant;
+
+    CodeTimer(const CodeTimer& timer) = delete;
+    CodeTimer& operator=(const CodeTimer& timer) = delete;
+
+  public:
+    CodeTimer(HistogramTimerStat& timer, bool allow_reentrant = false)
+        : d_timer(timer), d_reentrant(false) {
+      if(!allow_reentrant || !(d_reentrant = d_timer.running())) {
+        d_timer.start();
+      }
+    }
+    ~CodeTimer() {
+      if(!d_reentrant) {
+        d_timer.stop();
+      }
+    }
+  };/* class HistogramTimerStat::CodeTimer */
+
+  HistogramTimerStat(const std::string& name)
+      : TimerStat(name), d_histogram{} {}
+
+  /** Stop the timer and count the duration of this (start,stop) pair. */
+  void stop();
+
+  /** The number of (start,stop) pairs in bucket i of the histogram */
+  uint64_t getHistogramCount(unsigned i) const { return d_histogram[i]; }
+
+private:
+
+  /**
+   * The number of (start,stop) pairs by duration.  Bucket i counts the
+   * durations in [2^i, 2^(i+1)) microseconds, the first bucket also the
+   * shorter ones and the last bucket also the longer ones.
+   */
+  uint64_t d_histogram[s_histogramSize];
+
+};/* class HistogramTimerStat */
+
 /**
  * Resource-acquisition-is-initialization idiom for statistics
  * registry.  Useful for stack-based statistics (like in the driver).
@@ -0,0 +1,132 @@
+/*********************                                                        */
+/*! \file worker_pool.cpp
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2018 by the authors listed in the file AUTHORS
+ ** in the top-level source directory) and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief A pool of worker threads
+ **/
+
+#include "util/worker_pool.h"
+
+namespace CVC4 {
+
+WorkerPool::WorkerPool()
+    : d_work(nullptr),
+      d_numThreads(0),
+      d_generation(0),
+      d_pending(0),
+      d_stop(false)
+{
+}
+
+WorkerPool::~WorkerPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(d_mutex);
+    d_stop = true;
+  }
+  d_start.notify_all();
+  for (std::thread& thread : d_threads)
+  {
+    thread.join();
+  }
+}
+
+void WorkerPool::run(size_t numThreads,
+                     const std::function<void(size_t)>& work)
+{
+  if (numThreads <= 1)
+  {
+    work(0);
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(d_mutex);
+    while (d_threads.size() + 1 < numThreads)
+    {
+      // the new worker takes part in the call that is published below
+      d_threads.push_back(std::thread(
+          &WorkerPool::workerLoop, this, d_threads.size() + 1, d_generation));
+    }
+    d_work = &work;
+    d_numThreads = numThreads;
+    d_pending = numThreads - 1;
+    d_exceptions.assign(numThreads, std::exception_ptr());
+    ++d_generation;
+  }
+  d_start.notify_all();
+
+  std::exception_ptr exception;
+  try
+  {
+    work(0);
+  }
+  catch (...)
+  {
+    exception = std::current_exception();
+  }
+
+  std::unique_lock<std::mutex> lock(d_mutex);
+  d_done.wait(lock, [this]() { return d_pending == 0; });
+  d_work = nullptr;
+  if (!exception)
+  {
+    for (const std::exception_ptr& e : d_exceptions)
+    {
+      if (e)
+      {
+        exception = e;
+        break;
+      }
+    }
+  }
+  d_exceptions.clear();
+  lock.unlock();
+  if (exception)
+  {
+    std::rethrow_exception(exception);
+  }
+}
+
+void WorkerPool::workerLoop(size_t i, size_t generation)
+{
+  std::unique_lock<std::mutex> lock(d_mutex);
+  for (;;)
+  {
+    d_start.wait(lock, [this, generation]() {
+      return d_stop || d_generation != generation;
+    });
+    if (d_stop)
+    {
+      return;
+    }
+    generation = d_generation;
+    if (i >= d_numThreads)
+    {
+      continue;
+    }
+    const std::function<void(size_t)>* work = d_work;
+    lock.unlock();
+    std::exception_ptr exception;
+    try
+    {
+      (*work)(i);
+    }
+    catch (...)
+    {
+      exception = std::current_exception();
+    }
+    lock.lock();
+    d_exceptions[i] = exception;
+    if (--d_pending == 0)
+    {
+      d_done.notify_one();
+    }
+  }
+}
+
+}/* CVC4 namespace */
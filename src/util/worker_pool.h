@@ -0,0 +1,80 @@
+/*********************                                                        */
+/*! \file worker_pool.h
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2018 by the authors listed in the file AUTHORS
+ ** in the top-level source directory) and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief A pool of worker threads
+ **
+ ** A pool of worker threads that are kept between the calls to run, so that
+ ** the solver does not create threads in each round of a check.
+ **/
+
+#include "cvc4_private.h"
+
+#ifndef __CVC4__UTIL__WORKER_POOL_H
+#define __CVC4__UTIL__WORKER_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace CVC4 {
+
+class WorkerPool
+{
+ public:
+  WorkerPool();
+  /** Stops and joins the workers. */
+  ~WorkerPool();
+
+  /**
+   * Calls work(i) for each i in [0, numThreads), where work(0) runs on the
+   * calling thread and the others on workers of this pool, which is grown
+   * as needed. Returns once all calls returned.
+   *
+   * If some calls throw, run still waits for all of them, and then
+   * rethrows the exception of the call with the smallest i. Hence no worker
+   * uses work, or what it refers to, after run returns or throws.
+   */
+  void run(size_t numThreads, const std::function<void(size_t)>& work);
+
+  /** Returns the number of workers, the calling thread excluded. */
+  size_t size() const { return d_threads.size(); }
+
+ private:
+  /**
+   * The loop of the worker running work(i), which takes part in the calls
+   * to run after the first generation ones.
+   */
+  void workerLoop(size_t i, size_t generation);
+
+  std::vector<std::thread> d_threads;
+  std::mutex d_mutex;
+  /** Signals a new call to run, or that the workers must stop */
+  std::condition_variable d_start;
+  /** Signals that a worker finished its call */
+  std::condition_variable d_done;
+  /** The work of the current call to run */
+  const std::function<void(size_t)>* d_work;
+  /** The number of threads of the current call to run */
+  size_t d_numThreads;
+  /** The number of calls to run so far */
+  size_t d_generation;
+  /** The number of calls of the current run that did not return yet */
+  size_t d_pending;
+  /** The exceptions of the calls of the current run, indexed by i */
+  std::vector<std::exception_ptr> d_exceptions;
+  bool d_stop;
+};/* class WorkerPool */
+
+}/* CVC4 namespace */
+
+#endif /* __CVC4__UTIL__WORKER_POOL_H */
@@ -0,0 +1,17 @@
+; COMMAND-LINE: --arith-minimize-conflicts
+; COMMAND-LINE: --arith-minimize-conflicts --arith-explanation-cache
+; EXPECT: unsat
+(set-logic QF_LRA)
+(declare-fun x () Real)
+(declare-fun y () Real)
+(declare-fun z () Real)
+(declare-fun b () Bool)
+(assert (>= x 0))
+(assert (>= y 0))
+(assert (>= z 0))
+(assert (<= (+ x y) 2))
+(assert (<= (+ y z) 2))
+(assert (or b (>= (+ x z) 5)))
+(assert (or (not b) (> (+ x y z) 3)))
+(assert (or (not b) (<= (+ x z) 1)))
+(check-sat)
@@ -0,0 +1,16 @@
+; COMMAND-LINE: --arith-par-prop-rows=1 --arith-par-prop-threads=2
+; EXPECT: unsat
+(set-logic QF_LRA)
+(declare-fun x () Real)
+(declare-fun y () Real)
+(declare-fun z () Real)
+(declare-fun w () Real)
+(assert (and (<= 0 x) (<= x 2)))
+(assert (and (<= 0 y) (<= y 3)))
+(assert (and (<= 1 z) (<= z 4)))
+(assert (<= (+ x y) 4))
+(assert (<= (+ y z) 5))
+(assert (>= (+ x (* 2 z)) 3))
+(assert (= w (+ x y z)))
+(assert (or (> (+ x y) 5) (> w 9) (and (> z 3) (> y 2))))
+(check-sat)
@@ -0,0 +1,12 @@
+; COMMAND-LINE: --dio-hnf
+; EXPECT: unsat
+(set-logic QF_LIA)
+(declare-fun x () Int)
+(declare-fun y () Int)
+(declare-fun z () Int)
+(declare-fun w () Int)
+(assert (= (+ x (* 2 y) (* 4 w)) 1))
+(assert (= (+ x (* 6 z) (* (- 2) w)) 8))
+(assert (<= 0 x))
+(assert (<= x 100))
+(check-sat)
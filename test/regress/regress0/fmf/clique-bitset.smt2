@@ -0,0 +1,13 @@
+; COMMAND-LINE: --finite-model-find --uf-ss-clique-bitset
+; EXPECT: unsat
+(set-logic UF)
+(declare-sort U 0)
+(declare-fun f (U) U)
+(declare-fun a () U)
+(declare-fun b () U)
+(declare-fun c () U)
+(declare-fun d () U)
+(assert (forall ((x U) (y U) (z U)) (or (= x y) (= x z) (= y z))))
+(assert (distinct a b (f a)))
+(assert (or (distinct c d (f c)) (distinct a (f b) (f (f a)))))
+(check-sat)
@@ -0,0 +1,16 @@
+; COMMAND-LINE: --finite-model-find --fmc-batch
+; EXPECT: sat
+(set-logic UF)
+(declare-sort U 0)
+(declare-fun f (U U) U)
+(declare-fun P (U) Bool)
+(declare-fun a () U)
+(declare-fun b () U)
+(declare-fun c () U)
+(assert (distinct a b c))
+(assert (forall ((x U) (y U)) (= (f x y) (f y x))))
+(assert (forall ((x U)) (or (= x a) (= x b) (= x c))))
+(assert (forall ((x U) (y U)) (=> (and (P x) (P y)) (= (f x y) x))))
+(assert (forall ((x U)) (ite (P x) (not (= x b)) (= (f x x) b))))
+(assert (P a))
+(check-sat)
@@ -0,0 +1,22 @@
+; COMMAND-LINE: --finite-model-find --inst-schedule --inst-schedule-budget=1
+; EXPECT: unsat
+(set-logic UF)
+(declare-sort U 0)
+(declare-fun P (U) Bool)
+(declare-fun R (U) Bool)
+(declare-fun a () U)
+(declare-fun b () U)
+(declare-fun c () U)
+(declare-fun A () Bool)
+(declare-fun B () Bool)
+; The quantified formulas are asserted under decisions on A and B. Their
+; instances are delayed by the small budget, and the SAT solver backtracks
+; past their assertion before the delayed instances are sent. The instances
+; must still be sent once the quantified formulas are asserted again.
+(assert (or A (forall ((x U)) (P x))))
+(assert (or (not A) (forall ((x U)) (P x))))
+(assert (or B (forall ((x U)) (or (not (P x)) (R x)))))
+(assert (or (not B) (forall ((x U)) (or (not (P x)) (R x)))))
+(assert (distinct a b c))
+(assert (or (not (R a)) (not (R b)) (not (R c))))
+(check-sat)
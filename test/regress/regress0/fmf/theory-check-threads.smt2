@@ -0,0 +1,19 @@
+; COMMAND-LINE: --finite-model-find --uf-ss-clique-bitset --theory-check-threads=2
+; COMMAND-LINE: --finite-model-find --uf-ss-clique-bitset --theory-check-threads=4
+; EXPECT: unsat
+(set-logic UFLIA)
+(declare-sort U 0)
+(declare-sort V 0)
+(declare-fun f (U) U)
+(declare-fun g (V) V)
+(declare-fun h (U) Int)
+(declare-fun a () U)
+(declare-fun b () U)
+(declare-fun c () V)
+(declare-fun d () V)
+(assert (forall ((x U) (y U) (z U)) (or (= x y) (= x z) (= y z))))
+(assert (forall ((x V) (y V)) (= x y)))
+(assert (distinct a b (f a)))
+(assert (or (distinct c (g c)) (distinct a (f b) (f (f a)))))
+(assert (> (h a) (h b)))
+(check-sat)
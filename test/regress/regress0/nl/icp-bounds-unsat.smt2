@@ -0,0 +1,12 @@
+; COMMAND-LINE: --nl-ext-icp
+; EXPECT: unsat
+(set-logic QF_NRA)
+(set-info :status unsat)
+(declare-fun x () Real)
+(declare-fun y () Real)
+(declare-fun z () Real)
+(assert (>= x 2.0))
+(assert (>= y 3.0))
+(assert (and (>= z 1.0) (<= z 4.0)))
+(assert (< (* x y z) 5.0))
+(check-sat)
@@ -0,0 +1,31 @@
+; COMMAND-LINE: --incremental --arith-basis-snapshots
+; EXPECT: sat
+; EXPECT: unsat
+; EXPECT: sat
+; EXPECT: unsat
+; EXPECT: sat
+; EXPECT: sat
+(set-logic QF_LRA)
+(declare-fun x () Real)
+(declare-fun y () Real)
+(declare-fun z () Real)
+(assert (>= (+ x y) 2))
+(assert (<= (- x y) 1))
+(check-sat)
+(push 1)
+(assert (>= x 10))
+(assert (<= y 0))
+(check-sat)
+(pop 1)
+(push 1)
+(assert (>= (+ x (* 2 z)) 5))
+(assert (<= z 1))
+(check-sat)
+(push 1)
+(assert (<= x 2))
+(check-sat)
+(pop 1)
+(check-sat)
+(pop 1)
+(assert (< x 0))
+(check-sat)
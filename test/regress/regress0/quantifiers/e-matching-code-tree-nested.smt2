@@ -0,0 +1,21 @@
+; COMMAND-LINE: --e-matching-code-tree
+; EXPECT: unsat
+(set-logic UF)
+(declare-sort U 0)
+(declare-fun f (U U) U)
+(declare-fun g (U) U)
+(declare-fun h (U) U)
+(declare-fun k (U U) U)
+(declare-fun P (U) Bool)
+(declare-fun Q (U) Bool)
+(declare-fun a () U)
+(declare-fun b () U)
+(declare-fun c () U)
+(declare-fun d () U)
+(assert (forall ((x U)) (! (= (f (g x) x) x) :pattern ((f (g x) x)))))
+(assert (forall ((x U) (y U)) (! (=> (P x) (Q y)) :pattern ((h x) (k x y)))))
+(assert (= c (g a)))
+(assert (P b))
+(assert (= (h b) (k b d)))
+(assert (or (not (= (f c a) a)) (not (Q d))))
+(check-sat)
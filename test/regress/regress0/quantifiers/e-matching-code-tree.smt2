@@ -0,0 +1,15 @@
+; COMMAND-LINE: --e-matching-code-tree
+; EXPECT: unsat
+(set-logic UF)
+(declare-sort U 0)
+(declare-fun f (U U) U)
+(declare-fun P (U) Bool)
+(declare-fun a () U)
+(declare-fun b () U)
+(declare-fun c () U)
+(assert (forall ((x U)) (! (P (f x a)) :pattern ((f x a)))))
+(assert (forall ((y U)) (! (=> (= y b) (not (P (f y a)))) :pattern ((f y a)))))
+(assert (forall ((x U)) (! (= (f x x) x) :pattern ((f x x)))))
+(assert (= c (f b a)))
+(assert (or (not (= (f c c) c)) (= b (f b b))))
+(check-sat)
@@ -0,0 +1,15 @@
+; COMMAND-LINE: --full-saturate-quant --no-e-matching --no-quant-cf --fs-threads=4
+; EXPECT: unsat
+(set-logic UF)
+(declare-sort U 0)
+(declare-fun P (U) Bool)
+(declare-fun Q (U U) Bool)
+(declare-fun R (U U U) Bool)
+(declare-fun a () U)
+(declare-fun b () U)
+(declare-fun c () U)
+(assert (forall ((x U)) (P x)))
+(assert (forall ((x U) (y U)) (or (not (P x)) (Q x y))))
+(assert (forall ((x U) (y U) (z U)) (or (not (Q x y)) (not (Q y z)) (R x y z))))
+(assert (not (R a b c)))
+(check-sat)
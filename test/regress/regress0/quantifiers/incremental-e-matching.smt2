@@ -0,0 +1,16 @@
+; COMMAND-LINE: --incremental-e-matching
+; EXPECT: unsat
+(set-logic UF)
+(declare-sort U 0)
+(declare-fun f (U) U)
+(declare-fun g (U) U)
+(declare-fun h (U U) U)
+(declare-fun P (U) Bool)
+(declare-fun a () U)
+(declare-fun b () U)
+(assert (forall ((x U)) (! (= (f x) (g x)) :pattern ((f x)))))
+(assert (forall ((x U)) (! (P (g x)) :pattern ((g x)))))
+(assert (forall ((x U)) (! (not (P (h x x))) :pattern ((h x x)))))
+(assert (= (h a b) (f a)))
+(assert (or (= a b) (not (P (f b)))))
+(check-sat)
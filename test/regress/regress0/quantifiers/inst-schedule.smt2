@@ -0,0 +1,19 @@
+; COMMAND-LINE: --inst-schedule --inst-schedule-budget=2
+; EXPECT: unsat
+(set-logic UF)
+(declare-sort U 0)
+(declare-fun f (U) U)
+(declare-fun P (U) Bool)
+(declare-fun R (U U) Bool)
+(declare-fun a () U)
+(declare-fun b () U)
+(declare-fun c () U)
+; a matching loop, whose instances are delayed once they are not useful
+(assert (forall ((x U)) (! (= (f x) (f (f x))) :pattern ((f x)))))
+(assert (forall ((x U) (y U)) (=> (R x y) (R y x))))
+(assert (forall ((x U) (y U) (z U)) (=> (and (R x y) (R y z)) (R x z))))
+(assert (forall ((x U)) (=> (R x (f x)) (P x))))
+(assert (R a b))
+(assert (R b (f a)))
+(assert (not (P a)))
+(check-sat)
@@ -0,0 +1,18 @@
+; COMMAND-LINE: --incremental --inst-tuple-store
+; EXPECT: unsat
+; EXPECT: unsat
+(set-logic UF)
+(declare-sort U 0)
+(declare-fun f (U U) U)
+(declare-fun P (U) Bool)
+(declare-fun a () U)
+(declare-fun b () U)
+(assert (forall ((x U) (y U)) (! (P (f x y)) :pattern ((f x y)))))
+(push 1)
+(assert (not (P (f a b))))
+(check-sat)
+(pop 1)
+(push 1)
+(assert (not (P (f a b))))
+(check-sat)
+(pop 1)
@@ -0,0 +1,18 @@
+; COMMAND-LINE: --qcf-join-plan --no-e-matching
+; COMMAND-LINE: --no-e-matching
+; EXPECT: unsat
+(set-logic UF)
+(declare-sort U 0)
+(declare-fun f (U) U)
+(declare-fun g (U) U)
+(declare-fun k (U) U)
+(declare-fun P (U) Bool)
+(declare-fun R (U) Bool)
+(declare-fun a () U)
+(declare-fun b () U)
+; the instance x = a, y = b propagates the equality (f a) = (g b)
+(assert (forall ((x U) (y U)) (or (not (P x)) (not (R y)) (= (f x) (g y)))))
+(assert (P a))
+(assert (R b))
+(assert (distinct (k (f a)) (k (g b))))
+(check-sat)
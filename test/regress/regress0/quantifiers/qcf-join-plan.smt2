@@ -0,0 +1,19 @@
+; COMMAND-LINE: --qcf-join-plan
+; COMMAND-LINE: --qcf-join-plan --quant-cf-mode=conflict
+; EXPECT: unsat
+(set-logic UF)
+(declare-sort U 0)
+(declare-fun f (U) U)
+(declare-fun g (U U) U)
+(declare-fun P (U) Bool)
+(declare-fun Q (U U) Bool)
+(declare-fun a () U)
+(declare-fun b () U)
+(declare-fun c () U)
+(assert (forall ((x U) (y U)) (or (not (Q x y)) (not (P (f x))) (= (g x y) c))))
+(assert (forall ((x U)) (or (not (P x)) (Q x (f x)))))
+(assert (P (f a)))
+(assert (P (f (f a))))
+(assert (= (f (f a)) b))
+(assert (distinct (g (f a) b) c))
+(check-sat)
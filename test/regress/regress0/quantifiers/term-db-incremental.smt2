@@ -0,0 +1,17 @@
+; COMMAND-LINE: --term-db-incremental
+; EXPECT: unsat
+(set-logic UF)
+(declare-sort U 0)
+(declare-fun f (U) U)
+(declare-fun g (U U) U)
+(declare-fun P (U) Bool)
+(declare-fun a () U)
+(declare-fun b () U)
+(declare-fun c () U)
+(assert (forall ((x U)) (! (= (f (f x)) x) :pattern ((f x)))))
+(assert (forall ((x U) (y U)) (! (=> (= x y) (P (g x y))) :pattern ((g x y)))))
+(assert (= (g (f (f a)) b) c))
+(assert (or (= a b) (= (f a) b)))
+(assert (=> (= (f a) b) (= (f b) b)))
+(assert (not (P c)))
+(check-sat)
@@ -0,0 +1,17 @@
+; COMMAND-LINE: --incremental --telemetry=telemetry-csv.out.csv
+; REQUIRES: statistics
+; SCRUBBER: sh -c 'cat; cut -d, -f1,2 telemetry-csv.out.csv | uniq; grep -c "^2,unsat,smt::SmtEngine::solveTime::bucket[0-9]*,," telemetry-csv.out.csv; rm -f telemetry-csv.out.csv'
+; EXPECT: sat
+; EXPECT: unsat
+; EXPECT: query,result
+; EXPECT: 1,sat
+; EXPECT: 2,unsat
+; EXPECT: 32
+(set-logic QF_LIA)
+(declare-fun x () Int)
+(declare-fun y () Int)
+(assert (> x 0))
+(check-sat)
+(assert (> y x))
+(assert (< y 0))
+(check-sat)
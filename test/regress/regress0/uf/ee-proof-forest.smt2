@@ -0,0 +1,25 @@
+; COMMAND-LINE: --incremental
+; EXPECT: unsat
+; EXPECT: sat
+; EXPECT: unsat
+(set-logic QF_UF)
+(declare-sort U 0)
+(declare-fun f (U U) U)
+(declare-fun g (U) U)
+(declare-fun a () U)
+(declare-fun b () U)
+(declare-fun c () U)
+(declare-fun d () U)
+(declare-fun e () U)
+(assert (= a b))
+(push 1)
+(assert (= b c))
+(assert (= c d))
+(assert (not (= (g (f a d)) (g (f d a)))))
+(check-sat)
+(pop 1)
+(assert (not (= (f a c) (f b d))))
+(check-sat)
+(assert (= e c))
+(assert (= e d))
+(check-sat)
@@ -0,0 +1,37 @@
+; COMMAND-LINE: --incremental --theory-explanation-memo
+; EXPECT: sat
+; EXPECT: unsat
+; EXPECT: sat
+; EXPECT: unsat
+; EXPECT: sat
+(set-logic QF_UFLIA)
+(declare-fun f (Int) Int)
+(declare-fun g (Int) Int)
+(declare-fun x () Int)
+(declare-fun y () Int)
+(declare-fun z () Int)
+(declare-fun a () Bool)
+(declare-fun b () Bool)
+(assert (<= x y))
+(assert (<= y (+ z 1)))
+(assert (or a (= (f x) 3)))
+(assert (or b (= (g (f x)) 4)))
+(check-sat)
+(push 1)
+; x = y = z + 1 is propagated by arithmetic and explained in every conflict
+(assert (>= x (+ z 1)))
+(assert (or (not a) (distinct (f x) (f y))))
+(assert (or (not b) (distinct (g (f x)) (g (f y)))))
+(assert (or (= (f y) 5) (= (g (f y)) 6)))
+(check-sat)
+(pop 1)
+(assert (or (not a) (not b)))
+(check-sat)
+(push 1)
+(assert (= y (+ z 1)))
+(assert (= x y))
+(assert (distinct (g (f x)) (g (f (- (+ z 2) 1)))))
+(check-sat)
+(pop 1)
+(assert (distinct x y))
+(check-sat)
@@ -0,0 +1,20 @@
+; COMMAND-LINE: --incremental --tc-model-based
+; EXPECT: sat
+; EXPECT: unsat
+; EXPECT: sat
+(set-logic QF_UFLIA)
+(declare-fun f (Int) Int)
+(declare-fun x () Int)
+(declare-fun y () Int)
+(declare-fun z () Int)
+(assert (= (f x) 1))
+(assert (= (f y) 2))
+(assert (<= 0 x 3))
+(assert (<= 0 y 3))
+(check-sat)
+(push 1)
+(assert (= (+ x z) (+ y z)))
+(check-sat)
+(pop 1)
+(assert (= (f z) (+ (f x) 1)))
+(check-sat)
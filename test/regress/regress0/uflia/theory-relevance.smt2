@@ -0,0 +1,18 @@
+; COMMAND-LINE: --incremental --theory-relevance
+; EXPECT: sat
+; EXPECT: unsat
+; EXPECT: sat
+(set-logic QF_UFLIA)
+(declare-fun f (Int) Int)
+(declare-fun x () Int)
+(declare-fun y () Int)
+(declare-fun c () Bool)
+(assert (ite c (= (f x) (+ y 1)) (and (< x 0) (> x 0))))
+(assert (or (= (f y) x) (> (f x) (f y))))
+(check-sat)
+(push 1)
+(assert (= (f x) y))
+(check-sat)
+(pop 1)
+(assert (=> (not c) (= x y)))
+(check-sat)
@@ -0,0 +1,214 @@
+/*********************                                                        */
+/*! \file telemetry_black.h
+ ** \verbatim
+ ** This file is part of the CVC4 project.
+ ** Copyright (c) 2009-2018 by the authors listed in the file AUTHORS
+ ** in the top-level source directory) and their institutional affiliations.
+ ** All rights reserved.  See the file COPYING in the top-level source
+ ** directory for licensing information.\endverbatim
+ **
+ ** \brief Black box testing of the telemetry records of SmtEngine
+ **
+ ** Black box testing of the JSON records passed to the telemetry callback
+ ** of SmtEngine after each query.
+ **/
+
+#include <cxxtest/TestSuite.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "expr/expr.h"
+#include "expr/expr_manager.h"
+#include "smt/smt_engine.h"
+#include "util/rational.h"
+#include "util/statistics_registry.h"
+
+using namespace CVC4;
+using namespace std;
+
+class TelemetryBlack : public CxxTest::TestSuite
+{
+  ExprManager* d_em;
+  SmtEngine* d_smt;
+
+  /** The records passed to the callback */
+  vector<string> d_records;
+
+  /** Returns the text of the number starting at pos, and moves pos past it */
+  static string parseNumber(const string& json, size_t& pos)
+  {
+    size_t end = json.find_first_of(",}]", pos);
+    TS_ASSERT(end != string::npos);
+    string number = json.substr(pos, end - pos);
+    pos = end;
+    return number;
+  }
+
+  /** Returns the value of the integer field name of the record */
+  static unsigned parseField(const string& json, const string& name)
+  {
+    size_t pos = json.find("\"" + name + "\":");
+    TS_ASSERT(pos != string::npos);
+    pos += name.size() + 3;
+    return Rational(parseNumber(json, pos)).getNumerator().getUnsignedInt();
+  }
+
+  /**
+   * Parses the integral statistics of the record into values and deltas,
+   * returns the number of statistics.
+   */
+  static unsigned parseStats(const string& json,
+                             map<string, Rational>& values,
+                             map<string, Rational>& deltas)
+  {
+    size_t pos = json.find("\"stats\":[");
+    size_t end = json.find("],\"timers\":[");
+    TS_ASSERT(pos != string::npos && end != string::npos);
+    unsigned count = 0;
+    const string nameKey = "{\"name\":\"";
+    while ((pos = json.find(nameKey, pos)) != string::npos && pos < end)
+    {
+      pos += nameKey.size();
+      size_t nameEnd = json.find("\",\"value\":", pos);
+      TS_ASSERT(nameEnd != string::npos);
+      string name = json.substr(pos, nameEnd - pos);
+      pos = nameEnd + 10;
+      ++count;
+      if (json[pos] == '"')
+      {
+        // not numeric, so it has no delta
+        continue;
+      }
+      string value = parseNumber(json, pos);
+      TS_ASSERT_EQUALS(json.compare(pos, 9, ",\"delta\":"), 0);
+      pos += 9;
+      string delta = parseNumber(json, pos);
+      if (value.find_first_of(".e") == string::npos
+          && delta.find_first_of(".e") == string::npos)
+      {
+        values[name] = Rational(value);
+        deltas[name] = Rational(delta);
+      }
+    }
+    return count;
+  }
+
+  /** Returns the histogram of the timer name in the record */
+  static vector<uint64_t> parseHistogram(const string& json,
+                                         const string& name)
+  {
+    string key = "{\"name\":\"" + name + "\",\"histogram\":[";
+    size_t pos = json.find(key, json.find("],\"timers\":["));
+    vector<uint64_t> histogram;
+    TS_ASSERT(pos != string::npos);
+    if (pos == string::npos)
+    {
+      return histogram;
+    }
+    pos += key.size();
+    while (json[pos] != ']')
+    {
+      if (json[pos] == ',')
+      {
+        ++pos;
+      }
+      string count = parseNumber(json, pos);
+      histogram.push_back(Rational(count).getNumerator().getUnsignedLong());
+    }
+    return histogram;
+  }
+
+ public:
+  void setUp() override
+  {
+    d_em = new ExprManager();
+    d_smt = new SmtEngine(d_em);
+    d_smt->setOption("incremental", SExpr("true"));
+    d_records.clear();
+    vector<string>* records = &d_records;
+    d_smt->setTelemetryCallback(
+        [records](const string& json) { records->push_back(json); });
+  }
+
+  void tearDown() override
+  {
+    delete d_smt;
+    delete d_em;
+  }
+
+  void testTwoQueries()
+  {
+    Expr x = d_em->mkVar("x", d_em->integerType());
+    Expr y = d_em->mkVar("y", d_em->integerType());
+    Expr zero = d_em->mkConst(Rational(0));
+    d_smt->assertFormula(d_em->mkExpr(kind::GT, x, zero));
+    TS_ASSERT_EQUALS(d_smt->checkSat().isSat(), Result::SAT);
+    d_smt->assertFormula(d_em->mkExpr(kind::GT, y, x));
+    d_smt->assertFormula(d_em->mkExpr(kind::GT, zero, y));
+    TS_ASSERT_EQUALS(d_smt->checkSat().isSat(), Result::UNSAT);
+
+    // The queries are numbered from one
+    TS_ASSERT_EQUALS(d_records.size(), 2u);
+    TS_ASSERT_EQUALS(parseField(d_records[0], "query"), 1u);
+    TS_ASSERT_EQUALS(parseField(d_records[1], "query"), 2u);
+    TS_ASSERT(d_records[0].find("\"result\":\"sat\"") != string::npos);
+    TS_ASSERT(d_records[1].find("\"result\":\"unsat\"") != string::npos);
+
+#ifdef CVC4_STATISTICS_ON
+    // The delta of a statistic is its change since the previous query
+    map<string, Rational> values1, deltas1, values2, deltas2;
+    TS_ASSERT(parseStats(d_records[0], values1, deltas1) > 0);
+    TS_ASSERT(parseStats(d_records[1], values2, deltas2) > 0);
+    TS_ASSERT(!values1.empty());
+    for (map<string, Rational>::const_iterator i = values1.begin();
+         i != values1.end();
+         ++i)
+    {
+      TS_ASSERT_EQUALS(deltas1[(*i).first], (*i).second);
+    }
+    for (map<string, Rational>::const_iterator i = values2.begin();
+         i != values2.end();
+         ++i)
+    {
+      map<string, Rational>::const_iterator previous =
+          values1.find((*i).first);
+      Rational before =
+          previous == values1.end() ? Rational(0) : (*previous).second;
+      TS_ASSERT_EQUALS(deltas2[(*i).first], (*i).second - before);
+    }
+
+    // The solve timer is stopped once per query, so each histogram has one
+    // more duration than the previous one
+    for (unsigned r = 0; r < 2; ++r)
+    {
+      vector<uint64_t> histogram =
+          parseHistogram(d_records[r], "smt::SmtEngine::solveTime");
+      TS_ASSERT_EQUALS(histogram.size(), HistogramTimerStat::s_histogramSize);
+      uint64_t total = 0;
+      for (unsigned b = 0; b < histogram.size(); ++b)
+      {
+        total += histogram[b];
+      }
+      TS_ASSERT_EQUALS(total, 1u);
+    }
+#endif /* CVC4_STATISTICS_ON */
+  }
+
+  void testOutOfResources()
+  {
+    Expr x = d_em->mkVar("x", d_em->integerType());
+    Expr y = d_em->mkVar("y", d_em->integerType());
+    d_smt->assertFormula(d_em->mkExpr(kind::GT, y, x));
+    d_smt->setResourceLimit(1);
+    Result r = d_smt->checkSat();
+
+    // The query is recorded even if it ran out of resources
+    TS_ASSERT_EQUALS(d_records.size(), 1u);
+    if (r.isSat() == Result::SAT_UNKNOWN)
+    {
+      TS_ASSERT(d_records[0].find("\"result\":\"unknown") != string::npos);
+    }
+  }
+};
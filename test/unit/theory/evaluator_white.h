@@ -119,4 +119,70 @@ class TheoryEvaluatorWhite : public CxxTest::TestSuite
                      Rewriter::rewrite(t.substitute(
                          args.begin(), args.end(), vals.begin(), vals.end())));
   }
+
+  void testBatch()
+  {
+    TypeNode bv8Type = d_nm->mkBitVectorType(8);
+    TypeNode bv128Type = d_nm->mkBitVectorType(128);
+
+    Node x = d_nm->mkVar("x", bv8Type);
+    Node y = d_nm->mkVar("y", bv8Type);
+    Node s = d_nm->mkVar("s", d_nm->stringType());
+    Node z = d_nm->mkVar("z", bv128Type);
+
+    Node w = d_nm->mkBoundVar(bv8Type);
+    Node largs = d_nm->mkNode(kind::BOUND_VAR_LIST, w);
+    Node lbody = d_nm->mkNode(kind::BITVECTOR_MULT,
+                              d_nm->mkNode(kind::BITVECTOR_NEG, w),
+                              d_nm->mkNode(kind::BITVECTOR_PLUS, w, y));
+    Node lambda = d_nm->mkNode(kind::LAMBDA, largs, lbody);
+    Node app = d_nm->mkNode(kind::APPLY_UF, lambda, x);
+    Node len = d_nm->mkNode(kind::STRING_LENGTH, s);
+    Node t = d_nm->mkNode(
+        kind::ITE,
+        d_nm->mkNode(kind::EQUAL, bv::utils::mkExtract(app, 0, 0),
+                     bv::utils::mkOne(1)),
+        d_nm->mkNode(kind::STRING_SUBSTR, s, d_nm->mkConst(Rational(1)), len),
+        d_nm->mkNode(kind::STRING_CONCAT, s, s));
+    Node u = d_nm->mkNode(
+        kind::BITVECTOR_XOR, z, d_nm->mkNode(kind::BITVECTOR_NOT, z));
+
+    std::vector<Node> args = {x, y, s, z};
+    std::vector<std::vector<Node> > points;
+    for (unsigned i = 0; i < 6; i++)
+    {
+      std::vector<Node> pt;
+      pt.push_back(d_nm->mkConst(BitVector(8, i * 37 + 11)));
+      pt.push_back(d_nm->mkConst(BitVector(8, i * 101 + 3)));
+      pt.push_back(d_nm->mkConst(String(std::string(i, 'a') + "bc")));
+      pt.push_back(d_nm->mkConst(BitVector(128, i)));
+      points.push_back(pt);
+    }
+    // a point whose value for x is not a constant
+    points.push_back(points[0]);
+    points.back()[0] = y;
+
+    Evaluator eval;
+    for (const Node& n : {t, u})
+    {
+      std::vector<Node> results;
+      eval.evalBatch(n, args, points, results);
+      TS_ASSERT_EQUALS(results.size(), points.size());
+      for (unsigned i = 0, npts = points.size(); i < npts; i++)
+      {
+        Node r = eval.eval(n, args, points[i]);
+        TS_ASSERT_EQUALS(results[i], r);
+        TS_ASSERT_EQUALS(eval.evalCached(n, args, points[i]), r);
+        if (i + 1 < npts)
+        {
+          TS_ASSERT_EQUALS(
+              r,
+              Rewriter::rewrite(n.substitute(args.begin(),
+                                             args.end(),
+                                             points[i].begin(),
+                                             points[i].end())));
+        }
+      }
+    }
+  }
 };